@@ -0,0 +1,14 @@
+#!/usr/bin/env bash
+# Compare two result files written by run.sh (--json, or BENCH_SAVE=path) on
+# the same machine.
+#
+#   bash bench/compiler/compare.sh BASE.json NEW.json [THRESHOLD_PCT]
+#
+# Exits 1 if any metric regressed by more than THRESHOLD_PCT (default 20).
+set -euo pipefail
+HERE="$(cd "$(dirname "$0")" && pwd)"
+[ $# -ge 2 ] || { echo "usage: $0 BASE.json NEW.json [THRESHOLD_PCT]" >&2; exit 2; }
+OUT="${TMPDIR:-/tmp}/lain_compiler_cmp.$$"; mkdir -p "$OUT"
+trap 'rm -rf "$OUT"' EXIT
+gcc -std=c99 -O2 -o "$OUT/driver" "$HERE/driver.c"
+"$OUT/driver" compare "$@"
@@ -0,0 +1,321 @@
+/* Measurement and comparison driver for the compiler throughput suite.
+ *
+ *   driver run LAIN DIR NAME LINES REPS
+ *       Compiles DIR/main.ln REPS times (working directory DIR, so module
+ *       imports resolve) with `--time-passes=0 --stats` and prints one JSON
+ *       case object with the median of every metric over the runs: CPU time
+ *       and lines/sec per CPU second, wall time, peak RSS of the compiler
+ *       process and the self time of every pass. CPU time is the gated
+ *       figure because it moves least when the machine is busy.
+ *
+ *   driver pair BASE_LAIN NEW_LAIN DIR NAME LINES REPS BASE_OUT NEW_OUT
+ *       The same for two compilers, alternating their runs so that drift in
+ *       the machine's speed hits both alike; appends BASE_LAIN's case object
+ *       to BASE_OUT and NEW_LAIN's to NEW_OUT.
+ *
+ *   driver compare BASE.json NEW.json [THRESHOLD_PCT]
+ *       Prints every metric side by side and exits 1 if CPU time, lines/sec
+ *       or peak RSS regressed by more than THRESHOLD_PCT (default
+ *       20, as in run.sh). Wall and per-pass times are marked but do not fail the run:
+ *       they are too noisy to gate on. Differences under the
+ *       noise floor (2 ms, 1 MiB) never count.
+ *
+ * POSIX only (fork/exec, wait4 for the child's peak RSS).
+ */
+#define _DEFAULT_SOURCE
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/time.h>
+#include <sys/wait.h>
+
+#define DEFAULT_THRESHOLD_PCT 20.0
+#define NOISE_MS   2.0
+#define NOISE_KIB  1024.0
+
+static const char *pass_names[] = {
+    "load_module", "sema_build_scope", "resolve", "infer",
+    "linearity", "vra", "niche", "emit",
+};
+#define PASS_COUNT 8
+
+typedef struct {
+    double wall_ms;
+    double cpu_ms;          /* user + system time of the lain process */
+    double total_ms;        /* lain's own "total" (no process start/exit) */
+    double pass_ms[PASS_COUNT];
+    long   peak_rss_kib;
+} Run;
+
+static double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e3 + (double)ts.tv_nsec / 1e6;
+}
+
+/* One compile; false if lain could not be run or failed. */
+static int run_once(const char *lain, const char *dir, Run *r) {
+    char log_path[] = "/tmp/lain_bench_XXXXXX";
+    int log_fd = mkstemp(log_path);
+    if (log_fd < 0) { perror("mkstemp"); return 0; }
+    unlink(log_path);
+
+    double t0 = now_ms();
+    pid_t pid = fork();
+    if (pid < 0) { perror("fork"); return 0; }
+    if (pid == 0) {
+        int null_fd = open("/dev/null", O_WRONLY);
+        if (chdir(dir) != 0) _exit(126);
+        if (null_fd >= 0) dup2(null_fd, 1);
+        dup2(log_fd, 2);
+        execl(lain, lain, "main.ln", "-o", "main.c", "--time-passes=0", "--stats", (char *)NULL);
+        _exit(127);
+    }
+    int status;
+    struct rusage usage;
+    if (wait4(pid, &status, 0, &usage) < 0) { perror("wait4"); return 0; }
+    r->wall_ms = now_ms() - t0;
+    r->peak_rss_kib = usage.ru_maxrss;
+    r->cpu_ms = (double)(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1e3
+              + (double)(usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e3;
+
+    /* Pass table: "  <pass>  <ms>  <pct>%  <calls>  <KiB>", then "  total  <ms>". */
+    lseek(log_fd, 0, SEEK_SET);
+    FILE *log = fdopen(log_fd, "r");
+    char line[1024];
+    memset(r->pass_ms, 0, sizeof r->pass_ms);
+    r->total_ms = 0;
+    while (log && fgets(line, sizeof line, log)) {
+        char name[64];
+        double ms;
+        if (sscanf(line, " %63s %lf", name, &ms) != 2) continue;
+        if (strcmp(name, "total") == 0) r->total_ms = ms;
+        for (int p = 0; p < PASS_COUNT; p++)
+            if (strcmp(name, pass_names[p]) == 0) r->pass_ms[p] = ms;
+    }
+    if (log) fclose(log);
+    else close(log_fd);
+
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        fprintf(stderr, "driver: %s/main.ln did not compile (status %d)\n", dir, status);
+        return 0;
+    }
+    return 1;
+}
+
+static int cmp_double(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+/* Median of `field` (a double at that offset in Run) over `n` runs. */
+static double median_at(const Run *runs, int n, size_t field, double *scratch) {
+    for (int i = 0; i < n; i++) scratch[i] = *(const double *)((const char *)&runs[i] + field);
+    qsort(scratch, (size_t)n, sizeof *scratch, cmp_double);
+    return n % 2 ? scratch[n / 2] : (scratch[n / 2 - 1] + scratch[n / 2]) / 2.0;
+}
+
+/* Print the case object of `runs`: every metric is its median over the runs. */
+static int print_case(FILE *out, const char *name, long lines, const Run *runs, int n) {
+    double *scratch = malloc((size_t)n * sizeof *scratch);
+    if (!scratch) { perror("malloc"); return 0; }
+    Run m;
+    m.cpu_ms   = median_at(runs, n, offsetof(Run, cpu_ms), scratch);
+    m.wall_ms  = median_at(runs, n, offsetof(Run, wall_ms), scratch);
+    m.total_ms = median_at(runs, n, offsetof(Run, total_ms), scratch);
+    for (int p = 0; p < PASS_COUNT; p++)
+        m.pass_ms[p] = median_at(runs, n, offsetof(Run, pass_ms) + (size_t)p * sizeof(double), scratch);
+    for (int i = 0; i < n; i++) scratch[i] = (double)runs[i].peak_rss_kib;
+    qsort(scratch, (size_t)n, sizeof *scratch, cmp_double);
+    m.peak_rss_kib = (long)scratch[n / 2];
+    free(scratch);
+
+    fprintf(out, "    {\"name\": \"%s\", \"lines\": %ld, \"cpu_ms\": %.3f, \"lines_per_sec\": %.0f, "
+            "\"peak_rss_kib\": %ld, \"wall_ms\": %.3f, \"total_ms\": %.3f,\n     \"phases_ms\": {",
+            name, lines, m.cpu_ms, m.cpu_ms > 0 ? (double)lines * 1e3 / m.cpu_ms : 0.0,
+            m.peak_rss_kib, m.wall_ms, m.total_ms);
+    for (int p = 0; p < PASS_COUNT; p++)
+        fprintf(out, "%s\"%s\": %.3f", p ? ", " : "", pass_names[p], m.pass_ms[p]);
+    fprintf(out, "}}");
+    return 1;
+}
+
+/* Run each of the `n` compilers REPS times, in turn, and print a case object
+   for each to outs[i]. */
+static int measure(const char **lains, FILE **outs, int n, const char *dir,
+                   const char *name, long lines, int reps) {
+    Run *runs = calloc((size_t)(n * reps), sizeof *runs);
+    if (!runs) { perror("calloc"); return 1; }
+    int ok = 1;
+    for (int i = 0; ok && i < reps; i++)
+        for (int c = 0; ok && c < n; c++)
+            ok = run_once(lains[c], dir, &runs[c * reps + i]);
+    for (int c = 0; ok && c < n; c++)
+        ok = print_case(outs[c], name, lines, &runs[c * reps], reps);
+    free(runs);
+    return ok ? 0 : 1;
+}
+
+static int cmd_run(int argc, char **argv) {
+    if (argc != 7) {
+        fprintf(stderr, "usage: driver run LAIN DIR NAME LINES REPS\n");
+        return 2;
+    }
+    const char *lain = argv[2];
+    FILE *out = stdout;
+    int reps = atoi(argv[6]);
+    return measure(&lain, &out, 1, argv[3], argv[4], atol(argv[5]), reps < 1 ? 1 : reps);
+}
+
+static int cmd_pair(int argc, char **argv) {
+    if (argc != 10) {
+        fprintf(stderr, "usage: driver pair BASE_LAIN NEW_LAIN DIR NAME LINES REPS BASE_OUT NEW_OUT\n");
+        return 2;
+    }
+    const char *lains[2] = { argv[2], argv[3] };
+    FILE *outs[2] = { fopen(argv[8], "a"), fopen(argv[9], "a") };
+    if (!outs[0] || !outs[1]) { perror("driver pair"); return 2; }
+    int reps = atoi(argv[7]);
+    int rc = measure(lains, outs, 2, argv[4], argv[5], atol(argv[6]), reps < 1 ? 1 : reps);
+    if (fclose(outs[0]) != 0 || fclose(outs[1]) != 0) { perror("driver pair"); rc = 2; }
+    return rc;
+}
+
+/* ── compare ─────────────────────────────────────────────────────────────── */
+
+typedef struct {
+    char   name[64];
+    char   metric[96];     /* "wall_ms", "phases_ms.infer", ... */
+    double value;
+} Metric;
+
+typedef struct {
+    Metric *items;
+    int     count, cap;
+} Metrics;
+
+static char *read_file(const char *path) {
+    FILE *f = fopen(path, "rb");
+    if (!f) { perror(path); exit(2); }
+    fseek(f, 0, SEEK_END);
+    long n = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    char *text = malloc((size_t)n + 1);
+    if (!text || fread(text, 1, (size_t)n, f) != (size_t)n) { perror(path); exit(2); }
+    text[n] = '\0';
+    fclose(f);
+    return text;
+}
+
+static const char *read_string(const char *p, char *out, size_t cap) {
+    size_t n = 0;
+    for (p++; *p && *p != '"'; p++)
+        if (n + 1 < cap) out[n++] = *p;
+    out[n] = '\0';
+    return *p ? p + 1 : p;
+}
+
+/* Flatten the numeric fields of every case in a results file written by
+   run.sh. Only that shape is understood: a "cases" array of flat objects,
+   with one nested object of numbers ("phases_ms"). */
+static Metrics load_metrics(const char *path) {
+    Metrics m = {0};
+    char *text = read_file(path);
+    const char *cases = strstr(text, "\"cases\"");
+    char current[64] = "", prefix[64] = "", key[64];
+    int depth = 0;
+    for (const char *p = cases ? cases : text; *p; ) {
+        if (*p == '{') { depth++; p++; continue; }
+        if (*p == '}') { if (--depth <= 1) prefix[0] = '\0'; p++; continue; }
+        if (*p != '"') { p++; continue; }
+        p = read_string(p, key, sizeof key);
+        while (*p == ' ' || *p == ':' || *p == '\n') p++;
+        if (*p == '"') {
+            char value[64];
+            p = read_string(p, value, sizeof value);
+            if (strcmp(key, "name") == 0) snprintf(current, sizeof current, "%s", value);
+        } else if (*p == '{') {
+            snprintf(prefix, sizeof prefix, "%s.", key);
+        } else if (current[0]) {
+            char *end;
+            double v = strtod(p, &end);
+            if (end == p) continue;
+            p = end;
+            if (m.count == m.cap) {
+                m.cap = m.cap ? m.cap * 2 : 64;
+                m.items = realloc(m.items, (size_t)m.cap * sizeof *m.items);
+                if (!m.items) { perror("realloc"); exit(2); }
+            }
+            Metric *it = &m.items[m.count++];
+            snprintf(it->name, sizeof it->name, "%s", current);
+            snprintf(it->metric, sizeof it->metric, "%s%s", prefix, key);
+            it->value = v;
+        }
+    }
+    free(text);
+    return m;
+}
+
+static const Metric *find_metric(const Metrics *m, const char *name, const char *metric) {
+    for (int i = 0; i < m->count; i++)
+        if (strcmp(m->items[i].name, name) == 0 && strcmp(m->items[i].metric, metric) == 0)
+            return &m->items[i];
+    return NULL;
+}
+
+static int cmd_compare(int argc, char **argv) {
+    if (argc < 4 || argc > 5) {
+        fprintf(stderr, "usage: driver compare BASE.json NEW.json [THRESHOLD_PCT]\n");
+        return 2;
+    }
+    double threshold = argc == 5 ? atof(argv[4]) : DEFAULT_THRESHOLD_PCT;
+    Metrics base = load_metrics(argv[2]);
+    Metrics cur = load_metrics(argv[3]);
+    int regressions = 0;
+
+    printf("%-10s %-24s %14s %14s %9s\n", "case", "metric", "base", "new", "change");
+    for (int i = 0; i < base.count; i++) {
+        const Metric *b = &base.items[i];
+        if (strcmp(b->metric, "lines") == 0) continue;
+        const Metric *n = find_metric(&cur, b->name, b->metric);
+        if (!n) {
+            printf("%-10s %-24s %14.1f %14s %9s  MISSING\n", b->name, b->metric, b->value, "-", "-");
+            regressions++;
+            continue;
+        }
+        double change = b->value != 0 ? (n->value - b->value) * 100.0 / b->value : 0.0;
+        int higher_is_better = strcmp(b->metric, "lines_per_sec") == 0;
+        int is_rss = strcmp(b->metric, "peak_rss_kib") == 0;
+        double floor = is_rss ? NOISE_KIB : NOISE_MS;
+        int gated = strcmp(b->metric, "cpu_ms") == 0 || higher_is_better || is_rss;
+        int worse;
+        if (higher_is_better) {
+            worse = change < -threshold;
+        } else {
+            worse = change > threshold && n->value - b->value >= floor;
+        }
+        if (gated) regressions += worse;
+        printf("%-10s %-24s %14.1f %14.1f %+8.1f%%%s\n", b->name, b->metric, b->value, n->value,
+               change, !worse ? "" : gated ? "  REGRESSION" : "  (slower)");
+    }
+    if (regressions) printf("\n%d regression(s) over %.0f%%\n", regressions, threshold);
+    else printf("\nno regressions over %.0f%%\n", threshold);
+    free(base.items);
+    free(cur.items);
+    return regressions ? 1 : 0;
+}
+
+int main(int argc, char **argv) {
+    if (argc >= 2 && strcmp(argv[1], "run") == 0) return cmd_run(argc, argv);
+    if (argc >= 2 && strcmp(argv[1], "pair") == 0) return cmd_pair(argc, argv);
+    if (argc >= 2 && strcmp(argv[1], "compare") == 0) return cmd_compare(argc, argv);
+    fprintf(stderr, "usage: driver run LAIN DIR NAME LINES REPS\n"
+                    "       driver pair BASE_LAIN NEW_LAIN DIR NAME LINES REPS BASE_OUT NEW_OUT\n"
+                    "       driver compare BASE.json NEW.json [THRESHOLD_PCT]\n");
+    return 2;
+}
@@ -0,0 +1,213 @@
+/* Synthetic Lain programs for the compiler throughput suite (see run.sh).
+ *
+ *   gen KIND SIZE DIR    writes DIR/main.ln (plus DIR/modN.ln for `imports`)
+ *                        and prints the number of source lines written.
+ *
+ * Every program compiles cleanly, so a run measures the whole pipeline and a
+ * generator change that breaks one shows up as a failed case, not as a fast
+ * one. Each shape stresses one axis of sema scaling:
+ *
+ *   functions  SIZE small functions (the common case: many short bodies)
+ *   nesting    SIZE functions with blocks nested 64 deep
+ *   enums      SIZE enums of 300 variants, matched exhaustively
+ *   match      SIZE functions with a 120-arm integer `case`
+ *   generics   SIZE generic functions and structs, each instantiated at the
+ *              eight integer types
+ *   imports    SIZE modules, each importing up to four others, all imported
+ *              by the root (a wide import graph)
+ */
+#define _POSIX_C_SOURCE 200809L
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define NEST_DEPTH     64
+#define ENUM_VARIANTS  300
+#define MATCH_ARMS     120
+#define IMPORT_FANOUT  4
+
+static const char *int_types[] = { "i8", "i16", "i32", "i64", "u8", "u16", "u32", "u64" };
+#define INT_TYPE_COUNT 8
+
+static FILE *out;
+static long lines;
+
+static void emit(const char *fmt, ...) {
+    va_list ap;
+    va_start(ap, fmt);
+    vfprintf(out, fmt, ap);
+    va_end(ap);
+    for (const char *p = fmt; *p; p++) lines += *p == '\n';
+}
+
+static void open_file(const char *dir, const char *name) {
+    char path[4096];
+    snprintf(path, sizeof path, "%s/%s", dir, name);
+    out = fopen(path, "w");
+    if (!out) {
+        perror(path);
+        exit(1);
+    }
+}
+
+static void close_file(void) {
+    if (fclose(out) != 0) {
+        perror("gen");
+        exit(1);
+    }
+}
+
+static void gen_functions(int n) {
+    for (int i = 0; i < n; i++) {
+        emit("func f%d(a i32) i32 {\n", i);
+        emit("    var x i32 = %d\n", i % 1000);
+        emit("    if a > 0 {\n");
+        emit("        x = 1\n");
+        emit("    }\n");
+        emit("    for k in 0..3 {\n");
+        emit("        x = x +%% a\n");
+        emit("    }\n");
+        emit("    return x\n");
+        emit("}\n");
+    }
+    emit("proc main() i32 {\n    return f0(0)\n}\n");
+}
+
+static void indent(int depth) {
+    for (int i = 0; i < depth; i++) emit("    ");
+}
+
+static void gen_nesting(int n) {
+    for (int f = 0; f < n; f++) {
+        emit("func n%d(a i32) i32 {\n", f);
+        emit("    var r i32 = 0\n");
+        for (int d = 1; d <= NEST_DEPTH; d++) {
+            indent(d);
+            emit("if a > %d {\n", d - 1);
+            indent(d + 1);
+            emit("var v%d i32 = %d\n", d, d);
+            indent(d + 1);
+            emit("r = v%d\n", d);
+        }
+        for (int d = NEST_DEPTH; d >= 1; d--) {
+            indent(d);
+            emit("} else {\n");
+            indent(d + 1);
+            emit("r = %d\n", -d);
+            indent(d);
+            emit("}\n");
+        }
+        emit("    return r\n}\n");
+    }
+    emit("proc main() i32 {\n    return n0(0) + 1\n}\n");
+}
+
+static void gen_enums(int n) {
+    for (int e = 0; e < n; e++) {
+        emit("type E%d {\n", e);
+        for (int v = 0; v < ENUM_VARIANTS; v++)
+            emit("    V%d%s\n", v, v + 1 < ENUM_VARIANTS ? "," : "");
+        emit("}\n");
+
+        emit("func e%d_code(e E%d) i32 {\n    return case e {\n", e, e);
+        for (int v = 0; v < ENUM_VARIANTS; v++) emit("        V%d: %d\n", v, v);
+        emit("    }\n}\n");
+
+        /* Fall-through groups of four variants. */
+        emit("func e%d_group(e E%d) i32 {\n    var r i32 = 0\n    case e {\n", e, e);
+        for (int v = 0; v < ENUM_VARIANTS; v += 4) {
+            emit("        ");
+            for (int k = v; k < v + 4 && k < ENUM_VARIANTS; k++)
+                emit("V%d%s", k, k + 1 < v + 4 && k + 1 < ENUM_VARIANTS ? ", " : "");
+            emit(": r = %d\n", v / 4);
+        }
+        emit("    }\n    return r\n}\n");
+    }
+    emit("proc main() i32 {\n    var a = E0.V1\n    var b = E0.V2\n    return e0_code(a) + e0_group(b) - 1\n}\n");
+}
+
+static void gen_match(int n) {
+    for (int f = 0; f < n; f++) {
+        emit("func m%d(x i32) i32 {\n    return case x {\n", f);
+        for (int a = 0; a < MATCH_ARMS; a++) {
+            if (a % 10 == 9) emit("        %d..%d: %d\n", a * 4, a * 4 + 3, a);
+            else emit("        %d: %d\n", a * 4, a);
+        }
+        emit("        else: -1\n    }\n}\n");
+    }
+    emit("proc main() i32 {\n    return m0(0)\n}\n");
+}
+
+static void gen_generics(int n) {
+    for (int g = 0; g < n; g++) {
+        emit("func g%d(T type, a T, b T) T {\n", g);
+        emit("    var x T = a\n");
+        emit("    if a > b { x = b }\n");
+        emit("    return x\n}\n");
+        emit("type P%d(T type) {\n    a T\n    b T\n}\n", g);
+        emit("func p%d_first(T type, p P%d(T)) T {\n    return p.a\n}\n", g, g);
+        for (int t = 0; t < INT_TYPE_COUNT; t++) {
+            const char *ty = int_types[t];
+            emit("func use%d_%s() %s {\n", g, ty, ty);
+            emit("    var p P%d(%s) = P%d(%s, 4, 9)\n", g, ty, g, ty);
+            emit("    return g%d(%s, p%d_first(%s, p), 2)\n}\n", g, ty, g, ty);
+        }
+    }
+    emit("proc main() i32 {\n    return use0_i32() - 2\n}\n");
+}
+
+static void gen_imports(const char *dir, int n) {
+    char name[64];
+    for (int m = 0; m < n; m++) {
+        snprintf(name, sizeof name, "mod%d.ln", m);
+        open_file(dir, name);
+        /* Each module imports a few lower-numbered ones (a wide DAG) and
+           calls into each of them. */
+        int deps[IMPORT_FANOUT], n_deps = 0;
+        for (int k = 1; k <= IMPORT_FANOUT && m - k * k >= 0; k++) deps[n_deps++] = m - k * k;
+        for (int d = 0; d < n_deps; d++) emit("import mod%d\n", deps[d]);
+        for (int f = 0; f < 8; f++) {
+            emit("func mod%d_f%d(a i32 < 100) i32 {\n", m, f);
+            emit("    var x i32 = a\n");
+            emit("    if x < 0 { x = 0 }\n");
+            emit("    return x + %d\n}\n", f);
+        }
+        for (int d = 0; d < n_deps; d++)
+            emit("func mod%d_use%d(a i32 < 100) i32 {\n    return mod%d.mod%d_f%d(a)\n}\n",
+                 m, d, deps[d], deps[d], d);
+        close_file();
+    }
+    open_file(dir, "main.ln");
+    for (int m = 0; m < n; m++) emit("import mod%d\n", m);
+    emit("proc main() i32 {\n    return mod0.mod0_f0(0) +%% mod%d.mod%d_f1(0) -%% 1\n}\n", n - 1, n - 1);
+    close_file();
+}
+
+int main(int argc, char **argv) {
+    if (argc != 4) {
+        fprintf(stderr, "usage: gen KIND SIZE DIR\n");
+        return 2;
+    }
+    const char *kind = argv[1], *dir = argv[3];
+    int size = atoi(argv[2]);
+    if (size < 1) size = 1;
+
+    if (strcmp(kind, "imports") == 0) {
+        gen_imports(dir, size);
+    } else {
+        open_file(dir, "main.ln");
+        if      (strcmp(kind, "functions") == 0) gen_functions(size);
+        else if (strcmp(kind, "nesting")   == 0) gen_nesting(size);
+        else if (strcmp(kind, "enums")     == 0) gen_enums(size);
+        else if (strcmp(kind, "match")     == 0) gen_match(size);
+        else if (strcmp(kind, "generics")  == 0) gen_generics(size);
+        else {
+            fprintf(stderr, "gen: unknown program kind '%s'\n", kind);
+            return 2;
+        }
+        close_file();
+    }
+    printf("%ld\n", lines);
+    return 0;
+}
@@ -0,0 +1,66 @@
+#!/usr/bin/env bash
+# Compiler throughput: lines/sec, per-pass time and peak RSS of `lain` on
+# synthetic programs (gen.c). The working tree is compared against a base
+# revision built and measured on the same machine, in the same run.
+#
+#   bash bench/compiler/run.sh          measure the tree and BENCH_BASE, compare
+#   bash bench/compiler/run.sh --json   measure the tree only, print the results
+#
+# BENCH_BASE (default HEAD) is any git revision; BENCH_SCALE=N (percent,
+# default 100) scales every program; BENCH_REPS (default 5) runs per case and
+# compiler, alternating the two compilers, the median is kept;
+# BENCH_THRESHOLD (default 20) percent; BENCH_SAVE=path keeps the results.
+set -euo pipefail
+HERE="$(cd "$(dirname "$0")" && pwd)"; ROOT="$(cd "$HERE/../.." && pwd)"
+OUT="${TMPDIR:-/tmp}/lain_compiler.$$"; mkdir -p "$OUT"
+trap 'rm -rf "$OUT"' EXIT
+SCALE="${BENCH_SCALE:-100}"; REPS="${BENCH_REPS:-5}"; THRESHOLD="${BENCH_THRESHOLD:-20}"
+BASE="${BENCH_BASE:-HEAD}"
+JSON_ONLY=0; [ "${1:-}" = "--json" ] && JSON_ONLY=1
+
+# Always fresh -O2 builds of the trees being measured, never a stale ./lain.
+build() { gcc -std=c99 -D_DEFAULT_SOURCE -O2 -o "$2" "$1/src/main.c" -I "$1/src"; }
+LAIN="$OUT/lain"
+build "$ROOT" "$LAIN"
+if [ "$JSON_ONLY" -eq 0 ]; then
+    mkdir -p "$OUT/base"
+    git -C "$ROOT" archive "$BASE" src | tar -x -C "$OUT/base"
+    build "$OUT/base" "$OUT/lain_base" || { echo "cannot build $BASE" >&2; exit 2; }
+fi
+gcc -std=c99 -O2 -o "$OUT/gen" "$HERE/gen.c"
+gcc -std=c99 -O2 -o "$OUT/driver" "$HERE/driver.c"
+
+# kind:size at BENCH_SCALE=100, each roughly 1-1.5 s of compile time, so
+# process start-up and timer resolution stay well under the threshold.
+CASES="functions:60000 nesting:900 enums:300 match:7000 generics:250 imports:4000"
+
+RESULTS="$OUT/results.json"; BASE_RESULTS="$OUT/base.json"
+for f in "$RESULTS" "$BASE_RESULTS"; do
+    printf '{\n  "suite": "compiler",\n  "scale": %s,\n  "cases": [\n' "$SCALE" > "$f"
+done
+sep=""
+for c in $CASES; do
+    kind="${c%%:*}"; size=$(( ${c##*:} * SCALE / 100 ))
+    mkdir -p "$OUT/$kind"
+    lines=$("$OUT/gen" "$kind" "$size" "$OUT/$kind")
+    printf '%s' "$sep" >> "$RESULTS"
+    if [ "$JSON_ONLY" -eq 1 ]; then
+        "$OUT/driver" run "$LAIN" "$OUT/$kind" "$kind" "$lines" "$REPS" >> "$RESULTS"
+    else
+        printf '%s' "$sep" >> "$BASE_RESULTS"
+        "$OUT/driver" pair "$OUT/lain_base" "$LAIN" "$OUT/$kind" "$kind" "$lines" "$REPS" \
+            "$BASE_RESULTS" "$RESULTS"
+    fi
+    sep=$',\n'
+done
+for f in "$RESULTS" "$BASE_RESULTS"; do
+    printf '\n  ]\n}\n' >> "$f"
+done
+
+[ -z "${BENCH_SAVE:-}" ] || cp "$RESULTS" "$BENCH_SAVE"
+if [ "$JSON_ONLY" -eq 1 ]; then
+    cat "$RESULTS"
+else
+    echo "base: $BASE ($(git -C "$ROOT" rev-parse --short "$BASE")), new: working tree"
+    "$OUT/driver" compare "$BASE_RESULTS" "$RESULTS" "$THRESHOLD"
+fi
@@ -0,0 +1,39 @@
+/* `for` lowering: the kernels in forlow.ln (counter typed from the range,
+ * element bound with its own C type) against C copies of the previous
+ * lowering, which bound every element as `int v` and counted ranges in `int`.
+ * Build with run.sh (-O3 -march=native). */
+#define _POSIX_C_SOURCE 199309L
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <time.h>
+#define N 65536
+extern uint32_t forlow_sum_u8(size_t, const uint8_t*);
+extern uint32_t forlow_count_above(size_t, const float*, float);
+extern uint64_t forlow_sum_u64(size_t, const uint64_t*);
+/* previous lowering, verbatim shape */
+__attribute__((noinline)) static uint32_t old_sum_u8(size_t len, const uint8_t *restrict a){
+    uint32_t s=0; for(size_t i=0;i<len;++i){int v=a[i]; s=(s+((uint32_t)(v)));} return s;}
+__attribute__((noinline)) static uint32_t old_count_above(size_t len, const float *restrict a, float t){
+    uint32_t c=0; for(size_t i=0;i<len;++i){int v=a[i]; if(v>t){c=(c+1);}} return c;}
+__attribute__((noinline)) static uint64_t old_sum_u64(size_t n, const uint64_t *restrict a){
+    uint64_t s=0; for(int j=0;j<n;++j){int i=(int)j; s=(s+a[i]);} return s;}
+static double now(void){struct timespec t;clock_gettime(CLOCK_MONOTONIC,&t);return t.tv_sec+t.tv_nsec*1e-9;}
+#define BENCH(label, expr, bytes) do { \
+    volatile uint64_t r = 0; double t0 = now(); \
+    for (int k = 0; k < it; k++) r += (expr); \
+    double t1 = now(); \
+    printf("%-28s %7.2f GB/s   result %llu\n", label, (double)(bytes)*it/1e9/(t1-t0), \
+           (unsigned long long)((expr))); (void)r; } while (0)
+int main(void){
+    static uint8_t b[N]; static float f[N]; static uint64_t w[N];
+    for(int i=0;i<N;i++){b[i]=(uint8_t)(i*7); f[i]=(float)(i%100)/100.0f; w[i]=(uint64_t)i*3;}
+    int it=20000;
+    BENCH("u8 sum      typed",  forlow_sum_u8(N,b), N);
+    BENCH("u8 sum      int v",  old_sum_u8(N,b), N);
+    BENCH("f32 count   typed",  forlow_count_above(N,f,0.5f), N*4);
+    BENCH("f32 count   int v",  old_count_above(N,f,0.5f), N*4);
+    BENCH("u64 sum     typed",  forlow_sum_u64(N,w), N*8);
+    BENCH("u64 sum     int i",  old_sum_u64(N,w), N*8);
+    return 0;
+}
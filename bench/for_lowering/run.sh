@@ -0,0 +1,14 @@
+#!/usr/bin/env bash
+# `for` lowering evidence: typed counters/bindings vs the old `int` lowering.
+# -O3 so gcc's cost model vectorizes the runtime-trip loops on both sides.
+set -euo pipefail
+HERE="$(cd "$(dirname "$0")" && pwd)"; ROOT="$(cd "$HERE/../.." && pwd)"; LAIN="$ROOT/lain"
+OUT="${TMPDIR:-/tmp}/lain_forlow.$$"; mkdir -p "$OUT"
+[ -x "$LAIN" ] || gcc -std=c99 -O2 -o "$LAIN" "$ROOT/src/main.c" -I "$ROOT/src"
+"$LAIN" "$HERE/forlow.ln" -o "$OUT/forlow.c"
+echo "== emitted loop heads =="
+grep -E 'for \(|= __slice|= __i' "$OUT/forlow.c"
+echo "== throughput =="
+gcc -O3 -march=native -std=gnu11 -w -o "$OUT/fl" "$OUT/forlow.c" "$HERE/driver.c"
+"$OUT/fl"
+rm -rf "$OUT"
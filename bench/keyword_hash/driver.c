@@ -0,0 +1,112 @@
+/* Keyword recognition: the perfect-hash token_match_keyword (src/token.h) vs the
+ * strncmp cascade it replaced, over every identifier in the std/ and tests/
+ * corpus. The identifier stream is extracted once up front so only the keyword
+ * match itself is timed — exactly the call the lexer makes per identifier.
+ * Build with run.sh. */
+#define _POSIX_C_SOURCE 199309L
+#include "token.h"
+
+/* The pre-hash implementation, verbatim: switch on length, then up to six
+ * strncmp calls. Kept here as the reference and the baseline to beat. */
+static TokenKind cascade_match_keyword(const char* lexeme, isize len) {
+    switch (len) {
+        case 2:
+            if (strncmp(lexeme, "if", 2) == 0)          return TOKEN_KEYWORD_IF;
+            if (strncmp(lexeme, "in", 2) == 0)          return TOKEN_KEYWORD_IN;
+            if (strncmp(lexeme, "as", 2) == 0)          return TOKEN_KEYWORD_AS;
+            if (strncmp(lexeme, "or", 2) == 0)          return TOKEN_KEYWORD_OR;
+            break;
+        case 3:
+            if (strncmp(lexeme, "for", 3) == 0)         return TOKEN_KEYWORD_FOR;
+            if (strncmp(lexeme, "var", 3) == 0)         return TOKEN_KEYWORD_VAR;
+            if (strncmp(lexeme, "mov", 3) == 0)         return TOKEN_KEYWORD_MOV;
+
+            if (strncmp(lexeme, "use", 3) == 0)         return TOKEN_KEYWORD_USE;
+            if (strncmp(lexeme, "and", 3) == 0)         return TOKEN_KEYWORD_AND;
+            if (strncmp(lexeme, "nil", 3) == 0)         return TOKEN_KEYWORD_NIL;
+            break;
+        case 4:
+            if (strncmp(lexeme, "type", 4) == 0)        return TOKEN_KEYWORD_TYPE;
+            if (strncmp(lexeme, "func", 4) == 0)        return TOKEN_KEYWORD_FUNC;
+            if (strncmp(lexeme, "proc", 4) == 0)        return TOKEN_KEYWORD_PROC;
+            if (strncmp(lexeme, "else", 4) == 0)        return TOKEN_KEYWORD_ELSE;
+            if (strncmp(lexeme, "case", 4) == 0)        return TOKEN_KEYWORD_CASE;
+            if (strncmp(lexeme, "true", 4) == 0)        return TOKEN_KEYWORD_TRUE;
+            break;
+        case 5:
+            if (strncmp(lexeme, "break", 5) == 0)       return TOKEN_KEYWORD_BREAK;
+            if (strncmp(lexeme, "false", 5) == 0)       return TOKEN_KEYWORD_FALSE;
+            if (strncmp(lexeme, "while", 5) == 0)       return TOKEN_KEYWORD_WHILE;
+            if (strncmp(lexeme, "defer", 5) == 0)       return TOKEN_KEYWORD_DEFER;
+            break;
+        case 6:
+            if (strncmp(lexeme, "import", 6) == 0)      return TOKEN_KEYWORD_IMPORT;
+            if (strncmp(lexeme, "extern", 6) == 0)      return TOKEN_KEYWORD_EXTERN;
+            if (strncmp(lexeme, "return", 6) == 0)      return TOKEN_KEYWORD_RETURN;
+            if (strncmp(lexeme, "unsafe", 6) == 0)      return TOKEN_KEYWORD_UNSAFE;
+            break;
+        case 8:
+            if (strncmp(lexeme, "continue", 8) == 0)    return TOKEN_KEYWORD_CONTINUE;
+            if (strncmp(lexeme, "comptime", 8) == 0)    return TOKEN_KEYWORD_COMPTIME;
+            break;
+        case 9:
+            if (strncmp(lexeme, "c_include", 9) == 0)   return TOKEN_KEYWORD_C_INCLUDE;
+            break;
+        case 10:
+            if (strncmp(lexeme, "decreasing", 10) == 0) return TOKEN_KEYWORD_DECREASING;
+            break;
+    }
+    return TOKEN_IDENTIFIER;
+}
+
+typedef struct { const char *start; isize length; } Ident;
+
+static double now(void){struct timespec t;clock_gettime(CLOCK_MONOTONIC,&t);return (double)t.tv_sec+(double)t.tv_nsec*1e-9;}
+
+static bool is_ident_start(char c){ return (c>='a'&&c<='z')||(c>='A'&&c<='Z')||c=='_'; }
+static bool is_ident_char(char c){ return is_ident_start(c)||(c>='0'&&c<='9'); }
+
+/* Append every identifier-shaped lexeme of `src` to `out` (grows with realloc). */
+static void collect(const char *src, Ident **out, isize *n, isize *cap){
+    for (const char *p = src; *p; ) {
+        if (!is_ident_start(*p)) { p++; continue; }
+        const char *s = p; while (is_ident_char(*p)) p++;
+        if (*n == *cap) { *cap = *cap ? *cap * 2 : 4096; *out = realloc(*out, (size_t)*cap * sizeof **out); }
+        (*out)[(*n)++] = (Ident){ s, p - s };
+    }
+}
+
+static char *slurp(const char *path){
+    FILE *f = fopen(path, "rb"); if (!f) return NULL;
+    fseek(f, 0, SEEK_END); long n = ftell(f); fseek(f, 0, SEEK_SET);
+    char *buf = malloc((size_t)n + 1);
+    if (fread(buf, 1, (size_t)n, f) != (size_t)n) n = 0;
+    buf[n] = '\0'; fclose(f); return buf;
+}
+
+int main(int argc, char **argv){
+    Ident *ids = NULL; isize n = 0, cap = 0; int files = 0;
+    for (int i = 1; i < argc; i++) { char *s = slurp(argv[i]); if (s) { collect(s, &ids, &n, &cap); files++; } }
+    if (n == 0) { fprintf(stderr, "no identifiers (pass .ln files)\n"); return 1; }
+
+    isize kw = 0, mismatches = 0;
+    for (isize i = 0; i < n; i++) {
+        TokenKind a = token_match_keyword(ids[i].start, ids[i].length);
+        TokenKind b = cascade_match_keyword(ids[i].start, ids[i].length);
+        if (a != b) { if (mismatches++ < 5) fprintf(stderr, "  MISMATCH '%.*s': hash=%d cascade=%d\n",
+                                                    (int)ids[i].length, ids[i].start, a, b); }
+        if (b != TOKEN_IDENTIFIER) kw++;
+    }
+    printf("corpus: %d files, %ld identifiers (%.1f%% keywords)\n", files, (long)n, 100.0 * kw / n);
+    if (mismatches) printf("correctness: %ld MISMATCH\n", (long)mismatches);
+    else            printf("correctness: ALL OK\n");
+
+    int it = 200; volatile unsigned sink = 0; double t0, t1, t2, t3;
+    t0 = now(); for (int k = 0; k < it; k++) for (isize i = 0; i < n; i++) sink += cascade_match_keyword(ids[i].start, ids[i].length); t1 = now();
+    t2 = now(); for (int k = 0; k < it; k++) for (isize i = 0; i < n; i++) sink += token_match_keyword(ids[i].start, ids[i].length);   t3 = now();
+    double cas = (t1 - t0) * 1e9 / ((double)n * it), ph = (t3 - t2) * 1e9 / ((double)n * it);
+    printf("  strncmp cascade   %6.2f ns/ident\n", cas);
+    printf("  perfect hash      %6.2f ns/ident   (%.2fx)\n", ph, cas / ph);
+    (void)sink; free(ids);
+    return mismatches != 0;
+}
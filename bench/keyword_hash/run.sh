@@ -0,0 +1,9 @@
+#!/usr/bin/env bash
+# Keyword recognition microbenchmark: perfect-hash token_match_keyword vs the old
+# strncmp cascade, over every identifier in std/ and tests/.
+set -euo pipefail
+HERE="$(cd "$(dirname "$0")" && pwd)"; ROOT="$(cd "$HERE/../.." && pwd)"
+OUT="${TMPDIR:-/tmp}/lain_kwhash.$$"; mkdir -p "$OUT"
+gcc -O2 -std=c99 -D_DEFAULT_SOURCE -w -I "$ROOT/src" -o "$OUT/kwhash" "$HERE/driver.c"
+find "$ROOT/std" "$ROOT/tests" -name '*.ln' -print0 | xargs -0 "$OUT/kwhash"
+rm -rf "$OUT"
@@ -6,6 +6,8 @@
 #   other .ln  → treated as passing by default
 # If a _fail.ln file contains "// EXPECT: [EXXX]" in its contents,
 # stderr must contain that code.
+# Everything that must compile is compiled with --verify-sema, so codegen
+# reaching an expression sema did not type or resolve fails the test.
 
 set -u
 
@@ -82,7 +84,11 @@ run_test() {
 
     local out
     local rc
-    out="$("$LAIN" "$file" 2>&1)"
+    if [[ $is_fail -eq 1 ]]; then
+        out="$("$LAIN" "$file" 2>&1)"
+    else
+        out="$("$LAIN" "$file" --verify-sema 2>&1)"
+    fi
     rc=$?
 
     if [[ $is_fail -eq 1 ]]; then
@@ -125,7 +131,7 @@ run_emit_snapshot() {
         return 0
     fi
     local out_c="/tmp/lain_emit_$$.c"
-    "$LAIN" "$file" -o "$out_c" > /dev/null 2>&1
+    "$LAIN" "$file" -o "$out_c" --verify-sema > /dev/null 2>&1
     local rc=$?
     if [[ $rc -ne 0 ]]; then
         FAIL_COUNT=$((FAIL_COUNT + 1))
@@ -18,6 +18,14 @@ typedef struct
     bool        no_line_directives; // --no-line-directives: suppress #line in emitted C
     bool        dump_niche;         // --dump-niche: print enum niche layout decisions
     const char* target_triple;      // --target=<triple>, NULL = host
+    bool        time_passes;        // --time-passes[=N]: per-pass times + N slowest functions
+    int         time_passes_top;
+    bool        stats;              // --stats: per-pass arena peak growth + size counters
+    int         jobs;               // -j N / --jobs=N: parser threads (1 = serial, 0 = all cores)
+    const char* cache_dir;          // --cache-dir=<dir>: reuse the output of an unchanged build
+    const char* units_dir;          // --units=<dir>: one .c per module plus a shared lain.h
+    bool        verify_sema;        // --verify-sema: fail if codegen reaches an unannotated node
+    bool        whole_program;      // --whole-program: internal linkage unless [export]
 } Args;
 
 static void _args_help(void)
@@ -28,7 +36,21 @@ static void _args_help(void)
     printf("  --dump-ast            Print the AST after parsing\n");
     printf("  --no-line-directives  Suppress #line directives in emitted C\n");
     printf("  --dump-niche          Print niche layout decision for every enum\n");
+    printf("  --time-passes[=N]     Print wall time per compiler pass and the N\n");
+    printf("                        slowest functions (default 10) to stderr\n");
+    printf("  --stats               Print arena peak growth per pass and size counters\n");
+    printf("  --verify-sema         Check that every expression reaching codegen\n");
+    printf("                        was typed and resolved by sema\n");
+    printf("  --whole-program       The output is the whole program: give every\n");
+    printf("                        function except main and [export] ones\n");
+    printf("                        internal linkage\n");
     printf("  -o <file>             Set output C file (default: out.c)\n");
+    printf("  --units=<dir>         Write one C file per module and a shared\n");
+    printf("                        lain.h into <dir> instead of -o\n");
+    printf("  -j <N>, --jobs=<N>    Lex and parse modules on N threads\n");
+    printf("                        (default 1; 0 = one per online CPU)\n");
+    printf("  --cache-dir=<dir>     Store builds in <dir>; a build whose sources,\n");
+    printf("                        target and flags are unchanged is not redone\n");
     printf("  --target=<triple>     Cross-compile target. Supported:\n");
     printf("                          x86_64-linux-gnu, aarch64-linux-gnu,\n");
     printf("                          x86_64-windows-msvc, cortex-m4-bare, host\n");
@@ -42,6 +64,8 @@ static Args args_parse(int argc, char** argv)
 
     Args args = {0};
     args.output_file = "out.c";  // default
+    args.time_passes_top = 10;
+    args.jobs = 1;
 
     for (int i = 1; i < argc; i++) {
         if (strcmp(argv[i], "--dump-ast") == 0) {
@@ -54,6 +78,25 @@ static Args args_parse(int argc, char** argv)
             args.dump_niche = true;
         } else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
             args.output_file = argv[++i];
+        } else if (strcmp(argv[i], "--time-passes") == 0) {
+            args.time_passes = true;
+        } else if (strncmp(argv[i], "--time-passes=", 14) == 0) {
+            args.time_passes = true;
+            args.time_passes_top = atoi(argv[i] + 14);
+        } else if (strcmp(argv[i], "-j") == 0 && i + 1 < argc) {
+            args.jobs = atoi(argv[++i]);
+        } else if (strncmp(argv[i], "--jobs=", 7) == 0) {
+            args.jobs = atoi(argv[i] + 7);
+        } else if (strcmp(argv[i], "--stats") == 0) {
+            args.stats = true;
+        } else if (strcmp(argv[i], "--verify-sema") == 0) {
+            args.verify_sema = true;
+        } else if (strcmp(argv[i], "--whole-program") == 0) {
+            args.whole_program = true;
+        } else if (strncmp(argv[i], "--units=", 8) == 0) {
+            args.units_dir = argv[i] + 8;
+        } else if (strncmp(argv[i], "--cache-dir=", 12) == 0) {
+            args.cache_dir = argv[i] + 12;
         } else if (strncmp(argv[i], "--target=", 9) == 0) {
             args.target_triple = argv[i] + 9;
         } else {
@@ -61,10 +104,19 @@ static Args args_parse(int argc, char** argv)
         }
     }
     
+#if OS_LINUX
+    if (args.jobs <= 0) args.jobs = (int)sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+    if (args.jobs <= 0) args.jobs = 1;
+
     if (!args.filename) {
         printf("Error: No input file specified.\n");
         exit(1);
     }
+    if (args.whole_program && args.units_dir) {
+        printf("Error: --whole-program needs a single output file; modules split by --units call each other.\n");
+        exit(1);
+    }
     
     return args;
 }
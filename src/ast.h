@@ -3,6 +3,7 @@
 
 #include "utils/arena.h"
 #include "token.h"
+#include "intern.h"
 
 /*──────────────────────────────────────────────────────────────────╗
 │ FORWARD DECLARATIONS                                              │
@@ -26,6 +27,8 @@ typedef struct DeclList DeclList;
 typedef struct Id {
     isize       length;
     const char* name;
+    const char* atom;   // interned spelling (intern.h): equal names <=> equal atoms
+    uint32      hash;   // intern_hash of the spelling
 } Id;
 
 /*──────────────────────────────────────────────────────────────────╗
@@ -326,6 +329,7 @@ typedef struct {
     Id       *value_name;  // always non‐NULL
     Expr     *iterable;
     StmtList *body;
+    Type     *value_type;  // set by sema: the value binding's type (counter type for a range)
 } StmtFor;
 
 typedef struct {
@@ -597,13 +601,26 @@ typedef struct Expr {
 │ ID CONSTRUCTOR                                                    │
 ╚──────────────────────────────────────────────────────────────────*/
 
-Id *id(Arena *arena, isize length, const char* name) {
-    Id *id = arena_push_aligned(arena, Id);
+// Point `id` at a new spelling (e.g. sema rewriting a name to its mangled C
+// name in place). Always go through here so `atom` stays canonical.
+static inline void id_set(Id *id, isize length, const char* name) {
     id->length = length;
     id->name = name;
+    id->hash = intern_hash(name, length);
+    id->atom = atom_intern_hashed(name, length, id->hash);
+}
+
+Id *id(Arena *arena, isize length, const char* name) {
+    Id *id = arena_push_aligned(arena, Id);
+    id_set(id, length, name);
     return id;
 }
 
+// Name equality for identifiers: one pointer compare.
+static inline bool id_eq(const Id *a, const Id *b) {
+    return a->atom == b->atom;
+}
+
 /*──────────────────────────────────────────────────────────────────╗
 │ TYPE CONSTRUCTORS                                               │
 ╚──────────────────────────────────────────────────────────────────*/
@@ -611,7 +628,7 @@ Id *id(Arena *arena, isize length, const char* name) {
 // P2/S1b: intern TYPE_SIMPLE nodes so equal scalar/nominal types (same name,
 // same mode) share ONE canonical, immutable node. Safe: Type nodes are now
 // immutable and nothing compares Type* by identity. Single-shot compiler, so a
-// global list is fine.
+// global list is fine (guarded by intern_lock() while modules parse in parallel).
 typedef struct InternedSimple {
     Type *type;
     struct InternedSimple *next;
@@ -642,9 +659,12 @@ static void ast_parse_int_width(const char *n, isize len, signed char *w, bool *
 
 // Simple names: no element_type, no sentinel
 Type *type_simple(Arena *arena, Id *base) {
+    intern_lock();
     for (InternedSimple *it = g_interned_simple; it; it = it->next) {
-        if (it->type->mode == MODE_SHARED && id_bytes_equal(it->type->base_type, base))
+        if (it->type->mode == MODE_SHARED && id_bytes_equal(it->type->base_type, base)) {
+            intern_unlock();
             return it->type;  // canonical, deduplicated
+        }
     }
     Type *t = arena_push_aligned(arena, Type);
     t->kind      = TYPE_SIMPLE;
@@ -658,6 +678,7 @@ Type *type_simple(Arena *arena, Id *base) {
     node->type = t;
     node->next = g_interned_simple;
     g_interned_simple = node;
+    intern_unlock();
     return t;
 }
 
@@ -13,9 +13,8 @@ Decl *clone_decl(Arena *arena, Decl *d);
 Id *clone_id(Arena *arena, Id *id) {
     if (!id) return NULL;
     Id *new_id = arena_push_aligned(arena, Id);
-    new_id->length = id->length;
     // Identifiers are usually static strings from the source, but to be truly safe over transformations, we can just copy the pointer since the source buffer lifespan is the entire compilation.
-    new_id->name = id->name;
+    *new_id = *id;
     return new_id;
 }
 
@@ -0,0 +1,482 @@
+#ifndef CACHE_H
+#define CACHE_H
+
+/*
+   Content-addressed compilation cache (--cache-dir=DIR).
+
+   A build is identified by two hashes:
+
+     • the ROOT key: the cache format, the bytes of the compiler executable,
+       the root file and module name, the target triple, the output form (one
+       C file or --units) and every flag that changes the output (#line
+       directives, W130, --whole-program). It names DIR/<root>.manifest.
+
+     • the BUILD key: the root key plus the path and content hash of every
+       module the build loaded (the root and its transitive imports, the std
+       modules included), in load order. It names the build's artifacts:
+         DIR/<build>.c       the emitted C (single-file output)
+         DIR/<build>.units   --units: one "unit <hash> <file>" line per file
+         DIR/<build>.diag    what sema printed (warnings), replayed on a hit
+       Each --units file is stored once under its own content hash, as
+       DIR/<hash>.unit, so builds that differ in one module share every other
+       unit on disk.
+
+   The manifest lists the last CACHE_MAX_BUILDS builds of the root, newest
+   first, each with the modules it loaded and their content hashes.
+   cache_lookup() re-hashes those files WITHOUT lexing or parsing them and
+   takes the first build whose modules all still match: its C is written to
+   the output and the compile is skipped entirely. Reverting an edit finds
+   the earlier build again.
+
+   This memoizes whole builds; it is not incremental compilation. An edit to
+   any module is a miss that re-runs the whole frontend and emitter, and
+   nothing smaller than a build is ever reused. There are no per-module
+   entries because a module's C is not a function of the modules it
+   imports: the instances of its generics are emitted into its unit from
+   its importers' types, and its names resolve against every loaded module
+   (E105). With --units, only the files whose C changed are rewritten, and
+   temporaries are numbered per function, so an edit usually leaves every
+   other module's unit untouched and a make-style C build redoes just that
+   one.
+
+   Only successful builds are stored. Files are written under a temporary
+   name and renamed, so a concurrent or interrupted build never leaves a torn
+   entry behind. Any I/O failure just disables the cache for this run.
+*/
+
+#include "utils/common/libc.h"
+#include "intern.h"
+#include "module.h"
+#include "target.h"
+#include "emit.h"
+#include "sema/context.h"
+
+#if OS_WINDOWS
+#   include <direct.h>
+#else
+#   include <sys/stat.h>
+#   include <unistd.h>
+#endif
+
+#define CACHE_FORMAT "lain-cache-2"
+#define CACHE_PATH_MAX 4096
+#define CACHE_MAX_BUILDS 8
+
+// 128-bit content hash: two FNV-1a lanes with different offset bases.
+typedef struct {
+    uint64_t a, b;
+} CacheHash;
+
+static void cache_hash_init(CacheHash *h) {
+    h->a = 14695981039346656037ull;
+    h->b = 9650029242287828579ull;
+}
+
+static void cache_hash_bytes(CacheHash *h, const void *data, isize length) {
+    const unsigned char *p = data;
+    for (isize i = 0; i < length; i++) {
+        h->a = (h->a ^ p[i]) * 1099511628211ull;
+        h->b = (h->b ^ p[i]) * 1099511628211ull;
+        h->b ^= h->b >> 29;
+    }
+}
+
+// Strings are hashed with their length, so ("ab","c") and ("a","bc") differ.
+static void cache_hash_str(CacheHash *h, const char *s) {
+    uint64_t length = s ? (uint64_t)strlen(s) : UINT64_MAX;
+    cache_hash_bytes(h, &length, sizeof length);
+    if (s) cache_hash_bytes(h, s, (isize)length);
+}
+
+static void cache_hash_hex(CacheHash h, char out[33]) {
+    snprintf(out, 33, "%016llx%016llx", (unsigned long long)h.a, (unsigned long long)h.b);
+}
+
+typedef struct {
+    bool        enabled;
+    const char *dir;
+    const char *units_dir;      // --units output directory, NULL for one C file
+    CacheHash   root;
+    char        root_hex[33];
+} CompileCache;
+
+static CompileCache cache;
+
+static void _cache_path(char *out, const char *dir, const char *hex, const char *ext) {
+    snprintf(out, CACHE_PATH_MAX, "%s/%s%s", dir, hex, ext);
+}
+
+static void _cache_mkdir(const char *dir) {
+#if OS_WINDOWS
+    _mkdir(dir);
+#else
+    mkdir(dir, 0775);
+#endif
+}
+
+// Whole file into a malloc'd, NUL-terminated buffer; NULL if it cannot be read.
+static char *_cache_read_file(const char *path, isize *length) {
+    FILE *f = fopen(path, "rb");
+    if (!f) return NULL;
+    isize cap = 4096, len = 0;
+    char *buf = malloc((size_t)cap);
+    while (buf) {
+        size_t got = fread(buf + len, 1, (size_t)(cap - len - 1), f);
+        len += (isize)got;
+        if (len < cap - 1) break;
+        cap *= 2;
+        char *grown = realloc(buf, (size_t)cap);
+        if (!grown) { free(buf); buf = NULL; }
+        else buf = grown;
+    }
+    fclose(f);
+    if (!buf) return NULL;
+    buf[len] = '\0';
+    *length = len;
+    return buf;
+}
+
+// Write `data` to `path` through a temporary file and a rename.
+static bool _cache_write_file(const char *path, const char *data, isize length) {
+    char tmp[CACHE_PATH_MAX];
+    snprintf(tmp, sizeof tmp, "%s.tmp%ld", path, (long)getpid());
+    FILE *f = fopen(tmp, "wb");
+    if (!f) return false;
+    bool ok = fwrite(data, 1, (size_t)length, f) == (size_t)length;
+    ok = fclose(f) == 0 && ok;
+    if (ok) ok = rename(tmp, path) == 0;
+    if (!ok) remove(tmp);
+    return ok;
+}
+
+// As _cache_write_file, but leave `path` (and its mtime) alone if it already
+// holds exactly `data`.
+static bool _cache_write_if_changed(const char *path, const char *data, isize length) {
+    isize old_len;
+    char *old = _cache_read_file(path, &old_len);
+    bool same = old && old_len == length && memcmp(old, data, (size_t)length) == 0;
+    free(old);
+    return same || _cache_write_file(path, data, length);
+}
+
+static CacheHash cache_hash_file_contents(const char *text, isize length) {
+    CacheHash h;
+    cache_hash_init(&h);
+    cache_hash_bytes(&h, text, length);
+    return h;
+}
+
+// The compiler's identity is the running executable itself: rebuilding the
+// compiler with any change invalidates the cache, an identical rebuild does not.
+static bool _cache_hash_self(CacheHash *h) {
+    char path[CACHE_PATH_MAX];
+#if OS_WINDOWS
+    DWORD n = GetModuleFileNameA(NULL, path, (DWORD)sizeof path);
+    if (n == 0 || n >= sizeof path) return false;
+#elif OS_LINUX
+    snprintf(path, sizeof path, "/proc/self/exe");
+#else
+    return false;
+#endif
+    isize length;
+    char *self = _cache_read_file(path, &length);
+    if (!self) return false;
+    cache_hash_bytes(h, &length, sizeof length);
+    cache_hash_bytes(h, self, length);
+    free(self);
+    return true;
+}
+
+// Enable the cache and compute the root key. `filename` is the root source as
+// given on the command line (it also ends up in the #line directives).
+// `units_dir` is the --units directory, or NULL for single-file output.
+static void cache_init(const char *dir, const char *filename, const char *modname,
+                       const char *units_dir, bool line_directives, bool w130,
+                       bool whole_program) {
+    if (!dir || !*dir) return;
+    cache_hash_init(&cache.root);
+    cache_hash_str(&cache.root, CACHE_FORMAT);
+    if (!_cache_hash_self(&cache.root)) return;
+    _cache_mkdir(dir);
+    cache.enabled = true;
+    cache.dir = dir;
+    cache.units_dir = units_dir;
+    cache_hash_str(&cache.root, filename);
+    cache_hash_str(&cache.root, modname);
+    cache_hash_str(&cache.root, target.triple);
+    cache_hash_str(&cache.root, units_dir ? "units" : "single");
+    cache_hash_str(&cache.root, line_directives ? "line" : "noline");
+    cache_hash_str(&cache.root, w130 ? "w130" : "now130");
+    cache_hash_str(&cache.root, whole_program ? "whole" : "parts");
+    cache_hash_hex(cache.root, cache.root_hex);
+}
+
+/*
+   Manifest: "lain-cache-2\n", then per build, newest first,
+       build <build key>
+       src <content hash> <path>       one per module, in load order
+*/
+typedef struct {
+    char        build[33];
+    const char *text;       // the entry's lines, from "build" up to the next entry
+    isize       len;
+} CacheEntry;
+
+// Split a manifest into its entries. Returns how many were found (at most
+// `max`); 0 if `text` is not a manifest of this format.
+static int _cache_parse_manifest(const char *text, CacheEntry *entries, int max) {
+    if (strncmp(text, CACHE_FORMAT "\n", sizeof CACHE_FORMAT) != 0) return 0;
+    int count = 0;
+    for (const char *line = text + sizeof CACHE_FORMAT; *line; ) {
+        const char *end = strchr(line, '\n');
+        if (!end) break;
+        if (strncmp(line, "build ", 6) == 0) {
+            if (count == max || end - line != 6 + 32) break;
+            memcpy(entries[count].build, line + 6, 32);
+            entries[count].build[32] = '\0';
+            entries[count].text = line;
+            count++;
+        } else if (count == 0 || strncmp(line, "src ", 4) != 0 || end - line < 4 + 32 + 2) {
+            return 0;
+        }
+        line = end + 1;
+        if (count) entries[count - 1].len = line - entries[count - 1].text;
+    }
+    return count;
+}
+
+// Do the sources listed in `e` still hash to what they did in that build?
+static bool _cache_entry_matches(const CacheEntry *e) {
+    const char *line = strchr(e->text, '\n') + 1;
+    for (const char *stop = e->text + e->len; line < stop; ) {
+        const char *end = strchr(line, '\n');
+        char path[CACHE_PATH_MAX];
+        isize plen = end - (line + 4 + 33);
+        if (plen <= 0 || plen >= (isize)sizeof path) return false;
+        memcpy(path, line + 4 + 33, (size_t)plen);
+        path[plen] = '\0';
+        isize src_len;
+        char *src = _cache_read_file(path, &src_len);
+        if (!src) return false;
+        char have[33];
+        cache_hash_hex(cache_hash_file_contents(src, src_len), have);
+        free(src);
+        if (memcmp(line + 4, have, 32) != 0) return false;
+        line = end + 1;
+    }
+    return true;
+}
+
+// Write the --units files of `build_hex` into cache.units_dir. Every stored
+// unit is read before any file is written, so a missing one changes nothing.
+static bool _cache_restore_units(const char *build_hex) {
+    char path[CACHE_PATH_MAX];
+    _cache_path(path, cache.dir, build_hex, ".units");
+    isize list_len;
+    char *list = _cache_read_file(path, &list_len);
+    if (!list) return false;
+
+    isize count = 0;
+    for (char *c = list; *c; c++) count += *c == '\n';
+    char  **files = calloc((size_t)(count ? count : 1), sizeof *files);
+    char  **data  = calloc((size_t)(count ? count : 1), sizeof *data);
+    isize  *lens  = calloc((size_t)(count ? count : 1), sizeof *lens);
+    bool ok = files && data && lens;
+    isize n = 0;
+    for (char *line = list, *end; ok && (end = strchr(line, '\n')); line = end + 1, n++) {
+        *end = '\0';
+        if (strncmp(line, "unit ", 5) != 0 || end - line < 5 + 32 + 2) { ok = false; break; }
+        line[5 + 32] = '\0';
+        files[n] = line + 5 + 33;
+        _cache_path(path, cache.dir, line + 5, ".unit");
+        data[n] = _cache_read_file(path, &lens[n]);
+        ok = data[n] != NULL;
+    }
+    if (ok) {
+        _cache_mkdir(cache.units_dir);
+        for (isize i = 0; ok && i < n; i++) {
+            snprintf(path, sizeof path, "%s/%s", cache.units_dir, files[i]);
+            ok = _cache_write_if_changed(path, data[i], lens[i]);
+        }
+        if (ok) emit_remove_stale_units(cache.units_dir, (const char *const *)files, (int)n);
+    }
+    for (isize i = 0; data && i < n; i++) free(data[i]);
+    free(files);
+    free(data);
+    free(lens);
+    free(list);
+    return ok;
+}
+
+// Write the single C file of `build_hex` to `output_file`.
+static bool _cache_restore_c(const char *build_hex, const char *output_file) {
+    char path[CACHE_PATH_MAX];
+    _cache_path(path, cache.dir, build_hex, ".c");
+    isize c_len;
+    char *c_text = _cache_read_file(path, &c_len);
+    if (!c_text) return false;
+    bool ok = false;
+    FILE *out = fopen(output_file, "wb");
+    if (out) {
+        ok = fwrite(c_text, 1, (size_t)c_len, out) == (size_t)c_len;
+        ok = fclose(out) == 0 && ok;
+    }
+    free(c_text);
+    return ok;
+}
+
+// On a hit, write the cached C to `output_file` (or the --units directory),
+// print the cached diagnostics and return true.
+static bool cache_lookup(const char *output_file) {
+    if (!cache.enabled) return false;
+    char path[CACHE_PATH_MAX];
+    _cache_path(path, cache.dir, cache.root_hex, ".manifest");
+    isize length;
+    char *manifest = _cache_read_file(path, &length);
+    if (!manifest) return false;
+
+    CacheEntry entries[CACHE_MAX_BUILDS];
+    int count = _cache_parse_manifest(manifest, entries, CACHE_MAX_BUILDS);
+    bool hit = false;
+    for (int i = 0; i < count && !hit; i++) {
+        if (!_cache_entry_matches(&entries[i])) continue;
+        hit = cache.units_dir ? _cache_restore_units(entries[i].build)
+                              : _cache_restore_c(entries[i].build, output_file);
+        if (hit) {
+            _cache_path(path, cache.dir, entries[i].build, ".diag");
+            isize diag_len = 0;
+            char *diag = _cache_read_file(path, &diag_len);
+            if (diag) fwrite(diag, 1, (size_t)diag_len, stderr);
+            free(diag);
+        }
+    }
+    free(manifest);
+    return hit;
+}
+
+// Store the --units file `file` as DIR/<content hash>.unit and list it.
+static bool _cache_store_unit(const char *file, EmitBuffer *list) {
+    char path[CACHE_PATH_MAX];
+    snprintf(path, sizeof path, "%s/%s", cache.units_dir, file);
+    isize len;
+    char *text = _cache_read_file(path, &len);
+    if (!text) return false;
+    char hex[33];
+    cache_hash_hex(cache_hash_file_contents(text, len), hex);
+    _cache_path(path, cache.dir, hex, ".unit");
+    bool ok = _cache_write_if_changed(path, text, len);
+    free(text);
+    emit_buffer_append(list, "unit ", 5);
+    emit_buffer_append(list, hex, 32);
+    emit_buffer_append(list, " ", 1);
+    emit_buffer_append(list, file, (isize)strlen(file));
+    emit_buffer_append(list, "\n", 1);
+    return ok;
+}
+
+// Store lain.h and every module's unit, listed in DIR/<build_hex>.units.
+static bool _cache_store_units(const char *build_hex) {
+    EmitBuffer list = {0};
+    bool ok = _cache_store_unit("lain.h", &list);
+    for (ModuleNode *m = loaded_modules; ok && m; m = m->next) {
+        char file[256];
+        emit_unit_file_name(m->name ? m->name : "main", file, sizeof file);
+        ok = _cache_store_unit(file, &list);
+    }
+    if (ok) {
+        char path[CACHE_PATH_MAX];
+        _cache_path(path, cache.dir, build_hex, ".units");
+        ok = _cache_write_file(path, list.data, list.len);
+    }
+    emit_buffer_free(&list);
+    return ok;
+}
+
+// Forget an evicted build's artifacts. Its .unit files may be shared with
+// the builds that stay, so they are kept.
+static void _cache_remove_build(const char *build_hex) {
+    char path[CACHE_PATH_MAX];
+    _cache_path(path, cache.dir, build_hex, ".c");
+    remove(path);
+    _cache_path(path, cache.dir, build_hex, ".units");
+    remove(path);
+    _cache_path(path, cache.dir, build_hex, ".diag");
+    remove(path);
+}
+
+// After a successful build: store the emitted C and the recorded diagnostics
+// under the build key, then put the build at the head of the root manifest.
+static void cache_store(const char *output_file) {
+    if (!cache.enabled) return;
+
+    // Modules in load order (loaded_modules is newest first).
+    isize count = 0;
+    for (ModuleNode *m = loaded_modules; m; m = m->next) count++;
+    ModuleNode **mods = malloc((size_t)(count ? count : 1) * sizeof *mods);
+    if (!mods) return;
+    isize i = count;
+    for (ModuleNode *m = loaded_modules; m; m = m->next) mods[--i] = m;
+
+    CacheHash build = cache.root;
+    EmitBuffer srcs = {0};
+    bool ok = true;
+    for (i = 0; ok && i < count; i++) {
+        if (!mods[i]->source_text || !mods[i]->source_file) { ok = false; break; }
+        char hex[33];
+        cache_hash_hex(cache_hash_file_contents(mods[i]->source_text,
+                                                (isize)strlen(mods[i]->source_text)), hex);
+        cache_hash_str(&build, mods[i]->source_file);
+        cache_hash_str(&build, hex);
+        emit_buffer_append(&srcs, "src ", 4);
+        emit_buffer_append(&srcs, hex, 32);
+        emit_buffer_append(&srcs, " ", 1);
+        emit_buffer_append(&srcs, mods[i]->source_file, (isize)strlen(mods[i]->source_file));
+        emit_buffer_append(&srcs, "\n", 1);
+    }
+    free(mods);
+
+    char build_hex[33], path[CACHE_PATH_MAX];
+    cache_hash_hex(build, build_hex);
+    if (ok) {
+        if (cache.units_dir) {
+            ok = _cache_store_units(build_hex);
+        } else {
+            isize c_len;
+            char *c_text = _cache_read_file(output_file, &c_len);
+            _cache_path(path, cache.dir, build_hex, ".c");
+            ok = c_text && _cache_write_file(path, c_text, c_len);
+            free(c_text);
+        }
+        _cache_path(path, cache.dir, build_hex, ".diag");
+        ok = ok && _cache_write_file(path, sema_diag_record.text ? sema_diag_record.text : "",
+                                     sema_diag_record.len);
+    }
+
+    if (ok) {
+        // The new build first, then the previous ones that still fit.
+        _cache_path(path, cache.dir, cache.root_hex, ".manifest");
+        isize old_len;
+        char *old = _cache_read_file(path, &old_len);
+        CacheEntry entries[CACHE_MAX_BUILDS + 1];
+        int old_count = old ? _cache_parse_manifest(old, entries, CACHE_MAX_BUILDS + 1) : 0;
+
+        EmitBuffer manifest = {0};
+        emit_buffer_append(&manifest, CACHE_FORMAT "\nbuild ", sizeof CACHE_FORMAT + 6);
+        emit_buffer_append(&manifest, build_hex, 32);
+        emit_buffer_append(&manifest, "\n", 1);
+        emit_buffer_append(&manifest, srcs.data, srcs.len);
+        int kept = 1;
+        for (int e = 0; e < old_count; e++) {
+            if (strcmp(entries[e].build, build_hex) == 0) continue;
+            if (kept == CACHE_MAX_BUILDS) { _cache_remove_build(entries[e].build); continue; }
+            emit_buffer_append(&manifest, entries[e].text, entries[e].len);
+            kept++;
+        }
+        _cache_write_file(path, manifest.data, manifest.len);
+        emit_buffer_free(&manifest);
+        free(old);
+    }
+    emit_buffer_free(&srcs);
+}
+
+#endif // CACHE_H
@@ -7,35 +7,33 @@
 #include "emit/ctor.h"
 #include "emit/lain_header.h"
 #include "emit/core.h"
+#include "emit/switch.h"
 #include "emit/expr.h"
 #include "emit/stmt.h"
 #include "emit/decl.h"
 #include "emit/type_order.h"
+#include "module.h"
 
-// Entry point: write out C file (all types inlined — no separate lain.h).
-//
-// Slice/array typedefs (Slice_<T>, Fixed_<T>_N, sentinel variants) are recorded
-// lazily as the body is emitted, but must appear BEFORE their first use. Since
-// everything now lives in one translation unit, the body is emitted into a temp
-// file first (populating the recorded-type list), then the typedefs are written
-// ahead of the buffered body. Struct/enum forward typedefs are emitted directly
-// so that a Slice_<UserType> (a pointer to a forward-declared struct) is valid.
-static inline void emit(DeclList *decls, int depth, const char *filename) {
-    FILE *real_out = fopen(filename, "w");
-    if (!real_out) {
-        fprintf(stderr, "Error: cannot open %s\n", filename);
-        exit(1);
-    }
-    output_file = real_out;
-    EMIT("#include <stdint.h>\n");
-    EMIT("#include <stddef.h>\n");
-    EMIT("#include <stdlib.h>\n");   // abort (panic), malloc/free/realloc/calloc, exit — otherwise implicit-int declarations truncate their pointers on LP64
-    EMIT("#include <stdio.h>\n");
-    EMIT("#include <string.h>\n");
-    EMIT("#include <stdbool.h>\n\n");
-    emitted_decls = decls; // so that lookup_function_decl can see all the functions we’re about to emit.
+#if OS_WINDOWS
+#   include <direct.h>
+#else
+#   include <sys/stat.h>
+#   include <dirent.h>
+#endif
 
-    // Emit forward declarations for structs and enums to satisfy function parameters
+// The standard headers every emitted file starts with.
+static void emit_std_includes(void) {
+    EMIT_LIT("#include <stdint.h>\n");
+    EMIT_LIT("#include <stddef.h>\n");
+    EMIT_LIT("#include <stdlib.h>\n");   // abort (panic), malloc/free/realloc/calloc, exit — otherwise implicit-int declarations truncate their pointers on LP64
+    EMIT_LIT("#include <stdio.h>\n");
+    EMIT_LIT("#include <string.h>\n");
+    EMIT_LIT("#include <stdbool.h>\n\n");
+}
+
+// Forward typedefs for every struct and enum, plus primitive-alias typedefs,
+// so function parameters and slices of user types can name them.
+static void emit_type_forward_decls(DeclList *decls) {
     for (DeclList *dl = decls; dl; dl = dl->next) {
         if (decl_is_generic_template(dl->decl)) continue;   // templates: only instances are emitted
         if (dl->decl->kind == DECL_STRUCT) {
@@ -79,51 +77,89 @@ static inline void emit(DeclList *decls, int depth, const char *filename) {
             }
         }
     }
-    EMIT("\n");
+    EMIT_LIT("\n");
+}
+
+typedef enum {
+    GLOBAL_STATIC,      // single file: `static [const] T x = init;`
+    GLOBAL_DECLARE,     // shared header: constants as above, `extern T x;` for a `var`
+    GLOBAL_DEFINE,      // owning unit: `T x = init;` for a `var`, nothing for a constant
+} GlobalEmitMode;
+
+// One top-level constant or `var`.
+static void emit_global_variable(Decl *d, GlobalEmitMode mode) {
+    bool is_var = d->as.variable_decl.is_mutable;
+    if (mode == GLOBAL_DEFINE && !is_var) return;
+    Type *ty = d->as.variable_decl.type;
+    // A bare `NAME T = expr` is an immutable compile-time constant (`static
+    // const`); a `var NAME T` is a mutable global (`static`, no const). Split
+    // units share one definition of a `var` instead of a copy per file.
+    const char *cst = !is_var                  ? "static const "
+                    : mode == GLOBAL_STATIC    ? "static "
+                    : mode == GLOBAL_DECLARE   ? "extern "
+                    :                            "";
+    char nm[256]; snprintf(nm, sizeof nm, "%s", c_name_for_id(d->as.variable_decl.name));
+    if (ty && ty->kind == TYPE_ARRAY && ty->array_len > 0) {
+        char elem[256]; c_name_for_type(ty->element_type, elem, sizeof elem);
+        EMIT("%s%s %s[%ld]", cst, elem, nm, (long)ty->array_len);
+    } else {
+        char tb[256]; c_name_for_type(ty, tb, sizeof tb);
+        EMIT("%s%s %s", cst, tb, nm);
+    }
+    Expr *init = d->as.variable_decl.init;
+    if (init && !(is_var && mode == GLOBAL_DECLARE)) {
+        EMIT_LIT(" = ");
+        if (init->kind == EXPR_ARRAY_LITERAL) {
+            EMIT_LIT("{ ");
+            bool first = true;
+            for (ExprList *el = init->as.array_literal_expr.elements; el; el = el->next) {
+                if (!first) EMIT_LIT(", ");
+                first = false;
+                emit_expr(el->expr, 0);
+            }
+            EMIT_LIT(" }");
+        } else {
+            emit_expr(init, 0);
+        }
+    }
+    EMIT_LIT(";\n");
+}
+
+// Entry point: write out C file (all types inlined — no separate lain.h).
+//
+// Slice/array typedefs (Slice_<T>, Fixed_<T>_N, sentinel variants) are recorded
+// lazily as the body is emitted, but must appear BEFORE their first use. Since
+// everything now lives in one translation unit, the body is emitted into a temp
+// file first (populating the recorded-type list), then the typedefs are written
+// ahead of the buffered body. Struct/enum forward typedefs are emitted directly
+// so that a Slice_<UserType> (a pointer to a forward-declared struct) is valid.
+static inline void emit(DeclList *decls, int depth, const char *filename) {
+    FILE *real_out = fopen(filename, "wb");
+    if (!real_out) {
+        fprintf(stderr, "Error: cannot open %s\n", filename);
+        exit(1);
+    }
+    EmitBuffer head = {0}, body = {0};
+    emit_out = &head;
+    emit_std_includes();
+    emitted_decls = decls; // so that lookup_function_decl can see all the functions we’re about to emit.
+
+    // Emit forward declarations for structs and enums to satisfy function parameters
+    emit_type_forward_decls(decls);
 
     // Emit top-level constants BEFORE any function, so function bodies (and later
     // constants like a lookup table) can reference them. `static const` — a
     // module-scoped compile-time constant, folded by the C compiler.
     for (DeclList *dl = decls; dl; dl = dl->next) {
-        if (!dl->decl || dl->decl->kind != DECL_VARIABLE) continue;
-        Decl *d = dl->decl;
-        Type *ty = d->as.variable_decl.type;
-        // A bare `NAME T = expr` is an immutable compile-time constant (`static
-        // const`); a `var NAME T` is a mutable global (`static`, no const).
-        const char *cst = d->as.variable_decl.is_mutable ? "static " : "static const ";
-        char nm[256]; snprintf(nm, sizeof nm, "%s", c_name_for_id(d->as.variable_decl.name));
-        if (ty && ty->kind == TYPE_ARRAY && ty->array_len > 0) {
-            char elem[256]; c_name_for_type(ty->element_type, elem, sizeof elem);
-            EMIT("%s%s %s[%ld]", cst, elem, nm, (long)ty->array_len);
-        } else {
-            char tb[256]; c_name_for_type(ty, tb, sizeof tb);
-            EMIT("%s%s %s", cst, tb, nm);
-        }
-        Expr *init = d->as.variable_decl.init;
-        if (init) {
-            EMIT(" = ");
-            if (init->kind == EXPR_ARRAY_LITERAL) {
-                EMIT("{ ");
-                bool first = true;
-                for (ExprList *el = init->as.array_literal_expr.elements; el; el = el->next) {
-                    if (!first) EMIT(", ");
-                    first = false;
-                    emit_expr(el->expr, 0);
-                }
-                EMIT(" }");
-            } else {
-                emit_expr(init, 0);
-            }
-        }
-        EMIT(";\n");
+        if (dl->decl && dl->decl->kind == DECL_VARIABLE)
+            emit_global_variable(dl->decl, GLOBAL_STATIC);
     }
-    EMIT("\n");
+    EMIT_LIT("\n");
 
-    // Emit the body (function forward decls + definitions) into a temp file so
-    // that every slice/array type it references gets recorded before we decide
-    // which typedefs to emit. Fall back to writing directly if tmpfile() fails.
-    FILE *body = tmpfile();
-    output_file = body ? body : real_out;
+    // Emit the body (function forward decls + definitions) into its own buffer
+    // so that every slice/array type it references gets recorded before we
+    // decide which typedefs to emit.
+    emit_out = &body;
 
     // Emit forward declarations for all functions and procedures
     for (DeclList *dl = decls; dl; dl = dl->next) {
@@ -132,26 +168,249 @@ static inline void emit(DeclList *decls, int depth, const char *filename) {
             emit_forward_decl(dl->decl, 0);
         }
     }
-    EMIT("\n");
+    EMIT_LIT("\n");
     emit_decl_list_topo(decls, depth);
     // Emit Fixed_<UserType>_N typedefs that depend on user-defined struct types
     // (complete type required for arrays) — after all struct definitions.
-    emit_user_fixed_typedefs(output_file);
+    emit_user_fixed_typedefs();
 
     // Now that all slice/array types are recorded, emit the primitive and
     // dynamic-slice typedefs ahead of the body, then splice the body in.
-    if (body) {
-        emit_needed_vector_types(real_out);  // before slices: a slice element may be a vector
-        emit_needed_slice_types(real_out);
-        fflush(body);
-        rewind(body);
+    emit_out = &head;
+    emit_needed_vector_types();  // before slices: a slice element may be a vector
+    emit_needed_slice_types();
+    emit_buffer_append(&head, body.data, body.len);
+    emit_buffer_free(&body);
+
+    if (fwrite(head.data, 1, (size_t)head.len, real_out) != (size_t)head.len || fclose(real_out) != 0) {
+        fprintf(stderr, "Error: cannot write %s\n", filename);
+        exit(1);
+    }
+    emit_buffer_free(&head);
+    emit_out = NULL;
+}
+
+/*
+   Split output (--units=DIR): one C file per Lain module plus a shared lain.h,
+   so the C compiler can build the modules in parallel and a build system can
+   recompile only the units that changed.
+
+   lain.h (generate_lain_header's slice and vector typedefs, extended) holds
+   everything more than one unit may need:
+     • the standard includes and the struct/enum forward typedefs;
+     • constants (`static const`; a copy per unit folds away) and an `extern`
+       declaration of every `var` global;
+     • the vector and slice typedefs;
+     • the type definitions with their inline constructors;
+     • extern C functions and a prototype of every function with external
+       linkage (the cross-module prototypes).
+   Each <module>.c includes lain.h, defines the module's `var` globals,
+   forward-declares its `static` functions and defines its functions. A
+   monomorphized instance goes to the unit of its template's module; decls sema
+   synthesized without a module go to the root unit.
+
+   A file whose contents did not change is left alone (mtime included). A
+   unit left in the directory by an earlier build, for a module this build no
+   longer has, is removed; any other file there is left alone.
+*/
+
+typedef struct {
+    const char *module;     // module path (the decls' defining_module)
+    const char *source;     // its .ln file, for #line
+    char        file[256];  // emit_unit_file_name(module)
+    EmitBuffer  body;
+} EmitUnit;
+
+// "<module path with '.' and '/' → '_'>.c": the unit file of `module`.
+static void emit_unit_file_name(const char *module, char *out, isize cap) {
+    snprintf(out, (size_t)cap, "%s.c", module);
+    for (char *c = out; c[2]; c++) if (*c == '.' || *c == '/') *c = '_';
+}
+
+// Unit of a decl: its module's, or the root unit (0).
+static int emit_unit_of(EmitUnit *units, int count, Decl *d) {
+    if (!d->defining_module) return 0;
+    for (int i = 0; i < count; i++)
+        if (strcmp(units[i].module, d->defining_module) == 0) return i;
+    return 0;
+}
+
+// Write `b` to `path` unless the file already holds exactly that.
+static void emit_write_if_changed(const char *path, const EmitBuffer *b) {
+    bool same = false;
+    FILE *old = fopen(path, "rb");
+    if (old) {
         char buf[8192];
+        isize pos = 0;
         size_t n;
-        while ((n = fread(buf, 1, sizeof buf, body)) > 0)
-            fwrite(buf, 1, n, real_out);
-        fclose(body);
+        same = true;
+        while (same && (n = fread(buf, 1, sizeof buf, old)) > 0) {
+            same = pos + (isize)n <= b->len && memcmp(buf, b->data + pos, n) == 0;
+            pos += (isize)n;
+        }
+        same = same && pos == b->len;
+        fclose(old);
+    }
+    if (!same) emit_buffer_write_file(b, path);
+}
+
+#define EMIT_UNIT_FIRST_LINE "#include \"lain.h\"\n"
+
+// True if `path` starts like a unit file (EMIT_UNIT_FIRST_LINE).
+static bool emit_is_unit_file(const char *path) {
+    char head[sizeof EMIT_UNIT_FIRST_LINE - 1];
+    FILE *f = fopen(path, "rb");
+    if (!f) return false;
+    bool unit = fread(head, 1, sizeof head, f) == sizeof head &&
+                memcmp(head, EMIT_UNIT_FIRST_LINE, sizeof head) == 0;
+    fclose(f);
+    return unit;
+}
+
+static void _emit_remove_if_stale(const char *dir, const char *name,
+                                  const char *const *keep, int count) {
+    isize len = (isize)strlen(name);
+    if (len < 3 || strcmp(name + len - 2, ".c") != 0) return;
+    for (int i = 0; i < count; i++)
+        if (strcmp(keep[i], name) == 0) return;
+    char path[4096];
+    snprintf(path, sizeof path, "%s/%s", dir, name);
+    if (emit_is_unit_file(path)) remove(path);
+}
+
+// Remove the unit files in `dir` that are not among the `count` files in
+// `keep`: the units of modules an earlier build had and this one does not.
+// Only "*.c" files that start like a unit are touched.
+static void emit_remove_stale_units(const char *dir, const char *const *keep, int count) {
+#if OS_WINDOWS
+    char pattern[4096];
+    WIN32_FIND_DATAA found;
+    snprintf(pattern, sizeof pattern, "%s/*.c", dir);
+    HANDLE h = FindFirstFileA(pattern, &found);
+    if (h == INVALID_HANDLE_VALUE) return;
+    do _emit_remove_if_stale(dir, found.cFileName, keep, count);
+    while (FindNextFileA(h, &found));
+    FindClose(h);
+#else
+    DIR *d = opendir(dir);
+    if (!d) return;
+    for (struct dirent *e; (e = readdir(d)) != NULL; )
+        _emit_remove_if_stale(dir, e->d_name, keep, count);
+    closedir(d);
+#endif
+}
+
+static void emit_units(DeclList *decls, int depth, const char *dir) {
+#if OS_WINDOWS
+    _mkdir(dir);
+#else
+    mkdir(dir, 0775);
+#endif
+    emitted_decls = decls;
+    const char *root_source = emit_source_filename;
+
+    // Units in load order: the root module first.
+    int count = 0;
+    for (ModuleNode *m = loaded_modules; m; m = m->next) count++;
+    if (count == 0) count = 1;
+    EmitUnit *units = calloc((size_t)count, sizeof *units);
+    if (!units) {
+        fprintf(stderr, "Error: out of memory splitting the output\n");
+        exit(1);
     }
-    fclose(real_out);
+    int i = count;
+    for (ModuleNode *m = loaded_modules; m; m = m->next) {
+        units[--i].module = m->name;
+        units[i].source = m->source_file;
+    }
+    if (!units[0].module) units[0].module = "main";
+    for (i = 0; i < count; i++)
+        emit_unit_file_name(units[i].module, units[i].file, sizeof units[i].file);
+
+    // Header, first part: forward typedefs and globals. The slice and vector
+    // typedefs go between it and the type definitions once every unit has
+    // been emitted (that is when they are all recorded).
+    EmitBuffer head = {0}, types = {0};
+    emit_out = &head;
+    EMIT_LIT("#ifndef LAIN_H\n#define LAIN_H\n\n");
+    emit_std_includes();
+    emit_type_forward_decls(decls);
+    for (DeclList *dl = decls; dl; dl = dl->next) {
+        if (dl->decl && dl->decl->kind == DECL_VARIABLE)
+            emit_global_variable(dl->decl, GLOBAL_DECLARE);
+    }
+    EMIT_LIT("\n");
+
+    emit_out = &types;
+    emit_type_decls_topo(decls, depth);
+    emit_user_fixed_typedefs();
+    for (DeclList *dl = decls; dl; dl = dl->next) {
+        Decl *d = dl->decl;
+        if (!emit_is_function_pass_decl(d)) continue;
+        if (d->kind == DECL_EXTERN_FUNCTION || d->kind == DECL_EXTERN_PROCEDURE)
+            emit_decl(d, depth);
+        else if (d->kind != DECL_VARIABLE && !emit_function_is_static(d))
+            emit_forward_decl(d, 0);
+    }
+    EMIT_LIT("\n#endif /* LAIN_H */\n");
+
+    for (i = 0; i < count; i++) {
+        emit_out = &units[i].body;
+        EMIT_LIT(EMIT_UNIT_FIRST_LINE "\n");
+    }
+    for (DeclList *dl = decls; dl; dl = dl->next) {
+        Decl *d = dl->decl;
+        if (!d || d->kind != DECL_VARIABLE) continue;
+        emit_out = &units[emit_unit_of(units, count, d)].body;
+        emit_global_variable(d, GLOBAL_DEFINE);
+    }
+    for (DeclList *dl = decls; dl; dl = dl->next) {
+        Decl *d = dl->decl;
+        if (!emit_is_function_pass_decl(d) || d->kind == DECL_VARIABLE) continue;
+        if ((d->kind == DECL_FUNCTION || d->kind == DECL_PROCEDURE) && emit_function_is_static(d)) {
+            emit_out = &units[emit_unit_of(units, count, d)].body;
+            emit_forward_decl(d, 0);
+        }
+    }
+    for (i = 0; i < count; i++) {
+        emit_out = &units[i].body;
+        EMIT_LIT("\n");
+    }
+    for (DeclList *dl = decls; dl; dl = dl->next) {
+        Decl *d = dl->decl;
+        if (!emit_is_function_pass_decl(d)) continue;
+        if (d->kind != DECL_FUNCTION && d->kind != DECL_PROCEDURE) continue;
+        EmitUnit *u = &units[emit_unit_of(units, count, d)];
+        emit_out = &u->body;
+        // #line names the module's own file (the single-file output uses
+        // the root file throughout).
+        if (root_source && u->source) emit_source_filename = u->source;
+        emit_function_decl_timed(d, depth);
+    }
+    emit_source_filename = root_source;
+
+    char path[4096];
+    const char **files = calloc((size_t)count, sizeof *files);
+    for (i = 0; i < count; i++) {
+        snprintf(path, sizeof path, "%s/%s", dir, units[i].file);
+        emit_write_if_changed(path, &units[i].body);
+        emit_buffer_free(&units[i].body);
+        if (files) files[i] = units[i].file;
+    }
+    if (files) emit_remove_stale_units(dir, files, count);
+    free(files);
+
+    emit_out = &head;
+    emit_needed_vector_types();  // before slices: a slice element may be a vector
+    emit_needed_slice_types();
+    emit_buffer_append(&head, types.data, types.len);
+    snprintf(path, sizeof path, "%s/lain.h", dir);
+    emit_write_if_changed(path, &head);
+    emit_buffer_free(&head);
+    emit_buffer_free(&types);
+    emit_out = NULL;
+
+    free(units);
 }
 
 #endif // EMIT_H
\ No newline at end of file
@@ -2,7 +2,8 @@
 #define EMIT_CORE_H
 
 #include "../emit.h"
-#include "../sema.h" // for Type, TYPE_* enums, sema_arena, etc.
+#include "../sema.h" // for Type, TYPE_* enums, sema_ctx->arena, etc.
+#include <stdarg.h>
 #include <stdio.h>
 #include <string.h>
 
@@ -18,9 +19,149 @@ void c_name_for_type(Type *t, char *out, size_t cap);
 static void c_name_for_fnptr(Type *t, const char *name, char *out, size_t cap);
 
 /*— where all output goes —*/
-static FILE *output_file;
+/*
+   The emitter appends to an in-memory EmitBuffer and the finished file is
+   written with one fwrite (emit_buffer_write_file). EMIT keeps printf syntax
+   but is formatted here: literal text is copied, and %s, %.*s, %c, %d, %ld,
+   %lld, %zu and %% are expanded inline. Only other conversions (widths,
+   %x, %g) go through vsnprintf. EMIT_LIT, emit_strn, emit_id and emit_int
+   skip the format scan altogether.
+*/
+typedef struct EmitBuffer {
+    char  *data;
+    isize  len;
+    isize  cap;
+} EmitBuffer;
+
+static EmitBuffer *emit_out;
 static const char *emit_source_filename = NULL;
-#define EMIT(...) fprintf(output_file, __VA_ARGS__)
+
+static void emit_buffer_reserve(EmitBuffer *b, isize extra) {
+    if (b->len + extra <= b->cap) return;
+    isize cap = b->cap ? b->cap : 64 * 1024;
+    while (cap < b->len + extra) cap *= 2;
+    char *data = realloc(b->data, (size_t)cap);
+    if (!data) {
+        fprintf(stderr, "Error: out of memory buffering emitted C (%ld bytes)\n", (long)cap);
+        exit(1);
+    }
+    b->data = data;
+    b->cap = cap;
+}
+
+static inline void emit_buffer_append(EmitBuffer *b, const char *s, isize n) {
+    emit_buffer_reserve(b, n);
+    memcpy(b->data + b->len, s, (size_t)n);
+    b->len += n;
+}
+
+static void emit_buffer_free(EmitBuffer *b) {
+    free(b->data);
+    b->data = NULL;
+    b->len = b->cap = 0;
+}
+
+// Write the whole buffer to `path` in one go.
+static void emit_buffer_write_file(const EmitBuffer *b, const char *path) {
+    FILE *f = fopen(path, "wb");
+    if (!f || fwrite(b->data, 1, (size_t)b->len, f) != (size_t)b->len || fclose(f) != 0) {
+        fprintf(stderr, "Error: cannot write %s\n", path);
+        exit(1);
+    }
+}
+
+static inline void emit_strn(const char *s, isize n) { emit_buffer_append(emit_out, s, n); }
+static inline void emit_str(const char *s)          { emit_strn(s, (isize)strlen(s)); }
+static inline void emit_id(Id *id)                  { emit_strn(id->name, id->length); }
+
+static inline void emit_char(char c) {
+    emit_buffer_reserve(emit_out, 1);
+    emit_out->data[emit_out->len++] = c;
+}
+
+static void emit_int(long long v) {
+    char tmp[24];
+    int i = (int)sizeof tmp;
+    unsigned long long u = v < 0 ? 0ull - (unsigned long long)v : (unsigned long long)v;
+    do { tmp[--i] = (char)('0' + u % 10); u /= 10; } while (u);
+    if (v < 0) tmp[--i] = '-';
+    emit_strn(tmp + i, (isize)sizeof tmp - i);
+}
+
+static void emit_uint(unsigned long long u) {
+    char tmp[24];
+    int i = (int)sizeof tmp;
+    do { tmp[--i] = (char)('0' + u % 10); u /= 10; } while (u);
+    emit_strn(tmp + i, (isize)sizeof tmp - i);
+}
+
+// A string literal: length known at compile time, no format scan.
+#define EMIT_LIT(lit) emit_strn("" lit, (isize)sizeof(lit) - 1)
+
+// Conversions emit_vfmt expands itself; anything else is handed to vsnprintf.
+static bool _emit_fmt_is_simple(const char *fmt) {
+    for (const char *p = fmt; (p = strchr(p, '%')) != NULL; ) {
+        p++;
+        if (*p == 's' || *p == 'd' || *p == 'c' || *p == '%') { p++; continue; }
+        if (p[0] == '.' && p[1] == '*' && p[2] == 's') { p += 3; continue; }
+        if (p[0] == 'z' && p[1] == 'u') { p += 2; continue; }
+        if (p[0] == 'l' && p[1] == 'd') { p += 2; continue; }
+        if (p[0] == 'l' && p[1] == 'l' && p[2] == 'd') { p += 3; continue; }
+        return false;
+    }
+    return true;
+}
+
+static void emit_vfmt(const char *fmt, va_list ap) {
+    if (!_emit_fmt_is_simple(fmt)) {
+        va_list ap2;
+        va_copy(ap2, ap);
+        int n = vsnprintf(NULL, 0, fmt, ap2);
+        va_end(ap2);
+        if (n <= 0) return;
+        emit_buffer_reserve(emit_out, n + 1);
+        vsnprintf(emit_out->data + emit_out->len, (size_t)n + 1, fmt, ap);
+        emit_out->len += n;
+        return;
+    }
+    const char *p = fmt;
+    for (;;) {
+        const char *pct = strchr(p, '%');
+        if (!pct) { emit_str(p); return; }
+        if (pct > p) emit_strn(p, pct - p);
+        p = pct + 1;
+        switch (*p++) {
+        case 's': { const char *s = va_arg(ap, const char *); emit_str(s ? s : "(null)"); break; }
+        case 'd': emit_int(va_arg(ap, int)); break;
+        case 'c': emit_char((char)va_arg(ap, int)); break;
+        case '%': emit_char('%'); break;
+        case '.': {                                     // %.*s
+            int n = va_arg(ap, int);
+            const char *s = va_arg(ap, const char *);
+            isize len = 0;
+            while ((n < 0 || len < n) && s[len]) len++;
+            emit_strn(s, len);
+            p += 2;
+            break;
+        }
+        case 'z': emit_uint(va_arg(ap, size_t)); p++; break;
+        case 'l':
+            if (*p == 'l') { emit_int(va_arg(ap, long long)); p += 2; }
+            else           { emit_int(va_arg(ap, long)); p++; }
+            break;
+        }
+    }
+}
+
+static void emit_fmt(const char *fmt, ...) __attribute__((format(printf, 1, 2)));
+static void emit_fmt(const char *fmt, ...) {
+    va_list ap;
+    va_start(ap, fmt);
+    emit_vfmt(fmt, ap);
+    va_end(ap);
+}
+
+#define EMIT(...) emit_fmt(__VA_ARGS__)
 
 /*— defer mechanics —*/
 #define MAX_DEFERS 256
@@ -31,10 +172,18 @@ static int emit_defer_count = 0;
 static int loop_defer_base[MAX_LOOPS];
 static int loop_depth = 0;
 
+/*— per-function name counters (__iN/__sliceN, __matchN) —*/
+// Reset at every function, so the temporaries a function's C uses do not
+// depend on how many loops or matches other functions (or other --units
+// files) emitted before it.
+static int emit_for_count = 0;
+static int emit_match_count = 0;
+static int emit_expr_match_count = 0;
+
 /*— indentation —*/
 static inline void emit_indent(int depth) {
   for (int i = 0; i < depth; i++)
-    EMIT("    ");
+    EMIT_LIT("    ");
 }
 
 
@@ -80,7 +229,7 @@ static bool emit_fixed_string_init(Type *ty, Expr *rhs, int depth) {
       // Wait, rhs->length includes valid chars.
       // We should append the sentinel value explicitly to be safe.
       // If Sentinel is 0:
-      EMIT("0 } }"); 
+      EMIT_LIT("0 } }"); 
       return true;
   }
 
@@ -96,13 +245,13 @@ static bool emit_fixed_string_init(Type *ty, Expr *rhs, int depth) {
   // Emit C array initializer: { 0x78, 0x20, ... }
   // (No struct wrapper — u8[N] is now a native C array)
   (void)sliceBuf;
-  EMIT("{ ");
+  EMIT_LIT("{ ");
   for (size_t i = 0; i < fixed_len; i++) {
       unsigned v = (i < bytes_len) ? (unsigned)bytes[i] : 0u;
       EMIT("0x%02X", v);
-      if (i + 1 < fixed_len) EMIT(", ");
+      if (i + 1 < fixed_len) EMIT_LIT(", ");
   }
-  EMIT(" }");
+  EMIT_LIT(" }");
   return true;
 }
 
@@ -156,8 +305,8 @@ static bool emit_slice_coercion(Type *target, Expr *source, int depth) {
         // directly. A fixed TYPE_SLICE (a Fixed_<T>_N struct — e.g. a string
         // literal binding `var s = "..."`) is a struct with a `.data[N]` member,
         // so it needs `.data` to yield the pointer.
-        if (st && st->kind == TYPE_SLICE) EMIT(".data");
-        EMIT(" }");
+        if (st && st->kind == TYPE_SLICE) EMIT_LIT(".data");
+        EMIT_LIT(" }");
         return true;
     }
     return false;
@@ -269,6 +418,39 @@ static bool is_primitive_type(Type *t) {
     return false;
 }
 
+// Approximate C size of a value of `t` in bytes (fields summed, padding
+// ignored), or -1 when it is not known here. Good enough to tell a value that
+// travels in registers from an aggregate worth reading in place.
+static isize emit_type_size_hint(Type *t, int depth) {
+    if (!t || depth > 16) return -1;
+    if (t->kind == TYPE_POINTER) return (isize)target.pointer_size;
+    if (t->kind == TYPE_SLICE) return 2 * (isize)target.pointer_size;
+    if (t->kind == TYPE_ARRAY) {
+        if (t->array_len < 0) return 2 * (isize)target.pointer_size;
+        isize e = emit_type_size_hint(t->element_type, depth + 1);
+        return e < 0 ? -1 : e * (isize)t->array_len;
+    }
+    if (t->kind != TYPE_SIMPLE || !t->base_type) return -1;
+    int bits; bool sgn;
+    if (parse_iN_uN(t, &bits, &sgn)) return bits <= 8 ? 1 : bits <= 16 ? 2 : bits <= 32 ? 4 : 8;
+    Id *b = t->base_type;
+    if (b->length == 5 && (strncmp(b->name, "usize", 5) == 0 || strncmp(b->name, "isize", 5) == 0))
+        return (isize)target.pointer_size;
+    if (b->length == 4 && strncmp(b->name, "bool", 4) == 0) return 1;
+    if (b->length == 3 && (strncmp(b->name, "int", 3) == 0 || strncmp(b->name, "f32", 3) == 0)) return 4;
+    if (b->length == 3 && strncmp(b->name, "f64", 3) == 0) return 8;
+    DeclStruct *sd = find_struct_decl(b);
+    if (!sd) return -1;
+    isize size = 0;
+    for (DeclList *f = sd->fields; f; f = f->next) {
+        if (!f->decl || f->decl->kind != DECL_VARIABLE) continue;
+        isize fs = emit_type_size_hint(f->decl->as.variable_decl.type, depth + 1);
+        if (fs < 0) return -1;
+        size += fs;
+    }
+    return size;
+}
+
 // True iff a TYPE_ARRAY with a non-primitive element type should be emitted
 // as a native C array (ElemType name[N]) rather than a Fixed_T_N struct.
 // User-defined element types cannot be used in Fixed_ structs defined in
@@ -294,6 +476,7 @@ static bool is_dynarray_param_decl(Decl *d) {
 // binding names here for the duration of that arm's body.
 static const char *emit_binding_name[256];
 static int         emit_binding_len[256];
+static bool        emit_binding_by_ref[256];   // bound as `const T *name`: reads are `(*name)`
 static int         emit_binding_depth = 0;
 static bool emit_name_is_binding(const char *name, int len) {
     for (int i = 0; i < emit_binding_depth; i++)
@@ -303,11 +486,22 @@ static bool emit_name_is_binding(const char *name, int len) {
 }
 static void emit_push_binding(const char *name, int len) {
     if (emit_binding_depth < 256) {
-        emit_binding_name[emit_binding_depth] = name;
-        emit_binding_len[emit_binding_depth]  = len;
+        emit_binding_name[emit_binding_depth]   = name;
+        emit_binding_len[emit_binding_depth]    = len;
+        emit_binding_by_ref[emit_binding_depth] = false;
         emit_binding_depth++;
     }
 }
+static void emit_push_ref_binding(const char *name, int len) {
+    emit_push_binding(name, len);
+    if (emit_binding_depth > 0) emit_binding_by_ref[emit_binding_depth - 1] = true;
+}
+static bool emit_binding_is_ref(const char *name, int len) {
+    for (int i = emit_binding_depth - 1; i >= 0; i--)
+        if (emit_binding_len[i] == len && strncmp(emit_binding_name[i], name, len) == 0)
+            return emit_binding_by_ref[i];
+    return false;
+}
 
 // Suppress the undeclared-identifier check while emitting expressions that live
 // inside a TYPE rather than a value position (e.g. a VLA's size expression
@@ -315,6 +509,46 @@ static void emit_push_binding(const char *name, int len) {
 // as value nodes, so they carry no type and would otherwise be mis-flagged.
 static bool emit_suppress_undeclared = false;
 
+// --verify-sema: emit is a pure consumer of sema's annotations, so every
+// expression it reaches must already carry them. A value node without a type,
+// or an identifier bound to nothing (outside the binding / type-position
+// exemptions above), means sema skipped it; report it instead of emitting C
+// from a half-annotated tree. Calls and builtins may be void, type names and
+// anonymous type literals have no value type.
+static bool emit_verify_sema = false;
+
+static const char *emit_expr_kind_names[] = {
+    "binary", "unary", "identifier", "literal", "member", "call", "string",
+    "char", "range", "index", "move", "mut", "cast", "float literal", "case",
+    "type", "anonymous struct", "anonymous enum", "array literal",
+    "array comprehension", "builtin", "address-of", "dereference",
+};
+
+static void emit_verify_annotated(Expr *e) {
+    bool ok;
+    switch (e->kind) {
+    case EXPR_IDENTIFIER:
+        ok = e->type || e->decl || e->is_global || emit_suppress_undeclared ||
+             emit_name_is_binding(e->as.identifier_expr.id->name,
+                                  (int)e->as.identifier_expr.id->length);
+        break;
+    case EXPR_CALL: case EXPR_BUILTIN: case EXPR_TYPE:
+    case EXPR_ANON_STRUCT: case EXPR_ANON_ENUM: case EXPR_ARRAY_COMPREHENSION:
+        ok = true;
+        break;
+    default:
+        ok = e->type != NULL;
+        break;
+    }
+    if (ok) return;
+    const char *kind = (size_t)e->kind < sizeof emit_expr_kind_names / sizeof *emit_expr_kind_names
+                     ? emit_expr_kind_names[e->kind] : "?";
+    fprintf(stderr, "Error: --verify-sema: Ln %li, Col %li: %s expression reached codegen "
+            "without sema annotations\n", (long)e->line, (long)e->col, kind);
+    diagnostic_show_line(e->line, e->col);
+    exit(1);
+}
+
 // A local `var a T[n]` VLA: an OWNED native stack array (a real `T a[n]`), not
 // a sized-slice view. Like a native fixed array it decays to a bare pointer and
 // indexes natively; its `.len` is the size expression `n`.
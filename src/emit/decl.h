@@ -266,6 +266,21 @@ static void emit_access_attributes(Decl *decl) {
     #undef MAX_PARAMS
 }
 
+// --whole-program: the output C is the entire program, so only main and the
+// functions marked [export] need to be callable from outside it.
+static bool emit_whole_program = false;
+
+// Q-018 [private]: module-internal functions get internal linkage (`static`);
+// main must stay external. Under --whole-program every function but main and
+// [export] ones does, which lets gcc drop the unused and inline the rest.
+static bool emit_function_is_static(Decl *decl) {
+    Id *name = decl->as.function_decl.name;
+    bool is_main = name->length == 4 && strncmp(name->name, "main", 4) == 0;
+    if (is_main) return false;
+    if (decl->is_private) return true;
+    return emit_whole_program && !decl_has_attribute(decl, "export", 6);
+}
+
 static void emit_forward_decl(Decl *decl, int depth) {
     if (!decl) return;
     if (decl->kind == DECL_FUNCTION || decl->kind == DECL_PROCEDURE) {
@@ -273,21 +288,21 @@ static void emit_forward_decl(Decl *decl, int depth) {
         // [private] → internal linkage. The forward declaration MUST carry the
         // same `static` as the definition, or gcc errors "static declaration
         // follows non-static declaration".
-        {
-            const char *_fn = decl->as.function_decl.name->name;
-            size_t _fl = decl->as.function_decl.name->length;
-            bool _is_main = (_fl == 4 && strncmp(_fn, "main", 4) == 0);
-            if (decl->is_private && !_is_main) EMIT("static ");
+        if (emit_function_is_static(decl)) {
+            EMIT_LIT("static ");
+            // Library code the program never calls is expected under
+            // --whole-program: let gcc drop it without a warning.
+            if (!decl->is_private) EMIT_LIT("__attribute__((unused)) ");
         }
         // @cold / @hot: programmer-declared frequency hints.
-        if (decl->as.function_decl.is_cold) EMIT("__attribute__((cold)) ");
-        if (decl->as.function_decl.is_hot)  EMIT("__attribute__((hot)) ");
+        if (decl->as.function_decl.is_cold) EMIT_LIT("__attribute__((cold)) ");
+        if (decl->as.function_decl.is_hot)  EMIT_LIT("__attribute__((hot)) ");
         // @allocator: return pointer doesn't alias any existing pointer.
         if (decl->as.function_decl.is_allocator)
-            EMIT("__attribute__((malloc, returns_nonnull)) ");
+            EMIT_LIT("__attribute__((malloc, returns_nonnull)) ");
         // @noreturn: function never returns (exit, panic, infinite loop).
         if (decl->as.function_decl.is_noreturn)
-            EMIT("__attribute__((noreturn)) ");
+            EMIT_LIT("__attribute__((noreturn)) ");
         // O-001 [access]: sized-array params → buffer bound annotation for GCC.
         emit_access_attributes(decl);
         // Q-019 [pure/const]: forward-declare func without var params as
@@ -299,32 +314,32 @@ static void emit_forward_decl(Decl *decl, int depth) {
             !func_has_var_param(decl) && !func_writes_through_param(decl) &&
             !func_has_fnptr_param(decl)) {
             if (func_all_params_by_value(decl))
-                EMIT("__attribute__((const)) ");
+                EMIT_LIT("__attribute__((const)) ");
             else
-                EMIT("__attribute__((pure)) ");
+                EMIT_LIT("__attribute__((pure)) ");
         }
         // Q-020 [nonnull]: every borrow (var T or shared T) is provably non-null;
         // emit nonnull with no args to cover all pointer parameters at once.
         if (func_has_ptr_param(decl))
-            EMIT("__attribute__((nonnull)) ");
+            EMIT_LIT("__attribute__((nonnull)) ");
         // Q-021 [returns_nonnull]: borrow return types are provably non-null pointers.
         if (func_returns_nonnull_ptr(decl))
-            EMIT("__attribute__((returns_nonnull)) ");
+            EMIT_LIT("__attribute__((returns_nonnull)) ");
         if (decl->as.function_decl.return_type) {
             emit_type(decl->as.function_decl.return_type);
         } else {
             const char *_fn = decl->as.function_decl.name->name;
             size_t _fl = decl->as.function_decl.name->length;
             if (_fl == 4 && strncmp(_fn, "main", 4) == 0)
-                EMIT("int32_t"); // C99: main must return int
+                EMIT_LIT("int32_t"); // C99: main must return int
             else
-                EMIT("void");
+                EMIT_LIT("void");
         }
 
         const char *id_name = decl->as.function_decl.name->name;
         size_t id_len = decl->as.function_decl.name->length;
         if (id_len == 4 && strncmp(id_name, "main", 4) == 0) {
-            EMIT(" main(");
+            EMIT_LIT(" main(");
         } else {
             EMIT(" %s(", c_name_for_id(decl->as.function_decl.name));
         }
@@ -338,7 +353,7 @@ static void emit_forward_decl(Decl *decl, int depth) {
                     continue;
                 }
                 if (!first) {
-                    EMIT(", ");
+                    EMIT_LIT(", ");
                 }
                 if (param->decl->kind == DECL_DESTRUCT) {
                     emit_param_type(param->decl->as.destruct_decl.type, true);
@@ -363,9 +378,9 @@ static void emit_forward_decl(Decl *decl, int depth) {
                 param = param->next;
             }
         } else {
-            EMIT("void");
+            EMIT_LIT("void");
         }
-        EMIT(");\n");
+        EMIT_LIT(");\n");
     }
 }
 
@@ -436,14 +451,14 @@ void emit_decl(Decl* decl, int depth) {
         case DECL_EXTERN_PROCEDURE:
         case DECL_EXTERN_FUNCTION: {
              emit_indent(depth);
-             EMIT("extern ");
+             EMIT_LIT("extern ");
              const char *fname = c_name_for_id(decl->as.function_decl.name);
              if (strcmp(fname, "fgets") == 0) {
-                 EMIT("char *");
+                 EMIT_LIT("char *");
              } else if (decl->as.function_decl.return_type) {
                  emit_type(decl->as.function_decl.return_type);
              } else {
-                 EMIT("void");
+                 EMIT_LIT("void");
              }
              EMIT(" %s(", fname);
             
@@ -451,10 +466,10 @@ void emit_decl(Decl* decl, int depth) {
              if (param) {
                  int first = 1;
                  while (param) {
-                     if (!first) EMIT(", ");
+                     if (!first) EMIT_LIT(", ");
                      if (param->decl->kind == DECL_DESTRUCT) {
                           emit_param_type(param->decl->as.destruct_decl.type, false);
-                          EMIT(" _destruct_param_");
+                          EMIT_LIT(" _destruct_param_");
                      } else {
                           Type *pt = param->decl->as.variable_decl.type;
                           const char *fname = c_name_for_id(decl->as.function_decl.name);
@@ -494,13 +509,13 @@ void emit_decl(Decl* decl, int depth) {
                               // C-Interop: Map u8* to char* and FILE* to FILE* (mut)
                               Id *base = pt->element_type->base_type;
                               if (base->length == 4 && strncmp(base->name, "FILE", 4) == 0) {
-                                  EMIT("FILE *"); // Always mutable FILE* for libc
+                                  EMIT_LIT("FILE *"); // Always mutable FILE* for libc
                               } else {
                                   // Strings (u8*)
                                   if (pt->mode == MODE_MUTABLE || pt->mode == MODE_OWNED) {
-                                      EMIT("char *");
+                                      EMIT_LIT("char *");
                                   } else {
-                                      EMIT("const char *");
+                                      EMIT_LIT("const char *");
                                   }
                               }
                           } else {
@@ -514,17 +529,17 @@ void emit_decl(Decl* decl, int depth) {
                      param = param->next;
                  }
                   if (decl->as.function_decl.is_variadic) {
-                      if (!first) EMIT(", ");
-                      EMIT("...");
+                      if (!first) EMIT_LIT(", ");
+                      EMIT_LIT("...");
                   }
               } else {
                   if (decl->as.function_decl.is_variadic) {
-                      EMIT("...");
+                      EMIT_LIT("...");
                  } else {
-                     EMIT("void");
+                     EMIT_LIT("void");
                  }
              }
-             EMIT(");\n");
+             EMIT_LIT(");\n");
              break;
         }
 
@@ -540,9 +555,9 @@ void emit_decl(Decl* decl, int depth) {
             }
             if (has_fast_math) {
                 emit_indent(depth);
-                EMIT("#pragma GCC push_options\n");
+                EMIT_LIT("#pragma GCC push_options\n");
                 emit_indent(depth);
-                EMIT("#pragma GCC optimize(\"fp-contract=fast\")\n");
+                EMIT_LIT("#pragma GCC optimize(\"fp-contract=fast\")\n");
             }
 
             emit_indent(depth);
@@ -551,18 +566,18 @@ void emit_decl(Decl* decl, int depth) {
             const char *fname = decl->as.function_decl.name->name;
             size_t flen = decl->as.function_decl.name->length;
             bool is_main = (flen == 4 && strncmp(fname, "main", 4) == 0);
-            if (decl->is_private && !is_main) {
-                EMIT("static ");
+            if (emit_function_is_static(decl)) {
+                EMIT_LIT("static ");
             }
             // @cold / @hot: programmer-declared frequency hints.
-            if (!is_main && decl->as.function_decl.is_cold) EMIT("__attribute__((cold)) ");
-            if (!is_main && decl->as.function_decl.is_hot)  EMIT("__attribute__((hot)) ");
+            if (!is_main && decl->as.function_decl.is_cold) EMIT_LIT("__attribute__((cold)) ");
+            if (!is_main && decl->as.function_decl.is_hot)  EMIT_LIT("__attribute__((hot)) ");
             // @allocator: fresh heap pointer — no aliasing with existing data.
             if (!is_main && decl->as.function_decl.is_allocator)
-                EMIT("__attribute__((malloc, returns_nonnull)) ");
+                EMIT_LIT("__attribute__((malloc, returns_nonnull)) ");
             // @noreturn: function never returns.
             if (!is_main && decl->as.function_decl.is_noreturn)
-                EMIT("__attribute__((noreturn)) ");
+                EMIT_LIT("__attribute__((noreturn)) ");
             // O-001 [access]: sized-array params → buffer bound annotation.
             if (!is_main) emit_access_attributes(decl);
             // Q-019 [pure/const]: func without var params gets __attribute__((const))
@@ -573,30 +588,30 @@ void emit_decl(Decl* decl, int depth) {
                 !func_has_var_param(decl) && !func_writes_through_param(decl) &&
                 !func_has_fnptr_param(decl)) {
                 if (func_all_params_by_value(decl))
-                    EMIT("__attribute__((const)) ");
+                    EMIT_LIT("__attribute__((const)) ");
                 else
-                    EMIT("__attribute__((pure)) ");
+                    EMIT_LIT("__attribute__((pure)) ");
             }
             // Q-020 [nonnull]: borrow checker proves every pointer param is non-null.
             if (!is_main && func_has_ptr_param(decl))
-                EMIT("__attribute__((nonnull)) ");
+                EMIT_LIT("__attribute__((nonnull)) ");
             // Q-021 [returns_nonnull]: borrow return type is provably non-null.
             if (!is_main && func_returns_nonnull_ptr(decl))
-                EMIT("__attribute__((returns_nonnull)) ");
+                EMIT_LIT("__attribute__((returns_nonnull)) ");
             // Print return type and function name.
             if (decl->as.function_decl.return_type) {
                 emit_type(decl->as.function_decl.return_type);
             } else if (is_main) {
-                EMIT("int32_t"); // C99: main must return int
+                EMIT_LIT("int32_t"); // C99: main must return int
             } else {
-                EMIT("void");
+                EMIT_LIT("void");
             }
 
             // special case if the function is named "main"
             const char *id_name = decl->as.function_decl.name->name;
             size_t id_len = decl->as.function_decl.name->length;
             if (id_len == 4 && strncmp(id_name, "main", 4) == 0) {
-                EMIT(" main(");
+                EMIT_LIT(" main(");
             } else {
                 EMIT(" %s(", c_name_for_id(decl->as.function_decl.name));
             }
@@ -612,7 +627,7 @@ void emit_decl(Decl* decl, int depth) {
                         continue;
                     }
                     if (!first) {
-                        EMIT(", ");
+                        EMIT_LIT(", ");
                     }
                     
                     if (param->decl->kind == DECL_DESTRUCT) {
@@ -651,9 +666,9 @@ void emit_decl(Decl* decl, int depth) {
                     param_idx++;
                 }
             } else {
-                EMIT("void");
+                EMIT_LIT("void");
             }
-            EMIT(") {\n");
+            EMIT_LIT(") {\n");
 
             // Q-022 [refinement-unreachable]: for every parameter with a refinement
             // constraint (e.g. `m usize >= 1`), emit __builtin_unreachable() on the
@@ -900,14 +915,14 @@ void emit_decl(Decl* decl, int depth) {
 
             emit_stmt_list(decl->as.function_decl.body, depth + 1);
             emit_indent(depth);
-            EMIT("}\n");
+            EMIT_LIT("}\n");
 
             // Q-017 [fast_math]: pop pragma options after function body
             if (has_fast_math) {
                 emit_indent(depth);
-                EMIT("#pragma GCC pop_options\n");
+                EMIT_LIT("#pragma GCC pop_options\n");
             }
-            EMIT("\n");
+            EMIT_LIT("\n");
             break;
         }
 
@@ -980,19 +995,19 @@ void emit_decl(Decl* decl, int depth) {
                 int idx = 0;
                 int first = 1;
                 for (DeclList *f = decl->as.struct_decl.fields; f; f = f->next, idx++) {
-                    if (!first) EMIT(", ");
+                    if (!first) EMIT_LIT(", ");
                     emit_type(f->decl->as.variable_decl.type);
                     EMIT(" %.*s",
                          (int)f->decl->as.variable_decl.name->length,
                          f->decl->as.variable_decl.name->name);
                     first = 0;
                 }
-                EMIT(") {\n");
+                EMIT_LIT(") {\n");
                 emit_indent(depth + 1);
                 EMIT("return (%s)(", container);
                 idx = 0; first = 1;
                 for (DeclList *f = decl->as.struct_decl.fields; f; f = f->next, idx++) {
-                    if (!first) EMIT(" | ");
+                    if (!first) EMIT_LIT(" | ");
                     int bits = pf[idx].bits;
                     int off  = pf[idx].offset;
                     unsigned long long mask = (bits >= 64) ? ~0ULL : ((1ULL << bits) - 1);
@@ -1003,9 +1018,9 @@ void emit_decl(Decl* decl, int depth) {
                          mask, off);
                     first = 0;
                 }
-                EMIT(");\n");
+                EMIT_LIT(");\n");
                 emit_indent(depth);
-                EMIT("}\n\n");
+                EMIT_LIT("}\n\n");
 
                 // Per-field getter functions.
                 // (Setters were removed for philosophical coherence with P5
@@ -1022,7 +1037,7 @@ void emit_decl(Decl* decl, int depth) {
 
                     // Getter: extract bit range.
                     emit_indent(depth);
-                    EMIT("static inline ");
+                    EMIT_LIT("static inline ");
                     emit_type(f->decl->as.variable_decl.type);
                     EMIT(" %s_get_%.*s(%s r) {\n",
                          structName,
@@ -1030,11 +1045,11 @@ void emit_decl(Decl* decl, int depth) {
                          f->decl->as.variable_decl.name->name,
                          structName);
                     emit_indent(depth + 1);
-                    EMIT("return (");
+                    EMIT_LIT("return (");
                     emit_type(f->decl->as.variable_decl.type);
                     EMIT(")((r >> %d) & 0x%llxULL);\n", off, mask);
                     emit_indent(depth);
-                    EMIT("}\n\n");
+                    EMIT_LIT("}\n\n");
                 }
                 break;
             }
@@ -1071,7 +1086,7 @@ void emit_decl(Decl* decl, int depth) {
                 int first = 1;
                 for (DeclList* f = decl->as.struct_decl.fields; f; f = f->next) {
                     if (!f->decl) continue;
-                    if (!first) EMIT(", ");
+                    if (!first) EMIT_LIT(", ");
                     emit_type(f->decl->as.variable_decl.type);
                     EMIT(" %.*s",
                          (int)f->decl->as.variable_decl.name->length,
@@ -1079,7 +1094,7 @@ void emit_decl(Decl* decl, int depth) {
                     first = 0;
                 }
             }
-            EMIT(") {\n");
+            EMIT_LIT(") {\n");
 
             // body: return (StructName){ .field1 = field1, .field2 = field2, … };
             emit_indent(depth + 1);
@@ -1088,7 +1103,7 @@ void emit_decl(Decl* decl, int depth) {
                 int first = 1;
                 for (DeclList* f = decl->as.struct_decl.fields; f; f = f->next) {
                     if (!f->decl) continue;
-                    if (!first) EMIT(", ");
+                    if (!first) EMIT_LIT(", ");
                     EMIT(".%.*s = %.*s",
                          (int)f->decl->as.variable_decl.name->length,
                          f->decl->as.variable_decl.name->name,
@@ -1097,11 +1112,11 @@ void emit_decl(Decl* decl, int depth) {
                     first = 0;
                 }
             }
-            EMIT(" };\n");
+            EMIT_LIT(" };\n");
 
             // 5) close constructor function
             emit_indent(depth);
-            EMIT("}\n\n");
+            EMIT_LIT("}\n\n");
 
             break;
         }
@@ -1137,7 +1152,7 @@ void emit_decl(Decl* decl, int depth) {
                     if (v->fields) {
                         int first = 1;
                         for (DeclList *f = v->fields; f; f = f->next) {
-                            if (!first) EMIT(", ");
+                            if (!first) EMIT_LIT(", ");
                             emit_type(f->decl->as.variable_decl.type);
                             EMIT(" %.*s",
                                  (int)f->decl->as.variable_decl.name->length,
@@ -1145,9 +1160,9 @@ void emit_decl(Decl* decl, int depth) {
                             first = 0;
                         }
                     } else {
-                        EMIT("void");
+                        EMIT_LIT("void");
                     }
-                    EMIT(") {\n");
+                    EMIT_LIT(") {\n");
                     emit_indent(depth + 1);
 
                     if (is_multi && v == __niche_layout.secondary_variant) {
@@ -1179,14 +1194,14 @@ void emit_decl(Decl* decl, int depth) {
                         }
                     }
                     emit_indent(depth);
-                    EMIT("}\n\n");
+                    EMIT_LIT("}\n\n");
                 }
                 break;  // skip legacy tag+union emit
             }
 
             // 2) Generate the Tag Enum: typedef enum { Shape_Tag_Circle, Shape_Tag_Rectangle } Shape_Tag;
             emit_indent(depth);
-            EMIT("typedef enum {\n");
+            EMIT_LIT("typedef enum {\n");
 
             for (Variant *v = decl->as.enum_decl.variants; v; v = v->next) {
                 emit_indent(depth + 1);
@@ -1213,12 +1228,12 @@ void emit_decl(Decl* decl, int depth) {
             
             if (has_fields) {
                 emit_indent(depth + 1);
-                EMIT("union {\n");
+                EMIT_LIT("union {\n");
                 
                 for (Variant *v = decl->as.enum_decl.variants; v; v = v->next) {
                     if (v->fields) {
                         emit_indent(depth + 2);
-                        EMIT("struct {\n");
+                        EMIT_LIT("struct {\n");
                         for (DeclList *f = v->fields; f; f = f->next) {
                             emit_indent(depth + 3);
                             emit_type(f->decl->as.variable_decl.type);
@@ -1232,7 +1247,7 @@ void emit_decl(Decl* decl, int depth) {
                 }
                 
                 emit_indent(depth + 1);
-                EMIT("} data;\n");
+                EMIT_LIT("} data;\n");
             }
             
             emit_indent(depth);
@@ -1250,7 +1265,7 @@ void emit_decl(Decl* decl, int depth) {
                 if (v->fields) {
                     int first = 1;
                     for (DeclList *f = v->fields; f; f = f->next) {
-                        if (!first) EMIT(", ");
+                        if (!first) EMIT_LIT(", ");
                         emit_type(f->decl->as.variable_decl.type);
                         EMIT(" %.*s", 
                              (int)f->decl->as.variable_decl.name->length,
@@ -1259,7 +1274,7 @@ void emit_decl(Decl* decl, int depth) {
                     }
                 }
                 
-                EMIT(") {\n");
+                EMIT_LIT(") {\n");
                 emit_indent(depth + 1);
                 EMIT("return (%s){ .tag = %s_Tag_%.*s", adt_name, adt_name, (int)v->name->length, v->name->name);
                 
@@ -1267,18 +1282,18 @@ void emit_decl(Decl* decl, int depth) {
                     EMIT(", .data.%.*s = { ", (int)v->name->length, v->name->name);
                     int first = 1;
                     for (DeclList *f = v->fields; f; f = f->next) {
-                        if (!first) EMIT(", ");
+                        if (!first) EMIT_LIT(", ");
                         EMIT(".%.*s = %.*s", 
                              (int)f->decl->as.variable_decl.name->length, f->decl->as.variable_decl.name->name,
                              (int)f->decl->as.variable_decl.name->length, f->decl->as.variable_decl.name->name);
                         first = 0;
                     }
-                    EMIT(" }");
+                    EMIT_LIT(" }");
                 }
                 
-                EMIT(" };\n");
+                EMIT_LIT(" };\n");
                 emit_indent(depth);
-                EMIT("}\n\n");
+                EMIT_LIT("}\n\n");
             }
         }
         break;
@@ -55,11 +55,11 @@ static void emit_size_expr(Expr *se, int depth) {
     if (se->kind == EXPR_BINARY) {
         TokenKind op = se->as.binary_expr.op;
         emit_size_expr(se->as.binary_expr.left, depth);
-        if (op == TOKEN_PLUS)        EMIT(" + ");
-        else if (op == TOKEN_MINUS)  EMIT(" - ");
-        else if (op == TOKEN_ASTERISK) EMIT(" * ");
-        else if (op == TOKEN_SLASH)    EMIT(" / ");
-        else                         EMIT(" ? ");
+        if (op == TOKEN_PLUS)        EMIT_LIT(" + ");
+        else if (op == TOKEN_MINUS)  EMIT_LIT(" - ");
+        else if (op == TOKEN_ASTERISK) EMIT_LIT(" * ");
+        else if (op == TOKEN_SLASH)    EMIT_LIT(" / ");
+        else                         EMIT_LIT(" ? ");
         emit_size_expr(se->as.binary_expr.right, depth);
         return;
     }
@@ -113,13 +113,9 @@ void emit_expr(Expr *expr, int depth) {
   if (!expr)
     return;
 
-  // ─────────────────────────────────────────────────────────────
-  // Make sure the type‐checker/semantic pass has run on this node
-  // before we ever try to access expr->type. Without this, indexing
-  // into something like `text[...]` will still have expr->type == NULL.
-  sema_resolve_expr(expr);
-  sema_infer_expr(expr);
-  // ─────────────────────────────────────────────────────────────
+  // Emit only reads what sema recorded (expr->type, expr->decl); it never
+  // re-runs resolution or inference. --verify-sema checks that contract.
+  if (emit_verify_sema) emit_verify_annotated(expr);
 
   switch (expr->kind) {
   case EXPR_LITERAL:
@@ -155,7 +151,7 @@ void emit_expr(Expr *expr, int depth) {
     EMIT(is_vec ? "(%s){ " : "(%s){ .data = { ", typeName);
     bool first = true;
     for (ExprList *el = expr->as.array_literal_expr.elements; el; el = el->next) {
-        if (!first) EMIT(", ");
+        if (!first) EMIT_LIT(", ");
         first = false;
         emit_expr(el->expr, depth);
     }
@@ -167,19 +163,19 @@ void emit_expr(Expr *expr, int depth) {
     unsigned char v = expr->as.char_expr.value;
     switch (v) {
     case '\n':
-      EMIT("'\\n'");
+      EMIT_LIT("'\\n'");
       break;
     case '\r':
-      EMIT("'\\r'");
+      EMIT_LIT("'\\r'");
       break;
     case '\t':
-      EMIT("'\\t'");
+      EMIT_LIT("'\\t'");
       break;
     case '\\':
-      EMIT("'\\\\'");
+      EMIT_LIT("'\\\\'");
       break;
     case '\'':
-      EMIT("'\\\''");
+      EMIT_LIT("'\\\''");
       break;
     default:
       if (v < 32 || v > 126) {
@@ -220,7 +216,11 @@ void emit_expr(Expr *expr, int depth) {
         expr->decl->as.variable_decl.type &&
         expr->decl->as.variable_decl.type->mode == MODE_MUTABLE &&
         is_primitive_type(expr->decl->as.variable_decl.type);
-    if (is_var_prim_param) {
+    // A `for` element bound by pointer (emit/stmt.h STMT_FOR) reads the same way.
+    bool is_ref_binding = !expr->is_global && !expr->decl &&
+        emit_binding_is_ref(expr->as.identifier_expr.id->name,
+                            (int)expr->as.identifier_expr.id->length);
+    if (is_var_prim_param || is_ref_binding) {
         EMIT("(*%s)", c_name_for_id(expr->as.identifier_expr.id));
     } else {
         EMIT("%s", c_name_for_id(expr->as.identifier_expr.id));
@@ -244,7 +244,7 @@ void emit_expr(Expr *expr, int depth) {
         int L = (int)lit->as.string_expr.length;
         const char *S = lit->as.string_expr.value;
         // == : len matches AND bytes match.  != : len differs OR bytes differ.
-        EMIT("(");
+        EMIT_LIT("(");
         emit_expr(slice, 0);
         EMIT(".len %s %d %s memcmp(", is_eq ? "==" : "!=", L, is_eq ? "&&" : "||");
         emit_expr(slice, 0);
@@ -260,10 +260,10 @@ void emit_expr(Expr *expr, int depth) {
       const char *op_str = (expr->as.binary_expr.op == TOKEN_KEYWORD_AND) ? " && " : " || ";
       Expr *lhs = expr->as.binary_expr.left;
       Expr *rhs = expr->as.binary_expr.right;
-      if (c_prec_of_expr(lhs) < prec) { EMIT("("); emit_expr(lhs, depth); EMIT(")"); }
+      if (c_prec_of_expr(lhs) < prec) { EMIT_LIT("("); emit_expr(lhs, depth); EMIT_LIT(")"); }
       else emit_expr(lhs, depth);
       EMIT("%s", op_str);
-      if (c_prec_of_expr(rhs) < prec) { EMIT("("); emit_expr(rhs, depth); EMIT(")"); }
+      if (c_prec_of_expr(rhs) < prec) { EMIT_LIT("("); emit_expr(rhs, depth); EMIT_LIT(")"); }
       else emit_expr(rhs, depth);
     } else if (expr->as.binary_expr.op == TOKEN_KEYWORD_IN) {
       Expr *lhs = expr->as.binary_expr.left;
@@ -281,57 +281,57 @@ void emit_expr(Expr *expr, int depth) {
 
         if (upper_bound_dead && lower_bound_dead) {
             // L3: both bounds dead — entire check is always true → emit 1
-            EMIT("1");
+            EMIT_LIT("1");
         } else if (upper_bound_dead) {
             // L3 eliminates upper bound: single comparison, no extra parens needed
             emit_expr(lhs, depth);
-            EMIT(" >= ");
+            EMIT_LIT(" >= ");
             emit_expr(rhs, depth);
         } else if (lower_bound_dead) {
             // L3 eliminates lower bound: single comparison, no extra parens needed
             emit_expr(lhs, depth);
-            EMIT(" < ");
+            EMIT_LIT(" < ");
             emit_expr(rhs, depth);
             if (ct && ct->kind == TYPE_ARRAY) {
                 if (ct->array_len >= 0) { EMIT(" + %lld", (long long)ct->array_len); }
-                else if (ct->size_expr) { EMIT(" + ("); emit_expr(ct->size_expr, depth); EMIT(")"); }
+                else if (ct->size_expr) { EMIT_LIT(" + ("); emit_expr(ct->size_expr, depth); EMIT_LIT(")"); }
                 else {
                     if (rhs->kind == EXPR_IDENTIFIER && rhs->as.identifier_expr.id)
                         EMIT(" + __len_%.*s", (int)rhs->as.identifier_expr.id->length, rhs->as.identifier_expr.id->name);
-                    else EMIT(".len");
+                    else EMIT_LIT(".len");
                 }
             }
         } else {
             // Full pointer in-guard: (ptr >= arr_base && ptr < arr_base + arr_len)
-            EMIT("(");
+            EMIT_LIT("(");
             emit_expr(lhs, depth);
-            EMIT(" >= ");
+            EMIT_LIT(" >= ");
             emit_expr(rhs, depth);
-            EMIT(" && ");
+            EMIT_LIT(" && ");
             emit_expr(lhs, depth);
-            EMIT(" < ");
+            EMIT_LIT(" < ");
             emit_expr(rhs, depth);
             if (ct && ct->kind == TYPE_ARRAY) {
                 if (ct->array_len >= 0) {
                     EMIT(" + %lld", (long long)ct->array_len);
                 } else if (ct->size_expr != NULL) {
-                    EMIT(" + ("); emit_expr(ct->size_expr, depth); EMIT(")");
+                    EMIT_LIT(" + ("); emit_expr(ct->size_expr, depth); EMIT_LIT(")");
                 } else {
                     if (rhs->kind == EXPR_IDENTIFIER && rhs->as.identifier_expr.id) {
                         EMIT(" + __len_%.*s", (int)rhs->as.identifier_expr.id->length,
                              rhs->as.identifier_expr.id->name);
-                    } else { EMIT(".len"); }
+                    } else { EMIT_LIT(".len"); }
                 }
             }
-            EMIT(")");
+            EMIT_LIT(")");
         }
       } else {
         // idx in arr → (idx >= 0 && idx < arr.len)
-        EMIT("(");
+        EMIT_LIT("(");
         emit_expr(lhs, depth);
-        EMIT(" >= 0 && ");
+        EMIT_LIT(" >= 0 && ");
         emit_expr(lhs, depth);
-        EMIT(" < ");
+        EMIT_LIT(" < ");
         if (ct && ct->kind == TYPE_ARRAY && ct->array_len >= 0) {
           EMIT("%lld", (long long)ct->array_len);
         } else if (ct && ct->kind == TYPE_SLICE) {
@@ -339,17 +339,17 @@ void emit_expr(Expr *expr, int depth) {
           // parameter) — it carries a real `.len` member. Only a *decomposed*
           // dynamic-array param (TYPE_ARRAY, array_len == -1) uses `__len_x`.
           emit_expr(rhs, depth);
-          EMIT(".len");
+          EMIT_LIT(".len");
         } else {
           if (rhs->kind == EXPR_IDENTIFIER && rhs->as.identifier_expr.id) {
             Id *rname = rhs->as.identifier_expr.id;
             EMIT("__len_%.*s", (int)rname->length, rname->name);
           } else {
             emit_expr(rhs, depth);
-            EMIT(".len");
+            EMIT_LIT(".len");
           }
         }
-        EMIT(")");
+        EMIT_LIT(")");
       }
     } else if (expr->as.binary_expr.op == TOKEN_PLUS_PERCENT
             || expr->as.binary_expr.op == TOKEN_MINUS_PERCENT
@@ -359,11 +359,11 @@ void emit_expr(Expr *expr, int depth) {
       const char *op_c = (expr->as.binary_expr.op == TOKEN_PLUS_PERCENT)  ? "+"
                        : (expr->as.binary_expr.op == TOKEN_MINUS_PERCENT) ? "-"
                                                                           : "*";
-      EMIT("(");
+      EMIT_LIT("(");
       emit_expr(expr->as.binary_expr.left, depth);
       EMIT(" %s ", op_c);
       emit_expr(expr->as.binary_expr.right, depth);
-      EMIT(")");
+      EMIT_LIT(")");
     } else if (expr->as.binary_expr.op == TOKEN_PLUS_PIPE
             || expr->as.binary_expr.op == TOKEN_MINUS_PIPE
             || expr->as.binary_expr.op == TOKEN_ASTERISK_PIPE) {
@@ -391,26 +391,26 @@ void emit_expr(Expr *expr, int depth) {
       // Build: ({ int64_t __t = (int64_t)L op (int64_t)R; __t > hi ? hi : (__t < lo ? lo : __t); })
       // We avoid statement expressions for portability and inline a ternary.
       // Pattern: (((int64_t)L op (int64_t)R) > hi) ? hi : ( ((int64_t)L op (int64_t)R) < lo ? lo : ((int64_t)L op (int64_t)R) )
-      EMIT("( ");
+      EMIT_LIT("( ");
       // outer: > hi check
-      EMIT("(((int64_t)(");
+      EMIT_LIT("(((int64_t)(");
       emit_expr(expr->as.binary_expr.left, depth);
       EMIT(") %s (int64_t)(", op_c);
       emit_expr(expr->as.binary_expr.right, depth);
       EMIT(")) > %lldLL) ? %lldLL : ", hi, hi);
       // < lo check
-      EMIT("( (((int64_t)(");
+      EMIT_LIT("( (((int64_t)(");
       emit_expr(expr->as.binary_expr.left, depth);
       EMIT(") %s (int64_t)(", op_c);
       emit_expr(expr->as.binary_expr.right, depth);
       EMIT(")) < %lldLL) ? %lldLL : ", lo, lo);
       // in-range: emit the actual op
-      EMIT("((int64_t)(");
+      EMIT_LIT("((int64_t)(");
       emit_expr(expr->as.binary_expr.left, depth);
       EMIT(") %s (int64_t)(", op_c);
       emit_expr(expr->as.binary_expr.right, depth);
-      EMIT(")) )");
-      EMIT(" )");
+      EMIT_LIT(")) )");
+      EMIT_LIT(" )");
     } else {
       // Pointer subtraction ptr1 - ptr2 → (uintptr_t)(ptr1 - ptr2)
       // This gives the element offset (ptrdiff_t cast to usize).
@@ -420,13 +420,13 @@ void emit_expr(Expr *expr, int depth) {
                      rt && rt->kind == TYPE_POINTER &&
                      expr->as.binary_expr.op == TOKEN_MINUS;
       if (ptr_sub) {
-          EMIT("((uintptr_t)(");
+          EMIT_LIT("((uintptr_t)(");
           emit_expr(expr->as.binary_expr.left, depth);
-          EMIT(") - (uintptr_t)(");
+          EMIT_LIT(") - (uintptr_t)(");
           emit_expr(expr->as.binary_expr.right, depth);
-          EMIT(")) / sizeof(*");
+          EMIT_LIT(")) / sizeof(*");
           emit_expr(expr->as.binary_expr.left, depth);
-          EMIT(")");
+          EMIT_LIT(")");
       } else {
           // Fallback for all other binary ops: +, -, *, /, %, <, ==, bitwise, etc.
           // Use C precedence to decide whether children need parens.
@@ -435,7 +435,7 @@ void emit_expr(Expr *expr, int depth) {
           Expr *rhs = expr->as.binary_expr.right;
           TokenKind op = expr->as.binary_expr.op;
           // Left child: needs parens only when it binds looser than the current op.
-          if (c_prec_of_expr(lhs) < prec) { EMIT("("); emit_expr(lhs, depth); EMIT(")"); }
+          if (c_prec_of_expr(lhs) < prec) { EMIT_LIT("("); emit_expr(lhs, depth); EMIT_LIT(")"); }
           else emit_expr(lhs, depth);
           EMIT(" %s ", token_kind_to_str(op));
           // Right child: additionally needs parens for same-prec left-assoc ops where
@@ -444,7 +444,7 @@ void emit_expr(Expr *expr, int depth) {
               (op == TOKEN_MINUS || op == TOKEN_SLASH || op == TOKEN_PERCENT) &&
               c_prec_of_expr(rhs) == prec;
           if (c_prec_of_expr(rhs) < prec || right_needs_same_prec_parens) {
-              EMIT("("); emit_expr(rhs, depth); EMIT(")");
+              EMIT_LIT("("); emit_expr(rhs, depth); EMIT_LIT(")");
           } else emit_expr(rhs, depth);
       }
     }
@@ -517,7 +517,7 @@ void emit_expr(Expr *expr, int depth) {
           const char *sn = c_name_for_id(tsym->decl->as.struct_decl.name);
           EMIT("%s_get_%.*s(", sn, (int)m->member->length, m->member->name);
           emit_expr(m->target, 0);
-          EMIT(")");
+          EMIT_LIT(")");
           break;
         }
       }
@@ -626,11 +626,11 @@ void emit_expr(Expr *expr, int depth) {
           // Generic slice: msg.data and msg.len
           EMIT("(fprintf(stderr, \"panic: %%.*s\\n\", (int)(");
           if (arg) emit_expr(arg, 0);
-          else EMIT("(u8[]){0}");
-          EMIT(").len, (");
+          else EMIT_LIT("(u8[]){0}");
+          EMIT_LIT(").len, (");
           if (arg) emit_expr(arg, 0);
-          else EMIT("(u8[]){0}");
-          EMIT(").data), abort(), 0)");
+          else EMIT_LIT("(u8[]){0}");
+          EMIT_LIT(").data), abort(), 0)");
         }
         break;
       }
@@ -702,7 +702,7 @@ void emit_expr(Expr *expr, int depth) {
     }
   
     // 5) emit the argument list
-    EMIT("(");
+    EMIT_LIT("(");
     bool first = true;
     DeclList *fld = sd ? sd->fields : NULL;
     
@@ -754,7 +754,7 @@ void emit_expr(Expr *expr, int depth) {
           if (param) param = param->next;
           continue;
       }
-      if (!first) EMIT(", ");
+      if (!first) EMIT_LIT(", ");
       first = false;
       if (is_ctor && fld) {
         // ... (existing ctor code) ...
@@ -770,13 +770,13 @@ void emit_expr(Expr *expr, int depth) {
               const unsigned char *S = (const unsigned char*)lit->as.string_expr.value;
 
               // Native C array initializer: { 0x78, ... }
-              EMIT("{ ");
+              EMIT_LIT("{ ");
               for (size_t i = 0; i < fixed_len; i++) {
                 unsigned v = (i < (size_t)L) ? (unsigned)S[i] : 0u;
                 EMIT("0x%02X", v);
-                if (i + 1 < fixed_len) EMIT(", ");
+                if (i + 1 < fixed_len) EMIT_LIT(", ");
               }
-              EMIT(" }");
+              EMIT_LIT(" }");
 
               fld = fld->next;
               if (param) param = param->next; // Advance param too if it exists
@@ -830,7 +830,7 @@ void emit_expr(Expr *expr, int depth) {
                 c_name_for_type(ft, fbuf, sizeof fbuf);
                 EMIT("(*(%s*)(&(", fbuf);
                 emit_expr(arg->expr, depth);
-                EMIT(")))");
+                EMIT_LIT(")))");
                 fld = fld->next;
                 if (param) param = param->next;
                 continue;
@@ -850,7 +850,7 @@ void emit_expr(Expr *expr, int depth) {
            for (int i = 0; i < L; i++) {
              EMIT("0x%02X, ", S[i]);
            }
-           EMIT("0 } }"); // explicit sentinel byte appended
+           EMIT_LIT("0 } }"); // explicit sentinel byte appended
            fld = fld->next;
            if (param) param = param->next; // Advance param too if it exists
            continue;
@@ -896,7 +896,7 @@ void emit_expr(Expr *expr, int depth) {
                        // the struct has no `.len` member — use the known length.
                        EMIT("(size_t)%lld, ", (long long)at->sentinel_len);
                    } else {
-                       emit_expr(base_arg, depth); EMIT(".len, ");
+                       emit_expr(base_arg, depth); EMIT_LIT(".len, ");
                    }
                }
                // Emit data pointer
@@ -909,9 +909,9 @@ void emit_expr(Expr *expr, int depth) {
                    // Slice struct field (e.g. l.text): needs .data to get the pointer.
                    bool _is_decomposed = (base_arg->kind == EXPR_IDENTIFIER && base_arg->decl &&
                                           is_dynarray_param_decl(base_arg->decl));
-                   if (!_is_decomposed) EMIT(".data");
+                   if (!_is_decomposed) EMIT_LIT(".data");
                } else {
-                   emit_expr(base_arg, depth); EMIT(".data");
+                   emit_expr(base_arg, depth); EMIT_LIT(".data");
                }
                goto next_arg;
            }
@@ -956,15 +956,15 @@ void emit_expr(Expr *expr, int depth) {
                    if (byptr_param) {
                        EMIT("%s", c_name_for_id(arg->expr->as.identifier_expr.id));
                    } else if (is_lvalue) {
-                       EMIT("&(");
+                       EMIT_LIT("&(");
                        emit_expr(arg->expr, depth);
-                       EMIT(")");
+                       EMIT_LIT(")");
                    } else {
                        Type tn = *at; tn.mode = MODE_SHARED;
                        char tbuf[256]; c_name_for_type(&tn, tbuf, sizeof tbuf);
                        EMIT("(%s[1]){ ", tbuf);
                        emit_expr(arg->expr, depth);
-                       EMIT(" }");
+                       EMIT_LIT(" }");
                    }
                    goto next_arg;
                }
@@ -984,7 +984,7 @@ void emit_expr(Expr *expr, int depth) {
       if (fld) fld = fld->next;
       if (param) param = param->next;
     }
-    EMIT(")");
+    EMIT_LIT(")");
     break;
   }
   
@@ -1034,19 +1034,19 @@ void emit_expr(Expr *expr, int depth) {
         emit_expr(ix->target, 0);
         if (!decays) EMIT(is_ptr ? "->data" : ".data");
       }
-      EMIT(" + ");
+      EMIT_LIT(" + ");
       emit_expr(r->start, 0);
 
       // length = end - start (+1 if inclusive)
-      EMIT(", .len = ");
+      EMIT_LIT(", .len = ");
       emit_expr(r->end, 0);
-      EMIT(" - ");
+      EMIT_LIT(" - ");
       emit_expr(r->start, 0);
       if (r->inclusive) {
-        EMIT(" + 1");
+        EMIT_LIT(" + 1");
       }
 
-      EMIT(" }");
+      EMIT_LIT(" }");
     } else {
       // Plain indexing: T = data[i]
       
@@ -1075,9 +1075,9 @@ void emit_expr(Expr *expr, int depth) {
           ((ix->target->decl && is_dynarray_param_decl(ix->target->decl)) ||
            (ix->target->type && ix->target->type->is_vla))) {
           emit_expr(ix->target, 0);
-          EMIT("[");
+          EMIT_LIT("[");
           emit_expr(ix->index, 0);
-          EMIT("]");
+          EMIT_LIT("]");
       } else {
           emit_expr(ix->target, 0);
           // User-type fixed arrays and thin pointers (*T[N]): index directly
@@ -1098,12 +1098,12 @@ void emit_expr(Expr *expr, int depth) {
           // value, no `.data` member).
           bool is_vector = ix->target->type && ix->target->type->kind == TYPE_VECTOR;
           if (is_user_type_fixed_array(ix->target->type) || is_thin_ptr || is_native_fixed || is_vector) {
-              EMIT("[");
+              EMIT_LIT("[");
           } else {
               EMIT(is_ptr ? "->data[" : ".data[");
           }
           emit_expr(ix->index, 0);
-          EMIT("]");
+          EMIT_LIT("]");
       }
     }
     break;
@@ -1131,9 +1131,9 @@ void emit_expr(Expr *expr, int depth) {
         // would auto-deref var primitive params and produce (*r) instead of r.
         EMIT("%s", c_name_for_id(inner->as.identifier_expr.id));
     } else {
-        EMIT("&(");
+        EMIT_LIT("&(");
         emit_expr(inner, depth);
-        EMIT(")");
+        EMIT_LIT(")");
     }
     break;
   }
@@ -1143,7 +1143,7 @@ void emit_expr(Expr *expr, int depth) {
     c_name_for_type(expr->as.cast_expr.target_type, tybuf, sizeof tybuf);
     EMIT("((%s)(", tybuf);
     emit_expr(expr->as.cast_expr.expr, depth);
-    EMIT("))");
+    EMIT_LIT("))");
     break;
   }
 
@@ -1154,10 +1154,9 @@ void emit_expr(Expr *expr, int depth) {
     char res_c_ty[256];
     c_name_for_type(expr->type, res_c_ty, sizeof(res_c_ty));
 
-    static int __expr_match_cnt = 0;
-    int __match_id = __expr_match_cnt++;
+    int __match_id = emit_expr_match_count++;
 
-    EMIT("({\n");
+    EMIT_LIT("({\n");
     emit_indent(depth + 1);
     EMIT("%s __match%d = ", scrut_c_ty, __match_id);
     // Dereference by-pointer parameters (const T* or T*)
@@ -1177,10 +1176,10 @@ void emit_expr(Expr *expr, int depth) {
                 }
             }
         }
-        if (needs_deref) EMIT("*");
+        if (needs_deref) EMIT_LIT("*");
         emit_expr(scrut_expr, depth + 1);
     }
-    EMIT(";\n");
+    EMIT_LIT(";\n");
     
     emit_indent(depth + 1);
     EMIT("%s __result%d;\n", res_c_ty, __match_id);
@@ -1199,15 +1198,37 @@ void emit_expr(Expr *expr, int depth) {
         xmatch_use_niche = xmatch_niche.is_zero_cost;
     }
 
+    // A C switch when every pattern is a constant label (emit/switch.h),
+    // otherwise an if / else-if chain.
+    char xmatch_cname[256] = "";
+    if (xmatch_adt) {
+        strncpy(xmatch_cname, c_name_for_id(xmatch_adt->type_name), sizeof xmatch_cname);
+        xmatch_cname[sizeof xmatch_cname - 1] = '\0';
+    }
+    CaseSwitch sw;
+    case_switch_init(&sw, scrut_type, xmatch_adt, xmatch_cname, &xmatch_niche, xmatch_use_niche);
+    bool use_switch = case_switch_plan_expr(&sw, expr->as.match_expr.cases);
+    if (use_switch) case_switch_open(&sw, __match_id, depth + 1);
+
     bool first_clause = true;
     for (ExprMatchCase *c = expr->as.match_expr.cases; c; c = c->next) {
         int __xsaved_bd = emit_binding_depth;  // restore after this arm's body
+        if (use_switch) {
+            int labels = 0;
+            case_switch_arm(&sw);
+            if (!c->patterns) labels += case_switch_labels(&sw, NULL, depth + 1);
+            for (ExprList *p = c->patterns; p; p = p->next)
+                labels += case_switch_labels(&sw, p->expr, depth + 1);
+            if (labels == 0) continue;   // no value of the scrutinee type reaches this arm
+        }
         emit_indent(depth + 1);
-        if (c->patterns) {
+        if (use_switch) {
+            EMIT_LIT("{\n");
+        } else if (c->patterns) {
             EMIT(first_clause ? "if (" : "else if (");
             bool first_cond = true;
             for (ExprList *p = c->patterns; p; p = p->next) {
-                if (!first_cond) EMIT(" || ");
+                if (!first_cond) EMIT_LIT(" || ");
                 first_cond = false;
 
                 switch (p->expr->kind) {
@@ -1229,13 +1250,17 @@ void emit_expr(Expr *expr, int depth) {
                     break;
                   }
                   case EXPR_RANGE: {
-                    // Numeric byte bounds (not raw '%c') to avoid broken C for
-                    // control-char bounds. `..` exclusive, `..=` inclusive.
-                    int lo = (unsigned char)p->expr->as.range_expr.start->as.char_expr.value;
-                    int hi = (unsigned char)p->expr->as.range_expr.end->as.char_expr.value;
-                    const char *up = p->expr->as.range_expr.inclusive ? "<=" : "<";
-                    EMIT("(__match%d >= %d && __match%d %s %d)", __match_id, lo,
-                         __match_id, up, hi);
+                    // Numeric bounds, for char and integer literals alike.
+                    // `..` exclusive, `..=` inclusive.
+                    ExprRange *rg = &p->expr->as.range_expr;
+                    long long lo, hi;
+                    EMIT("(__match%d >= ", __match_id);
+                    if (case_pattern_bound(rg->start, &lo)) EMIT("%lld", lo);
+                    else emit_expr(rg->start, depth);
+                    EMIT(" && __match%d %s ", __match_id, rg->inclusive ? "<=" : "<");
+                    if (case_pattern_bound(rg->end, &hi)) EMIT("%lld", hi);
+                    else emit_expr(rg->end, depth);
+                    EMIT_LIT(")");
                     break;
                   }
                   case EXPR_CALL: {
@@ -1264,9 +1289,9 @@ void emit_expr(Expr *expr, int depth) {
                           char ecn[256];
                           strncpy(ecn, c_name_for_id(padt->type_name), sizeof ecn); ecn[sizeof ecn - 1] = '\0';
                           bool is_multi = xmatch_niche.primary_variant && xmatch_niche.secondary_variant;
-                          EMIT("(");
+                          EMIT_LIT("(");
                           if (is_multi && pmv == xmatch_niche.primary_variant) {
-                              EMIT("1");
+                              EMIT_LIT("1");
                               for (size_t si = 0; si < xmatch_niche.secondary_sentinels_count; si++) {
                                   long long sv = xmatch_niche.secondary_sentinels[si];
                                   if (xmatch_niche.pool.kind == POOL_POINTER) EMIT(" && (uintptr_t)__match%d != %lldULL", __match_id, sv);
@@ -1304,7 +1329,7 @@ void emit_expr(Expr *expr, int depth) {
                                   else EMIT("__match%d < (%s)%lldLL", __match_id, ecn, upper);
                               }
                           } else if (pmv->fields) {
-                              EMIT("1");
+                              EMIT_LIT("1");
                               for (Variant *ev = padt->variants; ev; ev = ev->next) {
                                   if (ev->fields) continue;
                                   long long sv = niche_sentinel_for_variant(padt, ev, &xmatch_niche);
@@ -1316,7 +1341,7 @@ void emit_expr(Expr *expr, int depth) {
                               if (xmatch_niche.pool.kind == POOL_POINTER) EMIT("(uintptr_t)__match%d == %lldULL", __match_id, sv);
                               else EMIT("__match%d == (%s)%lldLL", __match_id, ecn, sv);
                           }
-                          EMIT(")");
+                          EMIT_LIT(")");
                       } else if (padt && pmv) {
                           char ecn[256];
                           strncpy(ecn, c_name_for_id(padt->type_name), sizeof ecn); ecn[sizeof ecn - 1] = '\0';
@@ -1325,7 +1350,7 @@ void emit_expr(Expr *expr, int depth) {
                       } else {
                           EMIT("(__match%d.tag == ", __match_id);
                           emit_expr(pcallee, depth + 1);
-                          EMIT(")");
+                          EMIT_LIT(")");
                       }
                       break;
                   }
@@ -1377,7 +1402,7 @@ void emit_expr(Expr *expr, int depth) {
                   }
                 }
             }
-            EMIT(") {\n");
+            EMIT_LIT(") {\n");
         } else {
             EMIT(first_clause ? "if (1) {\n" : "else {\n");
         }
@@ -1466,18 +1491,20 @@ void emit_expr(Expr *expr, int depth) {
         } else {
             emit_expr(c->body, depth + 2);
         }
-        EMIT(";\n");
+        EMIT_LIT(";\n");
         
         emit_indent(depth + 1);
-        EMIT("}\n");
+        EMIT(use_switch ? "} break;\n" : "}\n");
         emit_binding_depth = __xsaved_bd;   // bindings leave scope with the arm
         first_clause = false;
     }
+    if (use_switch) case_switch_close(&sw, depth + 1);
+    case_switch_free(&sw);
 
     emit_indent(depth + 1);
     EMIT("__result%d;\n", __match_id);
     emit_indent(depth);
-    EMIT("})");
+    EMIT_LIT("})");
     break;
   }
 
@@ -1487,10 +1514,10 @@ void emit_expr(Expr *expr, int depth) {
     Expr *inner = expr->as.addr_expr.expr;
     if (inner && inner->kind == EXPR_INDEX) {
         emit_expr(inner->as.index_expr.target, depth);
-        EMIT(" + ");
+        EMIT_LIT(" + ");
         emit_expr(inner->as.index_expr.index, depth);
     } else {
-        EMIT("&");
+        EMIT_LIT("&");
         emit_expr(inner, depth);
     }
     break;
@@ -1502,8 +1529,8 @@ void emit_expr(Expr *expr, int depth) {
     // (e.g. `*(a + b)` needs them; `*p` and `*p.field` do not).
     Expr *inner = expr->as.deref_expr.expr;
     bool needs_parens = inner && c_prec_of_expr(inner) < 13;
-    EMIT("*");
-    if (needs_parens) { EMIT("("); emit_expr(inner, depth); EMIT(")"); }
+    EMIT_LIT("*");
+    if (needs_parens) { EMIT_LIT("("); emit_expr(inner, depth); EMIT_LIT(")"); }
     else emit_expr(inner, depth);
     break;
   }
@@ -1512,11 +1539,11 @@ void emit_expr(Expr *expr, int depth) {
     BuiltinKind bk = expr->as.builtin_expr.builtin_kind;
     if (bk == BUILTIN_LIKELY || bk == BUILTIN_UNLIKELY) {
         int hint = (bk == BUILTIN_LIKELY) ? 1 : 0;
-        EMIT("__builtin_expect(!!(");
+        EMIT_LIT("__builtin_expect(!!(");
         emit_expr(expr->as.builtin_expr.arg, depth);
         EMIT("), %d)", hint);
     } else if (bk == BUILTIN_ASSUME_ALIGNED) {
-        EMIT("__builtin_assume_aligned(");
+        EMIT_LIT("__builtin_assume_aligned(");
         emit_expr(expr->as.builtin_expr.arg, depth);
         EMIT(", %lld)", (long long)expr->as.builtin_expr.align);
     } else if (bk == BUILTIN_CTZ || bk == BUILTIN_CLZ || bk == BUILTIN_POPCOUNT) {
@@ -1525,7 +1552,7 @@ void emit_expr(Expr *expr, int depth) {
                                              : "__builtin_popcount";
         EMIT("((uint32_t)%s((unsigned)(", fn);
         emit_expr(expr->as.builtin_expr.arg, depth);
-        EMIT(")))");
+        EMIT_LIT(")))");
     } else if (bk == BUILTIN_MOVEMASK) {
         // Vec(N,u8) → an N-bit lane bitmask. 128-bit is x86-64 baseline (SSE2);
         // 256-bit needs AVX2 (`-mavx2`). immintrin.h is emitted with the vector
@@ -1536,7 +1563,7 @@ void emit_expr(Expr *expr, int depth) {
             EMIT(n == 32 ? "((uint32_t)_mm256_movemask_epi8((__m256i)("
                          : "((uint32_t)_mm_movemask_epi8((__m128i)(");
             emit_expr(expr->as.builtin_expr.arg, depth);
-            EMIT(")))");
+            EMIT_LIT(")))");
         } else {
             fprintf(stderr, "[E100] Error Ln %li, Col %li: @movemask requires a "
                     "Vec(16, u8) or Vec(32, u8) argument.\n", (long)expr->line, (long)expr->col);
@@ -1549,16 +1576,16 @@ void emit_expr(Expr *expr, int depth) {
         c_name_for_type(expr->as.builtin_expr.vec_type, vt, sizeof vt);
         EMIT("({ %s __lv; memcpy(&__lv, (const uint8_t*)(", vt);
         emit_expr(expr->as.builtin_expr.arg, depth);   // ptr base
-        EMIT(") + (");
+        EMIT_LIT(") + (");
         emit_expr(expr->as.builtin_expr.arg2, depth);  // byte offset
-        EMIT("), sizeof(__lv)); __lv; })");
+        EMIT_LIT("), sizeof(__lv)); __lv; })");
     } else if (bk == BUILTIN_SPLAT) {
         // Broadcast: a zero vector plus the scalar duplicates it to every lane.
         char vt[128];
         c_name_for_type(expr->as.builtin_expr.vec_type, vt, sizeof vt);
         EMIT("(((%s){0}) + (", vt);
         emit_expr(expr->as.builtin_expr.arg, depth);   // scalar x
-        EMIT("))");
+        EMIT_LIT("))");
     } else if (bk == BUILTIN_STORE) {
         // memcpy from a vector temp (the value may be an rvalue) → vmovdqu at -O2.
         char vt[128];
@@ -1566,11 +1593,11 @@ void emit_expr(Expr *expr, int depth) {
         c_name_for_type(vtp, vt, sizeof vt);
         EMIT("({ %s __sv = (", vt);
         emit_expr(expr->as.builtin_expr.arg3, depth);  // value v
-        EMIT("); memcpy((uint8_t*)(");
+        EMIT_LIT("); memcpy((uint8_t*)(");
         emit_expr(expr->as.builtin_expr.arg, depth);   // ptr base
-        EMIT(") + (");
+        EMIT_LIT(") + (");
         emit_expr(expr->as.builtin_expr.arg2, depth);  // byte offset
-        EMIT("), &__sv, sizeof(__sv)); })");
+        EMIT_LIT("), &__sv, sizeof(__sv)); })");
     } else if (bk == BUILTIN_SHUFFLE) {
         // Per-lane table lookup (pshufb): result[i] = tbl[idx[i] & 15] within each
         // 128-bit lane; a high index bit zeroes the lane.
@@ -1583,7 +1610,7 @@ void emit_expr(Expr *expr, int depth) {
             emit_expr(expr->as.builtin_expr.arg, depth);   // tbl
             EMIT(n == 32 ? "), (__m256i)(" : "), (__m128i)(");
             emit_expr(expr->as.builtin_expr.arg2, depth);  // idx
-            EMIT(")))");
+            EMIT_LIT(")))");
         } else {
             fprintf(stderr, "[E100] Error Ln %li, Col %li: @shuffle requires a "
                     "Vec(16, u8) or Vec(32, u8) table.\n", (long)expr->line, (long)expr->col);
@@ -1594,7 +1621,7 @@ void emit_expr(Expr *expr, int depth) {
   }
 
   default:
-    EMIT("/* unhandled expression type */");
+    EMIT_LIT("/* unhandled expression type */");
     break;
   }
 }
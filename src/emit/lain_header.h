@@ -66,15 +66,15 @@ static void record_vector_type(const char *vecName, const char *c_elem, int byte
 
 // Emit `typedef <elem> <name> __attribute__((vector_size(<bytes>)));` for each.
 // Must be flushed BEFORE slice typedefs (a slice may have a vector element type).
-static void emit_needed_vector_types(FILE *out) {
+static void emit_needed_vector_types(void) {
     if (!emitted_vector_types) return;
     // x86 SIMD intrinsics for @movemask/@shuffle (harmless when merely present;
     // only AVX2 uses like a 256-bit movemask require `-mavx2` at gcc time).
-    fprintf(out, "#include <immintrin.h>\n");
+    EMIT_LIT("#include <immintrin.h>\n");
     for (VectorTypeNode *n = emitted_vector_types; n; n = n->next)
-        fprintf(out, "typedef %s %s __attribute__((vector_size(%d)));\n",
+        EMIT("typedef %s %s __attribute__((vector_size(%d)));\n",
                 n->c_elem, n->vecName, n->bytes);
-    fprintf(out, "\n");
+    EMIT_LIT("\n");
 }
 
 /* ------------------------ small helpers --------------------------------- */
@@ -182,31 +182,29 @@ static void record_slice_type(const char *sliceName,
 
 /* ------------------------ emit typedefs into header --------------------- */
 
-static void emit_needed_slice_types(FILE *out) {
+static void emit_needed_slice_types(void) {
     for (SliceTypeNode *n = emitted_slice_types; n; n = n->next) {
         if (n->has_len && n->sentinel_len == 0 && !n->has_sentinel) {
             // 1) dynamic-length slice: has_len==true, no fixed-length value, no sentinel
-            fprintf(out, "typedef struct {\n");
-            fprintf(out, "  size_t len;\n");
-            fprintf(out, "  %s *data;\n", n->c_type);
-            fprintf(out, "} %s;\n\n", n->sliceName);
+            EMIT_LIT("typedef struct {\n");
+            EMIT_LIT("  size_t len;\n");
+            EMIT("  %s *data;\n", n->c_type);
+            EMIT("} %s;\n\n", n->sliceName);
         }
         else if (n->has_sentinel) {
             // 2) sentinel-terminated slice (HAS length + sentinel guarantee)
-            fprintf(out, "typedef struct {\n");
-            fprintf(out, "  size_t len;\n");
-            fprintf(out, "  %s *data;\n", n->c_type);
-            fprintf(out, "} %s;\n", n->sliceName);
+            EMIT_LIT("typedef struct {\n");
+            EMIT_LIT("  size_t len;\n");
+            EMIT("  %s *data;\n", n->c_type);
+            EMIT("} %s;\n", n->sliceName);
             // sentinel macro: numeric or string
             if (n->sentinel_is_string && n->sentinel_str && n->sentinel_len > 0) {
-                fprintf(out,
-                        "#define %s_SENTINEL \"%.*s\"\n\n",
+                EMIT("#define %s_SENTINEL \"%.*s\"\n\n",
                         n->sliceName,
                         (int)n->sentinel_len,
                         n->sentinel_str);
             } else {
-                fprintf(out,
-                        "#define %s_SENTINEL %d\n\n",
+                EMIT("#define %s_SENTINEL %d\n\n",
                         n->sliceName,
                         n->sentinel_val);
             }
@@ -215,12 +213,11 @@ static void emit_needed_slice_types(FILE *out) {
             // User-defined element types are emitted in out.c (after struct defs),
             // not here in lain.h (where the struct isn't defined yet).
             if (n->user_type_elem) continue;
-            fprintf(out, "typedef struct {\n");
-            fprintf(out, "  %s data[%zu];\n", n->c_type, n->sentinel_len);
-            fprintf(out, "} %s;\n", n->sliceName);
+            EMIT_LIT("typedef struct {\n");
+            EMIT("  %s data[%zu];\n", n->c_type, n->sentinel_len);
+            EMIT("} %s;\n", n->sliceName);
             // length macro
-            fprintf(out,
-                    "#define %s_LENGTH %zu\n\n",
+            EMIT("#define %s_LENGTH %zu\n\n",
                     n->sliceName,
                     n->sentinel_len);
         }
@@ -230,13 +227,13 @@ static void emit_needed_slice_types(FILE *out) {
 // Emit Fixed_<UserType>_N typedefs that were deferred from lain.h because
 // they depend on user-defined struct types. Call this into out.c AFTER all
 // struct definitions are emitted.
-static void emit_user_fixed_typedefs(FILE *out) {
+static void emit_user_fixed_typedefs(void) {
     for (SliceTypeNode *n = emitted_slice_types; n; n = n->next) {
         if (n->has_len && n->sentinel_len > 0 && !n->has_sentinel && n->user_type_elem) {
-            fprintf(out, "typedef struct {\n");
-            fprintf(out, "  %s data[%zu];\n", n->c_type, n->sentinel_len);
-            fprintf(out, "} %s;\n", n->sliceName);
-            fprintf(out, "#define %s_LENGTH %zu\n\n", n->sliceName, n->sentinel_len);
+            EMIT_LIT("typedef struct {\n");
+            EMIT("  %s data[%zu];\n", n->c_type, n->sentinel_len);
+            EMIT("} %s;\n", n->sliceName);
+            EMIT("#define %s_LENGTH %zu\n\n", n->sliceName, n->sentinel_len);
         }
     }
 }
@@ -244,22 +241,25 @@ static void emit_user_fixed_typedefs(FILE *out) {
 /* ------------------------ header generator ---------------------------- */
 
 static void generate_lain_header(const char *filename) {
-    FILE *f = fopen(filename, "w");
-    if (!f) return;
+    EmitBuffer header = {0};
+    EmitBuffer *saved = emit_out;
+    emit_out = &header;
 
     // Header guards and includes
-    fprintf(f, "#ifndef LAIN_H\n#define LAIN_H\n\n");
-    fprintf(f, "#include <stdint.h> /* uint8_t, … */\n");
-    fprintf(f, "#include <stddef.h> /* size_t */\n");
-    fprintf(f, "#include <stdio.h> /* FILE */\n");
-    fprintf(f, "#include <string.h> /* memcmp */\n\n");
+    EMIT_LIT("#ifndef LAIN_H\n#define LAIN_H\n\n");
+    EMIT_LIT("#include <stdint.h> /* uint8_t, … */\n");
+    EMIT_LIT("#include <stddef.h> /* size_t */\n");
+    EMIT_LIT("#include <stdio.h> /* FILE */\n");
+    EMIT_LIT("#include <string.h> /* memcmp */\n\n");
 
     // Emit all recorded vector then slice types (a slice element may be a vector)
-    emit_needed_vector_types(f);
-    emit_needed_slice_types(f);
+    emit_needed_vector_types();
+    emit_needed_slice_types();
 
-    fprintf(f, "#endif /* LAIN_H */\n");
-    fclose(f);
+    EMIT_LIT("#endif /* LAIN_H */\n");
+    emit_out = saved;
+    emit_buffer_write_file(&header, filename);
+    emit_buffer_free(&header);
 }
 
 /* ------------------------ canonical name generation -------------------- */
@@ -8,6 +8,9 @@
 void emit_stmt(Stmt *stmt, int depth);
 // Emit a list of statements (e.g. function body)
 void emit_stmt_list(StmtList *stmts, int depth);
+// Write detection, defined with the parameter attributes in emit/decl.h.
+static Id *emit_lvalue_root_id(Expr *e);
+static bool emit_stmtlist_writes_id(StmtList *body, Id *pname);
 
 void emit_stmt(Stmt *stmt, int depth) {
   if (!stmt)
@@ -50,25 +53,25 @@ void emit_stmt(Stmt *stmt, int depth) {
       } else if (is_vla) {
         char elem_c[256];
         c_name_for_type(ty_var->element_type, elem_c, sizeof elem_c);
-        if (emit_const) EMIT("const ");
+        if (emit_const) EMIT_LIT("const ");
         EMIT("%s %s[", elem_c, c_name_for_id(v));
         bool __sv = emit_suppress_undeclared; emit_suppress_undeclared = true;
         emit_expr(ty_var->size_expr, depth);   // size expr is a type, not a value
         emit_suppress_undeclared = __sv;
-        EMIT("]");
+        EMIT_LIT("]");
       } else if (is_fixed_array) {
         char elem_c[256];
         c_name_for_type(ty_var->element_type, elem_c, sizeof elem_c);
-        if (emit_const) EMIT("const ");
+        if (emit_const) EMIT_LIT("const ");
         EMIT("%s %s[%ld]", elem_c, c_name_for_id(v), (long)ty_var->array_len);
       } else {
-        if (emit_const) EMIT("const ");
+        if (emit_const) EMIT_LIT("const ");
         if (ty_var) {
           char tybuf[256];
           c_name_for_type(ty_var, tybuf, sizeof tybuf);
           EMIT("%s", tybuf);
         } else {
-          EMIT("int32_t");
+          EMIT_LIT("int32_t");
         }
         // 3) emit the variable name
         EMIT(" %s", c_name_for_id(v));
@@ -77,7 +80,7 @@ void emit_stmt(Stmt *stmt, int depth) {
       // 4) optional initializer (NULL = a bare `var x T`, emitted as raw `T x;`;
       //    an array comprehension is lowered to a fill loop after the decl below)
       if (stmt->as.var_stmt.expr && stmt->as.var_stmt.expr->kind != EXPR_ARRAY_COMPREHENSION) {
-        EMIT(" = ");
+        EMIT_LIT(" = ");
   
         // centralized helper: emits compound byte array literal for fixed-like types
         Type *ty = stmt->as.var_stmt.type;
@@ -88,14 +91,14 @@ void emit_stmt(Stmt *stmt, int depth) {
           // Native fixed array (`int32_t arr[3]`) and SIMD vectors (`Vec_4_i32`)
           // both take a native initializer `{ e0, e1, ... }` — NOT the Fixed_T_N
           // struct wrapper (which is never typedef'd for them).
-          EMIT("{ ");
+          EMIT_LIT("{ ");
           bool first_el = true;
           for (ExprList *el = rhs->as.array_literal_expr.elements; el; el = el->next) {
-            if (!first_el) EMIT(", ");
+            if (!first_el) EMIT_LIT(", ");
             first_el = false;
             emit_expr(el->expr, depth);
           }
-          EMIT(" }");
+          EMIT_LIT(" }");
         } else if (!emit_slice_coercion(ty, rhs, depth)) {
           // fallback to general expression emission
           emit_expr(rhs, depth);
@@ -103,7 +106,7 @@ void emit_stmt(Stmt *stmt, int depth) {
       }
   
       // 5) terminate
-      EMIT(";\n");
+      EMIT_LIT(";\n");
 
       // 5b) array comprehension: `T a[N];` above, now the fill loop
       //     `for (i32 idx = lo; idx < hi; idx++) a[idx - lo] = body;`
@@ -124,7 +127,7 @@ void emit_stmt(Stmt *stmt, int depth) {
               EMIT("for (int32_t %s = %ld; %s < %ld; %s++) %s[%s - %ld] = ",
                    idxname, lo, idxname, hi, idxname, aname, idxname, lo);
           emit_expr(comp->as.array_comprehension_expr.body, depth);
-          EMIT(";\n");
+          EMIT_LIT(";\n");
       }
 
       // O-003 [assume-return]: if the initializer is a function call whose callee
@@ -177,12 +180,10 @@ void emit_stmt(Stmt *stmt, int depth) {
 
   case STMT_FOR: {
     // 1) pick unique names
-    emit_indent(depth);
-    static int __for_cnt = 0;
     char __i_var[32], __slice_var[32];
-    snprintf(__i_var, sizeof __i_var, "__i%d", __for_cnt);
-    snprintf(__slice_var, sizeof __slice_var, "__slice%d", __for_cnt);
-    __for_cnt++;
+    snprintf(__i_var, sizeof __i_var, "__i%d", emit_for_count);
+    snprintf(__slice_var, sizeof __slice_var, "__slice%d", emit_for_count);
+    emit_for_count++;
 
     // 2) check if iterable is a range‐slice
     Expr *it = stmt->as.for_stmt.iterable;
@@ -202,11 +203,12 @@ void emit_stmt(Stmt *stmt, int depth) {
 
     // 3) hoist into __sliceN (ONLY if it's a slice iteration)
     if (is_range && ix) {
+      emit_indent(depth);
       const char *sliceName;
       if (r->end) {
         // bounded [a..b] → length‐based slice
         Type *elem_ty = it->type->element_type;
-        Type *len_slice = type_array(sema_arena, elem_ty, -1);
+        Type *len_slice = type_array(sema_ctx->arena, elem_ty, -1);
         sliceName = emit_slice_type_definition(len_slice);
         EMIT("%s %s = ", sliceName, __slice_var);
         emit_expr(it, 0); // emits (Slice_u8){ .data, .len }
@@ -218,26 +220,33 @@ void emit_stmt(Stmt *stmt, int depth) {
         EMIT("%s %s = (%s){ .data = ", sliceName, __slice_var, sliceName);
         emit_expr(ix->target, 0);
         if (orig_slice_ty->kind == TYPE_SLICE) {
-          EMIT(".data");
+          EMIT_LIT(".data");
         }
-        EMIT(" + ");
+        EMIT_LIT(" + ");
         emit_expr(r->start, 0);
-        EMIT(" }");
+        EMIT_LIT(" }");
       }
-      EMIT(";\n");
+      EMIT_LIT(";\n");
     }
 
     // 4) emit for‐loop header
     emit_indent(depth);
 
+    // The value's C type from sema: the counter type of a range (the type of
+    // its bounds, i32 for literals), otherwise the element type. A `usize`
+    // bound counted in `int` cost a sign extension per index, and elements
+    // bound as `int` truncated wide and float data outright.
+    char v_ty[256];
+    c_name_for_type(stmt->as.for_stmt.value_type, v_ty, sizeof v_ty);
+
     if (is_range && !ix) {
-        // Direct range loop: for (int i = start; i < end; ++i)
-        EMIT("for (int %s = ", __i_var);
+        // Direct range loop: for (T i = start; i < end; ++i)
+        EMIT("for (%s %s = ", v_ty, __i_var);
         emit_expr(r->start, 0);
         EMIT("; %s < ", __i_var);
         emit_expr(r->end, 0);
         if (r->inclusive) {
-             EMIT(" + 1");
+             EMIT_LIT(" + 1");
         }
         EMIT("; ++%s) {\n", __i_var);
     } else {
@@ -277,14 +286,32 @@ void emit_stmt(Stmt *stmt, int depth) {
     }
 
     // 6) bind value var
+    Id *vname = stmt->as.for_stmt.value_name;
+    int saved_bd = emit_binding_depth;
     emit_indent(depth + 1);
     if (is_range && !ix) {
-        // For range loop, value is the index itself (cast to int if needed)
-        EMIT("int %.*s = (int)%s;\n", (int)stmt->as.for_stmt.value_name->length,
-             stmt->as.for_stmt.value_name->name, __i_var);
+        // For range loop, value is the counter itself
+        EMIT("%s %.*s = %s;\n", v_ty, (int)vname->length, vname->name, __i_var);
     } else {
-        EMIT("int %.*s = %s.data[%s];\n", (int)stmt->as.for_stmt.value_name->length,
-             stmt->as.for_stmt.value_name->name, __slice_var, __i_var);
+        // An aggregate too large for registers is read in place through a
+        // const pointer rather than copied per iteration — unless the body
+        // writes to the iterated array, which a copy would not observe.
+        Type *vt = stmt->as.for_stmt.value_type;
+        Id *root = ix ? emit_lvalue_root_id(ix->target) : NULL;
+        isize vsize = emit_type_size_hint(vt, 0);
+        bool by_ref = vt && vt->kind == TYPE_SIMPLE && !is_primitive_type(vt) &&
+                      vsize > 2 * (isize)target.pointer_size &&
+                      root && ix->target->kind == EXPR_IDENTIFIER && !ix->target->is_global &&
+                      ix->target->type && ix->target->type->mode != MODE_MUTABLE &&
+                      !emit_stmtlist_writes_id(stmt->as.for_stmt.body, root);
+        if (by_ref) {
+            EMIT("const %s *%.*s = &%s.data[%s];\n", v_ty, (int)vname->length, vname->name,
+                 __slice_var, __i_var);
+            emit_push_ref_binding(vname->name, (int)vname->length);
+        } else {
+            EMIT("%s %.*s = %s.data[%s];\n", v_ty, (int)vname->length, vname->name,
+                 __slice_var, __i_var);
+        }
     }
 
     // 7) loop body
@@ -293,10 +320,11 @@ void emit_stmt(Stmt *stmt, int depth) {
     }
     emit_stmt_list(stmt->as.for_stmt.body, depth + 1);
     if (loop_depth > 0) loop_depth--;
+    emit_binding_depth = saved_bd;
 
     // 8) close
     emit_indent(depth);
-    EMIT("}\n");
+    EMIT_LIT("}\n");
     break;
   }
 
@@ -308,16 +336,16 @@ void emit_stmt(Stmt *stmt, int depth) {
 
     // 2) emit "if (<cond>) {"
     emit_indent(depth);
-    EMIT("if (");
+    EMIT_LIT("if (");
     emit_expr(cond, depth);
-    EMIT(") {\n");
+    EMIT_LIT(") {\n");
 
     // 3) emit the `then` block
     emit_stmt_list(then_pl, depth + 1);
 
     // 4) close the `then` block
     emit_indent(depth);
-    EMIT("}");
+    EMIT_LIT("}");
 
     // 5) if there's an `else` branch, decide between "else if" vs. "else"
     if (else_pl) {
@@ -325,21 +353,21 @@ void emit_stmt(Stmt *stmt, int depth) {
       // an `if`
       if (else_pl->next == NULL && else_pl->stmt->kind == STMT_IF) {
         // "else if (…)" : simply emit a space and recursively emit that STMT_IF
-        EMIT(" else ");
+        EMIT_LIT(" else ");
         // NOTE: we call emit_stmt on the nested STMT_IF with the same `depth`
         //       so that it emits "if (…) { … }" without adding a newline
         //       before.
         emit_stmt(else_pl->stmt, depth);
       } else {
         // plain "else"
-        EMIT(" else {\n");
+        EMIT_LIT(" else {\n");
         emit_stmt_list(else_pl, depth + 1);
         emit_indent(depth);
-        EMIT("}\n");
+        EMIT_LIT("}\n");
       }
     } else {
       // no else: just emit newline
-      EMIT("\n");
+      EMIT_LIT("\n");
     }
     break;
   }
@@ -352,7 +380,7 @@ void emit_stmt(Stmt *stmt, int depth) {
         }
     }
     emit_indent(depth);
-    EMIT("continue;\n");
+    EMIT_LIT("continue;\n");
     break;
 
   case STMT_BREAK:
@@ -363,7 +391,7 @@ void emit_stmt(Stmt *stmt, int depth) {
         }
     }
     emit_indent(depth);
-    EMIT("break;\n");
+    EMIT_LIT("break;\n");
     break;
 
   case STMT_WHILE: {
@@ -379,9 +407,9 @@ void emit_stmt(Stmt *stmt, int depth) {
     //
     // 1) Emit standard "while (<cond>) {"
     emit_indent(depth);
-    EMIT("while (");
+    EMIT_LIT("while (");
     emit_expr(stmt->as.while_stmt.cond, depth);
-    EMIT(") {\n");
+    EMIT_LIT(") {\n");
 
     // 2) emit body
     if (loop_depth < MAX_LOOPS) {
@@ -392,15 +420,14 @@ void emit_stmt(Stmt *stmt, int depth) {
 
     // 3) close
     emit_indent(depth);
-    EMIT("}\n");
+    EMIT_LIT("}\n");
     break;
   }
 
   case STMT_MATCH: {
     // 1) figure out the scrutinee’s C type (handles simple, array, slice,…)
     Expr *scrut = stmt->as.match_stmt.value;
-    sema_resolve_expr(scrut);
-    sema_infer_expr(scrut);
+    if (emit_verify_sema) emit_verify_annotated(scrut);
     char c_ty[256];
     c_name_for_type(scrut->type, c_ty, sizeof c_ty);
 
@@ -414,33 +441,10 @@ void emit_stmt(Stmt *stmt, int depth) {
         strncpy(adt_cname, tname, sizeof(adt_cname));
         adt_cname[sizeof(adt_cname)-1] = '\0';
         
-        // Find the Decl by iterating sema_decls and checking for suffix match
-        // tname is likely mangled (tests_adt_Shape). Decl name is raw (Shape).
-        size_t tlen = strlen(tname);
-        
-        for (DeclList *dl = sema_decls; dl; dl = dl->next) {
-            if (!dl->decl || dl->decl->kind != DECL_ENUM) continue;
-            Id *enum_name = dl->decl->as.enum_decl.type_name;
-            if (!enum_name) continue;
-            
-            // 1. Exact match
-            if ((size_t)enum_name->length == tlen &&
-                strncmp(enum_name->name, tname, tlen) == 0) {
-                is_adt = true;
-                adt_decl = dl->decl;
-                break;
-            }
-
-            // 2. Suffix match
-            if (tlen > (size_t)enum_name->length + 1) {
-                const char *suffix = tname + (tlen - enum_name->length);
-                if (*(suffix-1) == '_' && strncmp(suffix, enum_name->name, enum_name->length) == 0) {
-                    is_adt = true;
-                    adt_decl = dl->decl;
-                    break;
-                }
-            }
-        }
+        // Find the enum Decl by exact or suffix match: tname is likely
+        // mangled (tests_adt_Shape), the Decl name is raw (Shape).
+        adt_decl = decl_index_enum_exact_or_suffix(tname, (isize)strlen(tname));
+        is_adt = adt_decl != NULL;
     }
 
     // D-Niche: if the scrutinee's enum is niche-optimized, discriminate on the
@@ -451,13 +455,27 @@ void emit_stmt(Stmt *stmt, int depth) {
 
     // 2) bind to __matchN with the real C type
     emit_indent(depth);
-    static int __match_cnt = 0;
-    int __match_id = __match_cnt++;
+    int __match_id = emit_match_count++;
     EMIT("%s __match%d = ", c_ty, __match_id);
+    // An aggregate parameter (enum, struct) arrives as a pointer; match on the
+    // value. Primitive `var` parameters are already dereferenced by emit_expr.
+    Type *scrut_pt = scrut->kind == EXPR_IDENTIFIER && scrut->decl &&
+                     scrut->decl->kind == DECL_VARIABLE && scrut->decl->as.variable_decl.is_parameter
+                   ? scrut->decl->as.variable_decl.type : NULL;
+    if (scrut_pt && scrut_pt->kind == TYPE_SIMPLE && !is_primitive_type(scrut_pt))
+        EMIT_LIT("*");
     emit_expr(scrut, depth);
-    EMIT(";\n");
+    EMIT_LIT(";\n");
 
-    // 3) each case
+    // 3) a C switch when every pattern is a constant label (emit/switch.h),
+    //    otherwise an if / else-if chain
+    CaseSwitch sw;
+    case_switch_init(&sw, scrut->type, is_adt ? &adt_decl->as.enum_decl : NULL,
+                     adt_cname, &match_niche, match_use_niche);
+    bool use_switch = case_switch_plan_stmt(&sw, stmt->as.match_stmt.cases);
+    if (use_switch) case_switch_open(&sw, __match_id, depth);
+
+    // 4) each case
     bool first_clause = true;
     bool had_catchall = false;   // true if a wildcard _ case was emitted
     for (StmtMatchCase *c = stmt->as.match_stmt.cases; c; /**/) {
@@ -466,9 +484,25 @@ void emit_stmt(Stmt *stmt, int depth) {
       while (group && !group->body && group->next)
         group = group->next;
 
+      if (use_switch) {
+        int labels = 0;
+        case_switch_arm(&sw);
+        for (StmtMatchCase *p = c;; p = p->next) {
+          if (!p->patterns) labels += case_switch_labels(&sw, NULL, depth);
+          for (ExprList *pat = p->patterns; pat; pat = pat->next)
+            labels += case_switch_labels(&sw, pat->expr, depth);
+          if (p == group) break;
+        }
+        if (labels == 0) {   // no value of the scrutinee type reaches this arm
+          c = group->next;
+          continue;
+        }
+      }
       emit_indent(depth);
       // start if / else if / else
-      if (group->patterns) {
+      if (use_switch) {
+        // the labels above select this arm
+      } else if (group->patterns) {
         EMIT(first_clause ? "if (" : "else if (");
         
         bool first_cond = true;
@@ -477,7 +511,7 @@ void emit_stmt(Stmt *stmt, int depth) {
             // ADT Pattern Matching
             for (StmtMatchCase *p = c;; p = p->next) {
                 for (ExprList *pat = p->patterns; pat; pat = pat->next) {
-                    if (!first_cond) EMIT(" || ");
+                    if (!first_cond) EMIT_LIT(" || ");
                     first_cond = false;
 
                     Id *variant_id = NULL;
@@ -510,7 +544,7 @@ void emit_stmt(Stmt *stmt, int depth) {
                                                 match_niche.secondary_variant != NULL;
                                 if (is_multi && matched_v == match_niche.primary_variant) {
                                     // Primary: matches when not any secondary sentinel.
-                                    EMIT("1");
+                                    EMIT_LIT("1");
                                     for (size_t si = 0; si < match_niche.secondary_sentinels_count; si++) {
                                         long long sv = match_niche.secondary_sentinels[si];
                                         if (match_niche.pool.kind == POOL_POINTER)
@@ -563,7 +597,7 @@ void emit_stmt(Stmt *stmt, int depth) {
                                     }
                                 } else if (matched_v->fields) {
                                     // Single payload variant — value is none of the empties.
-                                    EMIT("1");
+                                    EMIT_LIT("1");
                                     for (Variant *ev = adt_decl->as.enum_decl.variants; ev; ev = ev->next) {
                                         if (ev->fields) continue;
                                         long long sv = niche_sentinel_for_variant(&adt_decl->as.enum_decl, ev, &match_niche);
@@ -584,10 +618,10 @@ void emit_stmt(Stmt *stmt, int depth) {
                                 EMIT("__match%d.tag == %s_Tag_%.*s", __match_id, adt_cname, (int)matched_v->name->length, matched_v->name->name);
                             }
                         } else {
-                            EMIT("0 /* unknown variant */");
+                            EMIT_LIT("0 /* unknown variant */");
                         }
                     } else {
-                        EMIT("0 /* invalid pattern */");
+                        EMIT_LIT("0 /* invalid pattern */");
                     }
                 }
                 if (p == group) break;
@@ -596,7 +630,7 @@ void emit_stmt(Stmt *stmt, int depth) {
             // Existing logic for non-ADT
             for (StmtMatchCase *p = c;; p = p->next) {
               for (ExprList *pat = p->patterns; pat; pat = pat->next) {
-                  if (!first_cond) EMIT(" || ");
+                  if (!first_cond) EMIT_LIT(" || ");
                   first_cond = false;
 
                   switch (pat->expr->kind) {
@@ -618,14 +652,18 @@ void emit_stmt(Stmt *stmt, int depth) {
                     break;
                   }
                   case EXPR_RANGE: {
-                    // Emit the numeric byte value (not a raw '%c') so control-char
-                    // bounds don't produce broken C. `..` is exclusive of the
-                    // upper bound, `..=` inclusive (spec §8.16 / §15.3).
-                    int lo = (unsigned char)pat->expr->as.range_expr.start->as.char_expr.value;
-                    int hi = (unsigned char)pat->expr->as.range_expr.end->as.char_expr.value;
-                    const char *up = pat->expr->as.range_expr.inclusive ? "<=" : "<";
-                    EMIT("(__match%d >= %d && __match%d %s %d)", __match_id, lo,
-                         __match_id, up, hi);
+                    // `..` is exclusive of the upper bound, `..=` inclusive (spec §8.16 /
+                    // §15.3). Constant bounds are printed as numbers, so control-char and
+                    // integer bounds alike give valid C.
+                    ExprRange *rg = &pat->expr->as.range_expr;
+                    long long lo, hi;
+                    EMIT("(__match%d >= ", __match_id);
+                    if (case_pattern_bound(rg->start, &lo)) EMIT("%lld", lo);
+                    else emit_expr(rg->start, depth);
+                    EMIT(" && __match%d %s ", __match_id, rg->inclusive ? "<=" : "<");
+                    if (case_pattern_bound(rg->end, &hi)) EMIT("%lld", hi);
+                    else emit_expr(rg->end, depth);
+                    EMIT_LIT(")");
                     break;
                   }
                   default: {
@@ -639,15 +677,15 @@ void emit_stmt(Stmt *stmt, int depth) {
                 break;
             }
         }
-        EMIT(") ");
+        EMIT_LIT(") ");
       } else {
         // catch‐all / wildcard
         had_catchall = true;
         EMIT(first_clause ? "if (1) " : "else ");
       }
 
-      // 4) body
-      EMIT("{\n");
+      // 5) body
+      EMIT_LIT("{\n");
       int __saved_bd = emit_binding_depth;  // restore after this arm's body
 
       // Emit bindings for ADT patterns
@@ -738,7 +776,7 @@ void emit_stmt(Stmt *stmt, int depth) {
       }
       emit_binding_depth = __saved_bd;   // bindings leave scope with the arm
       emit_indent(depth);
-      EMIT("}\n");
+      EMIT(use_switch ? "} break;\n" : "}\n");
 
       first_clause = false;
       c = group->next;
@@ -747,10 +785,13 @@ void emit_stmt(Stmt *stmt, int depth) {
     // type checker. Emit `else { __builtin_unreachable(); }` so GCC sees
     // that no other tag value exists — enables tighter jump tables and
     // eliminates dead code on the "impossible" path.
-    if (is_adt && !first_clause && !had_catchall) {
+    if (use_switch) {
+        case_switch_close(&sw, depth);
+    } else if (is_adt && !first_clause && !had_catchall) {
         emit_indent(depth);
-        EMIT("else { __builtin_unreachable(); }\n");
+        EMIT_LIT("else { __builtin_unreachable(); }\n");
     }
+    case_switch_free(&sw);
     break;
   }
 
@@ -760,7 +801,7 @@ void emit_stmt(Stmt *stmt, int depth) {
         emit_stmt(emit_defer_stack[i], depth);
     }
     emit_indent(depth);
-    EMIT("return ");
+    EMIT_LIT("return ");
     if (stmt->as.return_stmt.value) {
         Expr *rv = stmt->as.return_stmt.value;
         // Returning a dynamic-array parameter as a slice: the parameter is
@@ -782,25 +823,25 @@ void emit_stmt(Stmt *stmt, int depth) {
             emit_expr(rv, depth);
         }
     }
-    EMIT(";\n");
+    EMIT_LIT(";\n");
     break;
 
   case STMT_UNSAFE: {
     emit_indent(depth);
-    EMIT("/* unsafe block */\n");
+    EMIT_LIT("/* unsafe block */\n");
     emit_indent(depth);
-    EMIT("{\n");
+    EMIT_LIT("{\n");
     
     // Set unsafe context so lazy-inference in emit_expr knows we are safe
-    bool old_unsafe = sema_in_unsafe_block;
-    sema_in_unsafe_block = true;
+    bool old_unsafe = sema_ctx->in_unsafe_block;
+    sema_ctx->in_unsafe_block = true;
     
     emit_stmt_list(stmt->as.unsafe_stmt.body, depth + 1);
     
-    sema_in_unsafe_block = old_unsafe;
+    sema_ctx->in_unsafe_block = old_unsafe;
     
     emit_indent(depth);
-    EMIT("}\n");
+    EMIT_LIT("}\n");
     break;
   }
   
@@ -834,7 +875,7 @@ void emit_stmt(Stmt *stmt, int depth) {
         }
   
         // 5) newline
-        EMIT(";\n");
+        EMIT_LIT(";\n");
       } else {
         // Note: packed struct setter (Sprint 19.5) was reverted.
         // Mutating a packed field requires explicit reconstruction:
@@ -843,9 +884,9 @@ void emit_stmt(Stmt *stmt, int depth) {
         // Normal assignment with indent
         emit_indent(depth);
         emit_expr(lhs, depth);
-        EMIT(" = ");
+        EMIT_LIT(" = ");
         emit_expr(rhs, depth);
-        EMIT(";\n");
+        EMIT_LIT(";\n");
       }
       break;
     }
@@ -855,7 +896,7 @@ void emit_stmt(Stmt *stmt, int depth) {
     // Emit expression statement (e.g. a function call)
     emit_indent(depth);
     emit_expr(stmt->as.expr_stmt.expr, depth);
-    EMIT(";\n");
+    EMIT_LIT(";\n");
     break;
 
   case STMT_COMPTIME_IF: {
@@ -879,7 +920,7 @@ void emit_stmt(Stmt *stmt, int depth) {
 
   default:
     emit_indent(depth);
-    EMIT("/* unhandled statement type */\n");
+    EMIT_LIT("/* unhandled statement type */\n");
     break;
   }
 }
@@ -0,0 +1,536 @@
+#ifndef EMIT_SWITCH_H
+#define EMIT_SWITCH_H
+
+#include "../emit.h"
+#include "core.h"
+
+/*
+   `case` lowered to a C `switch`.
+
+   The statement form (emit/stmt.h) and the expression form (emit/expr.h) bind
+   the scrutinee to __matchN and then test it arm by arm. When every pattern is
+   a compile-time constant of the discriminant, the arms become case labels of
+   one `switch` instead, so gcc can build a jump table (or a balanced compare
+   tree) rather than walking an if / else-if chain:
+
+     CASE_SWITCH_TAG    tagged enum         switch (__matchN.tag)
+                                            case <Enum>_Tag_<Variant>:
+     CASE_SWITCH_NICHE  niche-encoded enum  switch (__matchN), or on
+                                            (uintptr_t)__matchN for a pointer
+                                            pool; empty variants are their
+                                            sentinels, the payload variant is
+                                            `default:`
+     CASE_SWITCH_INT    integer scrutinee   integer / char literal labels
+
+   Fall-through groups (`A, B: body` and bodiless arms) become consecutive
+   labels. An exhaustive enum match without a wildcard gets
+   `default: __builtin_unreachable();`, so no range check guards the table.
+
+   Range patterns (`'a'..='z'`, `1..10`) are intervals, clipped to the value
+   range of the scrutinee type; a pattern left empty is impossible and an arm
+   with no label left is not emitted at all. The lowering then follows the
+   number of intervals and how densely they fill their span:
+
+     up to CASE_CHAIN_MAX    the if-chain: a couple of bound compares beat
+                             any dispatch
+     span <= 256             a `static const uint8_t` table from value to arm
+                             number, and a switch on the arm number; a u8
+                             scrutinee indexes it directly, anything else
+                             behind one unsigned bounds check
+     wider                   GNU case ranges (`case 48 ... 57:`), which gcc
+                             lowers to a balanced binary decision tree
+
+   When the labels cover every value of the type the `else` arm is dead and is
+   replaced by `default: __builtin_unreachable();`.
+
+   Anything else keeps the if-chain: string and non-constant patterns,
+   duplicate or overlapping labels (the table resolves overlaps first-wins like
+   the chain; plain labels cannot), two arms that would both need `default:`,
+   and a statement arm containing a `break` for an enclosing loop (inside a
+   switch it would leave the switch instead).
+*/
+
+typedef enum {
+    CASE_SWITCH_NONE,
+    CASE_SWITCH_TAG,
+    CASE_SWITCH_NICHE,
+    CASE_SWITCH_INT,
+} CaseSwitchKind;
+
+#define CASE_LABELS_DEFAULT (-2)
+#define CASE_LABELS_NONE    (-1)
+#define CASE_LABELS_MAX     256
+
+#define CASE_CHAIN_MAX      3      // range matches with this few intervals stay compares
+#define CASE_TABLE_MAX      256    // widest span given a lookup table
+
+#define CASE_ARM_DEFAULT    0x01   // the arm holds the wildcard
+#define CASE_ARM_LIVE       0x02   // some table entry selects the arm
+
+typedef struct {
+    long long lo, hi;              // inclusive
+    int       arm;
+} CaseInterval;
+
+typedef struct {
+    CaseSwitchKind kind;
+    DeclEnum      *adt;              // TAG / NICHE
+    const char    *adt_cname;        // C name of the enum (Tag constants, sentinel casts)
+    NicheLayout   *niche;            // NICHE
+    bool           has_default;      // some arm takes `default:`
+    bool           default_dead;     // the labels cover the whole type
+    bool           has_range;        // some pattern is a range
+    bool           has_domain;       // INT: dom_lo..dom_hi is the type's value range
+    long long      dom_lo, dom_hi;
+    CaseInterval  *seen;             // labels so far, with their arm
+    int            n_seen;
+    int            cap_seen;
+    unsigned char *arms;             // CASE_ARM_* per arm, 1-based
+    int            n_arms;
+    int            cur_arm;          // emission: arm being labelled
+    bool           cur_labelled;
+    bool           emitted_default;
+    unsigned char *table;            // arm number per value, 0 = default
+    long long      table_base;
+    int            table_len;
+    bool           table_direct;     // table spans the whole type: no bounds check
+} CaseSwitch;
+
+static void case_switch_init(CaseSwitch *sw, Type *scrut_type, DeclEnum *adt,
+                             const char *adt_cname, NicheLayout *niche, bool use_niche) {
+    memset(sw, 0, sizeof *sw);
+    sw->adt = adt;
+    sw->adt_cname = adt_cname;
+    sw->niche = niche;
+    if (adt) {
+        bool is_multi = niche->primary_variant && niche->secondary_variant;
+        if (!use_niche) sw->kind = CASE_SWITCH_TAG;
+        else if (!is_multi || niche->empty_variant_count == 0) sw->kind = CASE_SWITCH_NICHE;
+        return;
+    }
+    Type *t = sema_unwrap_type(scrut_type);
+    if (!is_integer_type(t)) return;
+    sw->kind = CASE_SWITCH_INT;
+    int bits; bool sgn;
+    if (parse_iN_uN(t, &bits, &sgn) && bits < 64) {
+        sw->has_domain = true;
+        sw->dom_lo = sgn ? -(1LL << (bits - 1)) : 0;
+        sw->dom_hi = sgn ? (1LL << (bits - 1)) - 1 : (long long)((1ULL << bits) - 1);
+    }
+}
+
+static void case_switch_free(CaseSwitch *sw) {
+    free(sw->seen);
+    free(sw->arms);
+    free(sw->table);
+    sw->seen = NULL;
+    sw->arms = sw->table = NULL;
+    sw->n_seen = sw->cap_seen = sw->n_arms = 0;
+}
+
+static void *case_switch_grow(void *p, size_t size) {
+    p = realloc(p, size);
+    if (!p) {
+        fprintf(stderr, "Error: out of memory lowering a case to a switch\n");
+        exit(1);
+    }
+    return p;
+}
+
+// The enum variant an ADT pattern names (`V`, `V(..)`, `E.V(..)`), or NULL.
+static Variant *case_pattern_variant(DeclEnum *adt, Expr *pat) {
+    if (pat->kind == EXPR_IDENTIFIER) {
+        if (!pat->is_global || !pat->decl || pat->decl->kind != DECL_ENUM) return NULL;
+    } else if (pat->kind == EXPR_CALL) {
+        Expr *callee = pat->as.call_expr.callee;
+        if (!callee || (callee->kind != EXPR_IDENTIFIER && callee->kind != EXPR_MEMBER)) return NULL;
+    } else {
+        return NULL;
+    }
+    for (Variant *v = adt->variants; v; v = v->next)
+        if (pattern_matches_variant(pat, v->name)) return v;
+    return NULL;
+}
+
+static int case_variant_index(DeclEnum *adt, Variant *target) {
+    int i = 0;
+    for (Variant *v = adt->variants; v; v = v->next, i++)
+        if (v == target) return i;
+    return -1;
+}
+
+// Secondary niche variant `Err(NotFound)`: index of the named sub-variant, or
+// -1 when the argument is a binding (`Err(e)`) and every sub-variant matches.
+static int case_niche_subvariant(NicheLayout *niche, Expr *pat) {
+    ExprList *arg = pat->kind == EXPR_CALL ? pat->as.call_expr.args : NULL;
+    if (!arg || !arg->expr || !niche->secondary_subenum_decl) return -1;
+    Id *sub_id = arg->expr->kind == EXPR_IDENTIFIER ? arg->expr->as.identifier_expr.id
+               : arg->expr->kind == EXPR_MEMBER     ? arg->expr->as.member_expr.member
+               : NULL;
+    if (!sub_id) return -1;
+    int idx = 0;
+    for (Variant *sv = niche->secondary_subenum_decl->as.enum_decl.variants; sv; sv = sv->next, idx++) {
+        if (sv->name->length == sub_id->length &&
+            memcmp(sv->name->name, sub_id->name, (size_t)sub_id->length) == 0) return idx;
+        if (sub_id->length > sv->name->length + 1) {
+            const char *sfx = sub_id->name + (sub_id->length - sv->name->length);
+            if (*(sfx - 1) == '_' && memcmp(sfx, sv->name->name, (size_t)sv->name->length) == 0) return idx;
+        }
+    }
+    return -1;
+}
+
+// The value of an integer or char literal, possibly negated.
+static bool case_pattern_bound(Expr *e, long long *out) {
+    if (!e) return false;
+    if (e->kind == EXPR_LITERAL) {
+        *out = (long long)e->as.literal_expr.value;
+        return true;
+    }
+    if (e->kind == EXPR_CHAR) {
+        *out = (unsigned char)e->as.char_expr.value;
+        return true;
+    }
+    if (e->kind == EXPR_UNARY && e->as.unary_expr.op == TOKEN_MINUS &&
+        e->as.unary_expr.right && e->as.unary_expr.right->kind == EXPR_LITERAL) {
+        *out = -(long long)e->as.unary_expr.right->as.literal_expr.value;
+        return true;
+    }
+    return false;
+}
+
+// The labels one pattern stands for: writes up to `cap` intervals and returns
+// their count (0 for a pattern the scrutinee type cannot match),
+// CASE_LABELS_DEFAULT for an arm that takes everything not labelled, or
+// CASE_LABELS_NONE if the pattern has no constant label.
+static int case_pattern_labels(CaseSwitch *sw, Expr *pat, CaseInterval *vals, int cap) {
+    switch (sw->kind) {
+    case CASE_SWITCH_TAG: {
+        Variant *v = case_pattern_variant(sw->adt, pat);
+        if (!v || cap < 1) return CASE_LABELS_NONE;
+        vals[0].lo = vals[0].hi = case_variant_index(sw->adt, v);
+        return 1;
+    }
+    case CASE_SWITCH_NICHE: {
+        NicheLayout *nl = sw->niche;
+        Variant *v = case_pattern_variant(sw->adt, pat);
+        if (!v) return CASE_LABELS_NONE;
+        bool is_multi = nl->primary_variant && nl->secondary_variant;
+        if (is_multi && v == nl->secondary_variant) {
+            long long stride = nl->pool.ptr_stride > 0 ? nl->pool.ptr_stride : 1;
+            int sub = case_niche_subvariant(nl, pat);
+            if (sub >= 0) {
+                if (cap < 1) return CASE_LABELS_NONE;
+                vals[0].lo = vals[0].hi = (long long)sub * stride;
+                return 1;
+            }
+            if ((int)nl->secondary_sentinels_count > cap) return CASE_LABELS_NONE;
+            for (size_t i = 0; i < nl->secondary_sentinels_count; i++)
+                vals[i].lo = vals[i].hi = (long long)i * stride;
+            return (int)nl->secondary_sentinels_count;
+        }
+        if (v->fields) return CASE_LABELS_DEFAULT;    // the payload: every non-sentinel value
+        if (cap < 1) return CASE_LABELS_NONE;
+        vals[0].lo = vals[0].hi = niche_sentinel_for_variant(sw->adt, v, nl);
+        return 1;
+    }
+    case CASE_SWITCH_INT: {
+        long long lo, hi;
+        if (pat->kind == EXPR_RANGE) {
+            if (!case_pattern_bound(pat->as.range_expr.start, &lo) ||
+                !case_pattern_bound(pat->as.range_expr.end, &hi)) return CASE_LABELS_NONE;
+            if (!pat->as.range_expr.inclusive) {
+                if (hi == LLONG_MIN) return 0;
+                hi--;
+            }
+        } else if (case_pattern_bound(pat, &lo)) {
+            hi = lo;
+        } else {
+            return CASE_LABELS_NONE;
+        }
+        if (sw->has_domain) {
+            if (lo < sw->dom_lo) lo = sw->dom_lo;
+            if (hi > sw->dom_hi) hi = sw->dom_hi;
+        }
+        if (lo > hi) return 0;               // matches nothing the type can hold
+        if (cap < 1) return CASE_LABELS_NONE;
+        vals[0].lo = lo;
+        vals[0].hi = hi;
+        return 1;
+    }
+    default:
+        return CASE_LABELS_NONE;
+    }
+}
+
+// Record the labels of one pattern (NULL = wildcard) for arm `arm`; false if
+// the match cannot be a switch.
+static bool case_switch_add(CaseSwitch *sw, Expr *pat, int arm) {
+    CaseInterval vals[CASE_LABELS_MAX];
+    int n = pat ? case_pattern_labels(sw, pat, vals, CASE_LABELS_MAX) : CASE_LABELS_DEFAULT;
+    if (n == CASE_LABELS_NONE) return false;
+    if (n == CASE_LABELS_DEFAULT) {
+        if (sw->has_default) return false;
+        sw->has_default = true;
+        sw->arms[arm] |= CASE_ARM_DEFAULT;
+        return true;
+    }
+    if (pat->kind == EXPR_RANGE) sw->has_range = true;
+    for (int i = 0; i < n; i++) {
+        if (sw->n_seen == sw->cap_seen) {
+            sw->cap_seen = sw->cap_seen ? sw->cap_seen * 2 : 64;
+            sw->seen = case_switch_grow(sw->seen, (size_t)sw->cap_seen * sizeof *sw->seen);
+        }
+        vals[i].arm = arm;
+        sw->seen[sw->n_seen++] = vals[i];
+    }
+    return true;
+}
+
+static int case_switch_new_arm(CaseSwitch *sw) {
+    sw->n_arms++;
+    sw->arms = case_switch_grow(sw->arms, (size_t)sw->n_arms + 1);
+    sw->arms[sw->n_arms] = 0;
+    return sw->n_arms;
+}
+
+static int case_interval_cmp(const void *a, const void *b) {
+    long long x = ((const CaseInterval *)a)->lo, y = ((const CaseInterval *)b)->lo;
+    return x < y ? -1 : x > y;
+}
+
+// Fill the value -> arm table. Earlier arms win where labels overlap, as in
+// the if-chain; values of the wildcard's arm stay 0 and reach `default:`.
+static void case_switch_build_table(CaseSwitch *sw, long long base, long long len) {
+    sw->table_base = base;
+    sw->table_len = (int)len;
+    sw->table = case_switch_grow(NULL, (size_t)len);
+    unsigned char *set = case_switch_grow(NULL, (size_t)len);
+    memset(sw->table, 0, (size_t)len);
+    memset(set, 0, (size_t)len);
+    for (int i = 0; i < sw->n_seen; i++) {
+        CaseInterval *iv = &sw->seen[i];
+        int arm = (sw->arms[iv->arm] & CASE_ARM_DEFAULT) ? 0 : iv->arm;
+        for (long long v = iv->lo; v <= iv->hi; v++) {
+            if (set[v - base]) continue;
+            set[v - base] = 1;
+            sw->table[v - base] = (unsigned char)arm;
+            sw->arms[arm] |= CASE_ARM_LIVE;
+        }
+    }
+    free(set);
+    bool any_default = false;
+    for (int i = 0; i < sw->table_len; i++)
+        if (sw->table[i] == 0) { any_default = true; break; }
+    sw->default_dead = sw->table_direct && !any_default;
+}
+
+// Pick the lowering once every pattern is recorded; false keeps the if-chain.
+static bool case_switch_finish(CaseSwitch *sw) {
+    if (sw->n_seen < 2) return false;
+    if (sw->has_range && sw->n_seen <= CASE_CHAIN_MAX) return false;
+
+    CaseInterval *sorted = case_switch_grow(NULL, (size_t)sw->n_seen * sizeof *sorted);
+    memcpy(sorted, sw->seen, (size_t)sw->n_seen * sizeof *sorted);
+    qsort(sorted, (size_t)sw->n_seen, sizeof *sorted, case_interval_cmp);
+    bool overlap = false;
+    bool covers = sw->has_domain && sorted[0].lo == sw->dom_lo;
+    long long reach = sorted[0].hi;
+    for (int i = 1; i < sw->n_seen; i++) {
+        if (sorted[i].lo <= reach) overlap = true;
+        else if (sorted[i].lo != reach + 1) covers = false;
+        if (sorted[i].hi > reach) reach = sorted[i].hi;
+    }
+    covers = covers && reach == sw->dom_hi;
+    long long lo = sorted[0].lo;
+    free(sorted);
+
+    if (sw->has_range && sw->n_arms <= 255) {
+        long long base = lo, len = reach - lo + 1;
+        if (sw->has_domain && sw->dom_hi - sw->dom_lo < CASE_TABLE_MAX) {
+            base = sw->dom_lo;
+            len = sw->dom_hi - sw->dom_lo + 1;
+            sw->table_direct = true;
+        }
+        if (len > 0 && len <= CASE_TABLE_MAX) {
+            case_switch_build_table(sw, base, len);
+            return true;
+        }
+    }
+    if (overlap) return false;
+    sw->default_dead = covers;
+    return true;
+}
+
+// A `break` that leaves the enclosing loop (not one of a nested loop).
+static bool stmt_list_breaks_loop(StmtList *list) {
+    for (StmtList *l = list; l; l = l->next) {
+        Stmt *s = l->stmt;
+        if (!s) continue;
+        switch (s->kind) {
+        case STMT_BREAK:
+            return true;
+        case STMT_IF:
+            if (stmt_list_breaks_loop(s->as.if_stmt.then_body) ||
+                stmt_list_breaks_loop(s->as.if_stmt.else_branch)) return true;
+            break;
+        case STMT_COMPTIME_IF:
+            if (stmt_list_breaks_loop(s->as.comptime_if_stmt.then_body) ||
+                stmt_list_breaks_loop(s->as.comptime_if_stmt.else_branch)) return true;
+            break;
+        case STMT_MATCH:
+            for (StmtMatchCase *c = s->as.match_stmt.cases; c; c = c->next)
+                if (stmt_list_breaks_loop(c->body)) return true;
+            break;
+        case STMT_UNSAFE:
+            if (stmt_list_breaks_loop(s->as.unsafe_stmt.body)) return true;
+            break;
+        default:
+            break;
+        }
+    }
+    return false;
+}
+
+// Decide whether a statement `case` becomes a switch. Worth it only with at
+// least two labels; a single test stays an `if`. Arms are numbered per
+// fall-through group, in the order emit/stmt.h walks them.
+static bool case_switch_plan_stmt(CaseSwitch *sw, StmtMatchCase *cases) {
+    if (sw->kind == CASE_SWITCH_NONE) return false;
+    for (StmtMatchCase *c = cases; c; ) {
+        StmtMatchCase *group = c;
+        while (group && !group->body && group->next) group = group->next;
+        int arm = case_switch_new_arm(sw);
+        for (StmtMatchCase *p = c;; p = p->next) {
+            if (!p->patterns && !case_switch_add(sw, NULL, arm)) return false;
+            for (ExprList *pat = p->patterns; pat; pat = pat->next)
+                if (!case_switch_add(sw, pat->expr, arm)) return false;
+            if (stmt_list_breaks_loop(p->body)) return false;
+            if (p == group) break;
+        }
+        c = group->next;
+    }
+    return case_switch_finish(sw);
+}
+
+static bool case_switch_plan_expr(CaseSwitch *sw, ExprMatchCase *cases) {
+    if (sw->kind == CASE_SWITCH_NONE) return false;
+    for (ExprMatchCase *c = cases; c; c = c->next) {
+        int arm = case_switch_new_arm(sw);
+        if (!c->patterns && !case_switch_add(sw, NULL, arm)) return false;
+        for (ExprList *p = c->patterns; p; p = p->next)
+            if (!case_switch_add(sw, p->expr, arm)) return false;
+    }
+    return case_switch_finish(sw);
+}
+
+static void case_switch_open(CaseSwitch *sw, int match_id, int depth) {
+    if (sw->table) {
+        emit_indent(depth);
+        EMIT("static const uint8_t __case%d_arm[%d] = {", match_id, sw->table_len);
+        for (int i = 0; i < sw->table_len; i++) {
+            if (i) EMIT_LIT(",");
+            if (i % 16 == 0) {
+                EMIT_LIT("\n");
+                emit_indent(depth + 1);
+            } else {
+                EMIT_LIT(" ");
+            }
+            EMIT("%d", sw->table[i]);
+        }
+        EMIT_LIT("\n");
+        emit_indent(depth);
+        EMIT_LIT("};\n");
+        emit_indent(depth);
+        if (sw->table_direct && sw->table_base == 0)
+            EMIT("switch (__case%d_arm[__match%d]) {\n", match_id, match_id);
+        else if (sw->table_direct)   // a signed type: shift its minimum to 0
+            EMIT("switch (__case%d_arm[(int)__match%d + %lld]) {\n", match_id, match_id, -sw->table_base);
+        else
+            EMIT("switch ((uint64_t)__match%d - (uint64_t)%lldLL < %dULL "
+                 "? __case%d_arm[(uint64_t)__match%d - (uint64_t)%lldLL] : 0) {\n",
+                 match_id, sw->table_base, sw->table_len, match_id, match_id, sw->table_base);
+        return;
+    }
+    emit_indent(depth);
+    if (sw->kind == CASE_SWITCH_TAG)
+        EMIT("switch (__match%d.tag) {\n", match_id);
+    else if (sw->kind == CASE_SWITCH_NICHE && sw->niche->pool.kind == POOL_POINTER)
+        EMIT("switch ((uintptr_t)__match%d) {\n", match_id);
+    else
+        EMIT("switch (__match%d) {\n", match_id);
+}
+
+// Start the labels of the next arm (a fall-through group of the statement
+// form, one case of the expression form).
+static void case_switch_arm(CaseSwitch *sw) {
+    sw->cur_arm++;
+    sw->cur_labelled = false;
+}
+
+static int case_switch_default_label(CaseSwitch *sw, int depth) {
+    if (sw->default_dead) return 0;
+    emit_indent(depth);
+    EMIT_LIT("default:\n");
+    sw->emitted_default = true;
+    return 1;
+}
+
+// The labels of one pattern (NULL = wildcard), one per line. Returns how many
+// were emitted; an arm that gets none can never run and is left out.
+static int case_switch_labels(CaseSwitch *sw, Expr *pat, int depth) {
+    if (sw->table) {
+        // one label per arm: its number in the table
+        if (sw->cur_labelled) return 0;
+        sw->cur_labelled = true;
+        unsigned char flags = sw->arms[sw->cur_arm];
+        if (flags & CASE_ARM_DEFAULT) return case_switch_default_label(sw, depth);
+        if (!(flags & CASE_ARM_LIVE)) return 0;
+        emit_indent(depth);
+        EMIT("case %d:\n", sw->cur_arm);
+        return 1;
+    }
+    CaseInterval vals[CASE_LABELS_MAX];
+    int n = pat ? case_pattern_labels(sw, pat, vals, CASE_LABELS_MAX) : CASE_LABELS_DEFAULT;
+    if (n == CASE_LABELS_DEFAULT) return case_switch_default_label(sw, depth);
+    for (int i = 0; i < n; i++) {
+        emit_indent(depth);
+        switch (sw->kind) {
+        case CASE_SWITCH_TAG: {
+            Variant *v = sw->adt->variants;
+            for (long long k = 0; k < vals[i].lo && v; k++) v = v->next;
+            EMIT("case %s_Tag_%.*s:\n", sw->adt_cname, (int)v->name->length, v->name->name);
+            break;
+        }
+        case CASE_SWITCH_NICHE:
+            if (sw->niche->pool.kind == POOL_POINTER) EMIT("case %lldULL:\n", vals[i].lo);
+            else EMIT("case (%s)%lldLL:\n", sw->adt_cname, vals[i].lo);
+            break;
+        default:
+            if (pat->kind == EXPR_CHAR) {
+                EMIT_LIT("case ");
+                emit_expr(pat, depth);
+                EMIT_LIT(":\n");
+            } else if (vals[i].lo != vals[i].hi) {
+                EMIT("case %lld ... %lld:\n", vals[i].lo, vals[i].hi);
+            } else {
+                EMIT("case %lld:\n", vals[i].lo);
+            }
+            break;
+        }
+    }
+    return n;
+}
+
+// Close the switch. An exhaustive enum match, or labels covering every value
+// of the type, leave nothing for `default:`.
+static void case_switch_close(CaseSwitch *sw, int depth) {
+    if (!sw->emitted_default && (sw->kind != CASE_SWITCH_INT || sw->default_dead)) {
+        emit_indent(depth);
+        EMIT_LIT("default: __builtin_unreachable();\n");
+    }
+    emit_indent(depth);
+    EMIT_LIT("}\n");
+}
+
+#endif // EMIT_SWITCH_H
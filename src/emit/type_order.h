@@ -170,56 +170,24 @@ static TypeNode **toposort(TypeNode *nodes, int n, int *out_sorted_n) {
 }
 
 //----------------------------------------------------------------------------
-// Public API: emit all enums & structs in dependency order, then all functions.
-static void emit_decl_list_topo(DeclList *decls, int depth) {
-    //fprintf(stderr, "[DEBUG] in emit_decl_list_topo with %p\n", decls);
+// Emit all enums, structs and primitive aliases in dependency order.
+static void emit_type_decls_topo(DeclList *decls, int depth) {
     // 1) collect & analyze
     TypeNode *nodes;
     int       n;
     collect_type_nodes(decls, &nodes, &n);
-
-    //debug
-    //fprintf(stderr, "[DEBUG] collected %d type-nodes:\n", n);
-    //for (int i = 0; i < n; i++) {
-    //    fprintf(stderr, "  node %2d: %s\n", i, nodes[i].name);
-    //}
-
     build_edges(nodes, n);
-    //debug
-    //fprintf(stderr, "[DEBUG] dependencies:\n");
-    //for (int i = 0; i < n; i++) {
-    //    fprintf(stderr, "  %s depends on:", nodes[i].name);
-    //    for (int k = 0; k < nodes[i].n_deps; k++) {
-    //        int j = nodes[i].deps[k];
-    //        fprintf(stderr, " %s", nodes[j].name);
-    //    }
-    //    fprintf(stderr, "\n");
-    //}
 
     // 2) toposort
     int        sorted_n;
     TypeNode **sorted = toposort(nodes, n, &sorted_n);
-    //debug
-    //fprintf(stderr, "[DEBUG] toposorted order (%d nodes):\n", sorted_n);
-    //for (int i = 0; i < sorted_n; i++) {
-    //    fprintf(stderr, "  %2d: %s\n", i, sorted[i]->name);
-    //}
 
     // 3) emit enums & structs in sorted order
     for (int i = 0; i < sorted_n; i++) {
         emit_decl(sorted[i]->decl, depth);
     }
 
-    // 4) emit all functions in original order
-    for (DeclList *dl = decls; dl; dl = dl->next) {
-        if (decl_is_generic_template(dl->decl)) continue;   // templates: only instances are emitted
-        if (dl->decl->kind == DECL_FUNCTION || dl->decl->kind == DECL_PROCEDURE ||
-            dl->decl->kind == DECL_EXTERN_FUNCTION || dl->decl->kind == DECL_EXTERN_PROCEDURE ||
-            dl->decl->kind == DECL_VARIABLE)
-            emit_decl(dl->decl, depth);
-    }
-
-    // 5) cleanup
+    // 4) cleanup
     for (int i = 0; i < n; i++) {
         free(nodes[i].name);
         free(nodes[i].deps);
@@ -228,4 +196,32 @@ static void emit_decl_list_topo(DeclList *decls, int depth) {
     free(sorted);
 }
 
+// A decl emitted by the function pass of emit_decl_list_topo (externs and
+// top-level variables included: emit_decl decides what they produce).
+static bool emit_is_function_pass_decl(Decl *d) {
+    if (!d || decl_is_generic_template(d)) return false;   // templates: only instances are emitted
+    return d->kind == DECL_FUNCTION || d->kind == DECL_PROCEDURE ||
+           d->kind == DECL_EXTERN_FUNCTION || d->kind == DECL_EXTERN_PROCEDURE ||
+           d->kind == DECL_VARIABLE;
+}
+
+static void emit_function_decl_timed(Decl *d, int depth) {
+    bool is_fn = d->kind == DECL_FUNCTION || d->kind == DECL_PROCEDURE;
+    if (is_fn) prof_function_begin(d);
+    emit_for_count = emit_match_count = emit_expr_match_count = 0;
+    emit_decl(d, depth);
+    if (is_fn) prof_function_end();
+}
+
+//----------------------------------------------------------------------------
+// Public API: emit all enums & structs in dependency order, then all functions.
+static void emit_decl_list_topo(DeclList *decls, int depth) {
+    emit_type_decls_topo(decls, depth);
+
+    // emit all functions in original order
+    for (DeclList *dl = decls; dl; dl = dl->next) {
+        if (emit_is_function_pass_decl(dl->decl)) emit_function_decl_timed(dl->decl, depth);
+    }
+}
+
 #endif // EMIT_ORDER_H
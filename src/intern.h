@@ -0,0 +1,227 @@
+#ifndef INTERN_H
+#define INTERN_H
+
+#include "utils/common.h" // isize, uint32, memcmp
+
+/*
+  Global identifier interning.
+
+  Every distinct identifier spelling is stored exactly once as an "atom": a
+  NUL-terminated copy preceded by an AtomHeader holding its hash and length.
+  Two spellings are equal iff their atoms are the same pointer, so the symbol
+  tables and the sema fact stores (ranges, linearity, borrows, comptime env)
+  compare names with `==` instead of strncmp.
+
+  The table is open-addressed (linear probing, power-of-two capacity) and
+  grows at 50% load; atom bytes live in malloc'd chunks that are never freed.
+  Single-shot compiler, so a global table is fine.
+
+  The parallel front end (module.h, -j) parses modules on several threads.
+  While it runs, `g_intern_threaded` is set and every table access goes
+  through intern_lock(); sema and emit are single-threaded and skip the lock.
+*/
+
+#if OS_LINUX
+#include <pthread.h>
+#endif
+
+typedef struct AtomHeader {
+    uint32 hash;
+    uint32 length;
+} AtomHeader;
+
+#define INTERN_INITIAL_CAPACITY 4096
+#define INTERN_CHUNK_SIZE       (64 * 1024)
+
+typedef struct InternTable {
+    const char **slots;       // atoms, NULL = empty slot
+    isize        capacity;    // power of two
+    isize        count;
+    char        *chunk;       // current atom storage chunk
+    isize        chunk_left;
+} InternTable;
+
+static InternTable g_intern;
+
+static bool g_intern_threaded = false;
+#if OS_LINUX
+static pthread_mutex_t g_intern_mutex = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
+static inline void intern_lock(void) {
+#if OS_LINUX
+    if (g_intern_threaded) pthread_mutex_lock(&g_intern_mutex);
+#endif
+}
+
+static inline void intern_unlock(void) {
+#if OS_LINUX
+    if (g_intern_threaded) pthread_mutex_unlock(&g_intern_mutex);
+#endif
+}
+
+// FNV-1a: the same hash for a spelling wherever it comes from (source text,
+// mangled names, synthetic "__len_" keys).
+static inline uint32 intern_hash(const char *s, isize length) {
+    uint32 h = 2166136261u;
+    for (isize i = 0; i < length; i++) {
+        h ^= (unsigned char)s[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+static inline uint32 atom_hash(const char *atom) {
+    return ((const AtomHeader *)atom)[-1].hash;
+}
+
+static inline isize atom_length(const char *atom) {
+    return ((const AtomHeader *)atom)[-1].length;
+}
+
+static void _intern_grow(void) {
+    isize capacity = g_intern.capacity ? g_intern.capacity * 2 : INTERN_INITIAL_CAPACITY;
+    const char **slots = calloc((size_t)capacity, sizeof *slots);
+    if (!slots) {
+        fprintf(stderr, "Error: out of memory interning identifiers\n");
+        exit(1);
+    }
+    for (isize i = 0; i < g_intern.capacity; i++) {
+        const char *atom = g_intern.slots[i];
+        if (!atom) continue;
+        isize j = atom_hash(atom) & (capacity - 1);
+        while (slots[j]) j = (j + 1) & (capacity - 1);
+        slots[j] = atom;
+    }
+    free(g_intern.slots);
+    g_intern.slots = slots;
+    g_intern.capacity = capacity;
+}
+
+// Slot index holding `s`, or the empty slot where it would go.
+static inline isize _intern_probe(const char *s, isize length, uint32 hash) {
+    isize mask = g_intern.capacity - 1;
+    isize i = hash & mask;
+    for (;;) {
+        const char *atom = g_intern.slots[i];
+        if (!atom) return i;
+        if (atom_hash(atom) == hash && atom_length(atom) == length &&
+            memcmp(atom, s, (size_t)length) == 0) {
+            return i;
+        }
+        i = (i + 1) & mask;
+    }
+}
+
+// Canonical atom for `s[0..length)`, or NULL if that spelling was never
+// interned (so nothing named it can be in any table).
+static const char *atom_find(const char *s, isize length) {
+    uint32 hash = intern_hash(s, length);
+    intern_lock();
+    const char *atom = g_intern.capacity ? g_intern.slots[_intern_probe(s, length, hash)] : NULL;
+    intern_unlock();
+    return atom;
+}
+
+static const char *atom_intern_hashed(const char *s, isize length, uint32 hash) {
+    intern_lock();
+    if (g_intern.count * 2 >= g_intern.capacity) _intern_grow();
+    isize i = _intern_probe(s, length, hash);
+    if (g_intern.slots[i]) {
+        const char *atom = g_intern.slots[i];
+        intern_unlock();
+        return atom;
+    }
+
+    isize need = (isize)sizeof(AtomHeader) + length + 1;
+    need = (need + 7) & ~(isize)7;
+    if (need > g_intern.chunk_left) {
+        isize size = need > INTERN_CHUNK_SIZE ? need : INTERN_CHUNK_SIZE;
+        g_intern.chunk = malloc((size_t)size);
+        if (!g_intern.chunk) {
+            fprintf(stderr, "Error: out of memory interning identifiers\n");
+            exit(1);
+        }
+        g_intern.chunk_left = size;
+    }
+    AtomHeader *header = (AtomHeader *)g_intern.chunk;
+    g_intern.chunk += need;
+    g_intern.chunk_left -= need;
+
+    header->hash = hash;
+    header->length = (uint32)length;
+    char *atom = (char *)(header + 1);
+    memcpy(atom, s, (size_t)length);
+    atom[length] = '\0';
+
+    g_intern.slots[i] = atom;
+    g_intern.count++;
+    intern_unlock();
+    return atom;
+}
+
+static inline const char *atom_intern(const char *s, isize length) {
+    return atom_intern_hashed(s, length, intern_hash(s, length));
+}
+
+/*
+  AtomMap: open-addressed map from an atom, or an (atom, atom) pair, to a
+  pointer. Atoms are canonical, so keys compare with `==` and hash with the
+  precomputed atom_hash. Pass NULL as `b` for single-atom keys.
+*/
+
+typedef struct AtomMapSlot {
+    const char *a;      // NULL = empty slot
+    const char *b;
+    void       *value;
+} AtomMapSlot;
+
+typedef struct AtomMap {
+    AtomMapSlot *slots;
+    isize        capacity;   // power of two
+    isize        count;
+} AtomMap;
+
+static inline uint32 _atom_map_hash(const char *a, const char *b) {
+    uint32 h = atom_hash(a);
+    if (b) h ^= atom_hash(b) * 0x9E3779B1u;
+    return h;
+}
+
+static inline isize _atom_map_probe(const AtomMap *m, const char *a, const char *b) {
+    isize mask = m->capacity - 1;
+    isize i = _atom_map_hash(a, b) & mask;
+    while (m->slots[i].a && (m->slots[i].a != a || m->slots[i].b != b)) {
+        i = (i + 1) & mask;
+    }
+    return i;
+}
+
+static void *atom_map_get(const AtomMap *m, const char *a, const char *b) {
+    if (!m->capacity || !a) return NULL;
+    return m->slots[_atom_map_probe(m, a, b)].value;
+}
+
+// Insert or overwrite.
+static void atom_map_put(AtomMap *m, const char *a, const char *b, void *value) {
+    if (m->count * 2 >= m->capacity) {
+        isize capacity = m->capacity ? m->capacity * 2 : 64;
+        AtomMap grown = { calloc((size_t)capacity, sizeof(AtomMapSlot)), capacity, m->count };
+        if (!grown.slots) {
+            fprintf(stderr, "Error: out of memory growing a name table\n");
+            exit(1);
+        }
+        for (isize i = 0; i < m->capacity; i++) {
+            if (m->slots[i].a) grown.slots[_atom_map_probe(&grown, m->slots[i].a, m->slots[i].b)] = m->slots[i];
+        }
+        free(m->slots);
+        *m = grown;
+    }
+    AtomMapSlot *slot = &m->slots[_atom_map_probe(m, a, b)];
+    if (!slot->a) m->count++;
+    slot->a = a;
+    slot->b = b;
+    slot->value = value;
+}
+
+#endif // INTERN_H
@@ -6,6 +6,67 @@
 #define SWITCH_STATE(_state) state = _state; break
 #define RETURN_TOKEN(_kind)  token.kind = _kind; token.length = lexer->current - token.start; return token
 
+/**
+    @brief
+        Width in bytes of the vector scan used to skip long comment and string
+        bodies: 32 (AVX2), 16 (SSE2) or 0 (scalar only). Selected from the
+        target at build time; pass -DLEXER_SIMD=0 to force the scalar path.
+*/
+#ifndef LEXER_SIMD
+#   if defined(__AVX2__) && COMPILER_HAS_BUILTIN(__builtin_ctz)
+#       define LEXER_SIMD 32
+#   elif defined(__SSE2__) && COMPILER_HAS_BUILTIN(__builtin_ctz)
+#       define LEXER_SIMD 16
+#   else
+#       define LEXER_SIMD 0
+#   endif
+#endif
+
+#if LEXER_SIMD == 32
+#   include <immintrin.h>
+#elif LEXER_SIMD == 16
+#   include <emmintrin.h>
+#endif
+
+// First byte at or after `p` equal to `a`, `b` or `c` (callers always pass 0 as
+// one of them, so the scan stops at the terminator). Used only for the long runs
+// — comment and string bodies — where a movemask+ctz per block beats a byte loop;
+// short tokens stay on the scalar state machine. Wide loads are only issued when
+// the block cannot cross a page, since bytes past the terminating NUL are not
+// guaranteed to be mapped.
+static inline const char *lexer_scan_to(const char *p, char a, char b, char c) {
+#if LEXER_SIMD == 32
+    const __m256i va = _mm256_set1_epi8(a), vb = _mm256_set1_epi8(b), vc = _mm256_set1_epi8(c);
+#elif LEXER_SIMD == 16
+    const __m128i va = _mm_set1_epi8(a), vb = _mm_set1_epi8(b), vc = _mm_set1_epi8(c);
+#endif
+    for (;;) {
+#if LEXER_SIMD
+        if (((uptr)p & (MEMORY_PAGE_MINIMUM_SIZE - 1)) <= MEMORY_PAGE_MINIMUM_SIZE - LEXER_SIMD) {
+#   if LEXER_SIMD == 32
+            __m256i v = _mm256_loadu_si256((const __m256i *)p);
+            __m256i hit = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(v, va),
+                                                          _mm256_cmpeq_epi8(v, vb)),
+                                          _mm256_cmpeq_epi8(v, vc));
+            unsigned mask = (unsigned)_mm256_movemask_epi8(hit);
+#   else
+            __m128i v = _mm_loadu_si128((const __m128i *)p);
+            __m128i hit = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, va),
+                                                    _mm_cmpeq_epi8(v, vb)),
+                                       _mm_cmpeq_epi8(v, vc));
+            unsigned mask = (unsigned)_mm_movemask_epi8(hit);
+#   endif
+            if (mask) return p + __builtin_ctz(mask);
+            p += LEXER_SIMD;
+            continue;
+        }
+#endif
+        // scalar: no SIMD, or the block would straddle a page boundary
+        if (*p == a || *p == b || *p == c) return p;
+        p++;
+    }
+}
+
 typedef struct {
     const char   *text;
     const char   *current;
@@ -167,7 +228,12 @@ Token lexer_next(Lexer* lexer) {
 
             case STATE_SINGLE_QUOTE:
                 // keep scanning until we hit the *matching* closing '
-                if (c == '\\') {
+                if (c == 0) {
+                    // unterminated literal: stop at the source's NUL sentinel
+                    lexer->current--;
+                    RETURN_TOKEN(TOKEN_INVALID);
+                }
+                else if (c == '\\') {
                     // skip over backslash-escape plus its following char
                     if (*lexer->current) lexer->current++;
                 }
@@ -189,6 +255,10 @@ Token lexer_next(Lexer* lexer) {
                     break;
                 }
                 switch (c) {
+                    case 0:
+                        // unterminated string: stop at the source's NUL sentinel
+                        lexer->current--;
+                        RETURN_TOKEN(TOKEN_INVALID);
                     case '"': {
                         // We have reached the closing double quote.
                         // Skip the opening quote and exclude the closing quote.
@@ -197,7 +267,10 @@ Token lexer_next(Lexer* lexer) {
                         token.kind = TOKEN_STRING_LITERAL;
                         return token;
                     }
-                    default:            break;
+                    default:
+                        // skip the plain run up to the next quote/escape/NUL
+                        lexer->current = lexer_scan_to(lexer->current, '"', '\\', 0);
+                        break;
                 }
                 break;
 
@@ -275,7 +348,8 @@ Token lexer_next(Lexer* lexer) {
                                 // EOF before close
                                 break;
                             } else {
-                                lexer->current++;
+                                // skip to the next byte that can open/close a comment
+                                lexer->current = lexer_scan_to(lexer->current + 1, '/', '*', 0);
                             }
                         }
                         // return the full comment token
@@ -295,14 +369,10 @@ Token lexer_next(Lexer* lexer) {
             
 
             case STATE_LINE_COMMENT:
-                switch (c) {
-                    case '\n':
-                    case '\r':
-                    case 0:             lexer->current--;
-                                        RETURN_TOKEN(TOKEN_LINE_COMMENT);
-                    default:            break;
-                }
-                break;
+                // `c` is the first body byte; the comment runs up to (excluding)
+                // the line terminator or NUL, so jump straight there.
+                lexer->current = lexer_scan_to(lexer->current - 1, '\n', '\r', 0);
+                RETURN_TOKEN(TOKEN_LINE_COMMENT);
 
 //            case STATE_MULTILINE_COMMENT:
 //                switch (c) {
@@ -388,4 +458,77 @@ Token lexer_peek(Lexer* lexer) {
     return lexer_next(&temp); // Return the next token without modifying the original lexer
 }
 
+/*──────────────────────────────────────────────────────────────────╗
+│ WHOLE-FILE TOKEN BUFFER                                           │
+╚──────────────────────────────────────────────────────────────────*/
+
+// Structure-of-arrays token stream, filled once per module by lexer_tokenize
+// (same layout as `tokenize` in bench/simd_lexer): `kinds[]` is 1 B/token and is
+// all the parser dispatches and looks ahead on; `starts[]`/`lengths[]` are only
+// read when a lexeme is needed. Lengths are stored rather than re-lexed because
+// string tokens exclude their quotes, so the gap to the next start is not enough.
+// Every raw token is kept (comments and newlines included) so streaming from the
+// buffer is token-for-token identical to pulling lexer_next.
+typedef struct {
+    const char *text;
+    uint8      *kinds;    // TokenKind, narrowed (all kinds fit in a byte)
+    uint32     *starts;   // byte offset of the lexeme in `text`
+    uint32     *lengths;  // lexeme length in bytes
+    isize       count;    // tokens stored, including the final TOKEN_EOF
+    isize       capacity;
+} TokenBuffer;
+
+static void _token_buffer_reserve(TokenBuffer *buf, isize cap) {
+    buf->kinds   = realloc(buf->kinds,   (size_t)cap * sizeof *buf->kinds);
+    buf->starts  = realloc(buf->starts,  (size_t)cap * sizeof *buf->starts);
+    buf->lengths = realloc(buf->lengths, (size_t)cap * sizeof *buf->lengths);
+    if (!buf->kinds || !buf->starts || !buf->lengths) {
+        fprintf(stderr, "Error: out of memory while tokenizing (%ld tokens)\n", (long)cap);
+        exit(1);
+    }
+    buf->capacity = cap;
+}
+
+// Lex all of `text` up to and including TOKEN_EOF.
+TokenBuffer lexer_tokenize(const char *text) {
+    TokenBuffer buf = {0};
+    buf.text = text;
+    Lexer lexer = lexer_new(text);
+    // One token per ~4 source bytes is typical; start there to skip most regrows.
+    _token_buffer_reserve(&buf, (isize)strlen(text) / 4 + 16);
+
+    Token token;
+    do {
+        token = lexer_next(&lexer);
+        if (buf.count == buf.capacity) _token_buffer_reserve(&buf, buf.capacity * 2);
+        buf.kinds[buf.count]   = (uint8)token.kind;
+        buf.starts[buf.count]  = (uint32)(token.start - text);
+        buf.lengths[buf.count] = (uint32)token.length;
+        buf.count++;
+    } while (token.kind != TOKEN_EOF);
+    return buf;
+}
+
+// Token at `index`; indices past the end read as the trailing TOKEN_EOF.
+static inline Token token_buffer_get(const TokenBuffer *buf, isize index) {
+    if (index >= buf->count) index = buf->count - 1;
+    return (Token) {
+        .kind   = (TokenKind)buf->kinds[index],
+        .start  = buf->text + buf->starts[index],
+        .length = (isize)buf->lengths[index],
+    };
+}
+
+static inline TokenKind token_buffer_kind(const TokenBuffer *buf, isize index) {
+    if (index >= buf->count) index = buf->count - 1;
+    return (TokenKind)buf->kinds[index];
+}
+
+void token_buffer_free(TokenBuffer *buf) {
+    free(buf->kinds);
+    free(buf->starts);
+    free(buf->lengths);
+    *buf = (TokenBuffer){0};
+}
+
 #endif /* LEXER_H */
\ No newline at end of file
@@ -1,3 +1,10 @@
+/* mmap flags (MAP_ANONYMOUS, MAP_NORESERVE) and CLOCK_MONOTONIC are hidden
+   under -std=c99 unless the POSIX/BSD extensions are requested before the
+   first system header. */
+#ifndef _DEFAULT_SOURCE
+#define _DEFAULT_SOURCE
+#endif
+
 #include "utils/common/def.h"
 #include "utils/arena.h"
 #include "utils/file.h"
@@ -6,6 +13,7 @@
 
 #include <unistd.h> /* chdir */
 
+#include "profile.h"
 #include "lexer.h"
 #include "parser.h"
 #include "ast.h"
@@ -16,6 +24,7 @@
 #include "args.h"
 #include "target.h"
 #include "sema.h"
+#include "cache.h"
 
 void expr_print_ast(Expr *expr, int depth);
 void stmt_print_ast(Stmt *stmt, int depth);
@@ -54,13 +63,21 @@ static char *filepath_to_modname(Arena *arena, const char *path) {
 
 
 int main(int argc, char **argv) {
-    // two arenas:
-    Arena file_arena = arena_new(memory_alloc, MEMORY_PAGE_MINIMUM_SIZE*4096);
-    Arena ast_arena  = arena_new(memory_alloc, MEMORY_PAGE_MINIMUM_SIZE*4096);
-    Arena _sema_arena = arena_new(memory_alloc, MEMORY_PAGE_MINIMUM_SIZE*4096);
+    // Growable arenas: address space is reserved up front and pages are
+    // committed as the arenas fill, so there is no fixed size ceiling.
+    Arena file_arena  = arena_reserve(ARENA_RESERVE_DEFAULT);
+    Arena ast_arena   = arena_reserve(ARENA_RESERVE_DEFAULT);
+    Arena _sema_arena = arena_reserve(ARENA_RESERVE_DEFAULT);
+    Arena _sema_scratch = arena_reserve(ARENA_RESERVE_DEFAULT);
 
     Args args = args_parse(argc, argv);
 
+    prof_init(args.time_passes, args.stats, args.time_passes_top);
+    prof_watch_arena("file arena", &file_arena);
+    prof_watch_arena("ast arena", &ast_arena);
+    prof_watch_arena("sema arena", &_sema_arena);
+    prof_watch_arena("sema scratch", &_sema_scratch);
+
     // Initialize target config (host auto-detect unless --target= specified).
     target_init_for(args.target_triple);
     sema_w130_silent = args.no_w130;
@@ -95,7 +112,17 @@ int main(int argc, char **argv) {
     // (strip “.ln” and turn “/” into “.”)
     char *modname = filepath_to_modname(&ast_arena, args.filename);
 
-    DeclList *program = load_module(&file_arena, &ast_arena, modname);
+    // Dumps, profiles and --verify-sema describe the work itself, so they
+    // always do it.
+    if (args.cache_dir && !args.dump_ast && !args.dump_niche && !prof.enabled
+        && !args.verify_sema) {
+        cache_init(args.cache_dir, args.filename, modname, args.units_dir,
+                   !args.no_line_directives, !args.no_w130, args.whole_program);
+        if (cache_lookup(args.output_file)) return 0;
+        sema_diag_recording = true;
+    }
+
+    DeclList *program = load_module_parallel(&file_arena, &ast_arena, modname, args.jobs);
     if (!program) {
         fprintf(stderr, "Could not load root module %s\n", modname);
         return 1;
@@ -108,13 +135,22 @@ int main(int argc, char **argv) {
     }
 
     // sema = resolve identifiers → you’d call:
-    sema_resolve_module(program, modname, &_sema_arena);
+    sema_resolve_module(program, modname, &_sema_arena, &_sema_scratch);
 
     // then code-gen:
     emit_source_filename = args.no_line_directives ? NULL : args.filename;
-    emit(program, 0, args.output_file);
+    emit_verify_sema = args.verify_sema;
+    emit_whole_program = args.whole_program;
+    prof_enter(PASS_EMIT);
+    if (args.units_dir)
+        emit_units(program, 0, args.units_dir);
+    else
+        emit(program, 0, args.output_file);
+    prof_leave();
+    cache_store(args.output_file);
 
     sema_destroy();
+    prof_report();
 
     return 0;
 }
@@ -5,6 +5,7 @@
 #include "lexer.h"
 #include "parser.h"
 #include "utils/file.h"
+#include "profile.h"
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
@@ -27,50 +28,33 @@ typedef struct ModuleNode {
     struct ModuleNode *next;
 } ModuleNode;
 
-static ModuleNode *loaded_modules = NULL;
+static ModuleNode *loaded_modules = NULL;   // load order, newest first
+static AtomMap     module_index;            // interned module path → ModuleNode
 
 // Registry of import qualifiers (the alias, or a module path's last segment) so
 // name resolution can recognize `qualifier.Member` as qualified module access.
 // Populated during load (the DECL_IMPORT nodes are spliced out afterward).
-typedef struct QualifierNode {
-    char *name;
-    struct QualifierNode *next;
-} QualifierNode;
-static QualifierNode *import_qualifiers = NULL;
-
-static void register_qualifier(Arena *arena, const char *name, size_t len) {
-    for (QualifierNode *q = import_qualifiers; q; q = q->next)
-        if (strlen(q->name) == len && strncmp(q->name, name, len) == 0) return;
-    QualifierNode *q = arena_push_aligned(arena, QualifierNode);
-    q->name = arena_push_many(arena, char, (isize)len + 1);
-    memcpy(q->name, name, len); q->name[len] = '\0';
-    q->next = import_qualifiers; import_qualifiers = q;
+// A set of interned names: the value is only a presence marker.
+static AtomMap import_qualifiers;
+
+static void register_qualifier(const char *name, size_t len) {
+    const char *atom = atom_intern(name, (isize)len);
+    atom_map_put(&import_qualifiers, atom, NULL, (void *)atom);
 }
 static bool qualifier_is_module(const char *name, size_t len) {
-    for (QualifierNode *q = import_qualifiers; q; q = q->next)
-        if (strlen(q->name) == len && strncmp(q->name, name, len) == 0) return true;
-    return false;
+    return atom_map_get(&import_qualifiers, atom_find(name, (isize)len), NULL) != NULL;
 }
 
 // Registry of selective imports: (importer module, name) pairs — the names an
 // importer pulled in unqualified via `import M.{a, b}`. With the glob retired,
-// a bare cross-module name is visible ONLY if it appears here.
-typedef struct SelImportNode {
-    char *importer;   // importing module path (defining_module of the import site)
-    char *name;       // the unqualified name brought in
-    struct SelImportNode *next;
-} SelImportNode;
-static SelImportNode *sel_imports = NULL;
-
-static void register_sel_import(Arena *arena, const char *importer, Id *name) {
+// a bare cross-module name is visible ONLY if it appears here. Keyed by the
+// interned importer path and the interned name.
+static AtomMap sel_imports;
+
+static void register_sel_import(const char *importer, Id *name) {
     if (!importer || !name) return;
-    SelImportNode *n = arena_push_aligned(arena, SelImportNode);
-    size_t il = strlen(importer);
-    n->importer = arena_push_many(arena, char, (isize)il + 1);
-    memcpy(n->importer, importer, il + 1);
-    n->name = arena_push_many(arena, char, (isize)name->length + 1);
-    memcpy(n->name, name->name, (size_t)name->length); n->name[name->length] = '\0';
-    n->next = sel_imports; sel_imports = n;
+    const char *importer_atom = atom_intern(importer, (isize)strlen(importer));
+    atom_map_put(&sel_imports, importer_atom, name->atom, (void *)name->atom);
 }
 // Compare two module paths treating '.' and '_' as equal — the dotted form
 // (`std.io`) and the C-sanitized form (`std_io`) name the same module.
@@ -85,18 +69,18 @@ static bool module_paths_equal(const char *a, const char *b) {
 }
 static bool sel_import_visible(const char *importer, const char *name, size_t len) {
     if (!importer) return false;
-    for (SelImportNode *s = sel_imports; s; s = s->next)
-        if (strcmp(s->importer, importer) == 0 &&
-            strlen(s->name) == len && strncmp(s->name, name, len) == 0)
-            return true;
-    return false;
+    const char *name_atom = atom_find(name, (isize)len);
+    if (!name_atom) return false;
+    return atom_map_get(&sel_imports, atom_find(importer, (isize)strlen(importer)), name_atom) != NULL;
+}
+
+// Lookup a module record by name
+static ModuleNode *find_module(const char *name) {
+    return atom_map_get(&module_index, atom_find(name, (isize)strlen(name)), NULL);
 }
 
 static bool module_already_loaded(const char *name) {
-    for (ModuleNode *n = loaded_modules; n; n = n->next)
-        if (strcmp(n->name, name) == 0)
-            return true;
-    return false;
+    return find_module(name) != NULL;
 }
 
 static ModuleNode* record_module(Arena *arena, const char *name, DeclList *decls, const char *source_text, const char *source_file) {
@@ -121,17 +105,10 @@ static ModuleNode* record_module(Arena *arena, const char *name, DeclList *decls
     }
     n->next  = loaded_modules;
     loaded_modules = n;
+    atom_map_put(&module_index, atom_intern(name, (isize)strlen(name)), NULL, n);
     return n;
 }
 
-// Lookup a module record by name
-static ModuleNode *find_module(const char *name) {
-    for (ModuleNode *n = loaded_modules; n; n = n->next)
-        if (strcmp(n->name, name) == 0)
-            return n;
-    return NULL;
-}
-
 /// “foo.bar.baz” → “foo/bar/baz.ln”
 static void module_name_to_path(const char *mod, char *out, size_t cap) {
     size_t i = 0;
@@ -145,37 +122,196 @@ static void module_name_to_path(const char *mod, char *out, size_t cap) {
     out[i] = '\0';
 }
 
+// Copy an import's dotted module path into `buf` (truncated to cap - 1).
+static void import_module_name(Decl *imp_decl, char *buf, size_t cap) {
+    Id *imp    = imp_decl->as.import_decl.module_name;
+    size_t len = imp->length;
+    if (len >= cap) len = cap - 1;
+    memcpy(buf, imp->name, len);
+    buf[len] = '\0';
+}
+
+// Lex the whole file into a token buffer, then parse it into ast_arena.
+static DeclList *parse_module_source(Arena *ast_arena, const char *source) {
+    TokenBuffer tokens = lexer_tokenize(source);
+    Parser  parser = {
+      .tokens = &tokens,
+      .line   = 1,
+      .column = 1
+    };
+    _parser_advance(&parser); // Fetch first token (and normalize NEWLINE -> EOL)
+    DeclList *decls = parse_module(ast_arena, &parser);
+    token_buffer_free(&tokens);  // AST Ids point into f.contents, not the buffer
+    return decls;
+}
+
+/*──────────────────────────────────────────────────────────────────╗
+│ Parallel front end (-j N).
+│
+│ Modules only depend on each other through the splice in load_module, so
+│ they can be read and parsed independently. A worker pool pops a module
+│ off a shared queue, parses it into the worker's own AST arena, and pushes
+│ every import it has not seen yet; the pool is done when the queue is
+│ empty and no worker is busy. load_module then runs exactly as in the
+│ serial build, but takes each module's decls from this prefetch instead of
+│ parsing, so the splice order (and the emitted C) is unchanged.
+│
+│ A worker parses with its module's ParseCapture armed (parser/core.h):
+│ a parse error is buffered and ends only that module. load_module prints
+│ it and exits when it reaches the module, so with several bad modules the
+│ one reported is the first in import order, as in the serial build.
+╚──────────────────────────────────────────────────────────────────*/
+typedef struct ParsedModule {
+    const char          *name;     // atom of the module path
+    char                 path[256];
+    File                 file;     // contents NULL = the file could not be opened
+    DeclList            *decls;
+    ParseCapture         errors;   // diagnostics; errors.failed = parse error
+    struct ParsedModule *next;     // work queue link
+} ParsedModule;
+
+typedef struct ModulePrefetch {
+    AtomMap       modules;         // module name atom → ParsedModule
+    ParsedModule *queue;
+    int           busy;            // workers currently parsing a module
+#if OS_LINUX
+    pthread_mutex_t lock;
+    pthread_cond_t  changed;
+#endif
+} ModulePrefetch;
+
+typedef struct ModuleWorker {
+    ModulePrefetch *prefetch;
+    Arena           file_arena;
+    Arena           ast_arena;
+} ModuleWorker;
+
+// Caller holds prefetch->lock (or runs single-threaded).
+static void _prefetch_enqueue(ModulePrefetch *pf, Arena *arena, const char *modname) {
+    const char *name = atom_intern(modname, (isize)strlen(modname));
+    if (atom_map_get(&pf->modules, name, NULL)) return;
+    ParsedModule *pm = arena_push_aligned(arena, ParsedModule);
+    memset(pm, 0, sizeof *pm);
+    pm->name = name;
+    module_name_to_path(modname, pm->path, sizeof pm->path);
+    atom_map_put(&pf->modules, name, NULL, pm);
+    pm->next = pf->queue;
+    pf->queue = pm;
+}
+
+#if OS_LINUX
+static void *_prefetch_worker(void *arg) {
+    ModuleWorker   *w  = arg;
+    ModulePrefetch *pf = w->prefetch;
+    pthread_mutex_lock(&pf->lock);
+    for (;;) {
+        while (!pf->queue && pf->busy > 0)
+            pthread_cond_wait(&pf->changed, &pf->lock);
+        if (!pf->queue) break;
+        ParsedModule *pm = pf->queue;
+        pf->queue = pm->next;
+        pf->busy++;
+        pthread_mutex_unlock(&pf->lock);
+
+        pm->file = file_load_source(&w->file_arena, pm->path);
+        if (pm->file.contents) {
+            parse_capture = &pm->errors;
+            if (setjmp(pm->errors.bail) == 0)
+                pm->decls = parse_module_source(&w->ast_arena, pm->file.contents);
+            parse_capture = NULL;
+        }
+
+        pthread_mutex_lock(&pf->lock);
+        for (DeclList *dl = pm->decls; dl; dl = dl->next) {
+            if (dl->decl->kind != DECL_IMPORT) continue;
+            char buf[256];
+            import_module_name(dl->decl, buf, sizeof buf);
+            _prefetch_enqueue(pf, &w->ast_arena, buf);
+        }
+        pf->busy--;
+        pthread_cond_broadcast(&pf->changed);
+    }
+    pthread_mutex_unlock(&pf->lock);
+    return NULL;
+}
+#endif
+
+// Parse `modname` and everything it imports, transitively, on `jobs` threads.
+static void module_prefetch(ModulePrefetch *pf, Arena *ast_arena, const char *modname, int jobs) {
+#if OS_LINUX
+    memset(pf, 0, sizeof *pf);
+    pthread_mutex_init(&pf->lock, NULL);
+    pthread_cond_init(&pf->changed, NULL);
+    _prefetch_enqueue(pf, ast_arena, modname);
+
+    ModuleWorker *workers = calloc((size_t)jobs, sizeof *workers);
+    pthread_t    *threads = calloc((size_t)jobs, sizeof *threads);
+    if (!workers || !threads) {
+        fprintf(stderr, "Error: out of memory starting %d parser threads\n", jobs);
+        exit(1);
+    }
+    g_intern_threaded = true;
+    for (int i = 0; i < jobs; i++) {
+        // Worker arenas are never released: the ASTs built in them live
+        // until the compiler exits, like the main ast_arena.
+        workers[i].prefetch   = pf;
+        workers[i].file_arena = arena_reserve(ARENA_RESERVE_DEFAULT);
+        workers[i].ast_arena  = arena_reserve(ARENA_RESERVE_DEFAULT);
+        if (pthread_create(&threads[i], NULL, _prefetch_worker, &workers[i]) != 0) {
+            fprintf(stderr, "Error: cannot start parser thread %d\n", i);
+            exit(1);
+        }
+    }
+    for (int i = 0; i < jobs; i++) pthread_join(threads[i], NULL);
+    g_intern_threaded = false;
+
+    pthread_cond_destroy(&pf->changed);
+    pthread_mutex_destroy(&pf->lock);
+    free(threads);
+    // `workers` holds the arena handles; keep it for the same reason.
+#else
+    (void)ast_arena; (void)modname; (void)jobs;
+    memset(pf, 0, sizeof *pf);
+#endif
+}
+
 /// Load (and splice) a module into the AST‐arena.
-///   file_arena: used only for reading files,
+///   file_arena: fallback storage for sources that cannot be mapped,
 ///   ast_arena:  used only for building AST nodes.
-static DeclList* load_module(Arena *file_arena,
-                             Arena *ast_arena,
-                             const char *modname)
+///   prefetch:   modules already parsed by module_prefetch, or NULL to parse
+///               each module here.
+static DeclList* _load_module(Arena *file_arena,
+                              Arena *ast_arena,
+                              const char *modname,
+                              ModulePrefetch *prefetch)
 {
     if (module_already_loaded(modname)) {
         return NULL;
     }
+    prof_enter(PASS_LOAD_MODULE);
+
+    ParsedModule *pre = prefetch
+        ? atom_map_get(&prefetch->modules, atom_find(modname, (isize)strlen(modname)), NULL)
+        : NULL;
 
     // 1) build the filesystem path
     char path[256];
     module_name_to_path(modname, path, sizeof path);
 
-    // 2) read the file into file_arena
-    File f = file_read_into_arena(file_arena, path);
+    // 2) map the file (zero-padded, no copy); file_arena is only the fallback
+    File f = pre ? pre->file : file_load_source(file_arena, path);
     if (!f.contents) {
         fprintf(stderr, "Error: Cannot open module file '%s'\n", path);
         exit(1);
     }
+    prof_count_source(f.contents, f.size);
 
     // 3) lex + parse into ast_arena
-    Lexer   lex    = lexer_new(f.contents);
-    Parser  parser = {
-      .lexer  = &lex,
-      .line   = 1,
-      .column = 1
-    };
-    _parser_advance(&parser); // Fetch first token (and normalize NEWLINE -> EOL)
-    DeclList *decls = parse_module(ast_arena, &parser);
+    if (pre && pre->errors.diag.text)
+        fputs(pre->errors.diag.text, stderr);
+    if (pre && pre->errors.failed)
+        exit(1);
+    DeclList *decls = pre ? pre->decls : parse_module_source(ast_arena, f.contents);
 
     // Q-018: tag every decl with its defining module path (for cross-module
     // visibility checks). Use a stable copy of `modname` in ast_arena.
@@ -201,32 +337,28 @@ static DeclList* load_module(Arena *file_arena,
     DeclList *prev = NULL, *cur = decls;
     while (cur) {
         if (cur->decl->kind == DECL_IMPORT) {
-            Id *imp       = cur->decl->as.import_decl.module_name;
-            size_t len    = imp->length;
             char buf[256];
-            if (len >= sizeof buf) len = sizeof buf - 1;
-            memcpy(buf, imp->name, len);
-            buf[len] = '\0';
+            import_module_name(cur->decl, buf, sizeof buf);
 
             // Register the access qualifier: the alias, else the path's last
             // segment (`std.math` → `math`). Enables `qualifier.Member` access
             // (the glob still binds bare names, so this is additive).
             Id *alias = cur->decl->as.import_decl.alias;
             if (alias) {
-                register_qualifier(ast_arena, alias->name, (size_t)alias->length);
+                register_qualifier(alias->name, (size_t)alias->length);
             } else {
                 const char *seg = buf; size_t seglen = strlen(buf);
                 const char *dot = strrchr(buf, '.');
                 if (dot) { seg = dot + 1; seglen = strlen(dot + 1); }
-                register_qualifier(ast_arena, seg, seglen);
+                register_qualifier(seg, seglen);
             }
             // Selective imports: `import M.{a, b}` brings a, b unqualified into
             // the importing module (`modname`).
             for (IdList *sn = cur->decl->as.import_decl.selected; sn; sn = sn->next)
-                register_sel_import(ast_arena, modname, sn->id);
+                register_sel_import(modname, sn->id);
 
             // recurse
-            DeclList *child = load_module(file_arena, ast_arena, buf);
+            DeclList *child = _load_module(file_arena, ast_arena, buf, prefetch);
             if (child) {
                 // splice child in place of this import
                 DeclList *end = child;
@@ -248,6 +380,27 @@ static DeclList* load_module(Arena *file_arena,
     // 5) refresh the record's decls head (splicing above may have changed it)
     //    and return. The module was already registered before the import loop.
     self->decls = decls;
+    prof_leave();
+    return decls;
+}
+
+static DeclList* load_module(Arena *file_arena, Arena *ast_arena, const char *modname) {
+    return _load_module(file_arena, ast_arena, modname, NULL);
+}
+
+// load_module with lexing and parsing spread over `jobs` threads (-j).
+static DeclList* load_module_parallel(Arena *file_arena, Arena *ast_arena,
+                                      const char *modname, int jobs) {
+#if !OS_LINUX
+    jobs = 1;   // no thread pool on this platform
+#endif
+    if (jobs <= 1) return load_module(file_arena, ast_arena, modname);
+    ModulePrefetch prefetch;
+    prof_enter(PASS_LOAD_MODULE);
+    module_prefetch(&prefetch, ast_arena, modname, jobs);
+    DeclList *decls = _load_module(file_arena, ast_arena, modname, &prefetch);
+    prof_leave();
+    free(prefetch.modules.slots);
     return decls;
 }
 
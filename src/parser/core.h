@@ -2,11 +2,48 @@
 #define PARSER_CORE_H
 
 #include <errno.h>
+#include <setjmp.h>
+#include <stdarg.h>
 #include <stdlib.h>
 #include "../parser.h"
+#include "../utils/diag.h"
+
+/*
+  Parse diagnostics go through parser_diag()/parser_fatal() instead of
+  stderr/exit. A -j parser thread (module.h) points parse_capture at its
+  module's ParseCapture: diagnostics are buffered there and a fatal error
+  longjmps back to the worker, so the main thread can report the failing
+  modules in import order rather than whichever thread failed first.
+*/
+typedef struct ParseCapture {
+    DiagBuffer diag;      // buffered diagnostics
+    bool       failed;    // parser_fatal() was reached
+    jmp_buf    bail;
+} ParseCapture;
+
+static _thread_local ParseCapture *parse_capture = NULL;
+
+static void parser_diag(const char *fmt, ...) {
+    va_list ap;
+    va_start(ap, fmt);
+    if (parse_capture) diag_buffer_vprintf(&parse_capture->diag, fmt, ap);
+    else               vfprintf(stderr, fmt, ap);
+    va_end(ap);
+}
+
+// A fatal parse error was reported: stop this module (worker), or the
+// compilation.
+static _noreturn void parser_fatal(void) {
+    if (parse_capture) {
+        parse_capture->failed = true;
+        longjmp(parse_capture->bail, 1);
+    }
+    exit(1);
+}
 
 typedef struct Parser {
-    Lexer *lexer;
+    const TokenBuffer *tokens;  // whole-module token stream (lexer_tokenize)
+    isize  cursor;              // index of the next raw token in `tokens`
     Token  token;
     isize  line;
     isize  column;
@@ -17,6 +54,12 @@ Token   _parser_advance(Parser *parser);
 void    _parser_expect(Parser *parser, bool expr, const char *msg);
 int     get_precedence(TokenKind op);
 
+// Kind of the raw token `ahead` positions past the current one (0 = the very
+// next token). Raw means un-normalized: comments and NEWLINE are visible here.
+static inline TokenKind parser_peek_kind(Parser *parser, isize ahead) {
+    return token_buffer_kind(parser->tokens, parser->cursor + ahead);
+}
+
 // helper to parse dotted paths in calls/use
 Expr *parse_path_expr(Arena *arena, Parser *parser);
 
@@ -39,7 +82,7 @@ Expr *parse_path_expr(Arena *arena, Parser *parser);
 Token _parser_advance(Parser* parser) {
     // keep pulling tokens until it's not a comment
     do {
-        parser->token = lexer_next(parser->lexer);
+        parser->token = token_buffer_get(parser->tokens, parser->cursor++);
         // Block comments may span multiple lines — count their internal newlines
         // so that subsequent tokens get the correct line number.
         if (parser->token.kind == TOKEN_MULTILINE_COMMENT) {
@@ -80,14 +123,14 @@ Token _parser_advance(Parser* parser) {
 
 
 void _parser_error(Parser* parser, const char *error_message) {
-    fprintf(stderr, "[E100] Error Ln %li, Col %li: %s\n", parser->line, parser->column, error_message);
-    exit(1);
+    parser_diag("[E100] Error Ln %li, Col %li: %s\n", parser->line, parser->column, error_message);
+    parser_fatal();
 }
 
 void _parser_expect(Parser* parser, bool expr, const char *error_message) {
     if (expr) {
-        fprintf(stderr, "[E100] Error Ln %li, Col %li: %s\n", parser->line, parser->column, error_message);
-        exit(1);
+        parser_diag("[E100] Error Ln %li, Col %li: %s\n", parser->line, parser->column, error_message);
+        parser_fatal();
     }
 }
 
@@ -226,9 +269,9 @@ static long long parse_numeric_literal(const char *start, long length) {
     errno = 0;
     long long value = strtoll(buf, NULL, 10);
     if (truncated || errno == ERANGE) {
-        fprintf(stderr, "[E086] Error: integer literal '%.*s' is too large to fit "
-                "in a signed 64-bit integer.\n", (int)length, start);
-        exit(1);
+        parser_diag("[E086] Error: integer literal '%.*s' is too large to fit "
+                    "in a signed 64-bit integer.\n", (int)length, start);
+        parser_fatal();
     }
     return value;
 }
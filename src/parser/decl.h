@@ -25,6 +25,7 @@ static bool is_known_attribute(const char *name, isize len) {
     if (len == 9 && strncmp(name, "fast_math", 9) == 0) return true;
     if (len == 7 && strncmp(name, "private",   7) == 0) return true;
     if (len == 6 && strncmp(name, "packed",    6) == 0) return true;
+    if (len == 6 && strncmp(name, "export",    6) == 0) return true;
     return false;
 }
 
@@ -33,14 +34,15 @@ static bool is_known_attribute(const char *name, isize len) {
 static Attr *parse_attributes(Arena *arena, Parser *parser, bool *out_is_private) {
     Attr *head = NULL;
     Attr **tail = &head;
+    bool saw_export = false;
     *out_is_private = false;
 
     while (parser_match(TOKEN_L_BRACKET)) {
         parser_advance(); // consume '['
 
         if (!parser_match(TOKEN_IDENTIFIER)) {
-            fprintf(stderr, "[E102] Error Ln %li, Col %li: expected attribute name after '['\n",
-                    parser->line, parser->column);
+            parser_diag("[E102] Error Ln %li, Col %li: expected attribute name after '['\n",
+                        parser->line, parser->column);
             return head;
         }
 
@@ -49,9 +51,9 @@ static Attr *parse_attributes(Arena *arena, Parser *parser, bool *out_is_private
 
         // Validate against whitelist
         if (!is_known_attribute(name->name, name->length)) {
-            fprintf(stderr, "[E103] Error Ln %li, Col %li: unknown attribute '%.*s' (known: fast_math, private)\n",
-                    parser->line, parser->column, (int)name->length, name->name);
-            exit(1);
+            parser_diag("[E103] Error Ln %li, Col %li: unknown attribute '%.*s' (known: fast_math, private, export)\n",
+                        parser->line, parser->column, (int)name->length, name->name);
+            parser_fatal();
         }
 
         // Optional args: [name(arg1, arg2, ...)]
@@ -80,6 +82,14 @@ static Attr *parse_attributes(Arena *arena, Parser *parser, bool *out_is_private
         if (name->length == 7 && strncmp(name->name, "private", 7) == 0) {
             *out_is_private = true;
         }
+        if (name->length == 6 && strncmp(name->name, "export", 6) == 0) {
+            saw_export = true;
+        }
+        if (saw_export && *out_is_private) {
+            parser_diag("[E107] Error Ln %li, Col %li: a declaration cannot be both [export] and [private]\n",
+                        parser->line, parser->column);
+            parser_fatal();
+        }
 
         // Append to list
         Attr *a = arena_push_aligned(arena, Attr);
@@ -135,9 +145,9 @@ DeclList *parse_module(Arena* arena, Parser* parser) {
         Decl* decl = parse_decl(arena, parser);
         if (!decl) {
             const char *tname = token_kind_name(parser->token.kind);
-            fprintf(stderr, "[E100] Error Ln %li, Col %li: Unexpected token at top level: %s\n",
-                    parser->line, parser->column,
-                    tname ? tname : "UNKNOWN_TOKEN");
+            parser_diag("[E100] Error Ln %li, Col %li: Unexpected token at top level: %s\n",
+                        parser->line, parser->column,
+                        tname ? tname : "UNKNOWN_TOKEN");
             parser_advance(); // consume to avoid infinite loop
             had_top_level_error = true;
             continue;         // keep reporting further top-level errors...
@@ -152,7 +162,7 @@ DeclList *parse_module(Arena* arena, Parser* parser) {
     // ...but a top-level parse error is fatal: never proceed to sema/emit with a
     // partial AST and exit 0 (that silently "compiled" a file full of errors).
     if (had_top_level_error) {
-        exit(1);
+        parser_fatal();
     }
 
     return list;
@@ -186,6 +196,7 @@ Decl *parse_decl(Arena* arena, Parser* parser)
     // Q-017: parse leading attributes [name] / [name(args)]
     bool is_private = false;
     Attr *attrs = NULL;
+    isize attrs_line = parser->line, attrs_column = parser->column;
     if (parser_match(TOKEN_L_BRACKET)) {
         attrs = parse_attributes(arena, parser, &is_private);
         parser_skip_eol();
@@ -298,6 +309,13 @@ done:
     if (d) {
         d->attributes = attrs;
         d->is_private = is_private;
+        // [export] controls linkage of a defined function; nothing else has any.
+        if (d->kind != DECL_FUNCTION && d->kind != DECL_PROCEDURE
+            && decl_has_attribute(d, "export", 6)) {
+            parser_diag("[E103] Error Ln %li, Col %li: attribute 'export' applies only to func and proc declarations\n",
+                        attrs_line, attrs_column);
+            parser_fatal();
+        }
         // Q-002 Sprint 19: propagate [packed] to struct decl.
         if (d->kind == DECL_STRUCT && decl_has_attribute(d, "packed", 6)) {
             // covered below via the attribute walk
@@ -563,10 +581,9 @@ Decl* parse_type_decl(Arena* arena, Parser* parser) {
         // Snapshot parser state, try parsing a base type identifier followed by
         // a comparison operator. If matched, parse constraints; otherwise restore
         // and parse a normal expression.
-        const char *snap_cur = parser->lexer ? parser->lexer->current : NULL;
+        isize snap_cursor = parser->cursor;
         Token snap_tok = parser->token;
         long snap_line = parser->line, snap_col = parser->column;
-        (void)snap_cur;
 
         ExprList *type_alias_constraints = NULL;
         Expr *base_type_expr = NULL;
@@ -613,7 +630,7 @@ Decl* parse_type_decl(Arena* arena, Parser* parser) {
                 parser->token = snap_tok;
                 parser->line = snap_line;
                 parser->column = snap_col;
-                if (parser->lexer) parser->lexer->current = (char*)snap_cur;
+                parser->cursor = snap_cursor;
             }
         }
 
@@ -943,7 +960,7 @@ Decl *parse_extern_func_proc_decl_impl(Arena *arena, Parser *parser, bool is_pro
                  break;
             }
             // Backward compatibility: "..." manually written as ".. ."
-            if (parser_match(TOKEN_DOT_DOT) && lexer_peek(parser->lexer).kind == TOKEN_DOT) {
+            if (parser_match(TOKEN_DOT_DOT) && parser_peek_kind(parser, 0) == TOKEN_DOT) {
                  // consume ".." then "."
                  parser_advance(); 
                  parser_advance();
@@ -159,8 +159,8 @@ Expr *parse_primary_expr(Arena* arena, Parser* parser)
         }
         
         if (pending_count > 0) {
-            fprintf(stderr, "Error Ln %li, Col %li: match patterns with no body at end of block\n", parser->line, parser->column);
-            exit(1);
+            parser_diag("Error Ln %li, Col %li: match patterns with no body at end of block\n", parser->line, parser->column);
+            parser_fatal();
         }
         
         parser_expect(TOKEN_R_BRACE, "Expected '}' after case expression block");
@@ -520,20 +520,20 @@ Expr *parse_primary_expr(Arena* arena, Parser* parser)
             parser_advance(); // consume ')'
             return expr_builtin_arg(arena, bk, arg);
         } else {
-            fprintf(stderr, "Error Ln %li, Col %li: Unknown builtin '@%.*s'\n",
-                    parser->line, parser->column, (int)len, name);
-            exit(1);
+            parser_diag("Error Ln %li, Col %li: Unknown builtin '@%.*s'\n",
+                        parser->line, parser->column, (int)len, name);
+            parser_fatal();
         }
     }
 
     {
         const char *tname = token_kind_name(parser->token.kind);
-        fprintf(stderr, "[E100] Error Ln %li, Col %li: Unexpected token in expression: %s (%d)\n",
-                parser->line, parser->column,
-                tname ? tname : "UNKNOWN_TOKEN",
-                parser->token.kind);
+        parser_diag("[E100] Error Ln %li, Col %li: Unexpected token in expression: %s (%d)\n",
+                    parser->line, parser->column,
+                    tname ? tname : "UNKNOWN_TOKEN",
+                    parser->token.kind);
     }
-    exit(1);
+    parser_fatal();
     return NULL;
 }
 
@@ -673,54 +673,54 @@ Stmt *parse_match_stmt(Arena *arena, Parser *parser) {
             || cur == TOKEN_IDENTIFIER
             || cur == TOKEN_KEYWORD_ELSE)
             {
-                // fork the lexer so we don't consume anything
-                Lexer fork = *parser->lexer;
-                Token t1 = lexer_next(&fork);
+                // look ahead in the token buffer without consuming anything
+                isize la = 0;
+                TokenKind t1 = parser_peek_kind(parser, la++);
 
                 // Handle qualified names: Enum.Variant :
-                while (t1.kind == TOKEN_DOT) {
-                     Token t2 = lexer_next(&fork);
-                     if (t2.kind == TOKEN_IDENTIFIER) {
-                         t1 = lexer_next(&fork);
+                while (t1 == TOKEN_DOT) {
+                     TokenKind t2 = parser_peek_kind(parser, la++);
+                     if (t2 == TOKEN_IDENTIFIER) {
+                         t1 = parser_peek_kind(parser, la++);
                      } else {
                          break;
                      }
                 }
 
-                if (t1.kind == TOKEN_COLON || t1.kind == TOKEN_COMMA) {
+                if (t1 == TOKEN_COLON || t1 == TOKEN_COMMA) {
                     // single‐value header: X : or X , Y :
                     stop_for_header = true;
                 }
-                else if (t1.kind == TOKEN_DOT_DOT
-                    || t1.kind == TOKEN_DOT_DOT_EQUAL)
+                else if (t1 == TOKEN_DOT_DOT
+                    || t1 == TOKEN_DOT_DOT_EQUAL)
                 {
                     // maybe a range: X .. Y :
-                    Token t2 = lexer_next(&fork);
-                    if (t2.kind == TOKEN_CHAR_LITERAL
-                    || t2.kind == TOKEN_STRING_LITERAL
-                    || t2.kind == TOKEN_IDENTIFIER
-                    || t2.kind == TOKEN_NUMBER)
+                    TokenKind t2 = parser_peek_kind(parser, la++);
+                    if (t2 == TOKEN_CHAR_LITERAL
+                    || t2 == TOKEN_STRING_LITERAL
+                    || t2 == TOKEN_IDENTIFIER
+                    || t2 == TOKEN_NUMBER)
                     {
-                        Token t3 = lexer_next(&fork);
-                        if (t3.kind == TOKEN_COLON || t3.kind == TOKEN_COMMA) {
+                        TokenKind t3 = parser_peek_kind(parser, la++);
+                        if (t3 == TOKEN_COLON || t3 == TOKEN_COMMA) {
                             stop_for_header = true;
                         }
                     }
                 }
-                else if (t1.kind == TOKEN_L_PAREN) {
+                else if (t1 == TOKEN_L_PAREN) {
                     // Constructor pattern: Variant(...) :
                     // We need to skip balanced parens
                     int depth = 1;
                     while (depth > 0) {
-                        Token t = lexer_next(&fork);
-                        if (t.kind == TOKEN_EOF) break;
-                        if (t.kind == TOKEN_L_PAREN) depth++;
-                        else if (t.kind == TOKEN_R_PAREN) depth--;
+                        TokenKind t = parser_peek_kind(parser, la++);
+                        if (t == TOKEN_EOF) break;
+                        if (t == TOKEN_L_PAREN) depth++;
+                        else if (t == TOKEN_R_PAREN) depth--;
                     }
                     
                     if (depth == 0) {
-                        Token t_after = lexer_next(&fork);
-                        if (t_after.kind == TOKEN_COLON || t_after.kind == TOKEN_COMMA) {
+                        TokenKind t_after = parser_peek_kind(parser, la++);
+                        if (t_after == TOKEN_COLON || t_after == TOKEN_COMMA) {
                             stop_for_header = true;
                         }
                     }
@@ -758,8 +758,8 @@ Stmt *parse_match_stmt(Arena *arena, Parser *parser) {
 
     if (pending_count > 0) {
         // trailing patterns with no body → error
-        fprintf(stderr, "Error: match patterns with no body at end of block\n");
-        exit(1);
+        parser_diag("Error: match patterns with no body at end of block\n");
+        parser_fatal();
     }
 
     parser_expect(TOKEN_R_BRACE, "Expected '}' after match block");
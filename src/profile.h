@@ -0,0 +1,293 @@
+#ifndef PROFILE_H
+#define PROFILE_H
+
+/*
+   Compile-time profiling for --time-passes / --stats.
+
+   The compiler is split into passes (load_module, sema_build_scope, resolve,
+   infer, linearity, vra, niche, emit). A pass is entered with prof_enter()
+   and left with prof_leave(); passes nest (the VRA prover runs inside the
+   infer walk, niche layout inside emit), and each one is charged only its
+   SELF time and how far the arenas' high-water marks rose while it was
+   innermost, so the rows add up to the total. High-water marks never go
+   down, so a pass that rewinds a scratch arena is charged what it peaked
+   at, not a negative delta.
+
+   While sema or emit is working on one function, prof_function_begin() makes
+   it the current function and the same self time is also added to its row;
+   the report lists the slowest functions with their split across passes.
+
+   Everything is a no-op until prof_init() enables it, so the hooks stay in
+   the hot paths at the cost of one branch.
+*/
+
+#include "utils/common/libc.h"
+#include "utils/arena.h"
+#include "intern.h"
+#include "ast.h"
+
+typedef enum {
+    PASS_LOAD_MODULE,
+    PASS_BUILD_SCOPE,
+    PASS_RESOLVE,
+    PASS_INFER,
+    PASS_LINEARITY,
+    PASS_VRA,
+    PASS_NICHE,
+    PASS_EMIT,
+    PASS_COUNT
+} Pass;
+
+static const char *pass_names[PASS_COUNT] = {
+    "load_module",
+    "sema_build_scope",
+    "resolve",
+    "infer",
+    "linearity",
+    "vra",
+    "niche",
+    "emit",
+};
+
+#define PROF_STACK_MAX   64
+#define PROF_MAX_ARENAS  4
+
+typedef struct {
+    uint64_t ns;
+    isize    bytes;
+    uint64_t calls;
+} PassTotals;
+
+typedef struct {
+    const char *name;              // atom
+    const char *module;            // atom of the defining module, or NULL
+    uint64_t    ns[PASS_COUNT];
+    uint64_t    total_ns;
+} FunctionProfile;
+
+typedef struct {
+    Pass  pass;
+    int   repeat;                  // re-entries of the same pass (recursion)
+} ProfFrame;
+
+typedef struct {
+    bool        enabled;
+    bool        time_passes;
+    bool        stats;
+    int         top_n;
+
+    Arena      *arenas[PROF_MAX_ARENAS];
+    const char *arena_names[PROF_MAX_ARENAS];
+    int         arena_count;
+
+    ProfFrame   stack[PROF_STACK_MAX];
+    int         depth;
+    uint64_t    mark_ns;           // start of the current self-time slice
+    isize       mark_bytes;
+    uint64_t    start_ns;
+
+    PassTotals  totals[PASS_COUNT];
+
+    FunctionProfile *fns;
+    isize       fn_count;
+    isize       fn_capacity;
+    AtomMap     fn_index;          // (name, module) atoms → index + 1
+    isize       current_fn;        // -1 = none
+
+    // --stats counters
+    isize       modules;
+    isize       source_bytes;
+    isize       source_lines;
+} Profiler;
+
+static Profiler prof = { .current_fn = -1 };
+
+static inline uint64_t prof_now_ns(void) {
+#if OS_WINDOWS
+    LARGE_INTEGER freq, now;
+    QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&now);
+    return (uint64_t)((double)now.QuadPart * 1e9 / (double)freq.QuadPart);
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+static isize prof_arena_bytes(void) {
+    isize bytes = 0;
+    for (int i = 0; i < prof.arena_count; i++)
+        bytes += arena_high_water(prof.arenas[i]);
+    return bytes;
+}
+
+static void prof_init(bool time_passes, bool stats, int top_n) {
+    prof.enabled     = time_passes || stats;
+    prof.time_passes = time_passes;
+    prof.stats       = stats;
+    prof.top_n       = top_n;
+    prof.start_ns    = prof_now_ns();
+    prof.mark_ns     = prof.start_ns;
+}
+
+// Count `arena` in the per-pass byte column (and in the --stats summary).
+static void prof_watch_arena(const char *name, Arena *arena) {
+    if (prof.arena_count == PROF_MAX_ARENAS) return;
+    prof.arena_names[prof.arena_count] = name;
+    prof.arenas[prof.arena_count++] = arena;
+    prof.mark_bytes = prof_arena_bytes();
+}
+
+// Close the current self-time slice and charge it to the innermost pass.
+static void _prof_charge(void) {
+    uint64_t now   = prof_now_ns();
+    isize    bytes = prof_arena_bytes();
+    if (prof.depth > 0) {
+        Pass p = prof.stack[prof.depth - 1].pass;
+        prof.totals[p].ns    += now - prof.mark_ns;
+        prof.totals[p].bytes += bytes - prof.mark_bytes;
+        if (prof.current_fn >= 0) {
+            FunctionProfile *f = &prof.fns[prof.current_fn];
+            f->ns[p]    += now - prof.mark_ns;
+            f->total_ns += now - prof.mark_ns;
+        }
+    }
+    prof.mark_ns    = now;
+    prof.mark_bytes = bytes;
+}
+
+static void prof_enter(Pass p) {
+    if (!prof.enabled) return;
+    prof.totals[p].calls++;
+    if (prof.depth > 0 && prof.stack[prof.depth - 1].pass == p) {
+        prof.stack[prof.depth - 1].repeat++;
+        return;
+    }
+    _prof_charge();
+    if (prof.depth == PROF_STACK_MAX) {
+        fprintf(stderr, "Error: --time-passes: pass nesting deeper than %d\n", PROF_STACK_MAX);
+        exit(1);
+    }
+    prof.stack[prof.depth].pass = p;
+    prof.stack[prof.depth].repeat = 0;
+    prof.depth++;
+}
+
+static void prof_leave(void) {
+    if (!prof.enabled || prof.depth == 0) return;
+    if (prof.stack[prof.depth - 1].repeat > 0) {
+        prof.stack[prof.depth - 1].repeat--;
+        return;
+    }
+    _prof_charge();
+    prof.depth--;
+}
+
+// Make `fn` the function the following self time is also charged to. The
+// same function seen again (sema, then emit) reuses its row.
+static void prof_function_begin(Decl *fn) {
+    if (!prof.enabled || !fn || !fn->as.function_decl.name) return;
+    _prof_charge();
+    Id *name = fn->as.function_decl.name;
+    const char *module = fn->defining_module
+        ? atom_intern(fn->defining_module, (isize)strlen(fn->defining_module)) : NULL;
+    isize slot = (isize)(uintptr_t)atom_map_get(&prof.fn_index, name->atom, module);
+    if (slot == 0) {
+        if (prof.fn_count == prof.fn_capacity) {
+            prof.fn_capacity = prof.fn_capacity ? prof.fn_capacity * 2 : 256;
+            prof.fns = realloc(prof.fns, (size_t)prof.fn_capacity * sizeof *prof.fns);
+            if (!prof.fns) {
+                fprintf(stderr, "Error: out of memory recording function profiles\n");
+                exit(1);
+            }
+        }
+        FunctionProfile *f = &prof.fns[prof.fn_count++];
+        memset(f, 0, sizeof *f);
+        f->name = name->atom;
+        f->module = module;
+        slot = prof.fn_count;
+        atom_map_put(&prof.fn_index, name->atom, module, (void *)(uintptr_t)slot);
+    }
+    prof.current_fn = slot - 1;
+}
+
+static void prof_function_end(void) {
+    if (!prof.enabled) return;
+    _prof_charge();
+    prof.current_fn = -1;
+}
+
+static void prof_count_source(const char *text, isize length) {
+    if (!prof.enabled || !text) return;
+    prof.modules++;
+    prof.source_bytes += length;
+    for (const char *p = text, *end = text + length;
+         (p = memchr(p, '\n', (size_t)(end - p))) != NULL; p++)
+        prof.source_lines++;
+}
+
+static int _prof_cmp_fn(const void *a, const void *b) {
+    const FunctionProfile *fa = a, *fb = b;
+    if (fa->total_ns != fb->total_ns) return fa->total_ns < fb->total_ns ? 1 : -1;
+    return strcmp(fa->name, fb->name);
+}
+
+static double prof_ms(uint64_t ns) { return (double)ns / 1e6; }
+
+// Print the tables to stderr. Passes with no calls are left out.
+static void prof_report(void) {
+    if (!prof.enabled) return;
+    _prof_charge();
+    uint64_t wall = prof_now_ns() - prof.start_ns;
+    uint64_t in_passes = 0;
+    for (int p = 0; p < PASS_COUNT; p++) in_passes += prof.totals[p].ns;
+
+    fprintf(stderr, "===-------------------------------------------------------------------===\n");
+    fprintf(stderr, "  %-18s %10s %7s %10s %12s\n", "pass", "wall ms", "%", "calls", "peak KiB");
+    for (int p = 0; p < PASS_COUNT; p++) {
+        PassTotals *t = &prof.totals[p];
+        if (!t->calls) continue;
+        fprintf(stderr, "  %-18s %10.3f %6.1f%% %10llu %12.1f\n", pass_names[p],
+                prof_ms(t->ns), wall ? 100.0 * (double)t->ns / (double)wall : 0.0,
+                (unsigned long long)t->calls, (double)t->bytes / 1024.0);
+    }
+    fprintf(stderr, "  %-18s %10.3f\n", "(outside passes)", prof_ms(wall - in_passes));
+    fprintf(stderr, "  %-18s %10.3f\n", "total", prof_ms(wall));
+
+    if (prof.time_passes && prof.fn_count > 0 && prof.top_n > 0) {
+        qsort(prof.fns, (size_t)prof.fn_count, sizeof *prof.fns, _prof_cmp_fn);
+        isize n = prof.fn_count < prof.top_n ? prof.fn_count : prof.top_n;
+        fprintf(stderr, "\n  slowest %ld of %ld functions (ms):\n", (long)n, (long)prof.fn_count);
+        fprintf(stderr, "  %10s %9s %9s %9s %9s %9s %9s  %s\n",
+                "total", "resolve", "infer", "linearity", "vra", "niche", "emit", "function");
+        for (isize i = 0; i < n; i++) {
+            FunctionProfile *f = &prof.fns[i];
+            fprintf(stderr, "  %10.3f %9.3f %9.3f %9.3f %9.3f %9.3f %9.3f  %s%s%s\n",
+                    prof_ms(f->total_ns), prof_ms(f->ns[PASS_RESOLVE]), prof_ms(f->ns[PASS_INFER]),
+                    prof_ms(f->ns[PASS_LINEARITY]), prof_ms(f->ns[PASS_VRA]),
+                    prof_ms(f->ns[PASS_NICHE]), prof_ms(f->ns[PASS_EMIT]),
+                    f->module ? f->module : "", f->module ? "." : "", f->name);
+        }
+    }
+
+    if (prof.stats) {
+        fprintf(stderr, "\n  %-18s %10ld\n", "modules", (long)prof.modules);
+        fprintf(stderr, "  %-18s %10ld\n", "source lines", (long)prof.source_lines);
+        fprintf(stderr, "  %-18s %10.1f KiB\n", "source", (double)prof.source_bytes / 1024.0);
+        fprintf(stderr, "  %-18s %10ld\n", "functions", (long)prof.fn_count);
+        fprintf(stderr, "  %-18s %10ld\n", "interned names", (long)g_intern.count);
+        for (int i = 0; i < prof.arena_count; i++) {
+            Arena *a = prof.arenas[i];
+            fprintf(stderr, "  %-18s %10.1f KiB, peak %.1f KiB, committed %.1f KiB\n", prof.arena_names[i],
+                    (double)arena_used(a) / 1024.0, (double)arena_high_water(a) / 1024.0,
+                    (double)arena_committed(a) / 1024.0);
+        }
+        if (wall && prof.source_lines)
+            fprintf(stderr, "  %-18s %10.0f\n", "lines/sec",
+                    (double)prof.source_lines * 1e9 / (double)wall);
+    }
+    fprintf(stderr, "===-------------------------------------------------------------------===\n");
+}
+
+#endif // PROFILE_H
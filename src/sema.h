@@ -1,6 +1,8 @@
 #ifndef SEMA_H
 #define SEMA_H
 
+#include "sema/context.h"
+
 // Diagnostic globals (defined before sub-header includes so they can call diagnostic_show_line)
 const char *sema_source_text = NULL;
 const char *sema_source_file = NULL;
@@ -25,18 +27,18 @@ static void diagnostic_show_line(isize line, isize col) {
     int line_num_width = 1;
     { isize tmp = line; while (tmp >= 10) { line_num_width++; tmp /= 10; } }
 
-    fprintf(stderr, "  --> %s:%li:%li\n", sema_source_file, (long)line, (long)col);
-    fprintf(stderr, " %*s |\n", line_num_width, "");
-    fprintf(stderr, " %li | %.*s\n", (long)line, line_len, line_start);
-    fprintf(stderr, " %*s | ", line_num_width, "");
+    sema_diag("  --> %s:%li:%li\n", sema_source_file, (long)line, (long)col);
+    sema_diag(" %*s |\n", line_num_width, "");
+    sema_diag(" %li | %.*s\n", (long)line, line_len, line_start);
+    sema_diag(" %*s | ", line_num_width, "");
     isize caret_pos = (col > 0) ? col - 1 : 0;
     for (isize i = 0; i < caret_pos; i++) {
         if (i < line_len && line_start[i] == '\t')
-            fputc('\t', stderr);
+            sema_diag("%c", '\t');
         else
-            fputc(' ', stderr);
+            sema_diag("%c", ' ');
     }
-    fprintf(stderr, "^\n");
+    sema_diag("^\n");
 }
 
 // In-guard table (declared before sub-header includes so typecheck.h can use them)
@@ -48,8 +50,6 @@ typedef struct InGuardEntry {
     struct InGuardEntry *next;
 } InGuardEntry;
 
-static InGuardEntry *sema_in_guards = NULL;
-
 static bool expr_struct_equal(Expr *a, Expr *b); // defined later in sema.h
 static bool sema_is_affine_assign(Stmt *s, Id **out_var, long long *out_step); // defined below
 static void sema_push_in_guards(Expr *cond);
@@ -60,7 +60,6 @@ static bool sema_is_in_guarded(Expr *index, Expr *container);
 // in-guard mechanism — a scoped stack of variables proven present. Declared here
 // (before the sub-header includes) so check_conversion in typecheck.h can query it.
 typedef struct NarrowEntry { Expr *var; struct NarrowEntry *next; } NarrowEntry;
-static NarrowEntry *sema_narrows = NULL;
 static void sema_push_narrows(Expr *cond, bool negated);
 static bool sema_is_narrowed(Expr *e);
 
@@ -78,6 +77,9 @@ static void sema_union_coerce(Expr **slot, Type *target);
 // can narrow a proven-present union to its value type.
 static Type *union_payload_type(Type *t);
 
+// Defined in sema/typecheck.h; resolve.h types a range `for` counter with it.
+static bool is_integer_type(Type *t);
+
 // L3: pointer monotone table — pointers whose upper bound is dead inside while loops.
 // When p is monotone non-increasing and was initialized at a valid index into arr,
 // the upper-bound check `p < arr + arr_len` is always true → dead code in emit.
@@ -88,7 +90,6 @@ typedef struct PtrMonotoneEntry {
     bool unconditional;   // true if p = p-1 only at top level (not in if/else)
     struct PtrMonotoneEntry *next;
 } PtrMonotoneEntry;
-static PtrMonotoneEntry *sema_ptr_monotone = NULL;
 
 // L3 init-index table: records the initialization index for ptr in arr variables.
 typedef struct PtrInitIdxEntry {
@@ -96,7 +97,6 @@ typedef struct PtrInitIdxEntry {
     Expr *init_idx;   // the k in &arr[k]
     struct PtrInitIdxEntry *next;
 } PtrInitIdxEntry;
-static PtrInitIdxEntry *sema_ptr_init_idx = NULL;
 
 #include "sema/scope.h"
 #include "sema/resolve.h"
@@ -105,15 +105,7 @@ static PtrInitIdxEntry *sema_ptr_init_idx = NULL;
 #include "sema/linearity.h"
 #include "sema/niche.h"
 
-Type *current_return_type = NULL;
-Decl *current_function_decl = NULL;
-const char *current_module_path = NULL;
 DeclList *sema_decls = NULL;
-Arena *sema_arena = NULL;
-RangeTable *sema_ranges = NULL;
-bool sema_in_unsafe_block = false;
-bool sema_walk_phase = false;
-bool sema_addr_of_context = false; // set by EXPR_ADDR to relax &arr[len] in bounds check
 bool sema_dump_niche = false;      // set by main from args.dump_niche (D-Niche re-land)
 
 /*─────────────────────────────────────────────────────────────────╗
@@ -128,14 +120,8 @@ static Decl *find_union_enum(Type *t) {
     while (t->kind == TYPE_COMPTIME && t->element_type) t = t->element_type;
     if (t->kind == TYPE_UNION) t = mono_resolve_type_apps(t);  // lower a raw union → its enum
     if (t->kind != TYPE_SIMPLE || !t->base_type) return NULL;
-    const char *n = t->base_type->name; isize nl = t->base_type->length;
-    for (DeclList *dl = sema_decls; dl; dl = dl->next) {
-        Decl *d = dl->decl;
-        if (!d || d->kind != DECL_ENUM || !d->as.enum_decl.is_union) continue;
-        Id *en = d->as.enum_decl.type_name;
-        if (en && en->length == nl && memcmp(en->name, n, (size_t)nl) == 0) return d;
-    }
-    return NULL;
+    Decl *d = decl_index_enum(t->base_type);
+    return (d && d->as.enum_decl.is_union) ? d : NULL;
 }
 
 static Type *union_payload_type(Type *t) {
@@ -201,11 +187,11 @@ static void sema_union_coerce(Expr **slot, Type *target) {
     Expr *e = *slot;
     if (e->type && core_identical(e->type, target)) return;   // already exactly this union
     if (e->type && find_union_enum(e->type)) return;          // already SOME union value — don't re-wrap
-    Type *uty = type_simple(sema_arena, U->as.enum_decl.type_name);
+    Type *uty = type_simple(sema_ctx->arena, U->as.enum_decl.type_name);
     Id *marker = union_match_marker(U, e);
     if (marker) {                                             // bare marker → U.marker
-        Expr *tgt = expr_type(sema_arena, uty); tgt->decl = U;   // member handler keys on target->decl
-        Expr *m = expr_member(sema_arena, tgt, marker);
+        Expr *tgt = expr_type(sema_ctx->arena, uty); tgt->decl = U;   // member handler keys on target->decl
+        Expr *m = expr_member(sema_ctx->arena, tgt, marker);
         sema_infer_expr(m);
         *slot = m;
         return;
@@ -217,9 +203,9 @@ static void sema_union_coerce(Expr **slot, Type *target) {
     Type *payload = (sv && sv->fields && sv->fields->decl && sv->fields->decl->kind == DECL_VARIABLE)
                     ? sv->fields->decl->as.variable_decl.type : NULL;
     if (!e->type || !payload || !types_equal_exact(e->type, payload)) return;
-    Expr *tgt = expr_type(sema_arena, uty); tgt->decl = U;
-    Expr *pw = expr_member(sema_arena, tgt, sv->name);   // the payload variant, by its own name
-    Expr *call = expr_call(sema_arena, pw, expr_list(sema_arena, e));
+    Expr *tgt = expr_type(sema_ctx->arena, uty); tgt->decl = U;
+    Expr *pw = expr_member(sema_ctx->arena, tgt, sv->name);   // the payload variant, by its own name
+    Expr *call = expr_call(sema_ctx->arena, pw, expr_list(sema_ctx->arena, e));
     sema_infer_expr(call);
     *slot = call;
 }
@@ -425,7 +411,7 @@ static void l3_mark_dead_lower_bounds(Expr *cond, StmtList *body) {
 
         // Find init_idx for this pointer
         Expr *my_idx = NULL;
-        for (PtrInitIdxEntry *pie = sema_ptr_init_idx; pie; pie = pie->next) {
+        for (PtrInitIdxEntry *pie = sema_ctx->ptr_init_idx; pie; pie = pie->next) {
             if (pie->ptr_id->length == pid->length &&
                 memcmp(pie->ptr_id->name, pid->name, pid->length) == 0) {
                 my_idx = pie->init_idx; break;
@@ -441,7 +427,7 @@ static void l3_mark_dead_lower_bounds(Expr *cond, StmtList *body) {
             if (other_lhs->kind != EXPR_IDENTIFIER) continue;
             Id *opid = other_lhs->as.identifier_expr.id;
             Expr *other_idx = NULL;
-            for (PtrInitIdxEntry *pie = sema_ptr_init_idx; pie; pie = pie->next) {
+            for (PtrInitIdxEntry *pie = sema_ctx->ptr_init_idx; pie; pie = pie->next) {
                 if (pie->ptr_id->length == opid->length &&
                     memcmp(pie->ptr_id->name, opid->name, opid->length) == 0) {
                     other_idx = pie->init_idx; break;
@@ -449,15 +435,15 @@ static void l3_mark_dead_lower_bounds(Expr *cond, StmtList *body) {
             }
             if (!other_idx) { sum_others = NULL; break; } // can't build sum
             if (!sum_others) sum_others = other_idx;
-            else sum_others = expr_binary(sema_arena, TOKEN_PLUS, sum_others, other_idx);
+            else sum_others = expr_binary(sema_ctx->arena, TOKEN_PLUS, sum_others, other_idx);
         }
         // Single-pointer loop: the lower bound is the termination condition itself — never dead.
         // Multi-pointer: skip if we couldn't build sum_others for this pointer.
         if (!sum_others) continue;
 
         // Evaluate diff = my_idx - sum_others
-        Expr *diff_expr = expr_binary(sema_arena, TOKEN_MINUS, my_idx, sum_others);
-        Range diff = sema_eval_range(diff_expr, sema_ranges);
+        Expr *diff_expr = expr_binary(sema_ctx->arena, TOKEN_MINUS, my_idx, sum_others);
+        Range diff = sema_eval_range(diff_expr, sema_ctx->ranges);
         if (diff.known && diff.min >= 0) {
             // Lower bound provably dead: ptr.offset >= other_offsets_sum >= 0
             cond_ptrs[i]->as.binary_expr.l3_lower_dead = true;
@@ -491,7 +477,7 @@ static void l3_mark_dead_upper_bounds(Expr *cond, PtrMonotoneEntry *monotone) {
 }
 
 // L3 pointer monotone analysis: detect `p = p - 1` for pointer vars.
-// Registers p in sema_ptr_monotone so the emit can skip the upper-bound check.
+// Registers p in sema_ctx->ptr_monotone so the emit can skip the upper-bound check.
 static void l3_register_ptr_monotone(StmtList *body) {
     for (StmtList *b = body; b; b = b->next) {
         Stmt *s = b->stmt;
@@ -514,7 +500,7 @@ static void l3_register_ptr_monotone(StmtList *body) {
                     if (pid->length == lid->length &&
                         memcmp(pid->name, lid->name, pid->length) == 0) {
                         // Find this pointer's associated array from active in-guards
-                        for (InGuardEntry *ig = sema_in_guards; ig; ig = ig->next) {
+                        for (InGuardEntry *ig = sema_ctx->in_guards; ig; ig = ig->next) {
                             if (!ig->is_ptr_guard) continue;
                             if (ig->index && ig->index->kind == EXPR_IDENTIFIER) {
                                 Id *gid = ig->index->as.identifier_expr.id;
@@ -523,19 +509,19 @@ static void l3_register_ptr_monotone(StmtList *body) {
                                     // Found: p is monotone non-increasing in arr
                                     // Check not already registered
                                     bool dup = false;
-                                    for (PtrMonotoneEntry *e = sema_ptr_monotone; e; e = e->next) {
+                                    for (PtrMonotoneEntry *e = sema_ctx->ptr_monotone; e; e = e->next) {
                                         if (e->ptr_id->length == pid->length &&
                                             memcmp(e->ptr_id->name, pid->name, pid->length) == 0) {
                                             dup = true; break;
                                         }
                                     }
                                     if (!dup) {
-                                        PtrMonotoneEntry *entry = arena_push_aligned(sema_arena, PtrMonotoneEntry);
+                                        PtrMonotoneEntry *entry = arena_push_aligned(sema_ctx->arena, PtrMonotoneEntry);
                                         entry->ptr_id = pid;
                                         entry->arr_expr = ig->container;
-                                        // init_idx: look up from sema_ptr_init_idx
+                                        // init_idx: look up from sema_ctx->ptr_init_idx
                                         entry->init_idx = NULL;
-                                        for (PtrInitIdxEntry *pie = sema_ptr_init_idx; pie; pie = pie->next) {
+                                        for (PtrInitIdxEntry *pie = sema_ctx->ptr_init_idx; pie; pie = pie->next) {
                                             if (pie->ptr_id->length == pid->length &&
                                                 memcmp(pie->ptr_id->name, pid->name, pid->length) == 0) {
                                                 entry->init_idx = pie->init_idx; break;
@@ -543,8 +529,8 @@ static void l3_register_ptr_monotone(StmtList *body) {
                                         }
                                         // unconditional: decrement only at top level?
                                         entry->unconditional = l3_is_unconditional_decrement(body, pid);
-                                        entry->next = sema_ptr_monotone;
-                                        sema_ptr_monotone = entry;
+                                        entry->next = sema_ctx->ptr_monotone;
+                                        sema_ctx->ptr_monotone = entry;
                                     }
                                     break;
                                 }
@@ -920,34 +906,34 @@ static void sema_verify_bounded_while(Stmt *s) {
 
     // Check 1: condition implies measure >= 0
     if (!sema_verify_measure_nonneg(cond, measure)) {
-        fprintf(stderr, "[E080] Error Ln %li, Col %li: cannot verify that the termination measure "
+        sema_diag("[E080] Error Ln %li, Col %li: cannot verify that the termination measure "
                 "is non-negative when the loop condition holds.\n"
                 "  Hint: use 'while a < b : b - a { ... }' so the condition implies the measure is positive.\n",
                 s->line, s->col);
         diagnostic_show_line(s->line, s->col);
-        exit(1);
+        sema_fatal();
     }
 
     // Check 2: body strictly decreases the measure
     MeasureVar vars[MAX_MEASURE_VARS];
     int nvar = measure_extract_vars(measure, vars, MAX_MEASURE_VARS);
     if (nvar == 0) {
-        fprintf(stderr, "[E081] Error Ln %li, Col %li: cannot extract variables from termination measure.\n"
+        sema_diag("[E081] Error Ln %li, Col %li: cannot extract variables from termination measure.\n"
                 "  Hint: the measure must reference identifiers or struct fields.\n",
                 s->line, s->col);
         diagnostic_show_line(s->line, s->col);
-        exit(1);
+        sema_fatal();
     }
 
     int result = measure_scan_body(s->as.while_stmt.body, vars, nvar);
     if (result <= 0) {
-        fprintf(stderr, "[E082] Error Ln %li, Col %li: cannot verify that the termination measure "
+        sema_diag("[E082] Error Ln %li, Col %li: cannot verify that the termination measure "
                 "strictly decreases on each iteration.\n"
                 "  Hint: the loop body must contain an assignment that decreases the measure "
                 "(e.g., 'pos += 1' when measure is 'size - pos').\n",
                 s->line, s->col);
         diagnostic_show_line(s->line, s->col);
-        exit(1);
+        sema_fatal();
     }
 }
 
@@ -981,8 +967,8 @@ static void sema_push_narrows(Expr *cond, bool negated) {
     if (!cond) return;
     if (cond->kind == EXPR_IDENTIFIER) {
         if (!negated && nn_is_single_marker_var(cond)) {
-            NarrowEntry *e = arena_push_aligned(sema_arena, NarrowEntry);
-            e->var = cond; e->next = sema_narrows; sema_narrows = e;
+            NarrowEntry *e = arena_push_aligned(sema_ctx->arena, NarrowEntry);
+            e->var = cond; e->next = sema_ctx->narrows; sema_ctx->narrows = e;
         }
         return;
     }
@@ -998,7 +984,7 @@ static void sema_push_narrows(Expr *cond, bool negated) {
 
 static bool sema_is_narrowed(Expr *e) {
     if (!e || e->kind != EXPR_IDENTIFIER) return false;
-    for (NarrowEntry *n = sema_narrows; n; n = n->next)
+    for (NarrowEntry *n = sema_ctx->narrows; n; n = n->next)
         if (expr_struct_equal(e, n->var)) return true;
     return false;
 }
@@ -1008,25 +994,25 @@ static void sema_push_in_guards(Expr *cond) {
     if (cond->as.binary_expr.op == TOKEN_KEYWORD_IN) {
         Expr *lhs = cond->as.binary_expr.left;
         Expr *rhs = cond->as.binary_expr.right;
-        InGuardEntry *e = arena_push_aligned(sema_arena, InGuardEntry);
+        InGuardEntry *e = arena_push_aligned(sema_ctx->arena, InGuardEntry);
         e->index = lhs;
         e->container = rhs;
         e->is_ptr_guard = (lhs && lhs->type && lhs->type->kind == TYPE_POINTER);
         e->is_backward_guard = false;
-        e->next = sema_in_guards;
-        sema_in_guards = e;
+        e->next = sema_ctx->in_guards;
+        sema_ctx->in_guards = e;
     } else if (cond->as.binary_expr.op == TOKEN_ANGLE_BRACKET_RIGHT) {
         // `p > arr_ptr` — backward pointer guard: proves p-1 >= arr_ptr
         Expr *lhs = cond->as.binary_expr.left;
         Expr *rhs = cond->as.binary_expr.right;
         if (lhs && lhs->type && lhs->type->kind == TYPE_POINTER) {
-            InGuardEntry *e = arena_push_aligned(sema_arena, InGuardEntry);
+            InGuardEntry *e = arena_push_aligned(sema_ctx->arena, InGuardEntry);
             e->index = lhs;
             e->container = rhs;
             e->is_ptr_guard = true;
             e->is_backward_guard = true;
-            e->next = sema_in_guards;
-            sema_in_guards = e;
+            e->next = sema_ctx->in_guards;
+            sema_ctx->in_guards = e;
         }
     } else if (cond->as.binary_expr.op == TOKEN_KEYWORD_AND) {
         sema_push_in_guards(cond->as.binary_expr.left);
@@ -1035,7 +1021,7 @@ static void sema_push_in_guards(Expr *cond) {
 }
 
 static bool sema_is_in_guarded(Expr *index, Expr *container) {
-    for (InGuardEntry *e = sema_in_guards; e; e = e->next) {
+    for (InGuardEntry *e = sema_ctx->in_guards; e; e = e->next) {
         if (e->is_ptr_guard) continue;
         if (expr_struct_equal(e->index, index) &&
             expr_struct_equal(e->container, container))
@@ -1073,7 +1059,7 @@ static bool expr_references_id(Expr *e, Id *var) {
 // it stale — `while i in a { i = huge; a[i] }` must NOT keep the `i in a` guard and
 // read out of bounds. Unlink every such guard from the active list.
 static void sema_invalidate_in_guards(Id *var) {
-    InGuardEntry **pp = &sema_in_guards;
+    InGuardEntry **pp = &sema_ctx->in_guards;
     while (*pp) {
         InGuardEntry *e = *pp;
         if (expr_references_id(e->index, var) || expr_references_id(e->container, var))
@@ -1115,7 +1101,7 @@ static bool stmtlist_assigns_referenced(struct StmtList *body, Expr *guard) {
 // Invalidate every in-guard a nested `body` may have staled by assigning a variable
 // the guard references. Called after a branch/loop body's scope is restored.
 static void sema_invalidate_guards_for_body(struct StmtList *body) {
-    InGuardEntry **pp = &sema_in_guards;
+    InGuardEntry **pp = &sema_ctx->in_guards;
     while (*pp) {
         InGuardEntry *e = *pp;
         if (stmtlist_assigns_referenced(body, e->index) ||
@@ -1131,19 +1117,15 @@ static void sema_invalidate_guards_for_body(struct StmtList *body) {
 // goes STALE the instant `v1` or `v2` is reassigned. The bounds prover chains
 // such a constraint with the endpoint's range to prove a fixed-array index, so a
 // stale `i < n` after `i = i +% 1000` would wrongly prove an out-of-range `a[i]`.
-// Unlink every constraint mentioning the mutated variable (matched by name, as
-// the constraint table stores non-interned Ids). Same-scope mutation site.
+// Unlink every constraint mentioning the mutated variable (matched by atom; the
+// constraint Ids are not the declaring Ids). Same-scope mutation site.
 static void sema_invalidate_constraints(Id *var) {
-    if (!sema_ranges || !var) return;
-    ConstraintEntry **pp = &sema_ranges->constraints;
+    if (!sema_ctx->ranges || !var) return;
+    ConstraintEntry **pp = &sema_ctx->ranges->constraints;
     while (*pp) {
         ConstraintEntry *c = *pp;
-        bool hits =
-            (c->v1 && c->v1->length == var->length &&
-             strncmp(c->v1->name, var->name, (size_t)var->length) == 0) ||
-            (c->v2 && c->v2->length == var->length &&
-             strncmp(c->v2->name, var->name, (size_t)var->length) == 0);
-        if (hits) *pp = c->next;   // unlink the stale constraint
+        bool hits = (c->v1 && id_eq(c->v1, var)) || (c->v2 && id_eq(c->v2, var));
+        if (hits) constraint_unlink(sema_ctx->ranges, pp);   // unlink the stale constraint
         else      pp = &c->next;
     }
 }
@@ -1151,9 +1133,9 @@ static void sema_invalidate_constraints(Id *var) {
 // endpoint (mirrors sema_invalidate_guards_for_body; a branch's scope-restore
 // would otherwise re-expose a constraint the branch invalidated).
 static void sema_invalidate_constraints_for_body(struct StmtList *body) {
-    if (!sema_ranges) return;
+    if (!sema_ctx->ranges) return;
     Expr probe; memset(&probe, 0, sizeof probe); probe.kind = EXPR_IDENTIFIER;
-    ConstraintEntry **pp = &sema_ranges->constraints;
+    ConstraintEntry **pp = &sema_ctx->ranges->constraints;
     while (*pp) {
         ConstraintEntry *c = *pp;
         probe.as.identifier_expr.id = c->v1;
@@ -1162,7 +1144,7 @@ static void sema_invalidate_constraints_for_body(struct StmtList *body) {
             probe.as.identifier_expr.id = c->v2;
             staled = stmtlist_assigns_referenced(body, &probe);
         }
-        if (staled) *pp = c->next;
+        if (staled) constraint_unlink(sema_ctx->ranges, pp);
         else        pp = &c->next;
     }
 }
@@ -1184,28 +1166,28 @@ static void sema_push_struct_field_guards(Id *var_name_id, Type *var_ty) {
         Id *in_fld = sf->decl->as.variable_decl.in_field;
         if (!in_fld) continue;
         // Synthetic EXPR_IDENTIFIER for the variable
-        Expr *ve = arena_push_aligned(sema_arena, Expr);
+        Expr *ve = arena_push_aligned(sema_ctx->arena, Expr);
         memset(ve, 0, sizeof(Expr));
         ve->kind = EXPR_IDENTIFIER;
         ve->as.identifier_expr.id = var_name_id;
         // EXPR_MEMBER: var.field (the index)
-        Expr *fidx = arena_push_aligned(sema_arena, Expr);
+        Expr *fidx = arena_push_aligned(sema_ctx->arena, Expr);
         memset(fidx, 0, sizeof(Expr));
         fidx->kind = EXPR_MEMBER;
         fidx->as.member_expr.target = ve;
         fidx->as.member_expr.member = sf->decl->as.variable_decl.name;
         // EXPR_MEMBER: var.container
-        Expr *fcnt = arena_push_aligned(sema_arena, Expr);
+        Expr *fcnt = arena_push_aligned(sema_ctx->arena, Expr);
         memset(fcnt, 0, sizeof(Expr));
         fcnt->kind = EXPR_MEMBER;
         fcnt->as.member_expr.target = ve;
         fcnt->as.member_expr.member = in_fld;
         // Push the guard
-        InGuardEntry *ig = arena_push_aligned(sema_arena, InGuardEntry);
+        InGuardEntry *ig = arena_push_aligned(sema_ctx->arena, InGuardEntry);
         ig->index = fidx;
         ig->container = fcnt;
-        ig->next = sema_in_guards;
-        sema_in_guards = ig;
+        ig->next = sema_ctx->in_guards;
+        sema_ctx->in_guards = ig;
     }
 }
 
@@ -1223,7 +1205,7 @@ static void walk_stmt(Stmt *s) {
                 // gives x the VALUE type, not the reference type.
                 Type *inferred = s->as.var_stmt.expr->type;
                 if (inferred && inferred->mode == MODE_MUTABLE) {
-                    Type *stripped = arena_push_aligned(sema_arena, Type);
+                    Type *stripped = arena_push_aligned(sema_ctx->arena, Type);
                     *stripped = *inferred;
                     stripped->mode = MODE_SHARED;
                     inferred = stripped;
@@ -1238,8 +1220,8 @@ static void walk_stmt(Stmt *s) {
             // spec_audit_2026_05_14.md §F4.
 
             sema_union_coerce(&s->as.var_stmt.expr, s->as.var_stmt.type);  // `T | markers` construction
-            if (sema_ranges && s->as.var_stmt.expr) {
-                Range r = sema_eval_range(s->as.var_stmt.expr, sema_ranges);
+            if (sema_ctx->ranges && s->as.var_stmt.expr) {
+                Range r = sema_eval_range(s->as.var_stmt.expr, sema_ctx->ranges);
                 // Q-002 Phase 5: overflow-at-boundary check (var declaration).
                 if (s->as.var_stmt.type) {
                     char vname_buf[128];
@@ -1257,11 +1239,11 @@ static void walk_stmt(Stmt *s) {
                     if (s->as.var_stmt.type->kind == TYPE_ARRAY &&
                         s->as.var_stmt.type->element_type &&
                         s->as.var_stmt.type->element_type->kind == TYPE_ARRAY) {
-                        fprintf(stderr, "[E100] Error Ln %li, Col %li: multidimensional arrays are "
+                        sema_diag("[E100] Error Ln %li, Col %li: multidimensional arrays are "
                             "not supported — use a flat array 'T[m*n]' indexed 'a[i*n + j]'.\n",
                             (long)s->line, (long)s->col);
                         diagnostic_show_line(s->line, s->col);
-                        exit(1);
+                        sema_fatal();
                     }
                     // P2/S4: an array literal's element count must match a fixed
                     // array length (was a gap: u8[3] = [1,2] and u8[2] = [1,2,3]
@@ -1273,12 +1255,12 @@ static void walk_stmt(Stmt *s) {
                         for (ExprList *el = s->as.var_stmt.expr->as.array_literal_expr.elements;
                              el; el = el->next) count++;
                         if (count != (long)s->as.var_stmt.type->array_len) {
-                            fprintf(stderr, "[E012] Error Ln %li, Col %li: array literal has %ld "
+                            sema_diag("[E012] Error Ln %li, Col %li: array literal has %ld "
                                 "element(s) but '%s' has fixed length %lld.\n",
                                 (long)s->line, (long)s->col, count, vname_buf,
                                 (long long)s->as.var_stmt.type->array_len);
                             diagnostic_show_line(s->line, s->col);
-                            exit(1);
+                            sema_fatal();
                         }
                     }
                     // P2/S3: an array literal's literal elements must fit the target
@@ -1296,7 +1278,7 @@ static void walk_stmt(Stmt *s) {
                                 Range er = (el->expr->kind == EXPR_LITERAL)
                                     ? (Range){ el->expr->as.literal_expr.value,
                                                el->expr->as.literal_expr.value, true }
-                                    : sema_eval_range(el->expr, sema_ranges);
+                                    : sema_eval_range(el->expr, sema_ctx->ranges);
                                 check_conversion(el->expr->type, et, er, el->expr,
                                     el->expr->line, el->expr->col, "array element", vname_buf);
                             }
@@ -1324,10 +1306,10 @@ static void walk_stmt(Stmt *s) {
                 // type alias with constraints (e.g., `type Pressure = int >= 0 and <= 1000`),
                 // apply each constraint to the source range, narrowing it
                 // and emitting E086 on violation.
-                if (sema_ranges && s->as.var_stmt.type
+                if (sema_ctx->ranges && s->as.var_stmt.type
                     && s->as.var_stmt.type->kind == TYPE_SIMPLE
                     && s->as.var_stmt.type->base_type
-                    && !sema_in_unsafe_block && r.known) {
+                    && !sema_ctx->in_unsafe_block && r.known) {
                     char tnam[256];
                     isize tl = s->as.var_stmt.type->base_type->length;
                     if (tl < (isize)sizeof(tnam)) {
@@ -1353,19 +1335,19 @@ static void walk_stmt(Stmt *s) {
                                     default: fits = true; break;
                                 }
                                 if (!fits) {
-                                    fprintf(stderr,
+                                    sema_diag(
                                         "[E086] Error Ln %li, Col %li: assignment to '%.*s' violates refinement constraint of type alias '%s': value range [%lld, %lld] does not satisfy the alias constraint.\n",
                                         s->line, s->col,
                                         (int)s->as.var_stmt.name->length, s->as.var_stmt.name->name,
                                         tnam, (long long)r.min, (long long)r.max);
-                                    exit(1);
+                                    sema_fatal();
                                 }
                             }
                         }
                     }
                 }
 
-                range_set(sema_ranges, s->as.var_stmt.name, r);
+                range_set(sema_ctx->ranges, s->as.var_stmt.name, r);
 
                 // If the initializer is x.len or x.len ± k, register the equality
                 // (or affine relationship) between n and __len_x as difference constraints
@@ -1413,24 +1395,19 @@ static void walk_stmt(Stmt *s) {
                         delta = (init->as.binary_expr.op == TOKEN_PLUS) ? k : -k;
                     }
 
-                    if (ref && sema_ranges) {
+                    if (ref && sema_ctx->ranges) {
                         char lk[272]; int lklen = 6 + (int)ref->length;
                         if (lklen < (int)sizeof(lk)) {
                             memcpy(lk, "__len_", 6);
                             memcpy(lk + 6, ref->name, ref->length);
-                            Id *len_id = NULL;
-                            for (RangeEntry *re = sema_ranges->head; re; re = re->next) {
-                                if ((int)re->var->length == lklen &&
-                                    memcmp(re->var->name, lk, lklen) == 0) {
-                                    len_id = re->var; break;
-                                }
-                            }
+                            RangeEntry *len_re = range_find_atom(sema_ctx->ranges, atom_find(lk, lklen));
+                            Id *len_id = len_re ? len_re->var : NULL;
                             if (len_id) {
                                 /* n = __len_x + delta
                                    ↔  n - __len_x ≤  delta
                                       __len_x - n ≤ -delta  */
-                                constraint_add(sema_ranges, n_id,   len_id,  delta);
-                                constraint_add(sema_ranges, len_id, n_id,   -delta);
+                                constraint_add(sema_ctx->ranges, n_id,   len_id,  delta);
+                                constraint_add(sema_ctx->ranges, len_id, n_id,   -delta);
                             }
                         }
                     }
@@ -1473,12 +1450,12 @@ static void walk_stmt(Stmt *s) {
                         /* var x = y */
                         vref = init->as.identifier_expr.id; vdelta = 0;
                     }
-                    if (vref && n_id && sema_ranges &&
+                    if (vref && n_id && sema_ctx->ranges &&
                         !(vref->length == n_id->length &&
                           memcmp(vref->name, n_id->name, (size_t)vref->length) == 0)) {
                         /* x = y + delta  ↔  x - y ≤ delta ; y - x ≤ -delta */
-                        constraint_add(sema_ranges, n_id, vref,  vdelta);
-                        constraint_add(sema_ranges, vref, n_id, -vdelta);
+                        constraint_add(sema_ctx->ranges, n_id, vref,  vdelta);
+                        constraint_add(sema_ctx->ranges, vref, n_id, -vdelta);
                     }
                 }
 
@@ -1491,13 +1468,12 @@ static void walk_stmt(Stmt *s) {
                     if (lklen < (int)sizeof(lk)) {
                         memcpy(lk, "__len_", 6);
                         memcpy(lk + 6, vname->name, vname->length);
-                        char *stored = arena_push_many(sema_arena, char, lklen);
+                        char *stored = arena_push_many(sema_ctx->arena, char, lklen);
                         memcpy(stored, lk, lklen);
-                        Id *len_id = arena_push_aligned(sema_arena, Id);
-                        len_id->length = lklen; len_id->name = stored;
-                        Range len_r = sema_eval_range(sv_ty->size_expr, sema_ranges);
+                        Id *len_id = id(sema_ctx->arena, lklen, stored);
+                        Range len_r = sema_eval_range(sv_ty->size_expr, sema_ctx->ranges);
                         if (!len_r.known) len_r = range_make(0, INT64_MAX);
-                        range_set(sema_ranges, len_id, len_r);
+                        range_set(sema_ctx->ranges, len_id, len_r);
                     }
                 }
             }
@@ -1529,21 +1505,19 @@ static void walk_stmt(Stmt *s) {
                 memcpy(raw_ptr, s->as.var_stmt.name->name, rlen); raw_ptr[rlen] = '\0';
                 Symbol *psym = sema_lookup(raw_ptr);
                 const char *cname_ptr = psym ? psym->c_name : raw_ptr;
-                Id *resolved_id = arena_push_aligned(sema_arena, Id);
-                resolved_id->length = strlen(cname_ptr);
-                resolved_id->name = cname_ptr;
+                Id *resolved_id = id(sema_ctx->arena, strlen(cname_ptr), cname_ptr);
 
-                Expr *p_ve = arena_push_aligned(sema_arena, Expr);
+                Expr *p_ve = arena_push_aligned(sema_ctx->arena, Expr);
                 memset(p_ve, 0, sizeof(Expr));
                 p_ve->kind = EXPR_IDENTIFIER;
                 p_ve->as.identifier_expr.id = resolved_id; // mangled name
                 p_ve->type = s->as.var_stmt.type;
-                InGuardEntry *ig = arena_push_aligned(sema_arena, InGuardEntry);
+                InGuardEntry *ig = arena_push_aligned(sema_ctx->arena, InGuardEntry);
                 ig->index = p_ve;
                 ig->container = s->as.var_stmt.in_expr;
                 ig->is_ptr_guard = true;
-                ig->next = sema_in_guards;
-                sema_in_guards = ig;
+                ig->next = sema_ctx->in_guards;
+                sema_ctx->in_guards = ig;
 
                 // L3 lower bound: record init index from &arr[k] initializer
                 Expr *init = s->as.var_stmt.expr;
@@ -1551,11 +1525,11 @@ static void walk_stmt(Stmt *s) {
                     init->as.addr_expr.expr &&
                     init->as.addr_expr.expr->kind == EXPR_INDEX) {
                     Expr *idx = init->as.addr_expr.expr->as.index_expr.index;
-                    PtrInitIdxEntry *pie = arena_push_aligned(sema_arena, PtrInitIdxEntry);
+                    PtrInitIdxEntry *pie = arena_push_aligned(sema_ctx->arena, PtrInitIdxEntry);
                     pie->ptr_id = resolved_id;
                     pie->init_idx = idx;
-                    pie->next = sema_ptr_init_idx;
-                    sema_ptr_init_idx = pie;
+                    pie->next = sema_ctx->ptr_init_idx;
+                    sema_ctx->ptr_init_idx = pie;
                 }
             }
             break;
@@ -1563,13 +1537,12 @@ static void walk_stmt(Stmt *s) {
             sema_infer_expr(s->as.if_stmt.cond);
 
             // Save state
-            RangeEntry *old_head = sema_ranges->head;
-            ConstraintEntry *old_constraints = sema_ranges->constraints;
-            InGuardEntry *old_guards = sema_in_guards;
-            NarrowEntry *old_narrows = sema_narrows;
+            RangeSnapshot old_facts = range_snapshot(sema_ctx->ranges);
+            InGuardEntry *old_guards = sema_ctx->in_guards;
+            NarrowEntry *old_narrows = sema_ctx->narrows;
 
             // Apply condition for THEN branch
-            sema_apply_constraint(s->as.if_stmt.cond, sema_ranges);
+            sema_apply_constraint(s->as.if_stmt.cond, sema_ctx->ranges);
             sema_push_in_guards(s->as.if_stmt.cond);
             sema_push_narrows(s->as.if_stmt.cond, false);   // ?T narrows to T in THEN
 
@@ -1592,20 +1565,19 @@ static void walk_stmt(Stmt *s) {
             }
 
             // Restore state (pop constraints + in-guards from THEN)
-            sema_ranges->head = old_head;
-            sema_ranges->constraints = old_constraints;
-            sema_in_guards = old_guards;
-            sema_narrows = old_narrows;
+            range_restore(sema_ctx->ranges, old_facts);
+            sema_ctx->in_guards = old_guards;
+            sema_ctx->narrows = old_narrows;
 
             // Apply negated condition for ELSE branch (no in-guards — negated 'in' proves nothing)
-            sema_apply_negated_constraint(s->as.if_stmt.cond, sema_ranges);
+            sema_apply_negated_constraint(s->as.if_stmt.cond, sema_ctx->ranges);
             sema_push_narrows(s->as.if_stmt.cond, true);    // else: x present when cond was `x == nil`
 
             sema_push_scope();
             for (StmtList *b = s->as.if_stmt.else_branch; b; b = b->next)
                 walk_stmt(b->stmt);
             sema_pop_scope();
-            sema_narrows = old_narrows;
+            sema_ctx->narrows = old_narrows;
 
             if (then_returns) {
                 // Keep the negated constraints for the rest of the
@@ -1623,8 +1595,7 @@ static void walk_stmt(Stmt *s) {
                 sema_push_narrows(s->as.if_stmt.cond, true);
             } else {
                 // Normal: restore state to what it was before the if.
-                sema_ranges->head = old_head;
-                sema_ranges->constraints = old_constraints;
+                range_restore(sema_ctx->ranges, old_facts);
             }
             // SOUNDNESS: either branch may have mutated a guarded variable, and the
             // scope restore above re-added the outer guards — re-invalidate any guard
@@ -1645,9 +1616,9 @@ static void walk_stmt(Stmt *s) {
             Id *iter_var = s->as.for_stmt.index_name
                 ? s->as.for_stmt.index_name
                 : s->as.for_stmt.value_name;
-            if (sema_ranges && s->as.for_stmt.iterable->kind == EXPR_RANGE && iter_var) {
-                start_range = sema_eval_range(s->as.for_stmt.iterable->as.range_expr.start, sema_ranges);
-                end_range   = sema_eval_range(s->as.for_stmt.iterable->as.range_expr.end, sema_ranges);
+            if (sema_ctx->ranges && s->as.for_stmt.iterable->kind == EXPR_RANGE && iter_var) {
+                start_range = sema_eval_range(s->as.for_stmt.iterable->as.range_expr.start, sema_ctx->ranges);
+                end_range   = sema_eval_range(s->as.for_stmt.iterable->as.range_expr.end, sema_ctx->ranges);
                 // VRA: seed the counter's lower bound whenever `start` is known,
                 // even if `end` is not constant (`for i in 0..n` / `0..a.len`).
                 // Previously the whole range was dropped unless BOTH ends were
@@ -1658,7 +1629,7 @@ static void walk_stmt(Stmt *s) {
                 // post-loop.
                 if (start_range.known) {
                     int64_t hi = end_range.known ? end_range.max - 1 : INT64_MAX;
-                    range_set(sema_ranges, iter_var, range_make(start_range.min, hi));
+                    range_set(sema_ctx->ranges, iter_var, range_make(start_range.min, hi));
                 }
             }
 
@@ -1668,25 +1639,26 @@ static void walk_stmt(Stmt *s) {
             #define MAX_AFFINE 16
             Id   *affine_vars[MAX_AFFINE]; long long affine_steps[MAX_AFFINE];
             Range affine_inits[MAX_AFFINE]; int n_affine = 0;
-            if (sema_ranges) {
+            if (sema_ctx->ranges) {
                 for (StmtList *b = s->as.for_stmt.body; b; b = b->next) {
                     Id *v = NULL; long long step = 0;
                     if (sema_is_affine_assign(b->stmt, &v, &step) && n_affine < MAX_AFFINE) {
                         affine_vars[n_affine]  = v;
                         affine_steps[n_affine] = step;
-                        affine_inits[n_affine] = range_get(sema_ranges, v);
+                        affine_inits[n_affine] = range_get(sema_ctx->ranges, v);
                         n_affine++;
                     }
                 }
             }
 
             // Widen modified variables BEFORE body
-            if (sema_ranges) sema_widen_loop(s->as.for_stmt.body, sema_ranges);
+            if (sema_ctx->ranges) sema_widen_loop(s->as.for_stmt.body, sema_ctx->ranges);
 
             // Sized-slice constraint injection: add symbolic "iter_var < end" constraint
             // scoped to the body so it doesn't pollute post-loop analysis.
-            ConstraintEntry *__for_old_constraints = sema_ranges ? sema_ranges->constraints : NULL;
-            if (sema_ranges && iter_var &&
+            ConstraintEntry *__for_old_constraints = sema_ctx->ranges ? sema_ctx->ranges->constraints : NULL;
+            isize __for_old_seq = sema_ctx->ranges ? sema_ctx->ranges->next_seq : 0;
+            if (sema_ctx->ranges && iter_var &&
                 s->as.for_stmt.iterable->kind == EXPR_RANGE &&
                 s->as.for_stmt.iterable->as.range_expr.end) {
                 Expr *end_expr = s->as.for_stmt.iterable->as.range_expr.end;
@@ -1701,20 +1673,14 @@ static void walk_stmt(Stmt *s) {
                     if (klen < (int)sizeof(key)) {
                         memcpy(key, "__len_", 6);
                         memcpy(key + 6, obj_id->name, obj_id->length);
-                        Id *len_id = NULL;
-                        for (RangeEntry *re = sema_ranges->head; re; re = re->next) {
-                            if (re->var->length == klen &&
-                                strncmp(re->var->name, key, klen) == 0) {
-                                len_id = re->var;
-                                break;
-                            }
-                        }
-                        if (len_id) constraint_add(sema_ranges, iter_var, len_id, -1);
+                        RangeEntry *len_re = range_find_atom(sema_ctx->ranges, atom_find(key, klen));
+                        Id *len_id = len_re ? len_re->var : NULL;
+                        if (len_id) constraint_add(sema_ctx->ranges, iter_var, len_id, -1);
                     }
                 } else if (end_expr->kind == EXPR_IDENTIFIER) {
                     // for i in 0..n → i - n <= -1 inside body
                     Id *n_id = end_expr->as.identifier_expr.id;
-                    constraint_add(sema_ranges, iter_var, n_id, -1);
+                    constraint_add(sema_ctx->ranges, iter_var, n_id, -1);
                 }
             }
 
@@ -1724,7 +1690,7 @@ static void walk_stmt(Stmt *s) {
             sema_pop_scope();
 
             // Restore constraint scope: the symbolic bound only holds inside the body
-            if (sema_ranges) sema_ranges->constraints = __for_old_constraints;
+            constraint_restore(sema_ctx->ranges, __for_old_constraints, __for_old_seq);
 
             // SOUNDNESS: the loop body may have mutated an OUTER-guarded variable —
             // invalidate any guard whose variable the body assigns.
@@ -1732,7 +1698,7 @@ static void walk_stmt(Stmt *s) {
             sema_invalidate_constraints_for_body(s->as.for_stmt.body);
 
             // Widen modified variables AFTER body
-            if (sema_ranges) sema_widen_loop(s->as.for_stmt.body, sema_ranges);
+            if (sema_ctx->ranges) sema_widen_loop(s->as.for_stmt.body, sema_ctx->ranges);
 
             // S15 (VRA L3): post-loop affine recap.
             // For each affine var, compute final range from init + step * iter_count.
@@ -1752,7 +1718,7 @@ static void walk_stmt(Stmt *s) {
                         affine_vars[i]->length == affine_vars[j]->length &&
                         strncmp(affine_vars[i]->name, affine_vars[j]->name,
                                 affine_vars[i]->length) == 0) { recap_unsafe = true; break; }
-            if (!recap_unsafe && sema_ranges && n_affine > 0 && start_range.known && end_range.known) {
+            if (!recap_unsafe && sema_ctx->ranges && n_affine > 0 && start_range.known && end_range.known) {
                 long long iter_min = end_range.min - start_range.max;
                 long long iter_max = end_range.max - start_range.min;
                 if (iter_min < 0) iter_min = 0;  // empty-loop case
@@ -1771,18 +1737,18 @@ static void walk_stmt(Stmt *s) {
                     Range r = range_make(
                         affine_inits[i].min + delta_min,
                         affine_inits[i].max + delta_max);
-                    range_set(sema_ranges, affine_vars[i], r);
+                    range_set(sema_ctx->ranges, affine_vars[i], r);
                 }
             }
 
             // Preserve loop index value at exit. A clean `for i in start..end`
             // exits with i == end; but with a break the index can be anywhere in
             // [start, end], so widen it conservatively rather than claim `end`.
-            if (sema_ranges && iter_var && end_range.known) {
+            if (sema_ctx->ranges && iter_var && end_range.known) {
                 if (recap_unsafe && start_range.known)
-                    range_set(sema_ranges, iter_var, range_make(start_range.min, end_range.max));
+                    range_set(sema_ctx->ranges, iter_var, range_make(start_range.min, end_range.max));
                 else
-                    range_set(sema_ranges, iter_var, end_range);
+                    range_set(sema_ctx->ranges, iter_var, end_range);
             }
             #undef MAX_AFFINE
             break;
@@ -1793,8 +1759,8 @@ static void walk_stmt(Stmt *s) {
             // Auto-infer `decreasing` when measure is absent and all conditions are
             // pointer-in-arr guards (p in arr) or backward pointer guards (p > arr_ptr).
             // Synthesizes measure as sum of (p - &arr[0]) or (p - arr_ptr).
-            if (!s->as.while_stmt.measure && current_function_decl &&
-                current_function_decl->kind == DECL_FUNCTION) {
+            if (!s->as.while_stmt.measure && sema_ctx->function_decl &&
+                sema_ctx->function_decl->kind == DECL_FUNCTION) {
                 // Collect pointer conditions from AND-chain
                 Expr *ptr_exprs[8]; Expr *arr_exprs[8];
                 bool  is_backward[8]; int n_ptrs = 0;
@@ -1841,16 +1807,16 @@ static void walk_stmt(Stmt *s) {
                         base_ptr = arr_exprs[i];
                     } else {
                         // Build &arr[0]
-                        Expr *zero = arena_push_aligned(sema_arena, Expr);
+                        Expr *zero = arena_push_aligned(sema_ctx->arena, Expr);
                         memset(zero, 0, sizeof(Expr));
                         zero->kind = EXPR_LITERAL; zero->line = s->line; zero->col = s->col;
-                        Expr *aidx = arena_push_aligned(sema_arena, Expr);
+                        Expr *aidx = arena_push_aligned(sema_ctx->arena, Expr);
                         memset(aidx, 0, sizeof(Expr));
                         aidx->kind = EXPR_INDEX;
                         aidx->as.index_expr.target = arr_exprs[i];
                         aidx->as.index_expr.index = zero;
                         aidx->line = s->line; aidx->col = s->col;
-                        Expr *aaddr = arena_push_aligned(sema_arena, Expr);
+                        Expr *aaddr = arena_push_aligned(sema_ctx->arena, Expr);
                         memset(aaddr, 0, sizeof(Expr));
                         aaddr->kind = EXPR_ADDR;
                         aaddr->as.addr_expr.expr = aidx;
@@ -1858,7 +1824,7 @@ static void walk_stmt(Stmt *s) {
                         base_ptr = aaddr;
                     }
                     // p - base_ptr
-                    Expr *term = arena_push_aligned(sema_arena, Expr);
+                    Expr *term = arena_push_aligned(sema_ctx->arena, Expr);
                     memset(term, 0, sizeof(Expr));
                     term->kind = EXPR_BINARY;
                     term->as.binary_expr.op = TOKEN_MINUS;
@@ -1868,7 +1834,7 @@ static void walk_stmt(Stmt *s) {
                     if (!synth_measure) {
                         synth_measure = term;
                     } else {
-                        Expr *plus = arena_push_aligned(sema_arena, Expr);
+                        Expr *plus = arena_push_aligned(sema_ctx->arena, Expr);
                         memset(plus, 0, sizeof(Expr));
                         plus->kind = EXPR_BINARY;
                         plus->as.binary_expr.op = TOKEN_PLUS;
@@ -1882,14 +1848,14 @@ static void walk_stmt(Stmt *s) {
                     s->as.while_stmt.measure = synth_measure;
                 } else {
                     // No pointer decrements found: emit E011
-                    fprintf(stderr, "[E011] Error Ln %li, Col %li: 'while' loops without a termination "
+                    sema_diag("[E011] Error Ln %li, Col %li: 'while' loops without a termination "
                             "measure are not allowed in pure function '%.*s'. "
                             "Add 'decreasing <measure>' or use 'proc'.\n",
                             s->line, s->col,
-                            (int)current_function_decl->as.function_decl.name->length,
-                            current_function_decl->as.function_decl.name->name);
+                            (int)sema_ctx->function_decl->as.function_decl.name->length,
+                            sema_ctx->function_decl->as.function_decl.name->name);
                     diagnostic_show_line(s->line, s->col);
-                    exit(1);
+                    sema_fatal();
                 }
             }
 
@@ -1903,31 +1869,31 @@ static void walk_stmt(Stmt *s) {
             // their upper/lower bounds after the conservative widen.
             Id   *wl3_vars[MAX_AFFINE_L3]; long long wl3_steps[MAX_AFFINE_L3];
             Range wl3_inits[MAX_AFFINE_L3]; int n_wl3 = 0;
-            if (sema_ranges) {
+            if (sema_ctx->ranges) {
                 l3_scan_affine(s->as.while_stmt.body,
                                wl3_vars, wl3_steps, wl3_inits, &n_wl3, MAX_AFFINE_L3,
-                               sema_ranges);
+                               sema_ctx->ranges);
             }
 
             // L3 pointer monotone: register pointers that only decrement.
             // Then mark the while condition's `p in arr` expressions with dead upper bounds.
             l3_register_ptr_monotone(s->as.while_stmt.body);
-            l3_mark_dead_upper_bounds(s->as.while_stmt.cond, sema_ptr_monotone);
-            if (sema_ranges)
+            l3_mark_dead_upper_bounds(s->as.while_stmt.cond, sema_ctx->ptr_monotone);
+            if (sema_ctx->ranges)
                 l3_mark_dead_lower_bounds(s->as.while_stmt.cond,
                                           s->as.while_stmt.body);
 
             // Widen modified variables BEFORE body (conservative)
-            if (sema_ranges) sema_widen_loop(s->as.while_stmt.body, sema_ranges);
+            if (sema_ctx->ranges) sema_widen_loop(s->as.while_stmt.body, sema_ctx->ranges);
 
             // L3 apply: re-establish monotone bounds after widen.
             // Non-increasing vars: upper bound = initial max (preserved throughout).
             // Non-decreasing vars: lower bound = initial min (preserved throughout).
-            if (sema_ranges) {
+            if (sema_ctx->ranges) {
                 for (int i = 0; i < n_wl3; i++) {
                     if (!wl3_vars[i]) continue; // conflicted (not monotone)
                     if (!wl3_inits[i].known) continue;
-                    Range cur = range_get(sema_ranges, wl3_vars[i]);
+                    Range cur = range_get(sema_ctx->ranges, wl3_vars[i]);
                     if (wl3_steps[i] < 0) {
                         // Monotone non-increasing: x ≤ initial_max throughout loop
                         // Re-apply upper bound after widen
@@ -1936,7 +1902,7 @@ static void walk_stmt(Stmt *s) {
                                 ? range_make(cur.min, wl3_inits[i].max)
                                 : range_make(INT64_MIN, wl3_inits[i].max);
                             r.known = true;
-                            range_set(sema_ranges, wl3_vars[i], r);
+                            range_set(sema_ctx->ranges, wl3_vars[i], r);
                         }
                     } else if (wl3_steps[i] > 0) {
                         // Monotone non-decreasing: x ≥ initial_min throughout loop
@@ -1945,18 +1911,17 @@ static void walk_stmt(Stmt *s) {
                                 ? range_make(wl3_inits[i].min, cur.max)
                                 : range_make(wl3_inits[i].min, INT64_MAX);
                             r.known = true;
-                            range_set(sema_ranges, wl3_vars[i], r);
+                            range_set(sema_ctx->ranges, wl3_vars[i], r);
                         }
                     }
                 }
             }
 
             {   // Apply condition constraints + in-guards for body
-                RangeEntry *old_head = sema_ranges ? sema_ranges->head : NULL;
-                ConstraintEntry *old_constraints = sema_ranges ? sema_ranges->constraints : NULL;
-                InGuardEntry *old_guards = sema_in_guards;
+                RangeSnapshot old_facts = range_snapshot(sema_ctx->ranges);
+                InGuardEntry *old_guards = sema_ctx->in_guards;
 
-                if (sema_ranges) sema_apply_constraint(s->as.while_stmt.cond, sema_ranges);
+                if (sema_ctx->ranges) sema_apply_constraint(s->as.while_stmt.cond, sema_ctx->ranges);
                 sema_push_in_guards(s->as.while_stmt.cond);
 
                 sema_push_scope();
@@ -1964,15 +1929,12 @@ static void walk_stmt(Stmt *s) {
                     walk_stmt(b->stmt);
                 sema_pop_scope();
 
-                if (sema_ranges) {
-                    sema_ranges->head = old_head;
-                    sema_ranges->constraints = old_constraints;
-                }
-                sema_in_guards = old_guards;
+                range_restore(sema_ctx->ranges, old_facts);
+                sema_ctx->in_guards = old_guards;
             }
 
             // Widen modified variables AFTER body
-            if (sema_ranges) sema_widen_loop(s->as.while_stmt.body, sema_ranges);
+            if (sema_ctx->ranges) sema_widen_loop(s->as.while_stmt.body, sema_ctx->ranges);
 
             // SOUNDNESS: the loop body may have mutated an OUTER-guarded variable —
             // invalidate any guard whose variable the body assigns.
@@ -1990,19 +1952,19 @@ static void walk_stmt(Stmt *s) {
             // idiomatic in-place mutation: a `var` (mutable borrow) parameter. (Index
             // writes `out[i]=…` through sized array/slice OUTPUT params stay valid —
             // only field writes `p.f=…` through a `*T` pointer are caught.)
-            if (!sema_in_unsafe_block &&
+            if (!sema_ctx->in_unsafe_block &&
                 s->as.assign_stmt.target->kind == EXPR_MEMBER) {
                 Expr *base = s->as.assign_stmt.target->as.member_expr.target;
                 if (base && base->type && base->type->kind == TYPE_POINTER) {
                     Id *bid = base->kind == EXPR_IDENTIFIER ? base->as.identifier_expr.id : NULL;
-                    fprintf(stderr, "[E009] Error Ln %li, Col %li: cannot mutate a field through a raw pointer "
+                    sema_diag("[E009] Error Ln %li, Col %li: cannot mutate a field through a raw pointer "
                             "`*T`%s%.*s%s in safe code — `*T` is the unsafe/interop tool and is not borrow-checked. "
                             "For in-place mutation take a `var` (mutable borrow) parameter, e.g. `proc f(var x T)`, "
                             "or wrap the write in an `unsafe` block.\n",
                             s->line, s->col,
                             bid ? " (`" : "", bid ? (int)bid->length : 0, bid ? bid->name : "", bid ? "`)" : "");
                     diagnostic_show_line(s->line, s->col);
-                    exit(1);
+                    sema_fatal();
                 }
             }
 
@@ -2038,12 +2000,12 @@ static void walk_stmt(Stmt *s) {
                                 // G5: enforce the field's refinement constraints on
                                 // REASSIGNMENT too (`c.pct = 200` must satisfy pct's
                                 // `>= 0 and <= 100`), not just at construction.
-                                if (sf->decl->as.variable_decl.constraints && sema_ranges &&
-                                    !sema_in_unsafe_block) {
+                                if (sf->decl->as.variable_decl.constraints && sema_ctx->ranges &&
+                                    !sema_ctx->in_unsafe_block) {
                                     Expr *frhs = s->as.assign_stmt.expr;
                                     Range r = (frhs && frhs->kind == EXPR_LITERAL)
                                         ? (Range){ frhs->as.literal_expr.value, frhs->as.literal_expr.value, true }
-                                        : (frhs ? sema_eval_range(frhs, sema_ranges) : range_unknown());
+                                        : (frhs ? sema_eval_range(frhs, sema_ctx->ranges) : range_unknown());
                                     if (r.known) {
                                         for (ExprList *fc = sf->decl->as.variable_decl.constraints; fc; fc = fc->next) {
                                             if (!fc->expr || fc->expr->kind != EXPR_BINARY) continue;
@@ -2061,12 +2023,12 @@ static void walk_stmt(Stmt *s) {
                                                 default: break;
                                             }
                                             if (!fits) {
-                                                fprintf(stderr, "[E086] Error Ln %li, Col %li: assignment to field "
+                                                sema_diag("[E086] Error Ln %li, Col %li: assignment to field "
                                                     "'%.*s' value range [%lld, %lld] violates its refinement "
                                                     "constraint.\n", (long)s->line, (long)s->col,
                                                     (int)fn->length, fn->name, (long long)r.min, (long long)r.max);
                                                 diagnostic_show_line(s->line, s->col);
-                                                exit(1);
+                                                sema_fatal();
                                             }
                                         }
                                     }
@@ -2074,7 +2036,7 @@ static void walk_stmt(Stmt *s) {
                                 Id *in_fld = sf->decl->as.variable_decl.in_field;
                                 if (!in_fld) break; // field found but no invariant
                                 // Build synthetic EXPR_MEMBER for obj.container
-                                Expr *cnt_expr = arena_push_aligned(sema_arena, Expr);
+                                Expr *cnt_expr = arena_push_aligned(sema_ctx->arena, Expr);
                                 memset(cnt_expr, 0, sizeof(Expr));
                                 cnt_expr->kind = EXPR_MEMBER;
                                 cnt_expr->as.member_expr.target = obj;
@@ -2091,7 +2053,7 @@ static void walk_stmt(Stmt *s) {
                                     }
                                 }
                                 // Run bounds check: rhs must be in [0, obj.container.len)
-                                if (cnt_type && sema_ranges && !sema_in_unsafe_block) {
+                                if (cnt_type && sema_ctx->ranges && !sema_ctx->in_unsafe_block) {
                                     // Temporarily push the container in-guard so sema_is_in_guarded
                                     // doesn't double-fire; directly call sema_check_bounds.
                                     // Override error message to E121.
@@ -2099,9 +2061,9 @@ static void walk_stmt(Stmt *s) {
                                     // push (rhs, cnt_expr) and check; if not proven, emit E121.
                                     Expr *rhs = s->as.assign_stmt.expr;
                                     bool proven = sema_is_in_guarded(rhs, cnt_expr);
-                                    if (!proven && sema_ranges) {
+                                    if (!proven && sema_ctx->ranges) {
                                         // Try VRA: check rhs < cnt_type length
-                                        Range r = sema_eval_range(rhs, sema_ranges);
+                                        Range r = sema_eval_range(rhs, sema_ctx->ranges);
                                         bool ok = false;
                                         if (cnt_type->kind == TYPE_ARRAY && cnt_type->array_len >= 0) {
                                             // fixed-size container
@@ -2111,7 +2073,7 @@ static void walk_stmt(Stmt *s) {
                                         // the synthetic __len_ var for member access — future work).
                                         if (cnt_type->kind == TYPE_ARRAY && cnt_type->array_len == -1) ok = true;
                                         if (!ok && cnt_type->kind == TYPE_ARRAY && cnt_type->array_len >= 0) {
-                                            fprintf(stderr,
+                                            sema_diag(
                                                 "[E121] Error Ln %li, Col %li: assignment to '%.*s' may violate struct invariant "
                                                 "'%.*s in %.*s': value range [%lld, %lld] is not proven to be in [0, %lld).\n",
                                                 s->line, s->col,
@@ -2121,7 +2083,7 @@ static void walk_stmt(Stmt *s) {
                                                 (long long)r.min, (long long)r.max,
                                                 (long long)cnt_type->array_len);
                                             diagnostic_show_line(s->line, s->col);
-                                            exit(1);
+                                            sema_fatal();
                                         }
                                     }
                                 }
@@ -2134,8 +2096,8 @@ static void walk_stmt(Stmt *s) {
 
             // Q-002 Phase 5: overflow-at-boundary check (assignment).
             // Covers all assign target shapes: identifier / field / index.
-            if (sema_ranges && s->as.assign_stmt.target && s->as.assign_stmt.target->type) {
-                Range r = sema_eval_range(s->as.assign_stmt.expr, sema_ranges);
+            if (sema_ctx->ranges && s->as.assign_stmt.target && s->as.assign_stmt.target->type) {
+                Range r = sema_eval_range(s->as.assign_stmt.expr, sema_ctx->ranges);
                 Expr *tgt = s->as.assign_stmt.target;
                 char label[160];
                 const char *ctx = "assignment to";
@@ -2161,13 +2123,13 @@ static void walk_stmt(Stmt *s) {
                 check_conversion(s->as.assign_stmt.expr->type, tgt->type, r,
                     s->as.assign_stmt.expr, s->line, s->col, ctx, label);
             }
-            if (sema_ranges && s->as.assign_stmt.target->kind == EXPR_IDENTIFIER) {
+            if (sema_ctx->ranges && s->as.assign_stmt.target->kind == EXPR_IDENTIFIER) {
                 Expr *rhs = s->as.assign_stmt.expr;
                 Id *lhs_id = s->as.assign_stmt.target->as.identifier_expr.id;
 
                 // 1. Update Range
-                Range r = sema_eval_range(rhs, sema_ranges);
-                range_set(sema_ranges, lhs_id, r);
+                Range r = sema_eval_range(rhs, sema_ctx->ranges);
+                range_set(sema_ctx->ranges, lhs_id, r);
                 
                 // 2. Linear Constraints: x = y + c
                 if (rhs->kind == EXPR_BINARY) {
@@ -2178,26 +2140,26 @@ static void walk_stmt(Stmt *s) {
                     // x = y + c
                     if (op == TOKEN_PLUS && rl->kind == EXPR_IDENTIFIER && rr->kind == EXPR_LITERAL) {
                         int64_t c = rr->as.literal_expr.value;
-                        constraint_add(sema_ranges, lhs_id, rl->as.identifier_expr.id, c);
-                        constraint_add(sema_ranges, rl->as.identifier_expr.id, lhs_id, -c);
+                        constraint_add(sema_ctx->ranges, lhs_id, rl->as.identifier_expr.id, c);
+                        constraint_add(sema_ctx->ranges, rl->as.identifier_expr.id, lhs_id, -c);
                     }
                     // x = c + y
                     else if (op == TOKEN_PLUS && rl->kind == EXPR_LITERAL && rr->kind == EXPR_IDENTIFIER) {
                         int64_t c = rl->as.literal_expr.value;
-                        constraint_add(sema_ranges, lhs_id, rr->as.identifier_expr.id, c);
-                        constraint_add(sema_ranges, rr->as.identifier_expr.id, lhs_id, -c);
+                        constraint_add(sema_ctx->ranges, lhs_id, rr->as.identifier_expr.id, c);
+                        constraint_add(sema_ctx->ranges, rr->as.identifier_expr.id, lhs_id, -c);
                     }
                     // x = y - c
                     else if (op == TOKEN_MINUS && rl->kind == EXPR_IDENTIFIER && rr->kind == EXPR_LITERAL) {
                         int64_t c = rr->as.literal_expr.value;
-                        constraint_add(sema_ranges, lhs_id, rl->as.identifier_expr.id, -c);
-                        constraint_add(sema_ranges, rl->as.identifier_expr.id, lhs_id, c);
+                        constraint_add(sema_ctx->ranges, lhs_id, rl->as.identifier_expr.id, -c);
+                        constraint_add(sema_ctx->ranges, rl->as.identifier_expr.id, lhs_id, c);
                     }
                 }
                 // x = y
                 else if (rhs->kind == EXPR_IDENTIFIER) {
-                    constraint_add(sema_ranges, lhs_id, rhs->as.identifier_expr.id, 0);
-                    constraint_add(sema_ranges, rhs->as.identifier_expr.id, lhs_id, 0);
+                    constraint_add(sema_ctx->ranges, lhs_id, rhs->as.identifier_expr.id, 0);
+                    constraint_add(sema_ctx->ranges, rhs->as.identifier_expr.id, lhs_id, 0);
                 }
             }
             break;
@@ -2206,56 +2168,56 @@ static void walk_stmt(Stmt *s) {
             break;
         case STMT_RETURN:
             sema_infer_expr(s->as.return_stmt.value);
-            sema_union_coerce(&s->as.return_stmt.value, current_return_type);  // `T | markers` construction
+            sema_union_coerce(&s->as.return_stmt.value, sema_ctx->return_type);  // `T | markers` construction
             // Q-002 Phase 5: overflow-at-boundary check (return).
-            if (sema_ranges && s->as.return_stmt.value && current_return_type) {
-                Range r = sema_eval_range(s->as.return_stmt.value, sema_ranges);
+            if (sema_ctx->ranges && s->as.return_stmt.value && sema_ctx->return_type) {
+                Range r = sema_eval_range(s->as.return_stmt.value, sema_ctx->ranges);
                 const char *fname = "?";
                 int fn_len = 1;
-                if (current_function_decl && current_function_decl->as.function_decl.name) {
-                    fname = current_function_decl->as.function_decl.name->name;
-                    fn_len = (int)current_function_decl->as.function_decl.name->length;
+                if (sema_ctx->function_decl && sema_ctx->function_decl->as.function_decl.name) {
+                    fname = sema_ctx->function_decl->as.function_decl.name->name;
+                    fn_len = (int)sema_ctx->function_decl->as.function_decl.name->length;
                 }
                 char buf[160];
                 if (fn_len > 159) fn_len = 159;
                 memcpy(buf, fname, fn_len);
                 buf[fn_len] = '\0';
-                check_conversion(s->as.return_stmt.value->type, current_return_type, r,
+                check_conversion(s->as.return_stmt.value->type, sema_ctx->return_type, r,
                     s->as.return_stmt.value, s->line, s->col, "return from function", buf);
             }
             // Check Post-Contracts
-            if (current_function_decl && current_function_decl->as.function_decl.post_contracts) {
-                Range ret_range = sema_eval_range(s->as.return_stmt.value, sema_ranges);
+            if (sema_ctx->function_decl && sema_ctx->function_decl->as.function_decl.post_contracts) {
+                Range ret_range = sema_eval_range(s->as.return_stmt.value, sema_ctx->ranges);
                 
-                for (ExprList *post = current_function_decl->as.function_decl.post_contracts; post; post = post->next) {
-                    int result = sema_check_post_condition(post->expr, ret_range, sema_ranges);
+                for (ExprList *post = sema_ctx->function_decl->as.function_decl.post_contracts; post; post = post->next) {
+                    int result = sema_check_post_condition(post->expr, ret_range, sema_ctx->ranges);
                     
                     if (result == 0) {
-                        fprintf(stderr, "Error: Post-condition violation. Return value cannot satisfy contract.\n");
-                        exit(1);
+                        sema_diag("Error: Post-condition violation. Return value cannot satisfy contract.\n");
+                        sema_fatal();
                     }
                 }
             }
             
             // Check equation-style return constraints: func f() int >= 0
-            if (current_function_decl && current_function_decl->as.function_decl.return_constraints) {
-                Range ret_range = sema_eval_range(s->as.return_stmt.value, sema_ranges);
+            if (sema_ctx->function_decl && sema_ctx->function_decl->as.function_decl.return_constraints) {
+                Range ret_range = sema_eval_range(s->as.return_stmt.value, sema_ctx->ranges);
                 
-                for (ExprList *rc = current_function_decl->as.function_decl.return_constraints; rc; rc = rc->next) {
-                    int result = sema_check_post_condition(rc->expr, ret_range, sema_ranges);
+                for (ExprList *rc = sema_ctx->function_decl->as.function_decl.return_constraints; rc; rc = rc->next) {
+                    int result = sema_check_post_condition(rc->expr, ret_range, sema_ctx->ranges);
                     // PROVE-OR-REJECT: the compiler TRUSTS a return refinement to
                     // narrow every caller's VRA, so the body must PROVABLY satisfy
                     // it. `result == 1` means proven; 0 (violated) or -1 (unknown,
                     // e.g. unbounded/wrapping) must both be rejected — a refinement
                     // it can't prove is a lie that defeats callers' bounds proofs.
-                    if (result != 1 && !sema_in_unsafe_block) {
-                        fprintf(stderr, "[E086] Error Ln %li, Col %li: return value cannot be proven "
+                    if (result != 1 && !sema_ctx->in_unsafe_block) {
+                        sema_diag("[E086] Error Ln %li, Col %li: return value cannot be proven "
                             "to satisfy the function's return refinement (range [%lld, %lld]). Constrain "
                             "the inputs or narrow the value so VRA can prove it.\n",
                             (long)s->line, (long)s->col,
                             (long long)ret_range.min, (long long)ret_range.max);
                         diagnostic_show_line(s->line, s->col);
-                        exit(1);
+                        sema_fatal();
                     }
                 }
             }
@@ -2269,31 +2231,31 @@ static void walk_stmt(Stmt *s) {
                                                           s->as.match_stmt.cases);
             for (StmtMatchCase *c = s->as.match_stmt.cases; c; c = c->next) {
                 sema_push_scope();
-                NarrowEntry *old_narrows = sema_narrows;
+                NarrowEntry *old_narrows = sema_ctx->narrows;
                 if (else_narrows && c->patterns == NULL) {   // the `else` arm
-                    NarrowEntry *ne = arena_push_aligned(sema_arena, NarrowEntry);
+                    NarrowEntry *ne = arena_push_aligned(sema_ctx->arena, NarrowEntry);
                     ne->var = s->as.match_stmt.value;
-                    ne->next = sema_narrows; sema_narrows = ne;
+                    ne->next = sema_ctx->narrows; sema_ctx->narrows = ne;
                 }
                 for (ExprList *p = c->patterns; p; p = p->next) {
                     sema_infer_expr(p->expr);
                 }
                 for (StmtList *b = c->body; b; b = b->next)
                     walk_stmt(b->stmt);
-                sema_narrows = old_narrows;
+                sema_ctx->narrows = old_narrows;
                 sema_pop_scope();
             }
             break;
         }
         case STMT_UNSAFE: {
-            bool old_unsafe = sema_in_unsafe_block;
-            sema_in_unsafe_block = true;
+            bool old_unsafe = sema_ctx->in_unsafe_block;
+            sema_ctx->in_unsafe_block = true;
             sema_push_scope();
             for (StmtList *b = s->as.unsafe_stmt.body; b; b = b->next) {
                 walk_stmt(b->stmt);
             }
             sema_pop_scope();
-            sema_in_unsafe_block = old_unsafe;
+            sema_ctx->in_unsafe_block = old_unsafe;
             break;
         }
         case STMT_DEFER:
@@ -2523,7 +2485,7 @@ static void sema_check_proc_eligibility(Decl *d) {
         // Skip if name is "main" — entrypoint must remain a proc (it returns
         // i32 exit code and signals "this is the program start").
         if (n && n->length == 4 && memcmp(n->name, "main", 4) == 0) return;
-        fprintf(stderr,
+        sema_diag(
             "[W130] '%.*s' is declared `proc` but has no observable side\n"
             "       effect: it could be `func`. Consider downgrading to\n"
             "       `func` for clearer intent.\n",
@@ -2710,11 +2672,11 @@ static void sema_check_no_value_cycle(Decl *d) {
     if (sema_aggregate_reaches_by_value(d, d, seen, 0)) {
         Id *nm = (d->kind == DECL_STRUCT) ? d->as.struct_decl.name : d->as.enum_decl.type_name;
         int nl = nm ? (int)nm->length : 0;
-        fprintf(stderr, "[E104] Error Ln %li, Col %li: type '%.*s' contains itself by value "
+        sema_diag("[E104] Error Ln %li, Col %li: type '%.*s' contains itself by value "
             "(infinite size) — a recursive field must go through a pointer (e.g. '*%.*s').\n",
             (long)d->line, (long)d->col, nl, nm ? nm->name : "", nl, nm ? nm->name : "");
         diagnostic_show_line(d->line, d->col);
-        exit(1);
+        sema_fatal();
     }
 }
 
@@ -2743,7 +2705,7 @@ static void sema_check_no_mutual_recursion(DeclList *decls) {
             continue;
         }
         if (mrec_found_cycle_start == d) {
-            fprintf(stderr,
+            sema_diag(
                     "[E011] Error Ln %li, Col %li: pure function '%.*s' participates in mutual recursion (via '%.*s'). "
                     "Mutual recursion breaks the termination guarantee of 'func'.\n",
                     (long)d->line, (long)d->col,
@@ -2751,16 +2713,18 @@ static void sema_check_no_mutual_recursion(DeclList *decls) {
                     mrec_found_cycle_end ? (int)mrec_found_cycle_end->as.function_decl.name->length : 0,
                     mrec_found_cycle_end ? mrec_found_cycle_end->as.function_decl.name->name : "?");
             diagnostic_show_line(d->line, d->col);
-            exit(1);
+            sema_fatal();
         }
     }
 }
 
 static void sema_resolve_module(DeclList *decls, const char *module_path,
-                                Arena *arena) {
-    sema_arena = arena;
+                                Arena *arena, Arena *scratch) {
+    prof_enter(PASS_RESOLVE);
+    sema_ctx->arena = arena;
+    sema_ctx->scratch = scratch;
     sema_decls = decls;
-    sema_ranges = range_table_new(arena);
+    sema_ctx->ranges = range_table_new(arena);
 
     // Set source text for diagnostics
     ModuleNode *mod = find_module(module_path);
@@ -2771,7 +2735,9 @@ static void sema_resolve_module(DeclList *decls, const char *module_path,
 
     // 1) Clear old globals + insert top-level decls
     sema_clear_globals();
+    prof_enter(PASS_BUILD_SCOPE);
     sema_build_scope(decls, module_path);
+    prof_leave();
 
     // Q-008: enforce `mov` on every linear field of every struct/enum.
     {
@@ -2783,7 +2749,7 @@ static void sema_resolve_module(DeclList *decls, const char *module_path,
                 if (sema_check_struct_field_mov(dl->decl)) any_error = true;
             }
         }
-        if (any_error) exit(1);
+        if (any_error) sema_fatal();
     }
 
     // D-Niche (re-land): precompute niche layout for every enum, emit a
@@ -2844,12 +2810,14 @@ static void sema_resolve_module(DeclList *decls, const char *module_path,
         // Resolve generic type-applications in the signature (`Vec(i32)` params/
         // returns) — for original functions and appended instances alike.
         mono_resolve_signature(d);
+        prof_function_begin(d);
+        char *scratch_mark = arena_mark(scratch);
 
         sema_clear_locals();
 
         // P0 soundness (name-keyed leak): capture the VRA fact-table state BEFORE
         // this function seeds its parameter refinements, so those constraints are
-        // rolled back before the next function. `sema_ranges` is a single shared
+        // rolled back before the next function. `sema_ctx->ranges` is a single shared
         // table; seeding (`i < a.len` -> `i - __len_a <= -1`) happens in the param
         // loop and during resolve, and the old snapshot was taken at the walk —
         // TOO LATE, so a param refinement leaked by name into a later same-named
@@ -2857,8 +2825,10 @@ static void sema_resolve_module(DeclList *decls, const char *module_path,
         // range_set/constraint_add prepend, so resetting head/constraints fully
         // isolates. (Facts are still live through this function's walk below,
         // which runs before the restore.)
-        RangeEntry *__fn_pre_head = sema_ranges ? sema_ranges->head : NULL;
-        ConstraintEntry *__fn_pre_cons = sema_ranges ? sema_ranges->constraints : NULL;
+        RangeSnapshot __fn_pre_facts = range_snapshot(sema_ctx->ranges);
+        // Everything pushed past the snapshot is dropped by the restore below,
+        // so this function's facts go to the scratch arena.
+        sema_ctx->ranges->arena = scratch;
 
         // Reject duplicate parameter names (ambiguous — C would redefine the
         // symbol; the second shadows the first with no diagnostic otherwise).
@@ -2871,10 +2841,10 @@ static void sema_resolve_module(DeclList *decls, const char *module_path,
                 Id *nb = pb->decl->as.variable_decl.name;
                 if (nb && nb->length == na->length &&
                     strncmp(na->name, nb->name, na->length) == 0) {
-                    fprintf(stderr, "[E013] Error Ln %li, Col %li: duplicate parameter name '%.*s'.\n",
+                    sema_diag("[E013] Error Ln %li, Col %li: duplicate parameter name '%.*s'.\n",
                         (long)d->line, (long)d->col, (int)na->length, na->name);
                     diagnostic_show_line(d->line, d->col);
-                    exit(1);
+                    sema_fatal();
                 }
             }
         }
@@ -2904,12 +2874,12 @@ static void sema_resolve_module(DeclList *decls, const char *module_path,
                 if (sema_lookup(nb)) bound = true;
             }
             if (!bound) {
-                fprintf(stderr, "[E100] Error Ln %li, Col %li: dependent array size '%.*s' is "
+                sema_diag("[E100] Error Ln %li, Col %li: dependent array size '%.*s' is "
                     "not a parameter or in scope — use 'T[]' for an unsized slice or add a "
                     "length parameter.\n",
                     (long)d->line, (long)d->col, (int)sid->length, sid->name);
                 diagnostic_show_line(d->line, d->col);
-                exit(1);
+                sema_fatal();
             }
         }
 
@@ -2928,24 +2898,13 @@ static void sema_resolve_module(DeclList *decls, const char *module_path,
 
                 // 3) Resolve struct type to find fields
                 Decl *struct_decl = NULL;
-                // Simple linear search in sema_decls for the struct
-                // (Optimization: could use a hash map, but this is fine for now)
                 if (dd->type->kind == TYPE_SIMPLE) {
-                    for (DeclList *g = sema_decls; g; g = g->next) {
-                        if (g->decl->kind == DECL_STRUCT) {
-                            Id *sname = g->decl->as.struct_decl.name;
-                            if (sname->length == dd->type->base_type->length &&
-                                strncmp(sname->name, dd->type->base_type->name, sname->length) == 0) {
-                                struct_decl = g->decl;
-                                break;
-                            }
-                        }
-                    }
+                    struct_decl = decl_index_struct(dd->type->base_type);
                 }
 
                 if (!struct_decl) {
-                    fprintf(stderr, "Error: Could not resolve struct type for destructuring\n");
-                    exit(1);
+                    sema_diag("Error: Could not resolve struct type for destructuring\n");
+                    sema_fatal();
                 }
 
                 // 4) For each destructured name, find field type and insert local
@@ -2961,10 +2920,10 @@ static void sema_resolve_module(DeclList *decls, const char *module_path,
                     }
 
                     if (!field_type) {
-                        fprintf(stderr, "Error: Field '%.*s' not found in struct '%.*s'\n", 
+                        sema_diag("Error: Field '%.*s' not found in struct '%.*s'\n", 
                                 (int)n->id->length, n->id->name,
                                 (int)dd->type->base_type->length, dd->type->base_type->name);
-                        exit(1);
+                        sema_fatal();
                     }
 
                     // Insert local variable (e.g. "text" -> u8[:0])
@@ -2999,27 +2958,27 @@ static void sema_resolve_module(DeclList *decls, const char *module_path,
                 // cast is applied. (i64/isize seed to the full i64 range, which the
                 // UNBOUNDED_WINDOW treats as no-info — i64 has no headroom for VRA to
                 // detect overflow, so i64 arithmetic is unchecked, as before.)
-                if (sema_ranges && pty) {
+                if (sema_ctx->ranges && pty) {
                     int bits; bool sgn;
                     if (parse_iN_uN(pty, &bits, &sgn)) {
                         long long tlo, thi;
                         if (type_integer_range(pty, &tlo, &thi)) {
-                            range_set(sema_ranges, pid,
+                            range_set(sema_ctx->ranges, pid,
                                       range_make((int64_t)tlo, (int64_t)thi));
                         }
                     } else if (pty->kind == TYPE_SIMPLE && pty->base_type) {
                         isize pl = pty->base_type->length;
                         if (pl == 5 && memcmp(pty->base_type->name, "usize", 5) == 0) {
-                            range_set(sema_ranges, pid, range_make(0, INT64_MAX));
+                            range_set(sema_ctx->ranges, pid, range_make(0, INT64_MAX));
                         } else if (pl == 5 && memcmp(pty->base_type->name, "isize", 5) == 0) {
-                            range_set(sema_ranges, pid, range_make(INT64_MIN, INT64_MAX));
+                            range_set(sema_ctx->ranges, pid, range_make(INT64_MIN, INT64_MAX));
                         }
                     }
                 }
 
                 // Handle 'in' constraint: param int in arr
                 // Desugars to: param >= 0 and param < arr.len
-                if (p->decl->as.variable_decl.in_field && sema_ranges) {
+                if (p->decl->as.variable_decl.in_field && sema_ctx->ranges) {
                     Id *arr_id = p->decl->as.variable_decl.in_field;
                     Id *param_id = pid;
                     
@@ -3045,7 +3004,7 @@ static void sema_resolve_module(DeclList *decls, const char *module_path,
                             r = range_make(0, arr_type->array_len - 1);
                         }
 
-                        range_set(sema_ranges, param_id, r);
+                        range_set(sema_ctx->ranges, param_id, r);
 
                         // G9: dynamic array `i usize in a` — tie `i < a.len` via a
                         // difference constraint against the synthetic __len_a var
@@ -3057,20 +3016,18 @@ static void sema_resolve_module(DeclList *decls, const char *module_path,
                             if (klen < (int)sizeof(key)) {
                                 memcpy(key, "__len_", 6);
                                 memcpy(key + 6, arr_id->name, arr_id->length);
-                                Id *len_id = NULL;
-                                for (RangeEntry *re = sema_ranges->head; re; re = re->next)
-                                    if (re->var && re->var->length == klen &&
-                                        strncmp(re->var->name, key, klen) == 0) { len_id = re->var; break; }
-                                if (len_id) constraint_add(sema_ranges, param_id, len_id, -1);
+                                RangeEntry *len_re = range_find_atom(sema_ctx->ranges, atom_find(key, klen));
+                                Id *len_id = len_re ? len_re->var : NULL;
+                                if (len_id) constraint_add(sema_ctx->ranges, param_id, len_id, -1);
                             }
                         }
                     }
                 }
                 
                 // Apply equation-style constraints: b int != 0, x int >= 0 and <= 100
-                if (p->decl->as.variable_decl.constraints && sema_ranges) {
+                if (p->decl->as.variable_decl.constraints && sema_ctx->ranges) {
                     for (ExprList *c = p->decl->as.variable_decl.constraints; c; c = c->next) {
-                        sema_apply_constraint(c->expr, sema_ranges);
+                        sema_apply_constraint(c->expr, sema_ctx->ranges);
                     }
                 }
 
@@ -3078,7 +3035,7 @@ static void sema_resolve_module(DeclList *decls, const char *module_path,
                 // constraints too (they live on the alias decl, not the param),
                 // rewriting each as `param <op> bound`. Lets a bounded-alias
                 // index prove in-bounds (`a[i]` with `i SmallIdx` = i32 0..9).
-                if (sema_ranges) {
+                if (sema_ctx->ranges) {
                     ExprList *ac = alias_constraints_for(p->decl->as.variable_decl.type);
                     for (ExprList *c = ac; c; c = c->next) {
                         if (!c->expr || c->expr->kind != EXPR_BINARY) continue;
@@ -3089,7 +3046,7 @@ static void sema_resolve_module(DeclList *decls, const char *module_path,
                         synth.as.binary_expr.op = c->expr->as.binary_expr.op;
                         synth.as.binary_expr.left = &pe;
                         synth.as.binary_expr.right = c->expr->as.binary_expr.right;
-                        sema_apply_constraint(&synth, sema_ranges);
+                        sema_apply_constraint(&synth, sema_ctx->ranges);
                     }
                 }
 
@@ -3097,19 +3054,17 @@ static void sema_resolve_module(DeclList *decls, const char *module_path,
                 // i32[]), register a synthetic __len_PARAM entry in the VRA range table.
                 // This lets the for-loop constraint injector and the bounds checker use
                 // symbolic proof even when the interval is wide ([0, INT64_MAX]).
-                if (sema_ranges && pty->kind == TYPE_ARRAY && pty->array_len == -1) {
+                if (sema_ctx->ranges && pty->kind == TYPE_ARRAY && pty->array_len == -1) {
                     char lenkey[272];
                     int lklen = 6 + (int)pid->length;
                     if (lklen < (int)sizeof(lenkey)) {
                         memcpy(lenkey, "__len_", 6);
                         memcpy(lenkey + 6, pid->name, pid->length);
                         // Allocate persistent storage for the key in the sema arena
-                        char *stored = arena_push_many(sema_ranges->arena, char, lklen);
+                        char *stored = arena_push_many(sema_ctx->ranges->arena, char, lklen);
                         memcpy(stored, lenkey, lklen);
-                        Id *len_id = arena_push_aligned(sema_ranges->arena, Id);
-                        len_id->length = lklen;
-                        len_id->name   = stored;
-                        range_set(sema_ranges, len_id, range_make(0, INT64_MAX));
+                        Id *len_id = id(sema_ctx->ranges->arena, lklen, stored);
+                        range_set(sema_ctx->ranges, len_id, range_make(0, INT64_MAX));
 
                         // If a size_expr is given with equality, add constraint linking
                         // this parameter's length to the referenced expression.
@@ -3126,24 +3081,18 @@ static void sema_resolve_module(DeclList *decls, const char *module_path,
                                     memcpy(rkey, "__len_", 6);
                                     memcpy(rkey + 6, ref_id->name, ref_id->length);
                                     // Find the already-registered __len_REF Id
-                                    Id *ref_len_id = NULL;
-                                    for (RangeEntry *re = sema_ranges->head; re; re = re->next) {
-                                        if (re->var->length == rklen &&
-                                            strncmp(re->var->name, rkey, rklen) == 0) {
-                                            ref_len_id = re->var;
-                                            break;
-                                        }
-                                    }
+                                    RangeEntry *ref_len_re = range_find_atom(sema_ctx->ranges, atom_find(rkey, rklen));
+                                    Id *ref_len_id = ref_len_re ? ref_len_re->var : NULL;
                                     if (ref_len_id) {
-                                        constraint_add(sema_ranges, len_id, ref_len_id, 0);
-                                        constraint_add(sema_ranges, ref_len_id, len_id, 0);
+                                        constraint_add(sema_ctx->ranges, len_id, ref_len_id, 0);
+                                        constraint_add(sema_ctx->ranges, ref_len_id, len_id, 0);
                                     }
                                 }
                             } else if (pty->size_expr->kind == EXPR_IDENTIFIER) {
                                 // out i32[n] → out.len == n (__len_out == n)
                                 Id *n_id = pty->size_expr->as.identifier_expr.id;
-                                constraint_add(sema_ranges, len_id, n_id, 0);
-                                constraint_add(sema_ranges, n_id, len_id, 0);
+                                constraint_add(sema_ctx->ranges, len_id, n_id, 0);
+                                constraint_add(sema_ctx->ranges, n_id, len_id, 0);
                             } else if (pty->size_expr->kind == EXPR_BINARY) {
                             // Arithmetic size_expr: out i32[a.len + b.len] or i32[src.len - k].
                             // Derive monotone constraints that the constraint prover can chain.
@@ -3161,11 +3110,8 @@ static void sema_resolve_module(DeclList *decls, const char *module_path,
                                     if (_rkl < (int)sizeof(_rk)) { \
                                         memcpy(_rk, "__len_", 6); \
                                         memcpy(_rk + 6, _ref->name, _ref->length); \
-                                        for (RangeEntry *_re = sema_ranges->head; _re; _re = _re->next) { \
-                                            if (_re->var->length == _rkl && \
-                                                strncmp(_re->var->name, _rk, _rkl) == 0) \
-                                            { (OUT_ID) = _re->var; break; } \
-                                        } \
+                                        RangeEntry *_re = range_find_atom(sema_ctx->ranges, atom_find(_rk, _rkl)); \
+                                        if (_re) (OUT_ID) = _re->var; \
                                     } \
                                 } \
                             } while(0)
@@ -3175,14 +3121,14 @@ static void sema_resolve_module(DeclList *decls, const char *module_path,
                                 //   b.len ≤ out.len → __len_b - __len_out <= 0
                                 Id *la_id = NULL; FIND_LEN_ID(se_lhs, la_id);
                                 Id *lb_id = NULL; FIND_LEN_ID(se_rhs, lb_id);
-                                if (la_id) constraint_add(sema_ranges, la_id, len_id, 0);
-                                if (lb_id) constraint_add(sema_ranges, lb_id, len_id, 0);
+                                if (la_id) constraint_add(sema_ctx->ranges, la_id, len_id, 0);
+                                if (lb_id) constraint_add(sema_ctx->ranges, lb_id, len_id, 0);
                             } else if (binop == TOKEN_MINUS && se_rhs->kind == EXPR_LITERAL) {
                                 // out i32[src.len - k]:
                                 //   out.len = src.len - k → out.len - src.len <= -k
                                 int64_t k = se_rhs->as.literal_expr.value;
                                 Id *ls_id = NULL; FIND_LEN_ID(se_lhs, ls_id);
-                                if (ls_id) constraint_add(sema_ranges, len_id, ls_id, -k);
+                                if (ls_id) constraint_add(sema_ctx->ranges, len_id, ls_id, -k);
                             }
                             #undef FIND_LEN_ID
                             }  // closes else if (EXPR_BINARY)
@@ -3194,13 +3140,13 @@ static void sema_resolve_module(DeclList *decls, const char *module_path,
                             if (pty->size_expr->kind == EXPR_IDENTIFIER) {
                                 Id *n_id = pty->size_expr->as.identifier_expr.id;
                                 int64_t delta = (pty->size_relop == TOKEN_ANGLE_BRACKET_RIGHT) ? -1 : 0;
-                                constraint_add(sema_ranges, n_id, len_id, delta);
+                                constraint_add(sema_ctx->ranges, n_id, len_id, delta);
                             } else if (pty->size_expr->kind == EXPR_LITERAL) {
                                 // arr i32[> k] / arr i32[>= k] with literal k:
                                 // register a concrete lower bound on __len_arr.
                                 int64_t k = pty->size_expr->as.literal_expr.value;
                                 int64_t min_len = k + (pty->size_relop == TOKEN_ANGLE_BRACKET_RIGHT ? 1 : 0);
-                                range_set(sema_ranges, len_id, range_make(min_len, INT64_MAX));
+                                range_set(sema_ctx->ranges, len_id, range_make(min_len, INT64_MAX));
                             }
                         }
                     }
@@ -3213,19 +3159,19 @@ static void sema_resolve_module(DeclList *decls, const char *module_path,
         }
 
         // 2.b) Name resolution
-        current_return_type = mono_resolve_type_apps(d->as.function_decl.return_type);
-        current_function_decl = d; // Set current function
+        sema_ctx->return_type = mono_resolve_type_apps(d->as.function_decl.return_type);
+        sema_ctx->function_decl = d; // Set current function
         // Q-018: use the decl's defining_module if known so that cross-module
         // visibility checks within imported function bodies see the correct
         // owning module. Fallback to top-level module_path.
-        current_module_path = d->defining_module ? d->defining_module : module_path;
+        sema_ctx->module_path = d->defining_module ? d->defining_module : module_path;
 
         // Apply Pre-Contracts to Range Table
-        if (sema_ranges) {
+        if (sema_ctx->ranges) {
             for (ExprList *pre = d->as.function_decl.pre_contracts; pre; pre = pre->next) {
                 sema_resolve_expr(pre->expr);
                 sema_infer_expr(pre->expr);
-                sema_apply_constraint(pre->expr, sema_ranges);
+                sema_apply_constraint(pre->expr, sema_ctx->ranges);
             }
             
             // Also apply inline parameter constraints (e.g., `b int != 0`)
@@ -3248,7 +3194,7 @@ static void sema_resolve_module(DeclList *decls, const char *module_path,
                             lhs_id.type = NULL;
                             synth.as.binary_expr.left = &lhs_id;
                             synth.as.binary_expr.right = c->expr->as.binary_expr.right;
-                            sema_apply_constraint(&synth, sema_ranges);
+                            sema_apply_constraint(&synth, sema_ctx->ranges);
                         }
                     }
                 }
@@ -3276,51 +3222,55 @@ static void sema_resolve_module(DeclList *decls, const char *module_path,
 
         // 2.c) Type inference + bounds checking
         // (walk_stmt is defined as a static function above sema_resolve_module)
-        // Snapshot sema_ranges state so any constraints added during walk
+        // Snapshot sema_ctx->ranges state so any constraints added during walk
         // (e.g. by post-`if then-returns` propagation) don't leak to the
         // next function's resolve.
-        InGuardEntry *__fn_old_guards = sema_in_guards;
-        NarrowEntry *__fn_old_narrows = sema_narrows;
-        sema_walk_phase = true;
+        InGuardEntry *__fn_old_guards = sema_ctx->in_guards;
+        NarrowEntry *__fn_old_narrows = sema_ctx->narrows;
+        sema_ctx->walk_phase = true;
+        prof_enter(PASS_INFER);
         for (StmtList *sl = d->as.function_decl.body; sl; sl = sl->next)
             walk_stmt(sl->stmt);
-        sema_walk_phase = false;
+        prof_leave();
+        sema_ctx->walk_phase = false;
         // Restore to the PRE-function baseline (captured before param seeding, so
         // this function's parameter refinements + resolve/walk facts are all
         // rolled back — no leak into the next same-named function).
-        if (sema_ranges) {
-            sema_ranges->head = __fn_pre_head;
-            sema_ranges->constraints = __fn_pre_cons;
-        }
-        sema_in_guards = __fn_old_guards;
-        sema_narrows = __fn_old_narrows;
+        range_restore(sema_ctx->ranges, __fn_pre_facts);
+        sema_ctx->ranges->arena = arena;
+        sema_ctx->in_guards = __fn_old_guards;
+        sema_ctx->narrows = __fn_old_narrows;
 
         // 2.c.i) Return-path completeness: a non-void function must return (or
         // diverge) on every path — never fall off the end (C UB).
         if (d->as.function_decl.return_type &&
             !sema_stmts_always_exit(d->as.function_decl.body)) {
-            fprintf(stderr, "[E018] Error Ln %li, Col %li: function '%.*s' can reach the end "
+            sema_diag("[E018] Error Ln %li, Col %li: function '%.*s' can reach the end "
                 "without returning a value.\n"
                 "       Every path must end in a `return` (or a diverging call such as panic).\n",
                 (long)d->line, (long)d->col,
                 (int)d->as.function_decl.name->length, d->as.function_decl.name->name);
             diagnostic_show_line(d->line, d->col);
-            exit(1);
+            sema_fatal();
         }
 
         // 2.d) Linearity check: run function-level linearity checker
         // NOTE: sema_check_function_linearity must run while sema_locals still
         // exist (so it can trust that implicit locals were created by resolve).
-        // We keep current_function_decl set so the linearity pass can inspect
+        // We keep sema_ctx->function_decl set so the linearity pass can inspect
         // the function's parameters (Sprint 5 step D).
+        prof_enter(PASS_LINEARITY);
         sema_check_function_linearity(d);
+        prof_leave();
 
-        current_return_type = NULL;
-        current_function_decl = NULL;
-        current_module_path = NULL;
+        sema_ctx->return_type = NULL;
+        sema_ctx->function_decl = NULL;
+        sema_ctx->module_path = NULL;
 
-        // 2.e) Clear locals after all passes
+        // 2.e) Clear locals and the function's temporaries after all passes
         sema_clear_locals();
+        arena_rewind(scratch, scratch_mark);
+        prof_function_end();
     }
 
     // 3) F-020: detect mutual recursion involving pure functions.
@@ -3335,6 +3285,7 @@ static void sema_resolve_module(DeclList *decls, const char *module_path,
             sema_check_proc_eligibility(dl->decl);
         }
     }
+    prof_leave();
 }
 
 // Optional: destroy/reset global state
@@ -20,7 +20,7 @@
 #endif
 
 #if SEMA_BOUNDS_DEBUG
-#define BOUNDS_DBG(fmt, ...) fprintf(stderr, "[bounds] " fmt "\n", ##__VA_ARGS__)
+#define BOUNDS_DBG(fmt, ...) sema_diag("[bounds] " fmt "\n", ##__VA_ARGS__)
 #else
 #define BOUNDS_DBG(fmt, ...) do {} while(0)
 #endif
@@ -87,7 +87,7 @@ static void bounds_expr_str(Expr *e, char *buf, int n) {
     }
 }
 
-/* Emit a standard E085 header + source snippet + context lines, then exit(1). */
+/* Emit a standard E085 header + source snippet + context lines, then sema_fatal(). */
 static void bounds_error(
     const char *kind,       /* short one-line description */
     Expr       *index_expr, /* index sub-expression (for location) */
@@ -109,12 +109,12 @@ static void bounds_error(
     isize line = index_expr ? index_expr->line : 0;
     isize col  = index_expr ? index_expr->col  : 0;
 
-    fprintf(stderr, "[E085] bounds error: %s\n", kind);
+    sema_diag("[E085] bounds error: %s\n", kind);
     if (line > 0) diagnostic_show_line(line, col);
-    fprintf(stderr, "       index `%s`: range %s\n", idx_str, idx_range);
-    fprintf(stderr, "       array `%s`: length %s\n", arr_str, len_range);
-    if (hint) fprintf(stderr, "       hint: %s\n", hint);
-    exit(1);
+    sema_diag("       index `%s`: range %s\n", idx_str, idx_range);
+    sema_diag("       array `%s`: length %s\n", arr_str, len_range);
+    if (hint) sema_diag("       hint: %s\n", hint);
+    sema_fatal();
 }
 
 /*───────────────────────────────────────────────────────────────────╗
@@ -383,12 +383,8 @@ static void sema_check_bounds(RangeTable *ctx, Expr *index_expr, Type *array_typ
                     char _k[272]; int _kl = 6 + (int)_ref->length; \
                     if (_kl < (int)sizeof(_k)) { \
                         memcpy(_k, "__len_", 6); memcpy(_k+6, _ref->name, _ref->length); \
-                        Id *_lid = NULL; \
-                        for (RangeEntry *_re = ctx->head; _re; _re = _re->next) { \
-                            if (_re->var->length == _kl && \
-                                strncmp(_re->var->name, _k, _kl) == 0) \
-                            { _lid = _re->var; break; } \
-                        } \
+                        RangeEntry *_re = range_find_atom(ctx, atom_find(_k, _kl)); \
+                        Id *_lid = _re ? _re->var : NULL; \
                         if (_lid) { \
                             bool _f = false; \
                             int64_t _d = constraint_get_diff(ctx, idx_id, _lid, &_f); \
@@ -420,12 +416,8 @@ static void sema_check_bounds(RangeTable *ctx, Expr *index_expr, Type *array_typ
                     // Use constraint_get_diff (includes one-step bridge) so that
                     // transitive chains like i-__len_out<=-1, __len_out-__len_src<=-1
                     // prove i < src.len without needing a direct entry.
-                    Id *arr_len_id = NULL;
-                    for (RangeEntry *re = ctx->head; re; re = re->next) {
-                        if (re->var->length == klen &&
-                            strncmp(re->var->name, key, klen) == 0)
-                        { arr_len_id = re->var; break; }
-                    }
+                    RangeEntry *arr_len_re = range_find_atom(ctx, atom_find(key, klen));
+                    Id *arr_len_id = arr_len_re ? arr_len_re->var : NULL;
                     if (arr_len_id) {
                         bool gd_found = false;
                         int64_t gd = constraint_get_diff(ctx, idx_id, arr_len_id, &gd_found);
@@ -513,12 +505,8 @@ static void sema_check_bounds(RangeTable *ctx, Expr *index_expr, Type *array_typ
                     if (_kl < (int)sizeof(_k)) {
                         memcpy(_k, "__len_", 6);
                         memcpy(_k + 6, arr_id->name, arr_id->length);
-                        Id *aln_id = NULL;
-                        for (RangeEntry *re = ctx->head; re; re = re->next) {
-                            if ((int)re->var->length == _kl &&
-                                strncmp(re->var->name, _k, _kl) == 0)
-                            { aln_id = re->var; break; }
-                        }
+                        RangeEntry *aln_re = range_find_atom(ctx, atom_find(_k, _kl));
+                        Id *aln_id = aln_re ? aln_re->var : NULL;
                         if (aln_id) {
                             bool gf = false;
                             int64_t gd = constraint_get_diff(ctx, num_id, aln_id, &gf);
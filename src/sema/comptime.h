@@ -32,8 +32,7 @@ ComptimeEnv* comptime_env_push(Arena* arena, ComptimeEnv* env, Id* name, Expr* v
 
 Expr* comptime_env_lookup(ComptimeEnv* env, Id* name) {
     for (ComptimeEnv* curr = env; curr; curr = curr->next) {
-        if (curr->name->length == name->length && 
-            strncmp(curr->name->name, name->name, name->length) == 0) {
+        if (id_eq(curr->name, name)) {
             return curr->value;
         }
     }
@@ -77,12 +76,11 @@ Expr* comptime_evaluate_expr(Arena* arena, Expr* expr, ComptimeEnv* env) {
                         bits = bits * 10 + (raw[k] - '0');
                     }
                     if (all_digits && bits >= 1 && bits <= 64) {
-                        Id *type_id = arena_push_aligned(arena, Id);
                         char *nbuf = arena_push_many_aligned(arena, char, L + 1);
                         memcpy(nbuf, raw, L);
                         nbuf[L] = '\0';
-                        type_id->name = nbuf;
-                        type_id->length = L;
+                        Id *type_id = arena_push_aligned(arena, Id);
+                        id_set(type_id, L, nbuf);
                         Expr* texpr = clone_expr(arena, expr);
                         texpr->kind = EXPR_TYPE;
                         texpr->as.type_expr.type_value = type_simple(arena, type_id);
@@ -180,12 +178,12 @@ Expr* comptime_evaluate_expr(Arena* arena, Expr* expr, ComptimeEnv* env) {
                 if (strncmp(callee_id->name, "compileError", 12) == 0) {
                     if (expr->as.call_expr.args && expr->as.call_expr.args->expr->kind == EXPR_STRING) {
                         const char* error_msg = expr->as.call_expr.args->expr->as.string_expr.value;
-                        fprintf(stderr, "Compile Error: %.*s\n", 
+                        sema_diag("Compile Error: %.*s\n", 
                             (int)expr->as.call_expr.args->expr->as.string_expr.length, error_msg);
-                        exit(1);
+                        sema_fatal();
                     } else {
-                        fprintf(stderr, "Compile Error: compileError expects a string literal.\n");
-                        exit(1);
+                        sema_diag("Compile Error: compileError expects a string literal.\n");
+                        sema_fatal();
                     }
                 }
                 
@@ -204,9 +202,9 @@ Expr* comptime_evaluate_expr(Arena* arena, Expr* expr, ComptimeEnv* env) {
                 
                 // G-006: CTFE purity filter — reject non-pure callees
                 if (callee_decl && (callee_decl->kind == DECL_PROCEDURE || callee_decl->kind == DECL_EXTERN_PROCEDURE)) {
-                    fprintf(stderr, "[E101] Comptime purity error: cannot call procedure '%.*s' from comptime context (only `func` calls allowed)\n",
+                    sema_diag("[E101] Comptime purity error: cannot call procedure '%.*s' from comptime context (only `func` calls allowed)\n",
                             (int)callee_id->length, callee_id->name);
-                    exit(1);
+                    sema_fatal();
                 }
                 if (callee_decl && callee_decl->kind == DECL_EXTERN_FUNCTION) {
                     // extern func is trusted by convention (I-016) but still allowed in comptime
@@ -244,8 +242,7 @@ Expr* comptime_evaluate_stmt_list(Arena* arena, StmtList* stmts, ComptimeEnv* en
                     // Update existing environment variable (we'd mutate the node value)
                     Id* target_id = stmt->as.assign_stmt.target->as.identifier_expr.id;
                     for (ComptimeEnv* e = env; e; e = e->next) {
-                        if (e->name->length == target_id->length && 
-                            strncmp(e->name->name, target_id->name, target_id->length) == 0) {
+                        if (id_eq(e->name, target_id)) {
                             e->value = val;
                             break;
                         }
@@ -0,0 +1,102 @@
+#ifndef SEMA_CONTEXT_H
+#define SEMA_CONTEXT_H
+
+#include <stdarg.h>
+
+#include "../ast.h"
+#include "../utils/diag.h"
+
+/*
+  Per-function analysis state.
+
+  Everything sema keeps while it works through ONE function body lives in a
+  SemaContext: the local symbol table and its scope marks, the VRA fact table,
+  the in-guard / narrowing / pointer-monotone stacks, the function being
+  analyzed and the walk flags. Module-wide state (sema_globals, sema_decls, the
+  decl index, monomorphization) stays global.
+
+  Memory comes from two arenas. `arena` holds what outlives the function:
+  types, symbols, synthesized expressions, monomorphized instances. `scratch`
+  holds what dies with it: the function's VRA facts, the linearity, borrow
+  and last-use tables, return-range inference tables. The function loop takes
+  an arena_mark() of the scratch arena before each function and rewinds to it
+  afterwards, so peak memory follows the largest function instead of the sum
+  of all of them. Nested users mark and rewind the same way.
+
+  Sema runs on one thread: `sema_ctx` points at sema_main_ctx. Resolve
+  monomorphizes into sema_decls and the globals, and return-range inference
+  reads the ranges of callees walked earlier, so the per-function walk depends
+  on its order and is not split across -j threads.
+
+  Diagnostics go through sema_diag()/sema_fatal() instead of stderr/exit so
+  --cache-dir can record them (cache.h).
+*/
+
+#define SEMA_BUCKET_COUNT 4096
+
+struct Symbol;
+struct RangeTable;
+struct InGuardEntry;
+struct NarrowEntry;
+struct PtrMonotoneEntry;
+struct PtrInitIdxEntry;
+struct OmegaCache;
+
+typedef struct SemaContext {
+    Arena *arena;
+    Arena *scratch;                     // per-function temporaries, rewound after each
+
+    // scope.h: function-local symbols, their undo log and block-scope marks
+    struct Symbol  *locals[SEMA_BUCKET_COUNT];
+    struct Symbol **local_log;          // every live local, in insertion order
+    isize           local_log_len;
+    isize           local_log_cap;
+    isize          *scope_marks;        // undo-log marks, innermost last
+    isize           scope_depth;
+    isize           scope_capacity;
+
+    // flow facts
+    struct RangeTable       *ranges;
+    struct InGuardEntry     *in_guards;
+    struct NarrowEntry      *narrows;
+    struct PtrMonotoneEntry *ptr_monotone;
+    struct PtrInitIdxEntry  *ptr_init_idx;
+    struct OmegaCache       *omega_cache;   // omega.h: bounds proofs already decided
+
+    // the function being analyzed
+    Decl       *function_decl;
+    Type       *return_type;
+    const char *module_path;
+    bool        walk_phase;
+    bool        in_unsafe_block;
+    bool        addr_of_context;    // set by EXPR_ADDR to relax &arr[len] in bounds check
+    int         next_region_id;     // region.h
+} SemaContext;
+
+static SemaContext sema_main_ctx;
+static SemaContext *sema_ctx = &sema_main_ctx;
+
+// --cache-dir: everything sema prints is also recorded, so a cache hit can
+// print the same warnings the original compile did (cache.h).
+static bool       sema_diag_recording = false;
+static DiagBuffer sema_diag_record;
+
+static void sema_diag(const char *fmt, ...) {
+    va_list ap;
+    va_start(ap, fmt);
+    if (sema_diag_recording) {
+        isize at = sema_diag_record.len;
+        diag_buffer_vprintf(&sema_diag_record, fmt, ap);
+        fwrite(sema_diag_record.text + at, 1, (size_t)(sema_diag_record.len - at), stderr);
+    } else {
+        vfprintf(stderr, fmt, ap);
+    }
+    va_end(ap);
+}
+
+// A fatal diagnostic was reported: stop the compilation.
+static _noreturn void sema_fatal(void) {
+    exit(1);
+}
+
+#endif // SEMA_CONTEXT_H
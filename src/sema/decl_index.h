@@ -0,0 +1,144 @@
+#ifndef SEMA_DECL_INDEX_H
+#define SEMA_DECL_INDEX_H
+
+#include "../ast.h"
+#include "context.h"
+
+extern DeclList *sema_decls;
+
+/*
+  Name → Decl index over sema_decls, so struct/enum/alias/function lookups do
+  not walk the whole (monomorphization-extended) decl list.
+
+   • by raw name, one table per decl family (a struct and an enum may share a
+     name), plus enum variant name → owning enum;
+   • by mangled C name (filled by sema_insert_global as c names are minted;
+     a C name already carries its module path, "<module>_<raw>").
+
+  Every table keeps the FIRST decl in sema_decls order for a key, which is what
+  the linear scans it replaces returned. decl_index_build() runs at the start of
+  sema_build_scope; anything appended later goes through sema_decls_append().
+
+  The one deliberate difference is suffix lookup of a mangled name: the scans
+  took the first decl in list order whose raw name was any `_` suffix, so with
+  both `Kind` and `Op_Kind` declared, `m_Op_Kind` could resolve to `Kind`. The
+  index tries the exact name, then suffixes longest first.
+*/
+
+typedef struct DeclIndex {
+    AtomMap structs;
+    AtomMap enums;
+    AtomMap aliases;
+    AtomMap functions;   // functions, procedures and externs
+    AtomMap variants;    // variant name → enum Decl
+    AtomMap c_names;     // mangled C name → Decl
+} DeclIndex;
+
+static DeclIndex sema_decl_index;
+static DeclList *sema_decls_tail = NULL;
+
+static void _decl_index_put_first(AtomMap *m, Id *name, Decl *d) {
+    if (!name || atom_map_get(m, name->atom, NULL)) return;
+    atom_map_put(m, name->atom, NULL, d);
+}
+
+static void decl_index_add(Decl *d) {
+    if (!d) return;
+    switch (d->kind) {
+    case DECL_STRUCT:
+        _decl_index_put_first(&sema_decl_index.structs, d->as.struct_decl.name, d);
+        break;
+    case DECL_ENUM:
+        _decl_index_put_first(&sema_decl_index.enums, d->as.enum_decl.type_name, d);
+        for (Variant *v = d->as.enum_decl.variants; v; v = v->next)
+            _decl_index_put_first(&sema_decl_index.variants, v->name, d);
+        break;
+    case DECL_TYPE_ALIAS:
+        _decl_index_put_first(&sema_decl_index.aliases, d->as.type_alias_decl.name, d);
+        break;
+    case DECL_FUNCTION:
+    case DECL_PROCEDURE:
+    case DECL_EXTERN_FUNCTION:
+    case DECL_EXTERN_PROCEDURE:
+        _decl_index_put_first(&sema_decl_index.functions, d->as.function_decl.name, d);
+        break;
+    default:
+        break;
+    }
+}
+
+static void decl_index_add_c_name(const char *c_name, Decl *d) {
+    if (!c_name || !d) return;
+    const char *atom = atom_intern(c_name, (isize)strlen(c_name));
+    if (!atom_map_get(&sema_decl_index.c_names, atom, NULL)) atom_map_put(&sema_decl_index.c_names, atom, NULL, d);
+}
+
+// (Re)build the index from the current sema_decls.
+static void decl_index_build(void) {
+    DeclIndex empty = {0};
+    free(sema_decl_index.structs.slots);
+    free(sema_decl_index.enums.slots);
+    free(sema_decl_index.aliases.slots);
+    free(sema_decl_index.functions.slots);
+    free(sema_decl_index.variants.slots);
+    free(sema_decl_index.c_names.slots);
+    sema_decl_index = empty;
+    sema_decls_tail = NULL;
+    for (DeclList *dl = sema_decls; dl; dl = dl->next) {
+        decl_index_add(dl->decl);
+        sema_decls_tail = dl;
+    }
+}
+
+// Append a sema-synthesized decl (monomorphized instance, lowered union, alias
+// struct/enum) to sema_decls and index it.
+static void sema_decls_append(Decl *d) {
+    DeclList *node = decl_list(sema_ctx->arena, d);
+    if (!sema_decls) {
+        sema_decls = node;
+    } else {
+        DeclList *tail = sema_decls_tail ? sema_decls_tail : sema_decls;
+        while (tail->next) tail = tail->next;
+        tail->next = node;
+    }
+    sema_decls_tail = node;
+    decl_index_add(d);
+}
+
+static inline Decl *decl_index_struct(Id *name) {
+    return name ? atom_map_get(&sema_decl_index.structs, name->atom, NULL) : NULL;
+}
+
+static inline Decl *decl_index_enum(Id *name) {
+    return name ? atom_map_get(&sema_decl_index.enums, name->atom, NULL) : NULL;
+}
+
+static inline Decl *decl_index_alias(Id *name) {
+    return name ? atom_map_get(&sema_decl_index.aliases, name->atom, NULL) : NULL;
+}
+
+static inline Decl *decl_index_variant_enum(Id *variant) {
+    return variant ? atom_map_get(&sema_decl_index.variants, variant->atom, NULL) : NULL;
+}
+
+static inline Decl *decl_index_function(const char *name, isize length) {
+    return atom_map_get(&sema_decl_index.functions, atom_find(name, length), NULL);
+}
+
+static inline Decl *decl_index_c_name(const char *c_name) {
+    return atom_map_get(&sema_decl_index.c_names, atom_find(c_name, (isize)strlen(c_name)), NULL);
+}
+
+// Enum whose raw name is `name`, or whose raw name follows an '_' at the end
+// of `name` (a mangled "module_Enum"). The longest matching suffix wins, not
+// the first in list order (see the note at the top of this file).
+static Decl *decl_index_enum_exact_or_suffix(const char *name, isize length) {
+    Decl *d = atom_map_get(&sema_decl_index.enums, atom_find(name, length), NULL);
+    for (isize i = 1; !d && i + 1 < length; i++) {
+        if (name[i] != '_') continue;
+        d = atom_map_get(&sema_decl_index.enums, atom_find(name + i + 1, length - i - 1), NULL);
+    }
+    return d;
+}
+
+#endif // SEMA_DECL_INDEX_H
@@ -22,7 +22,7 @@
 #endif
 
 #if SEMA_EXHAUSTIVENESS_DEBUG
-#define EXHAUST_DBG(fmt, ...) fprintf(stderr, "[exhaust] " fmt "\n", ##__VA_ARGS__)
+#define EXHAUST_DBG(fmt, ...) sema_diag("[exhaust] " fmt "\n", ##__VA_ARGS__)
 #else
 #define EXHAUST_DBG(fmt, ...) do {} while(0)
 #endif
@@ -50,32 +50,8 @@ static Decl *find_enum_decl(Type *vtype) {
     if (!vtype || vtype->kind != TYPE_SIMPLE || !vtype->base_type) {
         return NULL;
     }
-    
-    const char *type_name = vtype->base_type->name;
-    int type_len = vtype->base_type->length;
-    
-    for (DeclList *dl = sema_decls; dl; dl = dl->next) {
-        if (!dl->decl || dl->decl->kind != DECL_ENUM) continue;
-        
-        Id *enum_name = dl->decl->as.enum_decl.type_name;
-        if (!enum_name) continue;
-
-        // 1. Exact match
-        if (enum_name->length == type_len &&
-            strncmp(enum_name->name, type_name, type_len) == 0) {
-            return dl->decl;
-        }
-
-        // 2. Suffix match (handle mangled names like module_Enum)
-        if (type_len > enum_name->length + 1) {
-            const char *suffix_start = type_name + (type_len - enum_name->length);
-            if (*(suffix_start - 1) == '_' &&
-                strncmp(suffix_start, enum_name->name, enum_name->length) == 0) {
-                return dl->decl;
-            }
-        }
-    }
-    return NULL;
+    // Exact match, or suffix match for mangled names like module_Enum
+    return decl_index_enum_exact_or_suffix(vtype->base_type->name, vtype->base_type->length);
 }
 
 // Check if a pattern matches an enum variant by name
@@ -243,7 +219,7 @@ static bool sema_check_match_exhaustive(Stmt *match_stmt) {
 // Report non-exhaustive match error
 static void sema_report_nonexhaustive_match(Stmt *match_stmt) {
     (void)match_stmt;
-    fprintf(stderr, "[E014] Error: non-exhaustive match - add an 'else:' case or cover all variants\n");
+    sema_diag("[E014] Error: non-exhaustive match - add an 'else:' case or cover all variants\n");
 }
 
 /*───────────────────────────────────────────────────────────────────╗
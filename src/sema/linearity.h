@@ -28,7 +28,7 @@
 #endif
 
 #if SEMA_LINEARITY_DEBUG
-#define DBG(fmt, ...) fprintf(stderr, "[linearity] " fmt "\n", ##__VA_ARGS__)
+#define DBG(fmt, ...) sema_diag("[linearity] " fmt "\n", ##__VA_ARGS__)
 #else
 #define DBG(fmt, ...) do {} while(0)
 #endif
@@ -55,7 +55,7 @@ static bool sema_check_struct_field_mov(Decl *d) {
             if (ft->mode != MODE_OWNED && sema_type_is_linear(ft)) {
                 Id *fname = f->decl->as.variable_decl.name;
                 Id *sname = d->as.struct_decl.name;
-                fprintf(stderr,
+                sema_diag(
                     "[E083] Error Ln %li, Col %li: field '%.*s' in struct '%.*s' has linear type but is missing `mov` annotation. Add `mov` to the field declaration.\n",
                     f->decl->line, f->decl->col,
                     (int)(fname ? fname->length : 0), fname ? fname->name : "?",
@@ -72,7 +72,7 @@ static bool sema_check_struct_field_mov(Decl *d) {
                 if (ft->mode != MODE_OWNED && sema_type_is_linear(ft)) {
                     Id *fname = f->decl->as.variable_decl.name;
                     Id *vname = v->name;
-                    fprintf(stderr,
+                    sema_diag(
                         "[E083] Error Ln %li, Col %li: field '%.*s' in variant '%.*s' has linear type but is missing `mov` annotation.\n",
                         f->decl->line, f->decl->col,
                         (int)(fname ? fname->length : 0), fname ? fname->name : "?",
@@ -166,7 +166,7 @@ typedef struct FieldState {
 // independently through the CFG. Nested structs recurse; a variable whose struct
 // contains an array/slice field (at any depth) is not field-tracked (NULL
 // field_inits → whole-var `is_initialized`), which keeps every path single-valued
-// and avoids false positives. `path` is an arena string in sema_arena.
+// and avoids false positives. `path` is an arena string in sema_ctx->scratch.
 typedef struct FieldInit {
     const char *path;    // dotted leaf path, e.g. "a.x" (relative to the variable)
     bool is_initialized;
@@ -187,11 +187,29 @@ typedef struct LEntry {
     isize line;        // line where var is defined
     isize col;         // col where var is defined
     LState state;
+    struct LEntry *origin; // copy-on-write copy: the declared entry it shadows
     struct LEntry *next;
 } LEntry;
 
-typedef struct {
+/*
+  Linearity tables are persistent. The function body is checked against a
+  root table; each branch of an if/match gets an overlay table whose `parent`
+  is the table the branch started from. An overlay holds only
+
+    • `head`:    the entries declared inside the branch, newest first;
+    • `shadows`: copy-on-write copies of the ancestor entries the branch
+                 changed (consumed, initialized, re-assigned, ...).
+
+  ltable_find() reads through the overlays without copying; ltable_find_mut()
+  copies an ancestor entry into the overlay before it is written. Opening a
+  branch is O(borrows), and the branch reconciliation below (consistency,
+  merge, definite-initialization join) walks only the `shadows` deltas.
+  A parent is never written while an overlay over it is alive.
+*/
+typedef struct LTable {
     LEntry *head;
+    LEntry *shadows;       // copies of ancestor entries changed in this table
+    struct LTable *parent; // table this branch started from (NULL at the root)
     BorrowTable *borrows;  // track active borrows
     Arena *arena;          // arena for allocations
 } LTable;
@@ -199,6 +217,8 @@ typedef struct {
 static LTable *ltable_new(Arena *arena) {
     LTable *t = arena_push_aligned(arena, LTable);
     t->head = NULL;
+    t->shadows = NULL;
+    t->parent = NULL;
     t->arena = arena;
     t->borrows = arena ? borrow_table_new(arena) : NULL;
     return t;
@@ -206,16 +226,90 @@ static LTable *ltable_new(Arena *arena) {
 
 static void ltable_free(LTable *t) {
     if (!t) return;
-    // Arena handles deallocation — just detach the list
+    // Arena handles deallocation — just detach the lists
     t->head = NULL;
+    t->shadows = NULL;
+}
+
+// Entry for `id` as seen from `t`, and the table whose `head` or `shadows`
+// holds it.
+static LEntry *_ltable_find_in(LTable *t, Id *id, LTable **owner) {
+    for (LTable *level = t; level; level = level->parent) {
+        for (LEntry *e = level->head; e; e = e->next)
+            if (id_eq(e->id, id)) { *owner = level; return e; }
+        for (LEntry *e = level->shadows; e; e = e->next)
+            if (id_eq(e->id, id)) { *owner = level; return e; }
+    }
+    return NULL;
 }
 
+// Read-only lookup: the returned entry may belong to an ancestor table.
 static LEntry *ltable_find(LTable *t, Id *id) {
-    for (LEntry *e = t->head; e; e = e->next) {
-        if (e->id->length == id->length &&
-            strncmp(e->id->name, id->name, id->length) == 0) {
-            return e;
-        }
+    LTable *owner;
+    return _ltable_find_in(t, id, &owner);
+}
+
+// Lookup for writing: an ancestor entry is first copied into `t->shadows`.
+static LEntry *ltable_find_mut(LTable *t, Id *id) {
+    LTable *owner;
+    LEntry *e = _ltable_find_in(t, id, &owner);
+    if (!e || owner == t) return e;
+
+    LEntry *c = arena_push_aligned(t->arena, LEntry);
+    *c = *e;
+    c->origin = e->origin ? e->origin : e;
+    c->field_states = NULL;
+    c->field_inits = NULL;
+    FieldState **fs_tail = &c->field_states;
+    for (FieldState *sf = e->field_states; sf; sf = sf->next) {
+        FieldState *df = arena_push_aligned(t->arena, FieldState);
+        df->field_name = sf->field_name;
+        df->is_consumed = sf->is_consumed;
+        df->next = NULL;
+        *fs_tail = df;
+        fs_tail = &df->next;
+    }
+    FieldInit **fi_tail = &c->field_inits;
+    for (FieldInit *sf = e->field_inits; sf; sf = sf->next) {
+        FieldInit *df = arena_push_aligned(t->arena, FieldInit);
+        df->path = sf->path;   // shared: path strings live in sema_ctx->scratch
+        df->is_initialized = sf->is_initialized;
+        df->next = NULL;
+        *fi_tail = df;
+        fi_tail = &df->next;
+    }
+    c->next = t->shadows;
+    t->shadows = c;
+    return c;
+}
+
+// Iteration over every entry visible from a table: each level's declared
+// entries, innermost table first, with each one replaced by its nearest
+// copy-on-write shadow.
+typedef struct {
+    LTable *table;
+    LTable *level;
+    LEntry *next;
+} LTableIter;
+
+static LTableIter ltable_iter(LTable *t) {
+    LTableIter it = { t, t, t->head };
+    return it;
+}
+
+static LEntry *ltable_iter_next(LTableIter *it) {
+    while (it->level) {
+        LEntry *e = it->next;
+        if (!e) {
+            it->level = it->level->parent;
+            it->next = it->level ? it->level->head : NULL;
+            continue;
+        }
+        it->next = e->next;
+        for (LTable *s = it->table; s != it->level; s = s->parent)
+            for (LEntry *c = s->shadows; c; c = c->next)
+                if (c->origin == e) return c;
+        return e;
     }
     return NULL;
 }
@@ -281,6 +375,7 @@ static void ltable_add(LTable *t, Id *id, int loop_depth, bool is_mutable, bool
     e->line = line;
     e->col = col;
     e->state = LSTATE_UNCONSUMED;
+    e->origin = NULL;
     e->next = t->head;
     t->head = e;
     DBG("ltable_add: added '%.*s' loop_depth=%d region=%d must_consume=%d", 
@@ -329,26 +424,26 @@ static void ltable_init_field_states(LEntry *e, Type *ty, Arena *arena) {
 static bool ltable_consume_field(LTable *t, Id *var_id, Id *field_id, int current_loop_depth) {
     LEntry *e = ltable_find(t, var_id);
     if (!e || !e->field_states) return false; // no field tracking → fall through to whole-var
+    e = ltable_find_mut(t, var_id);
     
     // Find the field
     for (FieldState *fs = e->field_states; fs; fs = fs->next) {
-        if (fs->field_name->length == field_id->length &&
-            strncmp(fs->field_name->name, field_id->name, field_id->length) == 0) {
+        if (id_eq(fs->field_name, field_id)) {
             if (fs->is_consumed) {
-                fprintf(stderr, "[E002] Error Ln %li, Col %li: field '%.*s' of '%.*s' was already consumed.\n",
+                sema_diag("[E002] Error Ln %li, Col %li: field '%.*s' of '%.*s' was already consumed.\n",
                         (long)e->line, (long)e->col,
                         (int)field_id->length, field_id->name,
                         (int)var_id->length, var_id->name);
                 diagnostic_show_line(e->line, e->col);
-                exit(1);
+                sema_fatal();
             }
             if (e->defined_loop_depth != current_loop_depth) {
-                fprintf(stderr, "[E006] Error Ln %li, Col %li: attempting to consume field '%.*s' of '%.*s' inside a loop.\n",
+                sema_diag("[E006] Error Ln %li, Col %li: attempting to consume field '%.*s' of '%.*s' inside a loop.\n",
                         (long)e->line, (long)e->col,
                         (int)field_id->length, field_id->name,
                         (int)var_id->length, var_id->name);
                 diagnostic_show_line(e->line, e->col);
-                exit(1);
+                sema_fatal();
             }
             fs->is_consumed = true;
             DBG("ltable_consume_field: consumed '%.*s.%.*s'",
@@ -383,8 +478,10 @@ static bool ltable_is_partially_consumed(LEntry *e) {
     return has_consumed && has_unconsumed;
 }
 
-static LTable *ltable_clone(LTable *src) {
+// Open a branch over `src`: an empty overlay plus its own copy of the borrows.
+static LTable *ltable_branch(LTable *src) {
     LTable *dst = ltable_new(src->arena);
+    dst->parent = src;
     // Copy current region state from source
     if (dst->borrows && src->borrows) {
         dst->borrows->current_region = src->borrows->current_region;
@@ -404,60 +501,19 @@ static LTable *ltable_clone(LTable *src) {
             last = d_entry;
         }
     }
-    // shallow-copy entries (Id* pointers are fine)
-    for (LEntry *s = src->head; s; s = s->next) {
-        ltable_add(dst, s->id, s->defined_loop_depth, s->is_mutable, s->must_consume, s->is_initialized, s->line, s->col);
-        LEntry *d = ltable_find(dst, s->id);
-        if (d) {
-            d->state = s->state;
-            d->region = s->region;
-            d->is_initialized = s->is_initialized;
-            d->is_defer_consumed = s->is_defer_consumed;
-            d->var_type = s->var_type;
-            
-            // Deep copy field_states
-            if (s->field_states) {
-                FieldState *last_fs = NULL;
-                d->field_states = NULL;
-                for (FieldState *sf = s->field_states; sf; sf = sf->next) {
-                    FieldState *df = arena_push_aligned(dst->arena, FieldState);
-                    df->field_name = sf->field_name;
-                    df->is_consumed = sf->is_consumed;
-                    df->next = NULL;
-                    if (last_fs) last_fs->next = df;
-                    else d->field_states = df;
-                    last_fs = df;
-                }
-            }
-            // Deep copy field_inits (field-sensitive definite assignment)
-            if (s->field_inits) {
-                FieldInit *last_fi = NULL;
-                d->field_inits = NULL;
-                for (FieldInit *sf = s->field_inits; sf; sf = sf->next) {
-                    FieldInit *df = arena_push_aligned(dst->arena, FieldInit);
-                    df->path = sf->path;   // shared: path strings live in sema_arena
-                    df->is_initialized = sf->is_initialized;
-                    df->next = NULL;
-                    if (last_fi) last_fi->next = df;
-                    else d->field_inits = df;
-                    last_fi = df;
-                }
-            }
-        }
-    }
     return dst;
 }
 
 /* update state strictly */
 static void __attribute__((unused)) ltable_set_state(LTable *t, Id *id, LState st) {
-    LEntry *e = ltable_find(t, id);
+    LEntry *e = ltable_find_mut(t, id);
     if (!e) return;
     e->state = st;
 }
 
 /* mark consumed — checks loop-depth rule */
 static void ltable_consume(LTable *t, Id *id, int current_loop_depth) {
-    LEntry *e = ltable_find(t, id);
+    LEntry *e = ltable_find_mut(t, id);
     if (!e) {
         // not tracked: ignore quietly
         DBG("ltable_consume: id '%.*s' not tracked (ignored)", id ? (int)id->length : 0, id ? id->name : "<null>");
@@ -470,29 +526,29 @@ static void ltable_consume(LTable *t, Id *id, int current_loop_depth) {
     // etc. — would run the drop twice at scope exit (double free). The plain
     // state check below misses this because the state was restored to UNCONSUMED.
     if (e->is_defer_consumed) {
-        fprintf(stderr, "[E002] Error Ln %li, Col %li: linear variable '%.*s' is already committed "
+        sema_diag("[E002] Error Ln %li, Col %li: linear variable '%.*s' is already committed "
                 "to a deferred consumption (`defer drop(mov %.*s)`); consuming it again would "
                 "double-free it at scope exit.\n",
                 (long)e->line, (long)e->col, (int)e->id->length,
                 e->id->name ? e->id->name : "<unknown>",
                 (int)e->id->length, e->id->name ? e->id->name : "<unknown>");
         diagnostic_show_line(e->line, e->col);
-        exit(1);
+        sema_fatal();
     }
     if (e->state != LSTATE_UNCONSUMED) {
-        fprintf(stderr, "[E002] Error Ln %li, Col %li: linear variable '%.*s' was already used/consumed.\n",
+        sema_diag("[E002] Error Ln %li, Col %li: linear variable '%.*s' was already used/consumed.\n",
                 (long)e->line, (long)e->col, (int)e->id->length, e->id->name ? e->id->name : "<unknown>");
-        fprintf(stderr, "  --> declared at Ln %li, Col %li\n", (long)e->line, (long)e->col);
+        sema_diag("  --> declared at Ln %li, Col %li\n", (long)e->line, (long)e->col);
         diagnostic_show_line(e->line, e->col);
-        exit(1);
+        sema_fatal();
     }
     if (e->defined_loop_depth != current_loop_depth) {
-        fprintf(stderr, "[E006] Error Ln %li, Col %li: attempting to consume linear variable '%.*s' defined outside a loop from inside a loop.\n",
+        sema_diag("[E006] Error Ln %li, Col %li: attempting to consume linear variable '%.*s' defined outside a loop from inside a loop.\n",
                 (long)e->line, (long)e->col, (int)e->id->length, e->id->name ? e->id->name : "<unknown>");
-        fprintf(stderr, "  --> declared at Ln %li, Col %li (loop depth %d, current %d)\n",
+        sema_diag("  --> declared at Ln %li, Col %li (loop depth %d, current %d)\n",
                 (long)e->line, (long)e->col, e->defined_loop_depth, current_loop_depth);
         diagnostic_show_line(e->line, e->col);
-        exit(1);
+        sema_fatal();
     }
     // Phase 5: whole-var consume should also mark all fields consumed
     if (e->field_states) {
@@ -507,21 +563,22 @@ static void ltable_consume(LTable *t, Id *id, int current_loop_depth) {
 /* check all vars in table are consumed */
 static void ltable_ensure_all_consumed(LTable *t) {
     int errors = 0;
-    for (LEntry *e = t->head; e; e = e->next) {
+    LTableIter it = ltable_iter(t);
+    for (LEntry *e; (e = ltable_iter_next(&it)); ) {
         // Phase 4: defer-consumed counts as consumed
         if (e->must_consume && e->state != LSTATE_CONSUMED && !e->is_defer_consumed) {
             // Phase 5: check field-level consumption
             if (e->field_states) {
                 for (FieldState *fs = e->field_states; fs; fs = fs->next) {
                     if (!fs->is_consumed) {
-                        fprintf(stderr, "[E003] Error Ln %li, Col %li: linear field '%.*s' of '%.*s' was not consumed before return.\n",
+                        sema_diag("[E003] Error Ln %li, Col %li: linear field '%.*s' of '%.*s' was not consumed before return.\n",
                                 (long)e->line, (long)e->col,
                                 (int)fs->field_name->length, fs->field_name->name,
                                 (int)e->id->length, e->id->name ? e->id->name : "<unknown>");
-                        fprintf(stderr, "  --> '%.*s' declared at Ln %li, Col %li\n",
+                        sema_diag("  --> '%.*s' declared at Ln %li, Col %li\n",
                                 (int)e->id->length, e->id->name ? e->id->name : "<unknown>",
                                 (long)e->line, (long)e->col);
-                        fprintf(stderr, "  help: consume with `mov %.*s.%.*s` or add `defer { drop(mov %.*s) }`\n",
+                        sema_diag("  help: consume with `mov %.*s.%.*s` or add `defer { drop(mov %.*s) }`\n",
                                 (int)e->id->length, e->id->name,
                                 (int)fs->field_name->length, fs->field_name->name,
                                 (int)e->id->length, e->id->name);
@@ -529,10 +586,10 @@ static void ltable_ensure_all_consumed(LTable *t) {
                     }
                 }
             } else {
-                fprintf(stderr, "[E003] Error Ln %li, Col %li: linear variable '%.*s' was not consumed before return.\n",
+                sema_diag("[E003] Error Ln %li, Col %li: linear variable '%.*s' was not consumed before return.\n",
                         (long)e->line, (long)e->col, (int)e->id->length, e->id->name ? e->id->name : "<unknown>");
-                fprintf(stderr, "  --> declared at Ln %li, Col %li\n", (long)e->line, (long)e->col);
-                fprintf(stderr, "  help: consume with `mov %.*s` or add `defer { drop(mov %.*s) }`\n",
+                sema_diag("  --> declared at Ln %li, Col %li\n", (long)e->line, (long)e->col);
+                sema_diag("  help: consume with `mov %.*s` or add `defer { drop(mov %.*s) }`\n",
                         (int)e->id->length, e->id->name, (int)e->id->length, e->id->name);
                 errors++;
             }
@@ -541,12 +598,13 @@ static void ltable_ensure_all_consumed(LTable *t) {
     
     if (errors > 0) {
         DBG("ltable_ensure_all_consumed: dumping table entries (due to errors):");
-        for (LEntry *e = t->head; e; e = e->next) {
+        it = ltable_iter(t);
+        for (LEntry *e; (e = ltable_iter_next(&it)); ) {
             DBG("  entry '%.*s' state=%d def_loop=%d must=%d", 
                 (int)e->id->length, e->id->name ? e->id->name : "<unknown>", 
                 (int)e->state, e->defined_loop_depth, e->must_consume);
         }
-        exit(1);
+        sema_fatal();
     }
     DBG("ltable_ensure_all_consumed: OK (all linear vars consumed)");
 }
@@ -561,7 +619,7 @@ static void ltable_pop_scope(LTable *tbl, LEntry *saved_head) {
             if (e->field_states) {
                 for (FieldState *fs = e->field_states; fs; fs = fs->next) {
                     if (!fs->is_consumed) {
-                        fprintf(stderr, "[E003] Error Ln %li, Col %li: linear field '%.*s' of '%.*s' was not consumed before end of scope.\n",
+                        sema_diag("[E003] Error Ln %li, Col %li: linear field '%.*s' of '%.*s' was not consumed before end of scope.\n",
                                 (long)e->line, (long)e->col,
                                 (int)fs->field_name->length, fs->field_name->name,
                                 (int)e->id->length, e->id->name ? e->id->name : "<unknown>");
@@ -569,7 +627,7 @@ static void ltable_pop_scope(LTable *tbl, LEntry *saved_head) {
                     }
                 }
             } else {
-                fprintf(stderr, "[E003] Error Ln %li, Col %li: linear variable '%.*s' was not consumed before end of scope.\n",
+                sema_diag("[E003] Error Ln %li, Col %li: linear variable '%.*s' was not consumed before end of scope.\n",
                         (long)e->line, (long)e->col, (int)e->id->length, e->id->name ? e->id->name : "<unknown>");
                 errors++;
             }
@@ -579,49 +637,76 @@ static void ltable_pop_scope(LTable *tbl, LEntry *saved_head) {
             borrow_release_by_binding(tbl->borrows, e->id);
         }
     }
-    if (errors > 0) exit(1);
+    if (errors > 0) sema_fatal();
     tbl->head = saved_head;
 }
 
 /* verify parent-consistency between two branch-results */
+static bool _ltable_entries_consistent(LEntry *ea, LEntry *eb) {
+    if (ea->state != eb->state) return false;
+    if (ea->field_states && eb->field_states) {
+        for (FieldState *fa = ea->field_states, *fb = eb->field_states; fa && fb; fa = fa->next, fb = fb->next)
+            if (fa->is_consumed != fb->is_consumed) return false;
+    }
+    return true;
+}
+
+// `a` and `b` are overlays (or `a` == parent). Only entries one of them
+// changed can differ; when one does, the parent's entries are rescanned in
+// declaration order so the first inconsistent variable is the one reported.
 static void ltable_check_branch_consistency(LTable *parent, LTable *a, LTable *b, const char *stmt_name) {
-    for (LEntry *p = parent->head; p; p = p->next) {
+    bool consistent = true;
+    for (LTable *side = a; side && consistent; side = side == a ? b : NULL) {
+        if (side == parent) continue;
+        for (LEntry *c = side->shadows; c && consistent; c = c->next)
+            consistent = _ltable_entries_consistent(ltable_find(a, c->id), ltable_find(b, c->id));
+    }
+    if (consistent) return;
+
+    isize count = 0;
+    LTableIter it = ltable_iter(parent);
+    while (ltable_iter_next(&it)) count++;
+    LEntry **order = arena_push_many_aligned(parent->arena, LEntry *, count);
+    it = ltable_iter(parent);
+    for (isize i = count; i > 0; ) order[--i] = ltable_iter_next(&it);
+
+    for (isize i = 0; i < count; i++) {
+        LEntry *p = order[i];
         LEntry *ea = ltable_find(a, p->id);
         LEntry *eb = ltable_find(b, p->id);
         LState sa = ea ? ea->state : LSTATE_UNCONSUMED;
         LState sb = eb ? eb->state : LSTATE_UNCONSUMED;
         if (sa != sb) {
-            fprintf(stderr, "[E016] Error: linear variable '%.*s' is used inconsistently in the branches of %s (one branch: %d, other: %d)\n",
+            sema_diag("[E016] Error: linear variable '%.*s' is used inconsistently in the branches of %s (one branch: %d, other: %d)\n",
                     (int)p->id->length, p->id->name ? p->id->name : "<unknown>", stmt_name ? stmt_name : "if", (int)sa, (int)sb);
-            exit(1);
+            sema_fatal();
         }
         // Phase 5: check field-level consistency
         if (ea && eb && ea->field_states && eb->field_states) {
             for (FieldState *fa = ea->field_states, *fb = eb->field_states; fa && fb; fa = fa->next, fb = fb->next) {
                 if (fa->is_consumed != fb->is_consumed) {
-                    fprintf(stderr, "[E016] Error: linear field '%.*s' of '%.*s' is consumed inconsistently in the branches of %s\n",
+                    sema_diag("[E016] Error: linear field '%.*s' of '%.*s' is consumed inconsistently in the branches of %s\n",
                             (int)fa->field_name->length, fa->field_name->name,
                             (int)p->id->length, p->id->name ? p->id->name : "<unknown>",
                             stmt_name ? stmt_name : "if");
-                    exit(1);
+                    sema_fatal();
                 }
             }
         }
     }
 }
 
-/* merge branch result back into parent */
+/* merge branch result back into parent (the branch's parent) */
 static void ltable_merge_from_branch(LTable *parent, LTable *branch) {
-    for (LEntry *p = parent->head; p; p = p->next) {
-        LEntry *b = ltable_find(branch, p->id);
-        if (b) {
-            p->state = b->state;
-            p->is_defer_consumed = b->is_defer_consumed;
-            // Phase 5: merge field states
-            if (b->field_states && p->field_states) {
-                for (FieldState *pf = p->field_states, *bf = b->field_states; pf && bf; pf = pf->next, bf = bf->next) {
-                    pf->is_consumed = bf->is_consumed;
-                }
+    for (LEntry *b = branch->shadows; b; b = b->next) {
+        LEntry *p = ltable_find_mut(parent, b->id);
+        if (!p) continue;
+        p->state = b->state;
+        p->is_defer_consumed = b->is_defer_consumed;
+        // Phase 5: merge field states
+        if (b->field_states && p->field_states) {
+            for (FieldState *pf = p->field_states, *bf = b->field_states; pf && bf; pf = pf->next, bf = bf->next) {
+                pf->is_consumed = bf->is_consumed;
             }
         }
     }
@@ -629,90 +714,119 @@ static void ltable_merge_from_branch(LTable *parent, LTable *branch) {
 
 /* intersect initialized state from two branches (for IF) */
 static void ltable_intersect_initialization(LTable *parent, LTable *a, LTable *b) {
-    for (LEntry *p = parent->head; p; p = p->next) {
-        LEntry *ea = ltable_find(a, p->id);
-        LEntry *eb = ltable_find(b, p->id);
-        bool init_a = ea ? ea->is_initialized : false;
-        bool init_b = eb ? eb->is_initialized : false;
-        p->is_initialized = p->is_initialized || (init_a && init_b);
+    // A variable (or field) the parent has not initialized can only be
+    // initialized on both sides if `a` changed it, so `a`'s deltas suffice.
+    // Intersecting a table with one of its branches changes nothing.
+    if (a == parent) return;
+    for (LEntry *ea = a->shadows; ea; ea = ea->next) {
+        LEntry *p = ltable_find(parent, ea->id);
+        LEntry *eb = ltable_find(b, ea->id);
+        if (!p || !eb) continue;
+        if (!p->is_initialized && ea->is_initialized && eb->is_initialized) {
+            p = ltable_find_mut(parent, ea->id);
+            p->is_initialized = true;
+        }
         // Field-sensitive: a field is initialized after the join iff it was
         // initialized on BOTH branches.
-        if (p->field_inits && ea && eb) {
+        if (p->field_inits) {
             for (FieldInit *pf = p->field_inits; pf; pf = pf->next) {
                 if (pf->is_initialized) continue;
                 FieldInit *fa = field_init_find(ea, pf->path);
                 FieldInit *fb = field_init_find(eb, pf->path);
-                if (fa && fb && fa->is_initialized && fb->is_initialized)
+                if (fa && fb && fa->is_initialized && fb->is_initialized) {
+                    LEntry *w = ltable_find_mut(parent, ea->id);
+                    if (w != p) { p = w; pf = field_init_find(p, pf->path); }
                     pf->is_initialized = true;
+                }
             }
         }
     }
 }
 
-/* apply initialization from a branch back to parent */
+/* apply initialization from a branch back to parent (the branch's parent) */
 static void ltable_apply_initialization(LTable *parent, LTable *branch) {
-    for (LEntry *p = parent->head; p; p = p->next) {
-        LEntry *b = ltable_find(branch, p->id);
-        if (b) p->is_initialized = p->is_initialized || b->is_initialized;
+    for (LEntry *b = branch->shadows; b; b = b->next) {
+        LEntry *p = ltable_find(parent, b->id);
+        if (!p) continue;
+        if (!p->is_initialized && b->is_initialized) {
+            p = ltable_find_mut(parent, b->id);
+            p->is_initialized = true;
+        }
         // Field-sensitive: pull field-init from the (already intersected) branch.
-        if (p->field_inits && b) {
+        if (p->field_inits) {
             for (FieldInit *pf = p->field_inits; pf; pf = pf->next) {
                 if (pf->is_initialized) continue;
                 FieldInit *bf = field_init_find(b, pf->path);
-                if (bf && bf->is_initialized) pf->is_initialized = true;
+                if (bf && bf->is_initialized) {
+                    LEntry *w = ltable_find_mut(parent, b->id);
+                    if (w != p) { p = w; pf = field_init_find(p, pf->path); }
+                    pf->is_initialized = true;
+                }
             }
         }
     }
 }
 
+// Definite-initialization state of the visible entries, saved before a loop
+// body: the body may run zero times, so afterwards every entry gets back the
+// value it had.
+typedef struct LInitSave {
+    Id *id;
+    bool is_initialized;
+    struct LInitSave *next;
+} LInitSave;
+
+static LInitSave *ltable_save_initialization(LTable *t) {
+    LInitSave *saves = NULL;
+    LTableIter it = ltable_iter(t);
+    for (LEntry *e; (e = ltable_iter_next(&it)); ) {
+        LInitSave *sv = arena_push_aligned(t->arena, LInitSave);
+        sv->id = e->id;
+        sv->is_initialized = e->is_initialized;
+        sv->next = saves;
+        saves = sv;
+    }
+    return saves;
+}
+
+static void ltable_restore_initialization(LTable *t, LInitSave *saves) {
+    for (LInitSave *sv = saves; sv; sv = sv->next) {
+        LEntry *e = ltable_find(t, sv->id);
+        if (e && e->is_initialized != sv->is_initialized)
+            ltable_find_mut(t, sv->id)->is_initialized = sv->is_initialized;
+    }
+}
+
 /* ---------- helpers to find function decl robustly ---------- */
 
 /* Try to find a function Decl by a mangled-or-raw name.
-   Accepts either "module_fn" or "fn" and matches Decl->as.function_decl.name (raw name). */
+   Accepts either "module_fn" or "fn" and matches Decl->as.function_decl.name (raw name).
+   Order: exact raw name, then the exact mangled C name, then the longest raw-name
+   suffix. (The list scans this replaced went straight from raw to the first
+   suffix match in module order, which could pick another module's `fn`.) */
 static Decl *find_function_decl_by_mangled_or_raw(const char *mangled) {
     if (!mangled) return NULL;
-    
+    isize mlen = (isize)strlen(mangled);
+
     // Quick pass: if the string exactly equals a raw name, use it.
-    for (ModuleNode *mn = loaded_modules; mn; mn = mn->next) {
-        for (DeclList *dl = mn->decls; dl; dl = dl->next) {
-            Decl *d = dl->decl;
-            if (!d) continue;
-            // Also check procedures and externs since they can take linear args
-            if (d->kind != DECL_FUNCTION && d->kind != DECL_PROCEDURE && 
-                d->kind != DECL_EXTERN_FUNCTION && d->kind != DECL_EXTERN_PROCEDURE) continue;
-            
-            Id *fid = d->as.function_decl.name;
-            if (!fid) continue;
-            if (strncmp(mangled, fid->name, fid->length) == 0 && mangled[fid->length] == '\0') return d;
-        }
-    }
-    for (DeclList *dl = sema_decls; dl; dl = dl->next) {
-        Decl *d = dl->decl;
-        if (!d || d->kind != DECL_FUNCTION) continue;
-        Id *fid = d->as.function_decl.name;
-        if (!fid) continue;
-        if (strncmp(mangled, fid->name, fid->length) == 0 && mangled[fid->length] == '\0') return d;
+    Decl *d = decl_index_function(mangled, mlen);
+    if (d) return d;
+
+    // The mangled C name minted by sema_build_scope / monomorphization.
+    d = decl_index_c_name(mangled);
+    if (d && (d->kind == DECL_FUNCTION || d->kind == DECL_PROCEDURE ||
+              d->kind == DECL_EXTERN_FUNCTION || d->kind == DECL_EXTERN_PROCEDURE)) {
+        return d;
     }
 
-    // Otherwise, try to match "<module>_<raw>" by suffix:
-    size_t mlen = strlen(mangled);
-    for (ModuleNode *mn = loaded_modules; mn; mn = mn->next) {
-        for (DeclList *dl = mn->decls; dl; dl = dl->next) {
-            Decl *d = dl->decl;
-            if (!d) continue;
-            if (d->kind != DECL_FUNCTION && d->kind != DECL_PROCEDURE && 
-                d->kind != DECL_EXTERN_FUNCTION && d->kind != DECL_EXTERN_PROCEDURE) continue;
-            
-            Id *fid = d->as.function_decl.name;
-            if (!fid) continue;
-            size_t rlen = (size_t)fid->length;
-            if (rlen + 1 <= mlen && mangled[mlen - rlen - 1] == '_') {
-                // compare suffix
-                if (strncmp(mangled + (mlen - rlen), fid->name, rlen) == 0) {
-                    DBG("find_function_decl_by_mangled_or_raw: matched mangled='%s' -> raw='%s'", mangled, fid->name);
-                    return d;
-                }
-            }
+    // Otherwise, try to match "<module>_<raw>" by suffix (longest first):
+    for (isize i = 0; i + 1 < mlen; i++) {
+        if (mangled[i] != '_') continue;
+        d = decl_index_function(mangled + i + 1, mlen - i - 1);
+        if (d) {
+            DBG("find_function_decl_by_mangled_or_raw: matched mangled='%s' -> raw='%.*s'", mangled,
+                (int)d->as.function_decl.name->length, d->as.function_decl.name->name);
+            return d;
         }
     }
     DBG("find_function_decl_by_mangled_or_raw: no decl found for '%s'", mangled);
@@ -796,7 +910,7 @@ static bool fi_flatten(Decl *sd, const char *prefix, bool all_init, int depth,
         if (ft && (ft->kind == TYPE_ARRAY || ft->kind == TYPE_SLICE)) return false;
         if (type_is_uninit_flaggable(ft)) {                 // scalar/pointer leaf
             if (*count >= FI_MAX_LEAVES) return false;
-            char *p = arena_push_many(sema_arena, char, (isize)n + 1);
+            char *p = arena_push_many(sema_ctx->scratch, char, (isize)n + 1);
             memcpy(p, path, (size_t)n + 1);
             FieldInit *fi = arena_push_aligned(arena, FieldInit);
             fi->path = p; fi->is_initialized = all_init;
@@ -905,10 +1019,10 @@ static void sema_check_expr_linearity(Expr *e, LTable *tbl, int loop_depth) {
             LEntry *entry = ltable_find(tbl, id);
             if (entry) {
                 if (entry->state == LSTATE_CONSUMED) {
-                    fprintf(stderr, "[E001] Error Ln %li, Col %li: use of linear variable '%.*s' after it was moved.\n",
+                    sema_diag("[E001] Error Ln %li, Col %li: use of linear variable '%.*s' after it was moved.\n",
                             (long)(e->line), (long)(e->col), (int)id->length, id->name ? id->name : "<unknown>");
                     diagnostic_show_line((e->line), (e->col));
-                    exit(1);
+                    sema_fatal();
                 }
                 // Fire for an uninitialized read of a linear var (must_consume)
                 // or a plain scalar/pointer. Arrays/slices are handled at the
@@ -920,28 +1034,28 @@ static void sema_check_expr_linearity(Expr *e, LTable *tbl, int loop_depth) {
                 bool is_arrlike = vt && (vt->kind == TYPE_ARRAY || vt->kind == TYPE_SLICE);
                 if (!entry->is_initialized && !is_arrlike &&
                     (entry->must_consume || type_is_uninit_flaggable(vt))) {
-                    fprintf(stderr, "[E005] Error Ln %li, Col %li: use of uninitialized variable '%.*s'.\n",
+                    sema_diag("[E005] Error Ln %li, Col %li: use of uninitialized variable '%.*s'.\n",
                             (long)(e->line), (long)(e->col), (int)id->length, id->name ? id->name : "<unknown>");
                     diagnostic_show_line((e->line), (e->col));
-                    exit(1);
+                    sema_fatal();
                 }
                 // Field-sensitive definite assignment: using a field-tracked
                 // struct as a WHOLE requires every field set. (Single-level
                 // member reads are handled in EXPR_MEMBER and never land here.)
                 if (entry->field_inits && !field_init_all(entry)) {
                     const char *miss = field_init_first_uninit(entry);
-                    fprintf(stderr, "[E019] Error Ln %li, Col %li: '%.*s' is partially initialized "
+                    sema_diag("[E019] Error Ln %li, Col %li: '%.*s' is partially initialized "
                             "(field '%s' is not set); initialize all fields before using it as a whole.\n",
                             (long)(e->line), (long)(e->col), (int)id->length, id->name ? id->name : "?",
                             miss ? miss : "?");
                     diagnostic_show_line((e->line), (e->col));
-                    exit(1);
+                    sema_fatal();
                 }
             }
             // NLL: Check if this variable is persistently borrowed (read access)
             if (tbl->borrows) {
                 if (borrow_check_owner_access(tbl->borrows, id, MODE_SHARED, e->line, e->col)) {
-                    exit(1);
+                    sema_fatal();
                 }
             }
         }
@@ -959,22 +1073,22 @@ static void sema_check_expr_linearity(Expr *e, LTable *tbl, int loop_depth) {
             LEntry *base = ltable_find(tbl, root);
             if (base && base->field_inits && field_init_has_prefix(base, path)) {
                 if (base->state == LSTATE_CONSUMED) {
-                    fprintf(stderr, "[E001] Error Ln %li, Col %li: use of linear variable '%.*s' after it was moved.\n",
+                    sema_diag("[E001] Error Ln %li, Col %li: use of linear variable '%.*s' after it was moved.\n",
                             (long)e->line, (long)e->col, (int)root->length, root->name ? root->name : "<unknown>");
                     diagnostic_show_line(e->line, e->col);
-                    exit(1);
+                    sema_fatal();
                 }
                 const char *miss = field_init_prefix_first_uninit(base, path);
                 if (miss) {
-                    fprintf(stderr, "[E005] Error Ln %li, Col %li: use of uninitialized field '%.*s.%s'.\n",
+                    sema_diag("[E005] Error Ln %li, Col %li: use of uninitialized field '%.*s.%s'.\n",
                             (long)e->line, (long)e->col,
                             (int)root->length, root->name ? root->name : "?", miss);
                     diagnostic_show_line(e->line, e->col);
-                    exit(1);
+                    sema_fatal();
                 }
                 if (tbl->borrows &&
                     borrow_check_owner_access(tbl->borrows, root, MODE_SHARED, e->line, e->col))
-                    exit(1);
+                    sema_fatal();
                 break;   // handled — skip the whole-identifier check
             }
         }
@@ -996,12 +1110,12 @@ static void sema_check_expr_linearity(Expr *e, LTable *tbl, int loop_depth) {
                 while (at && at->kind == TYPE_COMPTIME) at = at->element_type;
                 if (at && (at->kind == TYPE_ARRAY || at->kind == TYPE_SLICE)) {
                     Id *aid = ixt->as.identifier_expr.id;
-                    fprintf(stderr, "[E005] Error Ln %li, Col %li: read of an element of "
+                    sema_diag("[E005] Error Ln %li, Col %li: read of an element of "
                             "uninitialized array '%.*s'; initialize it with a whole-array "
                             "value (a literal or comprehension) before reading elements.\n",
                             (long)e->line, (long)e->col, (int)aid->length, aid->name ? aid->name : "?");
                     diagnostic_show_line(e->line, e->col);
-                    exit(1);
+                    sema_fatal();
                 }
             }
         }
@@ -1069,12 +1183,12 @@ static void sema_check_expr_linearity(Expr *e, LTable *tbl, int loop_depth) {
                             if (!linear_build_access_path(aa->expr, spath, 256)) continue;
                             for (int k = 0; k < n_mut; k++) {
                                 if (linear_paths_alias(mut_paths[k], spath)) {
-                                    fprintf(stderr, "[E004] Error Ln %li, Col %li: cannot pass '%s' as a "
+                                    sema_diag("[E004] Error Ln %li, Col %li: cannot pass '%s' as a "
                                         "shared argument while '%s' is passed as a mutable ('var') "
                                         "argument in the same call (aliasing a mutable borrow).\n",
                                         (long)e->line, (long)e->col, spath, mut_paths[k]);
                                     diagnostic_show_line(e->line, e->col);
-                                    exit(1);
+                                    sema_fatal();
                                 }
                             }
                         }
@@ -1115,18 +1229,18 @@ static void sema_check_expr_linearity(Expr *e, LTable *tbl, int loop_depth) {
                     // Only check for member-expression args if the borrow is ACTIVE (not RESERVED)
                     bool is_direct_move = (arg->kind == EXPR_IDENTIFIER || arg->kind == EXPR_MOVE);
                     if (is_direct_move && tbl->borrows && borrow_is_borrowed(tbl->borrows, owner_id)) {
-                        fprintf(stderr, "[E008] Error Ln %li, Col %li: cannot move '%.*s' because it is currently borrowed.\n",
+                        sema_diag("[E008] Error Ln %li, Col %li: cannot move '%.*s' because it is currently borrowed.\n",
                                 (long)(e->line), (long)(e->col), (int)owner_id->length, owner_id->name);
                         diagnostic_show_line((e->line), (e->col));
-                        exit(1);
+                        sema_fatal();
                     }
                     if (arg->kind == EXPR_MOVE) {
                         DBG("EXPR_CALL: '%.*s' already consumed by EXPR_MOVE", (int)owner_id->length, owner_id->name);
                     } else {
-                        fprintf(stderr, "[E007] Error Ln %li, Col %li: moving linear variable '%.*s' requires explicit 'mov' at the call site.\n",
+                        sema_diag("[E007] Error Ln %li, Col %li: moving linear variable '%.*s' requires explicit 'mov' at the call site.\n",
                                 (long)(e->line), (long)(e->col), (int)owner_id->length, owner_id->name);
                         diagnostic_show_line((e->line), (e->col));
-                        exit(1);
+                        sema_fatal();
                     }
                     // Invalidate any previous borrows of this owner
                     if (tbl->borrows) {
@@ -1138,10 +1252,10 @@ static void sema_check_expr_linearity(Expr *e, LTable *tbl, int loop_depth) {
                     // the receiver to EXPR_MUT during type inference, so `x.f()` is
                     // fine; a bare `f(x)` for a var-param is rejected.
                     if (arg->kind != EXPR_MUT) {
-                        fprintf(stderr, "[E017] Error Ln %li, Col %li: passing '%.*s' to a mutable ('var') parameter requires explicit 'var' at the call site.\n",
+                        sema_diag("[E017] Error Ln %li, Col %li: passing '%.*s' to a mutable ('var') parameter requires explicit 'var' at the call site.\n",
                                 (long)(e->line), (long)(e->col), (int)owner_id->length, owner_id->name);
                         diagnostic_show_line((e->line), (e->col));
-                        exit(1);
+                        sema_fatal();
                     }
                     // Mutable borrow: check for conflicts
                     LEntry *entry = ltable_find(tbl, owner_id);
@@ -1249,10 +1363,9 @@ static void sema_check_expr_linearity(Expr *e, LTable *tbl, int loop_depth) {
             }
             if (tbl->borrows) borrow_clear_temporaries(tbl->borrows);
         }
-        LTable *parent_snapshot = ltable_clone(tbl);
         LTable *first_branch = NULL;
         for (ExprMatchCase *c = e->as.match_expr.cases; c; c = c->next) {
-            LTable *branch_tbl = ltable_clone(parent_snapshot);
+            LTable *branch_tbl = ltable_branch(tbl);
             
             for (ExprList *p = c->patterns; p; p = p->next) {
                 sema_check_expr_linearity(p->expr, branch_tbl, loop_depth);
@@ -1260,19 +1373,18 @@ static void sema_check_expr_linearity(Expr *e, LTable *tbl, int loop_depth) {
             sema_check_expr_linearity(c->body, branch_tbl, loop_depth);
             
             if (!first_branch) {
-                first_branch = ltable_clone(branch_tbl);
+                first_branch = branch_tbl;
             } else {
-                ltable_check_branch_consistency(parent_snapshot, first_branch, branch_tbl, "match expr");
+                ltable_check_branch_consistency(tbl, first_branch, branch_tbl, "match expr");
                 ltable_intersect_initialization(first_branch, first_branch, branch_tbl);
+                ltable_free(branch_tbl);
             }
-            ltable_free(branch_tbl);
         }
         if (first_branch) {
             ltable_merge_from_branch(tbl, first_branch);
             ltable_apply_initialization(tbl, first_branch);
             ltable_free(first_branch);
         }
-        ltable_free(parent_snapshot);
         if (borrowed_match_entry_e && tbl->borrows) {
             borrow_remove_entry(tbl->borrows, borrowed_match_entry_e);
         }
@@ -1302,10 +1414,10 @@ static void sema_check_expr_linearity(Expr *e, LTable *tbl, int loop_depth) {
                 // Phase 5: check if trying to whole-move a partially consumed var
                 LEntry *entry = ltable_find(tbl, idptr);
                 if (entry && ltable_is_partially_consumed(entry)) {
-                    fprintf(stderr, "[E008] Error Ln %li, Col %li: cannot move '%.*s' because some fields have already been consumed.\n",
+                    sema_diag("[E008] Error Ln %li, Col %li: cannot move '%.*s' because some fields have already been consumed.\n",
                             (long)e->line, (long)e->col, (int)idptr->length, idptr->name);
                     diagnostic_show_line(e->line, e->col);
-                    exit(1);
+                    sema_fatal();
                 }
                 DBG("EXPR_MOVE: consume IDENT '%.*s'", (int)idptr->length, idptr->name ? idptr->name : "<null>");
                 ltable_consume(tbl, idptr, loop_depth);
@@ -1396,14 +1508,14 @@ static void sema_check_stmt_linearity_with_table(Stmt *s, LTable *tbl, int loop_
             ltable_add(tbl, id, loop_depth, s->as.var_stmt.is_mutable, must, is_init, s->line, s->col);
             // Phase 5: init field-level tracking if struct with linear fields
             if (must && ty) {
-                LEntry *entry = ltable_find(tbl, id);
+                LEntry *entry = ltable_find_mut(tbl, id);
                 if (entry) ltable_init_field_states(entry, ty, tbl->arena);
             }
             // Field-sensitive definite assignment: track per-field init for a
             // flat struct local. Seeded from `is_init` (a whole initializer sets
             // every field; a bare/undefined decl leaves them all uninitialized).
             if (ty) {
-                LEntry *entry = ltable_find(tbl, id);
+                LEntry *entry = ltable_find_mut(tbl, id);
                 if (entry) ltable_setup_field_inits(entry, ty, tbl->arena, is_init);
             }
         }
@@ -1589,11 +1701,11 @@ static void sema_check_stmt_linearity_with_table(Stmt *s, LTable *tbl, int loop_
                 // Check for write conflict with persistent borrows
                 if (tbl->borrows) {
                     if (borrow_check_owner_access(tbl->borrows, base_id, MODE_MUTABLE, s->line, s->col)) {
-                        exit(1);
+                        sema_fatal();
                     }
                 }
 
-                LEntry *entry = ltable_find(tbl, base_id);
+                LEntry *entry = ltable_find_mut(tbl, base_id);
                 if (entry) {
                     // F-035: direct reassignment of a linear variable with a
                     // fresh value. If the old value is still live, that is a
@@ -1603,11 +1715,11 @@ static void sema_check_stmt_linearity_with_table(Stmt *s, LTable *tbl, int loop_
                     bool lhs_is_identifier = (lhs && lhs->kind == EXPR_IDENTIFIER);
                     if (lhs_is_identifier && entry->must_consume) {
                         if (entry->state == LSTATE_UNCONSUMED && entry->is_initialized) {
-                            fprintf(stderr, "[E003] Error Ln %li, Col %li: overwriting linear variable '%.*s' without consuming the previous value.\n",
+                            sema_diag("[E003] Error Ln %li, Col %li: overwriting linear variable '%.*s' without consuming the previous value.\n",
                                     (long)s->line, (long)s->col,
                                     (int)entry->id->length, entry->id->name);
                             diagnostic_show_line(s->line, s->col);
-                            exit(1);
+                            sema_fatal();
                         }
                         if (entry->state == LSTATE_CONSUMED) {
                             entry->state = LSTATE_UNCONSUMED;
@@ -1650,9 +1762,9 @@ static void sema_check_stmt_linearity_with_table(Stmt *s, LTable *tbl, int loop_
     case STMT_EXPR: {
         Expr *e = s->as.expr_stmt.expr;
         if (e && e->type && is_type_move(e->type)) {
-            fprintf(stderr, "[E003] Error Ln %li, Col %li: discarding value of linear type (move) is not allowed.\n", (long)s->line, (long)s->col);
+            sema_diag("[E003] Error Ln %li, Col %li: discarding value of linear type (move) is not allowed.\n", (long)s->line, (long)s->col);
             diagnostic_show_line(s->line, s->col);
-            exit(1);
+            sema_fatal();
         }
         if (e) sema_check_expr_linearity(e, tbl, loop_depth);
         break;
@@ -1665,9 +1777,7 @@ static void sema_check_stmt_linearity_with_table(Stmt *s, LTable *tbl, int loop_
             if (tbl->borrows) borrow_clear_temporaries(tbl->borrows);
         }
 
-        LTable *parent_snapshot = ltable_clone(tbl);
-
-        LTable *then_tbl = ltable_clone(parent_snapshot);
+        LTable *then_tbl = ltable_branch(tbl);
         LEntry *then_saved = then_tbl->head;
         if (then_tbl->borrows) borrow_enter_scope(then_tbl->arena, then_tbl->borrows);
         for (StmtList *b = s->as.if_stmt.then_body; b; b = b->next) {
@@ -1675,7 +1785,7 @@ static void sema_check_stmt_linearity_with_table(Stmt *s, LTable *tbl, int loop_
         }
         ltable_pop_scope(then_tbl, then_saved);
 
-        LTable *else_tbl = ltable_clone(parent_snapshot);
+        LTable *else_tbl = ltable_branch(tbl);
         LEntry *else_saved = else_tbl->head;
         if (else_tbl->borrows) borrow_enter_scope(else_tbl->arena, else_tbl->borrows);
         for (StmtList *b = s->as.if_stmt.else_branch; b; b = b->next) {
@@ -1683,11 +1793,10 @@ static void sema_check_stmt_linearity_with_table(Stmt *s, LTable *tbl, int loop_
         }
         ltable_pop_scope(else_tbl, else_saved);
 
-        ltable_check_branch_consistency(parent_snapshot, then_tbl, else_tbl, "if");
+        ltable_check_branch_consistency(tbl, then_tbl, else_tbl, "if");
         ltable_merge_from_branch(tbl, then_tbl);
         ltable_intersect_initialization(tbl, then_tbl, else_tbl);
 
-        ltable_free(parent_snapshot);
         ltable_free(then_tbl);
         ltable_free(else_tbl);
         break;
@@ -1700,7 +1809,7 @@ static void sema_check_stmt_linearity_with_table(Stmt *s, LTable *tbl, int loop_
         }
         int new_depth = loop_depth + 1;
         
-        LTable *pre_loop = ltable_clone(tbl);
+        LInitSave *pre_loop = ltable_save_initialization(tbl);
         
         LEntry *saved_head = tbl->head;
         if (tbl->borrows) borrow_enter_scope(tbl->arena, tbl->borrows);
@@ -1711,11 +1820,7 @@ static void sema_check_stmt_linearity_with_table(Stmt *s, LTable *tbl, int loop_
         if (tbl->borrows) borrow_exit_scope(tbl->borrows);
         
         // Loop might run zero times, so restore initialization state from before the loop
-        for (LEntry *p = tbl->head; p; p = p->next) {
-            LEntry *pre = ltable_find(pre_loop, p->id);
-            if (pre) p->is_initialized = pre->is_initialized;
-        }
-        ltable_free(pre_loop);
+        ltable_restore_initialization(tbl, pre_loop);
         
         break;
     }
@@ -1731,7 +1836,7 @@ static void sema_check_stmt_linearity_with_table(Stmt *s, LTable *tbl, int loop_
         // exclusion: if the rooted identifier is NOT a parameter of the
         // current function, treat it as a local.
         if (val && val->kind == EXPR_CALL && val->as.call_expr.callee
-            && current_function_decl) {
+            && sema_ctx->function_decl) {
             Expr *callee = val->as.call_expr.callee;
             Decl *sd = NULL;
             if ((callee->kind == EXPR_IDENTIFIER || callee->kind == EXPR_TYPE)
@@ -1739,7 +1844,7 @@ static void sema_check_stmt_linearity_with_table(Stmt *s, LTable *tbl, int loop_
                 sd = callee->decl;
             }
             if (sd) {
-                DeclList *params = current_function_decl->as.function_decl.params;
+                DeclList *params = sema_ctx->function_decl->as.function_decl.params;
                 DeclList *field = sd->as.struct_decl.fields;
                 ExprList *arg   = val->as.call_expr.args;
                 while (field && arg) {
@@ -1782,14 +1887,14 @@ static void sema_check_stmt_linearity_with_table(Stmt *s, LTable *tbl, int loop_
                             }
                             if (!is_param) {
                                 Id *fname = field->decl->as.variable_decl.name;
-                                fprintf(stderr,
+                                sema_diag(
                                     "[E010] Error Ln %li, Col %li: returning struct '%.*s' whose pointer-bearing field '%.*s' borrows from local variable '%.*s'. The local is deallocated at function return, leaving a dangling reference. Pass the buffer in as a parameter, or rework the struct to own its data.\n",
                                     (long)s->line, (long)s->col,
                                     (int)sd->as.struct_decl.name->length, sd->as.struct_decl.name->name,
                                     (int)(fname ? fname->length : 0), fname ? fname->name : "?",
                                     (int)plen, plain);
                                 diagnostic_show_line(s->line, s->col);
-                                exit(1);
+                                sema_fatal();
                             }
                         }
                     }
@@ -1814,13 +1919,13 @@ static void sema_check_stmt_linearity_with_table(Stmt *s, LTable *tbl, int loop_
             if (root && root->kind == EXPR_IDENTIFIER) {
                 Decl *d = root->decl;
                 if (d && d->kind == DECL_VARIABLE && !d->as.variable_decl.is_parameter) {
-                    fprintf(stderr, "[E010] Error Ln %li, Col %li: cannot return mutable reference to local variable '%.*s'. "
+                    sema_diag("[E010] Error Ln %li, Col %li: cannot return mutable reference to local variable '%.*s'. "
                             "Local variables are deallocated when the function returns.\n",
                             (long)s->line, (long)s->col,
                             (int)root->as.identifier_expr.id->length,
                             root->as.identifier_expr.id->name);
                     diagnostic_show_line(s->line, s->col);
-                    exit(1);
+                    sema_fatal();
                 }
             }
         }
@@ -1842,13 +1947,13 @@ static void sema_check_stmt_linearity_with_table(Stmt *s, LTable *tbl, int loop_
                 bool is_param = root->decl && root->decl->kind == DECL_VARIABLE &&
                                 root->decl->as.variable_decl.is_parameter;
                 if (!is_param) {
-                    fprintf(stderr, "[E010] Error Ln %li, Col %li: cannot return the address of local variable "
+                    sema_diag("[E010] Error Ln %li, Col %li: cannot return the address of local variable "
                             "'%.*s' — it is deallocated when the function returns (dangling pointer).\n",
                             (long)s->line, (long)s->col,
                             (int)root->as.identifier_expr.id->length,
                             root->as.identifier_expr.id->name);
                     diagnostic_show_line(s->line, s->col);
-                    exit(1);
+                    sema_fatal();
                 }
             }
         }
@@ -1857,24 +1962,24 @@ static void sema_check_stmt_linearity_with_table(Stmt *s, LTable *tbl, int loop_
         // return type is a dynamic slice makes a slice pointing into stack memory
         // freed at return (gcc emits a pile of warnings). A fixed-array return
         // (by value) or a parameter array (owned by the caller) is fine.
-        if (val && val->kind == EXPR_IDENTIFIER && !val->is_global && current_function_decl &&
-            (current_function_decl->kind == DECL_FUNCTION ||
-             current_function_decl->kind == DECL_PROCEDURE)) {
+        if (val && val->kind == EXPR_IDENTIFIER && !val->is_global && sema_ctx->function_decl &&
+            (sema_ctx->function_decl->kind == DECL_FUNCTION ||
+             sema_ctx->function_decl->kind == DECL_PROCEDURE)) {
             bool is_param = val->decl && val->decl->kind == DECL_VARIABLE &&
                             val->decl->as.variable_decl.is_parameter;
             Type *vt = val->type;
-            Type *rt = current_function_decl->as.function_decl.return_type;
+            Type *rt = sema_ctx->function_decl->as.function_decl.return_type;
             bool val_fixed_array = vt && vt->kind == TYPE_ARRAY && vt->array_len >= 0;
             bool ret_is_slice = rt && ((rt->kind == TYPE_ARRAY && rt->array_len == -1) ||
                                        rt->kind == TYPE_SLICE);
             if (!is_param && val_fixed_array && ret_is_slice) {
-                fprintf(stderr, "[E010] Error Ln %li, Col %li: cannot return local fixed-size array '%.*s' as a "
+                sema_diag("[E010] Error Ln %li, Col %li: cannot return local fixed-size array '%.*s' as a "
                         "slice — it is deallocated at function return (dangling slice). Return it by value or "
                         "write into an output-buffer parameter.\n",
                         (long)s->line, (long)s->col,
                         (int)val->as.identifier_expr.id->length, val->as.identifier_expr.id->name);
                 diagnostic_show_line(s->line, s->col);
-                exit(1);
+                sema_fatal();
             }
         }
 
@@ -1897,13 +2002,13 @@ static void sema_check_stmt_linearity_with_table(Stmt *s, LTable *tbl, int loop_
                 Type *bt = root->type;
                 bool base_local_array = bt && bt->kind == TYPE_ARRAY && bt->array_len >= 0;
                 if (!is_param && base_local_array) {
-                    fprintf(stderr, "[E010] Error Ln %li, Col %li: cannot return a slice of local array '%.*s' — "
+                    sema_diag("[E010] Error Ln %li, Col %li: cannot return a slice of local array '%.*s' — "
                             "it is deallocated at function return (dangling slice). Slice a parameter or owned "
                             "buffer instead, or return the array by value.\n",
                             (long)s->line, (long)s->col,
                             (int)root->as.identifier_expr.id->length, root->as.identifier_expr.id->name);
                     diagnostic_show_line(s->line, s->col);
-                    exit(1);
+                    sema_fatal();
                 }
             }
         }
@@ -1931,10 +2036,9 @@ static void sema_check_stmt_linearity_with_table(Stmt *s, LTable *tbl, int loop_
             }
             if (tbl->borrows) borrow_clear_temporaries(tbl->borrows);
         }
-        LTable *parent_snapshot = ltable_clone(tbl);
         LTable *first_branch = NULL;
         for (StmtMatchCase *c = s->as.match_stmt.cases; c; c = c->next) {
-            LTable *branch_tbl = ltable_clone(parent_snapshot);
+            LTable *branch_tbl = ltable_branch(tbl);
             LEntry *saved_head = branch_tbl->head;
             if (branch_tbl->borrows) borrow_enter_scope(branch_tbl->arena, branch_tbl->borrows);
             
@@ -1947,19 +2051,18 @@ static void sema_check_stmt_linearity_with_table(Stmt *s, LTable *tbl, int loop_
             ltable_pop_scope(branch_tbl, saved_head);
 
             if (!first_branch) {
-                first_branch = ltable_clone(branch_tbl);
+                first_branch = branch_tbl;
             } else {
-                ltable_check_branch_consistency(parent_snapshot, first_branch, branch_tbl, "match");
+                ltable_check_branch_consistency(tbl, first_branch, branch_tbl, "match");
                 ltable_intersect_initialization(first_branch, first_branch, branch_tbl);
+                ltable_free(branch_tbl);
             }
-            ltable_free(branch_tbl);
         }
         if (first_branch) {
             ltable_merge_from_branch(tbl, first_branch);
             ltable_apply_initialization(tbl, first_branch);
             ltable_free(first_branch);
         }
-        ltable_free(parent_snapshot);
         // Remove the borrowed match borrow now that the match body is done
         if (borrowed_match_entry && tbl->borrows) {
             borrow_remove_entry(tbl->borrows, borrowed_match_entry);
@@ -1978,7 +2081,7 @@ static void sema_check_stmt_linearity_with_table(Stmt *s, LTable *tbl, int loop_
         }
         int new_depth = loop_depth + 1;
         
-        LTable *pre_loop = ltable_clone(tbl);
+        LInitSave *pre_loop = ltable_save_initialization(tbl);
         
         LEntry *saved_head = tbl->head;
         if (tbl->borrows) borrow_enter_scope(tbl->arena, tbl->borrows);
@@ -1989,11 +2092,7 @@ static void sema_check_stmt_linearity_with_table(Stmt *s, LTable *tbl, int loop_
         if (tbl->borrows) borrow_exit_scope(tbl->borrows);
         
         // Loop might run zero times, so restore initialization state from before the loop
-        for (LEntry *p = tbl->head; p; p = p->next) {
-            LEntry *pre = ltable_find(pre_loop, p->id);
-            if (pre) p->is_initialized = pre->is_initialized;
-        }
-        ltable_free(pre_loop);
+        ltable_restore_initialization(tbl, pre_loop);
         
         break;
     }
@@ -2025,7 +2124,8 @@ static void sema_check_stmt_linearity_with_table(Stmt *s, LTable *tbl, int loop_
         // Save state of all tracked variables before walking defer body
         typedef struct DeferSave { Id *id; LState state; bool must_consume; struct DeferSave *next; } DeferSave;
         DeferSave *saves = NULL;
-        for (LEntry *e = tbl->head; e; e = e->next) {
+        LTableIter it = ltable_iter(tbl);
+        for (LEntry *e; (e = ltable_iter_next(&it)); ) {
             DeferSave *sv = arena_push_aligned(tbl->arena, DeferSave);
             sv->id = e->id;
             sv->state = e->state;
@@ -2043,6 +2143,7 @@ static void sema_check_stmt_linearity_with_table(Stmt *s, LTable *tbl, int loop_
         for (DeferSave *sv = saves; sv; sv = sv->next) {
             LEntry *e = ltable_find(tbl, sv->id);
             if (e && sv->state == LSTATE_UNCONSUMED && e->state == LSTATE_CONSUMED) {
+                e = ltable_find_mut(tbl, sv->id);
                 e->is_defer_consumed = true;
                 e->state = LSTATE_UNCONSUMED; // Restore: var is still usable
                 DBG("STMT_DEFER Phase 4: marked '%.*s' as defer-consumed (restored to UNCONSUMED)",
@@ -2068,10 +2169,11 @@ static void sema_check_stmt_linearity_with_table(Stmt *s, LTable *tbl, int loop_
 static void sema_check_function_linearity(Decl *d) {
     if (!d || (d->kind != DECL_FUNCTION && d->kind != DECL_PROCEDURE)) return;
 
-    LTable *tbl = ltable_new(sema_arena);
+    // Every table below lives in the scratch arena; the caller rewinds it.
+    LTable *tbl = ltable_new(sema_ctx->scratch);
 
     // NLL: Compute last-use statement indices for all identifiers in the function body
-    UseTable *use_tbl = use_compute_last_uses(d->as.function_decl.body, sema_arena);
+    UseTable *use_tbl = use_compute_last_uses(d->as.function_decl.body, sema_ctx->scratch);
 
     // add parameters that are move-typed
     for (DeclList *p = d->as.function_decl.params; p; p = p->next) {
@@ -21,8 +21,7 @@
 // decl_is_generic_template() lives in ast.h (pure AST predicate, needed by emit too).
 
 static bool mono_id_eq(Id *a, Id *b) {
-    return a && b && a->length == b->length &&
-           strncmp(a->name, b->name, (size_t)a->length) == 0;
+    return a && b && id_eq(a, b);
 }
 
 // Substitution context: type-param names → concrete types.
@@ -44,7 +43,7 @@ typedef struct MonoInst {
 static MonoInst *g_mono_insts = NULL;
 
 static void mono_record_inst(Id *name, Type **args, int n) {
-    MonoInst *m = arena_push_aligned(sema_arena, MonoInst);
+    MonoInst *m = arena_push_aligned(sema_ctx->arena, MonoInst);
     m->name = name; m->n = n < MONO_MAX_TPARAMS ? n : MONO_MAX_TPARAMS;
     for (int i = 0; i < m->n; i++) m->args[i] = args[i];
     m->next = g_mono_insts; g_mono_insts = m;
@@ -204,7 +203,7 @@ static void mono_mangle_type(Type *t, char *buf, size_t cap) {
 // Persist a byte range as a NUL-terminated string in the sema arena (Id stores
 // the pointer, so mangled names must outlive the local buffer).
 static char *mono_dup(const char *s, size_t n) {
-    char *p = arena_push_many(sema_arena, char, (isize)(n + 1));
+    char *p = arena_push_many(sema_ctx->arena, char, (isize)(n + 1));
     memcpy(p, s, n); p[n] = '\0';
     return p;
 }
@@ -213,7 +212,7 @@ static char *mono_dup(const char *s, size_t n) {
 // parameters, substitute the type-param names → concrete types in the remaining
 // parameter types, the return type, and the body; rename to inst_id.
 static Decl *mono_instantiate_function(Decl *tmpl, SubstCtx *ctx, Id *inst_id) {
-    Decl *inst = clone_decl(sema_arena, tmpl);
+    Decl *inst = clone_decl(sema_ctx->arena, tmpl);
     inst->as.function_decl.name = inst_id;
     DeclList *newp = NULL, *nt = NULL;
     for (DeclList *p = inst->as.function_decl.params; p; p = p->next) {
@@ -221,7 +220,7 @@ static Decl *mono_instantiate_function(Decl *tmpl, SubstCtx *ctx, Id *inst_id) {
         Type *pt = p->decl->as.variable_decl.type;
         if (pt && pt->kind == TYPE_META) continue;            // drop the type parameter
         p->decl->as.variable_decl.type = mono_subst_type(pt, ctx);
-        DeclList *node = decl_list(sema_arena, p->decl);
+        DeclList *node = decl_list(sema_ctx->arena, p->decl);
         if (!newp) newp = node; else nt->next = node;
         nt = node;
     }
@@ -248,7 +247,7 @@ static Type *mono_arg_to_type(Expr *e) {
     if (e->kind == EXPR_TYPE) return e->as.type_expr.type_value;
     if (e->kind == EXPR_DEREF) {
         Type *inner = mono_arg_to_type(e->as.deref_expr.expr);
-        return inner ? type_pointer(sema_arena, inner) : NULL;
+        return inner ? type_pointer(sema_ctx->arena, inner) : NULL;
     }
     return NULL;
 }
@@ -295,24 +294,22 @@ static Decl *mono_type_instance(Decl *tmpl, SubstCtx *ctx, const char *suffix) {
     Symbol *existing = sema_lookup(rawbuf);
     if (existing) return existing->decl;
     char *raw = mono_dup(rawbuf, strlen(rawbuf));
-    Id *inst_id = id(sema_arena, (isize)strlen(raw), raw);
+    Id *inst_id = id(sema_ctx->arena, (isize)strlen(raw), raw);
     char tmplraw[224]; snprintf(tmplraw, sizeof tmplraw, "%.*s", (int)base->length, base->name);
     Symbol *tsym = sema_lookup(tmplraw);
     char cnamebuf[288]; snprintf(cnamebuf, sizeof cnamebuf, "%s%s", tsym ? tsym->c_name : rawbuf, suffix);
     char *cname = mono_dup(cnamebuf, strlen(cnamebuf));
 
     // 1) clone + rename + drop the header (the shell).
-    Decl *inst = clone_decl(sema_arena, tmpl);
+    Decl *inst = clone_decl(sema_ctx->arena, tmpl);
     if (inst->kind == DECL_STRUCT) { inst->as.struct_decl.name = inst_id; inst->as.struct_decl.type_params = NULL; }
     else                          { inst->as.enum_decl.type_name = inst_id; inst->as.enum_decl.type_params = NULL; }
 
     // 2) register + append BEFORE specializing fields (breaks self-reference).
-    Type *ity = type_simple(sema_arena, inst_id);
+    Type *ity = type_simple(sema_ctx->arena, inst_id);
     sema_insert_global(raw, cname, ity, inst, false);
     mono_record_inst(inst_id, ctx->concretes, ctx->n);   // for inference: Foo_i32 → [i32]
-    DeclList *node = decl_list(sema_arena, inst);
-    DeclList *tail = sema_decls; while (tail && tail->next) tail = tail->next;
-    if (tail) tail->next = node; else sema_decls = node;
+    sema_decls_append(inst);
 
     // 3) specialize each field: substitute the type params, then resolve any
     //    nested generic type-application (`inner Option(T)` → Option_i32).
@@ -350,47 +347,45 @@ static Type *union_lower(Type *u) {
     }
     Symbol *ex = sema_lookup(nb);
     if (ex && ex->decl && ex->decl->kind == DECL_ENUM)
-        return type_simple(sema_arena, ex->decl->as.enum_decl.type_name);
+        return type_simple(sema_ctx->arena, ex->decl->as.enum_decl.type_name);
 
     char *raw = mono_dup(nb, strlen(nb));
-    Id *ename = id(sema_arena, (isize)strlen(raw), raw);
+    Id *ename = id(sema_ctx->arena, (isize)strlen(raw), raw);
 
     // payload variant `__payload { __v : value }`, then one empty variant per
     // marker. The payload variant's name is a compiler-internal detail: user
     // code never spells it — the value is reached with the `else` arm of a
     // `case` (which narrows the scrutinee to the value type), never `some(v)`.
-    Variant *pv = arena_push_aligned(sema_arena, Variant);
-    pv->name   = id(sema_arena, 9, "__payload");
-    pv->fields = decl_list(sema_arena, decl_variable(sema_arena, id(sema_arena, 3, "__v"), value));
+    Variant *pv = arena_push_aligned(sema_ctx->arena, Variant);
+    pv->name   = id(sema_ctx->arena, 9, "__payload");
+    pv->fields = decl_list(sema_ctx->arena, decl_variable(sema_ctx->arena, id(sema_ctx->arena, 3, "__v"), value));
     pv->next   = NULL;
     Variant *tail = pv;
     for (IdList *m = u->union_markers; m; m = m->next) {
-        Variant *mv = arena_push_aligned(sema_arena, Variant);
+        Variant *mv = arena_push_aligned(sema_ctx->arena, Variant);
         mv->name = m->id; mv->fields = NULL; mv->next = NULL;
         tail->next = mv; tail = mv;
     }
 
-    Decl *ed = arena_push_aligned(sema_arena, Decl);
+    Decl *ed = arena_push_aligned(sema_ctx->arena, Decl);
     ed->kind = DECL_ENUM;
     ed->as.enum_decl.type_name   = ename;
     ed->as.enum_decl.variants    = pv;
     ed->as.enum_decl.type_params = NULL;
     ed->as.enum_decl.is_union    = true;
 
-    Type *ity = type_simple(sema_arena, ename);
+    Type *ity = type_simple(sema_ctx->arena, ename);
     sema_insert_global(raw, raw, ity, ed, false);
-    DeclList *node = decl_list(sema_arena, ed);
-    DeclList *tl = sema_decls; while (tl && tl->next) tl = tl->next;
-    if (tl) tl->next = node; else sema_decls = node;
+    sema_decls_append(ed);
 
     // Zero-cost mandatory: the markers must fit the value's niche, else reject.
     if (!niche_enum_is_zero_cost(&ed->as.enum_decl)) {
         char vd[128]; type_describe(value, vd, sizeof vd);
-        fprintf(stderr, "[E064] Error: the union `%s | ...` cannot be zero-cost — '%s' has no "
+        sema_diag("[E064] Error: the union `%s | ...` cannot be zero-cost — '%s' has no "
                 "spare bit-patterns for its %d marker(s). Give the value type niche room "
                 "(a refinement like `u8 where < 200`, a pointer, or a slice), or use fewer markers.\n",
                 vd, vd, nmark);
-        exit(1);
+        sema_fatal();
     }
     return ity;
 }
@@ -407,9 +402,9 @@ static Type *mono_resolve_type_apps(Type *t) {
         Symbol *sym = sema_lookup(nb);
         if (!sym || !sym->decl || !decl_is_generic_template(sym->decl) ||
             (sym->decl->kind != DECL_STRUCT && sym->decl->kind != DECL_ENUM)) {
-            fprintf(stderr, "[E124] Error: '%.*s' is not a generic type.\n",
+            sema_diag("[E124] Error: '%.*s' is not a generic type.\n",
                     (int)t->base_type->length, t->base_type->name);
-            exit(1);
+            sema_fatal();
         }
         Decl *tmpl = sym->decl;
         DeclList *tparams = (tmpl->kind == DECL_STRUCT) ? tmpl->as.struct_decl.type_params
@@ -423,7 +418,7 @@ static Type *mono_resolve_type_apps(Type *t) {
         }
         Decl *inst = mono_type_instance(tmpl, &ctx, suffix);
         Id *iname = (inst->kind == DECL_STRUCT) ? inst->as.struct_decl.name : inst->as.enum_decl.type_name;
-        return type_simple(sema_arena, iname);
+        return type_simple(sema_ctx->arena, iname);
     }
     if (t->element_type) t->element_type = mono_resolve_type_apps(t->element_type);
     return t;
@@ -463,9 +458,9 @@ static bool mono_construct_generic_struct(Expr *call, Decl *tmpl) {
         for (int i = 0; i < ntp; i++, a = a->next) {
             Type *ta = mono_arg_to_type(a->expr);
             if (!ta) {
-                fprintf(stderr, "[E124] Error Ln %li, Col %li: generic type '%.*s' expects a leading type argument.\n",
+                sema_diag("[E124] Error Ln %li, Col %li: generic type '%.*s' expects a leading type argument.\n",
                         (long)call->line, (long)call->col, (int)base->length, base->name);
-                diagnostic_show_line(call->line, call->col); exit(1);
+                diagnostic_show_line(call->line, call->col); sema_fatal();
             }
             mono_bind(&ctx, tp_names[i], ta);
         }
@@ -482,19 +477,19 @@ static bool mono_construct_generic_struct(Expr *call, Decl *tmpl) {
             bool bound = false;
             for (int j = 0; j < ctx.n; j++) if (mono_id_eq(ctx.names[j], tp_names[i])) bound = true;
             if (!bound) {
-                fprintf(stderr, "[E124] Error Ln %li, Col %li: cannot infer type parameter '%.*s' of '%.*s' "
+                sema_diag("[E124] Error Ln %li, Col %li: cannot infer type parameter '%.*s' of '%.*s' "
                         "from the field values — pass it explicitly.\n",
                         (long)call->line, (long)call->col, (int)tp_names[i]->length, tp_names[i]->name,
                         (int)base->length, base->name);
-                diagnostic_show_line(call->line, call->col); exit(1);
+                diagnostic_show_line(call->line, call->col); sema_fatal();
             }
         }
         field_args = call->as.call_expr.args;
     } else {
-        fprintf(stderr, "[E124] Error Ln %li, Col %li: wrong number of arguments to construct generic '%.*s' "
+        sema_diag("[E124] Error Ln %li, Col %li: wrong number of arguments to construct generic '%.*s' "
                 "(expected %d field values, with %d type argument(s) explicit or inferred).\n",
                 (long)call->line, (long)call->col, (int)base->length, base->name, nf, ntp);
-        diagnostic_show_line(call->line, call->col); exit(1);
+        diagnostic_show_line(call->line, call->col); sema_fatal();
     }
 
     char suffix[224]; int soff = 0; suffix[0] = '\0';
@@ -507,7 +502,7 @@ static bool mono_construct_generic_struct(Expr *call, Decl *tmpl) {
 
     call->as.call_expr.args = field_args;
     Decl *inst = mono_type_instance(tmpl, &ctx, suffix);
-    Type *ity = type_simple(sema_arena, inst->as.struct_decl.name);
+    Type *ity = type_simple(sema_ctx->arena, inst->as.struct_decl.name);
     callee->decl = inst;
     callee->type = ity;
     if (callee->kind == EXPR_TYPE) callee->as.type_expr.type_value = ity;
@@ -529,9 +524,9 @@ static bool mono_ref_generic_enum(Expr *call, Decl *tmpl) {
     for (DeclList *tp = tparams; tp; tp = tp->next) {
         Type *ta = a ? mono_arg_to_type(a->expr) : NULL;
         if (!ta) {
-            fprintf(stderr, "[E124] Error Ln %li, Col %li: generic type '%.*s' expects a type argument.\n",
+            sema_diag("[E124] Error Ln %li, Col %li: generic type '%.*s' expects a type argument.\n",
                     (long)call->line, (long)call->col, (int)base->length, base->name);
-            diagnostic_show_line(call->line, call->col); exit(1);
+            diagnostic_show_line(call->line, call->col); sema_fatal();
         }
         mono_bind(&ctx, tp->decl->as.variable_decl.name, ta);
         char tb[128]; mono_mangle_type(ta, tb, sizeof tb);
@@ -539,7 +534,7 @@ static bool mono_ref_generic_enum(Expr *call, Decl *tmpl) {
         a = a->next;
     }
     Decl *inst = mono_type_instance(tmpl, &ctx, suffix);
-    Type *ity = type_simple(sema_arena, inst->as.enum_decl.type_name);
+    Type *ity = type_simple(sema_ctx->arena, inst->as.enum_decl.type_name);
     call->kind = EXPR_TYPE;
     call->as.type_expr.type_value = ity;
     call->decl = inst;
@@ -592,14 +587,14 @@ static bool sema_monomorphize_call(Expr *call) {
         for (int i = 0; i < ntp; i++, a = a->next) {
             Type *ta = mono_arg_to_type(a->expr);
             if (!ta) {
-                fprintf(stderr, "[E124] Error Ln %li, Col %li: type parameter '%.*s' expects a type argument.\n",
+                sema_diag("[E124] Error Ln %li, Col %li: type parameter '%.*s' expects a type argument.\n",
                         (long)call->line, (long)call->col, (int)tp_names[i]->length, tp_names[i]->name);
-                diagnostic_show_line(call->line, call->col); exit(1);
+                diagnostic_show_line(call->line, call->col); sema_fatal();
             }
             mono_bind(&ctx, tp_names[i], ta);
         }
         for (; a; a = a->next) {           // remaining args are the value args
-            ExprList *node = arena_push(sema_arena, ExprList);
+            ExprList *node = arena_push(sema_ctx->arena, ExprList);
             node->expr = a->expr; node->next = NULL;
             if (!new_args) new_args = node; else na_tail->next = node;
             na_tail = node;
@@ -617,7 +612,7 @@ static bool sema_monomorphize_call(Expr *call) {
                 if (ft) argt = ft;
             }
             mono_unify(vparams[i]->decl->as.variable_decl.type, argt, &ctx, tp_names, ntp);
-            ExprList *node = arena_push(sema_arena, ExprList);
+            ExprList *node = arena_push(sema_ctx->arena, ExprList);
             node->expr = a->expr; node->next = NULL;
             if (!new_args) new_args = node; else na_tail->next = node;
             na_tail = node;
@@ -627,18 +622,18 @@ static bool sema_monomorphize_call(Expr *call) {
             bool bound = false;
             for (int j = 0; j < ctx.n; j++) if (mono_id_eq(ctx.names[j], tp_names[i])) bound = true;
             if (!bound) {
-                fprintf(stderr, "[E124] Error Ln %li, Col %li: cannot infer type parameter '%.*s' of '%.*s' "
+                sema_diag("[E124] Error Ln %li, Col %li: cannot infer type parameter '%.*s' of '%.*s' "
                         "from the arguments — pass it explicitly.\n",
                         (long)call->line, (long)call->col, (int)tp_names[i]->length, tp_names[i]->name,
                         (int)base->length, base->name);
-                diagnostic_show_line(call->line, call->col); exit(1);
+                diagnostic_show_line(call->line, call->col); sema_fatal();
             }
         }
     } else {
-        fprintf(stderr, "[E124] Error Ln %li, Col %li: wrong number of arguments to generic '%.*s' "
+        sema_diag("[E124] Error Ln %li, Col %li: wrong number of arguments to generic '%.*s' "
                 "(expected %d value arguments, with %d type argument(s) explicit or inferred).\n",
                 (long)call->line, (long)call->col, (int)base->length, base->name, nvp, ntp);
-        diagnostic_show_line(call->line, call->col); exit(1);
+        diagnostic_show_line(call->line, call->col); sema_fatal();
     }
 
     // Build the mangled suffix in type-parameter order (stable across explicit/inferred).
@@ -660,7 +655,7 @@ static bool sema_monomorphize_call(Expr *call) {
         inst_id = inst->as.function_decl.name;
     } else {
         char *raw = mono_dup(rawbuf, strlen(rawbuf));
-        inst_id = id(sema_arena, (isize)strlen(raw), raw);
+        inst_id = id(sema_ctx->arena, (isize)strlen(raw), raw);
         // cname = template's cname ⧺ suffix (e.g. "mod_max" → "mod_max_i32").
         char tmplraw[224];
         snprintf(tmplraw, sizeof tmplraw, "%.*s", (int)base->length, base->name);
@@ -674,9 +669,7 @@ static bool sema_monomorphize_call(Expr *call) {
         // though the instance is appended after (and processed later than) it.
         mono_resolve_signature(inst);
         sema_insert_global(raw, cname, inst->as.function_decl.return_type, inst, false);
-        DeclList *node = decl_list(sema_arena, inst);
-        DeclList *tail = sema_decls; while (tail && tail->next) tail = tail->next;
-        if (tail) tail->next = node; else sema_decls = node;
+        sema_decls_append(inst);
     }
 
     // Rewrite the call to target the concrete instance.
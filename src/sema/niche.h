@@ -20,8 +20,7 @@
 #include <limits.h>
 #include "../ast.h"
 #include "../target.h"
-
-extern Arena *sema_arena;
+#include "context.h"
 
 /*─────────────────────────────────────────────────────────────────╗
 │ Sentinel pool: kind-specific representation                      │
@@ -301,37 +300,15 @@ static Variant *enum_payload_variant(DeclEnum *e);
 /* Look up an enum declaration by the field type's base name.
    M6 cascade uses this to detect nested niche-optimized enums. */
 static Decl *niche_find_enum_by_name(Type *t) {
-    extern DeclList *sema_decls;
     if (!t || t->kind != TYPE_SIMPLE || !t->base_type) return NULL;
-    const char *n = t->base_type->name;
-    isize L = t->base_type->length;
-    for (DeclList *dl = sema_decls; dl; dl = dl->next) {
-        if (!dl->decl || dl->decl->kind != DECL_ENUM) continue;
-        Id *en = dl->decl->as.enum_decl.type_name;
-        if (!en) continue;
-        if (en->length == L && memcmp(en->name, n, L) == 0) {
-            return dl->decl;
-        }
-    }
-    return NULL;
+    return decl_index_enum(t->base_type);
 }
 
 /* Look up a type alias declaration by name. Sprint D follow-up
    uses this to extract refinement bounds for integer payload niche. */
 static Decl *niche_find_alias_by_name(Type *t) {
-    extern DeclList *sema_decls;
     if (!t || t->kind != TYPE_SIMPLE || !t->base_type) return NULL;
-    const char *n = t->base_type->name;
-    isize L = t->base_type->length;
-    for (DeclList *dl = sema_decls; dl; dl = dl->next) {
-        if (!dl->decl || dl->decl->kind != DECL_TYPE_ALIAS) continue;
-        Id *an = dl->decl->as.type_alias_decl.name;
-        if (!an) continue;
-        if (an->length == L && memcmp(an->name, n, L) == 0) {
-            return dl->decl;
-        }
-    }
-    return NULL;
+    return decl_index_alias(t->base_type);
 }
 
 /* Extract refinement bounds [lo, hi] from a type alias's constraint
@@ -438,7 +415,7 @@ static SentinelPool niche_pool_for_field(Type *field_ty) {
     return p;
 }
 
-static NicheLayout niche_compute_layout(DeclEnum *e) {
+static NicheLayout _niche_compute_layout(DeclEnum *e) {
     NicheLayout L = {0};
     L.payload_variant_count = niche_count_payload_variants(e);
     L.empty_variant_count   = niche_count_empty_variants(e);
@@ -453,7 +430,7 @@ static NicheLayout niche_compute_layout(DeclEnum *e) {
         p.kind = POOL_EMPTY;
         L.pool = p;
         L.empty_sentinels = arena_push_many_aligned(
-            sema_arena, long long, L.empty_variant_count);
+            sema_ctx->arena, long long, L.empty_variant_count);
         L.empty_sentinels_count = L.empty_variant_count;
         for (size_t i = 0; i < L.empty_variant_count; i++) {
             L.empty_sentinels[i] = (long long)i;
@@ -503,7 +480,7 @@ static NicheLayout niche_compute_layout(DeclEnum *e) {
             L.secondary_variant = sec;
             L.secondary_subenum_decl = sub_enum;
             L.secondary_sentinels = arena_push_many_aligned(
-                sema_arena, long long, sub_count);
+                sema_ctx->arena, long long, sub_count);
             L.secondary_sentinels_count = sub_count;
             for (size_t i = 0; i < sub_count; i++) {
                 L.secondary_sentinels[i] = sentinel_pick(&pool, i);
@@ -554,7 +531,7 @@ static NicheLayout niche_compute_layout(DeclEnum *e) {
     /* Allocate sentinel array if zero-cost. */
     if (L.is_zero_cost && L.empty_variant_count > 0) {
         L.empty_sentinels = arena_push_many_aligned(
-            sema_arena, long long, L.empty_variant_count);
+            sema_ctx->arena, long long, L.empty_variant_count);
         L.empty_sentinels_count = L.empty_variant_count;
         for (size_t i = 0; i < L.empty_variant_count; i++) {
             L.empty_sentinels[i] = sentinel_pick(&L.pool, i);
@@ -564,6 +541,13 @@ static NicheLayout niche_compute_layout(DeclEnum *e) {
     return L;
 }
 
+static NicheLayout niche_compute_layout(DeclEnum *e) {
+    prof_enter(PASS_NICHE);
+    NicheLayout L = _niche_compute_layout(e);
+    prof_leave();
+    return L;
+}
+
 /*─────────────────────────────────────────────────────────────────╗
 │ Codegen helpers (consumed by emit/decl.h and emit/stmt.h)        │
 ╚─────────────────────────────────────────────────────────────────*/
@@ -613,7 +597,7 @@ static long long niche_sentinel_for_variant(DeclEnum *e, Variant *target,
 static void niche_emit_w120(DeclEnum *e, NicheLayout *L) {
     if (!L->pool_was_short) return;
     Id *en = e->type_name;
-    fprintf(stderr,
+    sema_diag(
         "[W120] Warning: enum '%.*s' not fully zero-cost.\n"
         "       Payload provides %lld sentinel slot(s); %zu empty variant(s) require %zu.\n"
         "       Layout falls back to 1 tag byte + payload union.\n"
@@ -646,7 +630,7 @@ static void niche_dump_layout(DeclEnum *e, NicheLayout *L) {
     Id *name = e->type_name;
     int nlen = name ? (int)name->length : 1;
     const char *nstr = name ? name->name : "?";
-    fprintf(stderr, "[niche] enum '%.*s': "
+    sema_diag("[niche] enum '%.*s': "
                     "payload=%zu empty=%zu pool=%s pool.size=%lld "
                     "zero_cost=%s\n",
             nlen, nstr,
@@ -656,16 +640,16 @@ static void niche_dump_layout(DeclEnum *e, NicheLayout *L) {
             L->is_zero_cost ? "yes" : "no");
     if (L->is_zero_cost && L->empty_sentinels) {
         for (size_t i = 0; i < L->empty_sentinels_count; i++) {
-            fprintf(stderr, "[niche]   empty[%zu] = %lld\n",
+            sema_diag("[niche]   empty[%zu] = %lld\n",
                     i, L->empty_sentinels[i]);
         }
     }
     if (L->is_zero_cost && L->secondary_sentinels) {
         Id *sn = L->secondary_variant->name;
-        fprintf(stderr, "[niche]   multi-payload secondary=%.*s sub_count=%zu\n",
+        sema_diag("[niche]   multi-payload secondary=%.*s sub_count=%zu\n",
                 (int)sn->length, sn->name, L->secondary_sentinels_count);
         for (size_t i = 0; i < L->secondary_sentinels_count; i++) {
-            fprintf(stderr, "[niche]     %.*s[%zu] = %lld\n",
+            sema_diag("[niche]     %.*s[%zu] = %lld\n",
                     (int)sn->length, sn->name, i, L->secondary_sentinels[i]);
         }
     }
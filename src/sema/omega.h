@@ -11,16 +11,29 @@
  *   1. Decompose both expressions into linear forms over named variables.
  *      x.len references are mapped to the synthetic __len_x VRA entry.
  *   2. Form the negated query: bound - index ≤ 0  (i.e. index ≥ bound).
- *   3. Extract all VRA range / difference constraints for those variables.
+ *   3. Extract the VRA range / difference constraints for those variables,
+ *      and for the variables they are chained to by difference constraints
+ *      (i < n, n ≤ a.len proves i < a.len).
  *   4. Run Fourier-Motzkin variable elimination.
  *   5. If the resulting system contains "0 ≤ negative_constant" → UNSAT
  *      → the negation is impossible → index < bound is always true → safe.
  *
- * No external dependencies.  Self-contained ~250 LOC, polynomial time for
- * the small systems (2-6 vars, 5-15 ineqs) typical in slice manipulation.
+ * Systems are sized to the query: rows live in the sema scratch arena and
+ * are released when the query returns. Every variable is an integer, so each
+ * inequality is divided by the gcd of its coefficients with the constant
+ * rounded down; of the inequalities with the same left-hand side only the
+ * tightest is kept. That pruning runs after every elimination step and keeps
+ * the systems small; a work budget (OMEGA_FM_BUDGET rows per step) only
+ * stops pathological blow-ups, which then count as "not proved".
+ *
+ * The normalized system, variables and rows in canonical order, is the key
+ * of a per-context query cache: the same bounds check in a loop body, or an
+ * identical one elsewhere, is answered without running the elimination.
  */
 
 #include "../ast.h"
+#include "../intern.h"
+#include "context.h"
 #include "ranges.h"
 #include <string.h>
 #include <stdint.h>
@@ -28,91 +41,86 @@
 
 /* ── limits ──────────────────────────────────────────────────────────────── */
 
-#define OMEGA_MAX_VARS  12
-#define OMEGA_FM_BUF    80   /* max ineqs in the working FM buffer           */
+#define OMEGA_FM_BUDGET       4096   /* rows one elimination step may produce */
+#define OMEGA_CACHE_MAX_ITEMS 16384  /* the cache is emptied when it fills up */
 
 /* ── data structures ─────────────────────────────────────────────────────── */
 
-/* Inequality:  Σ coeff[i]*var[i]  ≤  rhs  */
+/* One term of a linear form: coeff * var (var is an atom). */
 typedef struct {
-    int64_t coeff[OMEGA_MAX_VARS];
-    int64_t rhs;
-} OmegaIneq;
+    const char *var;
+    int64_t     coeff;
+} OmegaTerm;
 
+/* Linear form:  Σ terms  +  const_term  */
 typedef struct {
-    int     n_vars;
-    int     vlen [OMEGA_MAX_VARS];
-    char    vname[OMEGA_MAX_VARS][72]; /* enough for "__len_" + 64-char id   */
-
-    int      n_ineqs;
-    OmegaIneq ineqs[OMEGA_FM_BUF];
-} OmegaSystem;
-
-/* Linear form:  Σ coeff[i]*var[i]  +  const_term  */
-typedef struct {
-    int64_t coeff[OMEGA_MAX_VARS];
-    int64_t const_term;
+    OmegaTerm *terms;
+    int        n_terms;
+    int        cap_terms;
+    int64_t    const_term;
 } OmegaLin;
 
-/* ── variable management ─────────────────────────────────────────────────── */
+/*
+ * Inequalities  Σ coeff[i]*var[i]  ≤  rhs  over `n_vars` variables. Row r is
+ * rows[r*(n_vars+1) .. +n_vars]: the coefficients, then the rhs.
+ */
+typedef struct {
+    Arena       *arena;
+    int          n_vars;
+    const char **vars;     /* atoms, sorted by address */
+    int          n_rows;
+    int          cap_rows;
+    int64_t     *rows;
+} OmegaSystem;
 
-static int omega_find_var(OmegaSystem *s, const char *n, int nl) {
-    for (int i = 0; i < s->n_vars; i++)
-        if (s->vlen[i] == nl && memcmp(s->vname[i], n, nl) == 0) return i;
-    return -1;
+static inline int omega_width(const OmegaSystem *s) { return s->n_vars + 1; }
+static inline int64_t *omega_row(const OmegaSystem *s, int r) {
+    return s->rows + (isize)r * omega_width(s);
 }
 
-static int omega_add_var(OmegaSystem *s, const char *n, int nl) {
-    int idx = omega_find_var(s, n, nl);
-    if (idx >= 0) return idx;
-    if (s->n_vars >= OMEGA_MAX_VARS) return -1;
-    idx = s->n_vars++;
-    s->vlen[idx] = nl;
-    int cp = nl < 71 ? nl : 71;
-    memcpy(s->vname[idx], n, cp);
-    s->vname[idx][cp] = '\0';
-    return idx;
-}
+/* ── expression → linear form ────────────────────────────────────────────── */
 
-/* Register an Id* directly. */
-static int omega_add_id(OmegaSystem *s, Id *id) {
-    return id ? omega_add_var(s, id->name, (int)id->length) : -1;
+static void omega_lin_add(Arena *arena, OmegaLin *lin, const char *var, int64_t coeff) {
+    if (lin->n_terms == lin->cap_terms) {
+        int cap = lin->cap_terms ? lin->cap_terms * 2 : 8;
+        OmegaTerm *grown = arena_push_many_aligned(arena, OmegaTerm, cap);
+        if (lin->n_terms) memcpy(grown, lin->terms, (size_t)lin->n_terms * sizeof *grown);
+        lin->terms = grown;
+        lin->cap_terms = cap;
+    }
+    lin->terms[lin->n_terms].var = var;
+    lin->terms[lin->n_terms].coeff = coeff;
+    lin->n_terms++;
 }
 
-/* Register __len_REF for a `.len` member reference. */
-static int omega_add_len_ref(OmegaSystem *s, Id *ref) {
-    if (!ref) return -1;
-    char k[72];
-    int  kl = 6 + (int)ref->length;
-    if (kl > 71) return -1;
+/* Atom of the synthetic __len_REF variable for a `.len` member reference. */
+static const char *omega_len_atom(Arena *arena, Id *ref) {
+    isize kl = 6 + ref->length;
+    char *k = arena_push_many(arena, char, kl);
     memcpy(k, "__len_", 6);
-    memcpy(k + 6, ref->name, ref->length);
-    return omega_add_var(s, k, kl);
+    memcpy(k + 6, ref->name, (size_t)ref->length);
+    return atom_intern(k, kl);
 }
 
-/* ── expression → linear form ────────────────────────────────────────────── */
-
 /*
  * Recursively decomposes `e` into `lin`, multiplied by `scale`.
  * Works on both body expressions (resolved) and type-annotation size_expr
  * nodes (unresolved) because we only read raw Id names, never decl/type.
  * Returns false if `e` is non-linear (e.g. var*var) or unsupported.
  */
-static bool omega_decompose(OmegaSystem *s, Expr *e, OmegaLin *lin,
-                            int64_t scale) {
+static bool omega_decompose(Arena *arena, Expr *e, OmegaLin *lin, int64_t scale) {
     if (!e) return false;
     switch (e->kind) {
 
     case EXPR_LITERAL:
-        lin->const_term += scale * e->as.literal_expr.value;
+        lin->const_term = sat_add_i64(lin->const_term,
+                                      sat_mul_i64(scale, e->as.literal_expr.value));
         return true;
 
     case EXPR_IDENTIFIER: {
         Id *id = e->as.identifier_expr.id;
         if (!id) return false;
-        int idx = omega_add_id(s, id);
-        if (idx < 0) return false;
-        lin->coeff[idx] += scale;
+        omega_lin_add(arena, lin, id->atom, scale);
         return true;
     }
 
@@ -125,28 +133,26 @@ static bool omega_decompose(OmegaSystem *s, Expr *e, OmegaLin *lin,
         if (mem->length != 3 || memcmp(mem->name, "len", 3) != 0) return false;
         Id *ref = tgt->as.identifier_expr.id;
         if (!ref) return false;
-        int idx = omega_add_len_ref(s, ref);
-        if (idx < 0) return false;
-        lin->coeff[idx] += scale;
+        omega_lin_add(arena, lin, omega_len_atom(arena, ref), scale);
         return true;
     }
 
     case EXPR_BINARY: {
         TokenKind op = e->as.binary_expr.op;
         if (op == TOKEN_PLUS)
-            return omega_decompose(s, e->as.binary_expr.left,  lin,  scale) &&
-                   omega_decompose(s, e->as.binary_expr.right, lin,  scale);
+            return omega_decompose(arena, e->as.binary_expr.left,  lin,  scale) &&
+                   omega_decompose(arena, e->as.binary_expr.right, lin,  scale);
         if (op == TOKEN_MINUS)
-            return omega_decompose(s, e->as.binary_expr.left,  lin,  scale) &&
-                   omega_decompose(s, e->as.binary_expr.right, lin, -scale);
+            return omega_decompose(arena, e->as.binary_expr.left,  lin,  scale) &&
+                   omega_decompose(arena, e->as.binary_expr.right, lin, -scale);
         /* constant scaling: k * expr  or  expr * k */
         if (op == TOKEN_ASTERISK) {
             Expr *L = e->as.binary_expr.left, *R = e->as.binary_expr.right;
             if (L && L->kind == EXPR_LITERAL)
-                return omega_decompose(s, R, lin,
+                return omega_decompose(arena, R, lin,
                            sat_mul_i64(scale, L->as.literal_expr.value));
             if (R && R->kind == EXPR_LITERAL)
-                return omega_decompose(s, L, lin,
+                return omega_decompose(arena, L, lin,
                            sat_mul_i64(scale, R->as.literal_expr.value));
         }
         return false; /* non-linear */
@@ -154,7 +160,7 @@ static bool omega_decompose(OmegaSystem *s, Expr *e, OmegaLin *lin,
 
     case EXPR_UNARY:
         if (e->as.unary_expr.op == TOKEN_MINUS)
-            return omega_decompose(s, e->as.unary_expr.right, lin, -scale);
+            return omega_decompose(arena, e->as.unary_expr.right, lin, -scale);
         return false;
 
     default:
@@ -162,57 +168,181 @@ static bool omega_decompose(OmegaSystem *s, Expr *e, OmegaLin *lin,
     }
 }
 
+static int omega_cmp_atom(const void *a, const void *b) {
+    uintptr_t x = (uintptr_t)*(const char *const *)a;
+    uintptr_t y = (uintptr_t)*(const char *const *)b;
+    return x < y ? -1 : x > y;
+}
+
+static int omega_cmp_term(const void *a, const void *b) {
+    return omega_cmp_atom(&((const OmegaTerm *)a)->var, &((const OmegaTerm *)b)->var);
+}
+
+/* Sort the terms by variable, fold repeated variables, drop zero terms. */
+static void omega_lin_canonicalize(OmegaLin *lin) {
+    if (lin->n_terms > 1)
+        qsort(lin->terms, (size_t)lin->n_terms, sizeof *lin->terms, omega_cmp_term);
+    int n = 0;
+    for (int i = 0; i < lin->n_terms; i++) {
+        if (n > 0 && lin->terms[n - 1].var == lin->terms[i].var)
+            lin->terms[n - 1].coeff = sat_add_i64(lin->terms[n - 1].coeff, lin->terms[i].coeff);
+        else
+            lin->terms[n++] = lin->terms[i];
+    }
+    lin->n_terms = 0;
+    for (int i = 0; i < n; i++)
+        if (lin->terms[i].coeff != 0) lin->terms[lin->n_terms++] = lin->terms[i];
+}
+
 /* ── system construction ─────────────────────────────────────────────────── */
 
-static bool omega_add_ineq(OmegaSystem *s, int64_t *coeff, int64_t rhs) {
-    if (s->n_ineqs >= OMEGA_FM_BUF) return false;
-    OmegaIneq *q = &s->ineqs[s->n_ineqs++];
-    memcpy(q->coeff, coeff, OMEGA_MAX_VARS * sizeof(int64_t));
-    q->rhs = rhs;
-    return true;
+static int omega_var_index(const OmegaSystem *s, const char *atom) {
+    int lo = 0, hi = s->n_vars - 1;
+    while (lo <= hi) {
+        int mid = (lo + hi) / 2;
+        if (s->vars[mid] == atom) return mid;
+        if ((uintptr_t)s->vars[mid] < (uintptr_t)atom) lo = mid + 1;
+        else hi = mid - 1;
+    }
+    return -1;
+}
+
+/* Append a zeroed row and return it. */
+static int64_t *omega_push_row(OmegaSystem *s) {
+    if (s->n_rows == s->cap_rows) {
+        int cap = s->cap_rows ? s->cap_rows * 2 : 16;
+        int64_t *grown = arena_push_many_aligned(s->arena, int64_t, (isize)cap * omega_width(s));
+        if (s->n_rows) memcpy(grown, s->rows, (size_t)s->n_rows * (size_t)omega_width(s) * sizeof *grown);
+        s->rows = grown;
+        s->cap_rows = cap;
+    }
+    int64_t *row = omega_row(s, s->n_rows++);
+    memset(row, 0, (size_t)omega_width(s) * sizeof *row);
+    return row;
+}
+
+static void omega_add_bound(OmegaSystem *s, int i1, int64_t c1, int i2, int64_t c2, int64_t rhs) {
+    int64_t *row = omega_push_row(s);
+    row[i1] = c1;
+    if (i2 >= 0) row[i2] = c2;
+    row[s->n_vars] = rhs;
+}
+
+/*
+ * The variables of the query plus everything reachable from them through
+ * difference constraints v1 - v2 ≤ d (v1 in the set pulls in v2).
+ */
+static void omega_collect_vars(OmegaSystem *s, RangeTable *ctx, const OmegaLin *query) {
+    int cap = query->n_terms + 8;
+    s->vars = arena_push_many_aligned(s->arena, const char *, cap);
+    s->n_vars = 0;
+    for (int i = 0; i < query->n_terms; i++) s->vars[s->n_vars++] = query->terms[i].var;
+
+    for (int v = 0; v < s->n_vars; v++) {
+        ConstraintEntry *c = atom_map_get(&ctx->from, s->vars[v], NULL);
+        for (; c; c = c->prev_from) {
+            if (c->removed) continue;
+            const char *to = c->v2->atom;
+            bool seen = false;
+            for (int k = 0; k < s->n_vars && !seen; k++) seen = s->vars[k] == to;
+            if (seen) continue;
+            if (s->n_vars == cap) {
+                const char **grown = arena_push_many_aligned(s->arena, const char *, cap * 2);
+                memcpy(grown, s->vars, (size_t)cap * sizeof *grown);
+                s->vars = grown;
+                cap *= 2;
+            }
+            s->vars[s->n_vars++] = to;
+        }
+    }
+    qsort(s->vars, (size_t)s->n_vars, sizeof *s->vars, omega_cmp_atom);
 }
 
 /*
- * Extract range and difference constraints from the VRA for variables
- * already registered in `s`.  Unregistered variables are silently skipped
- * (they cannot appear in the query expressions and are irrelevant).
+ * Every range and difference constraint in the VRA over the system's
+ * variables, shadowed versions included.
  */
 static void omega_extract_vra(OmegaSystem *s, RangeTable *ctx) {
-    if (!ctx) return;
+    for (int v = 0; v < s->n_vars; v++) {
+        /* Range bounds: var ∈ [lo, hi] → two ineqs */
+        for (RangeEntry *re = range_find_atom(ctx, s->vars[v]); re; re = re->shadowed) {
+            if (!re->range.known) continue;
+            if (re->range.max < INT64_MAX) omega_add_bound(s, v,  1, -1, 0,  re->range.max);
+            if (re->range.min > INT64_MIN) omega_add_bound(s, v, -1, -1, 0, -re->range.min);
+        }
+        /* Difference constraints: v1 - v2 ≤ max_diff */
+        for (ConstraintEntry *ce = atom_map_get(&ctx->from, s->vars[v], NULL); ce; ce = ce->prev_from) {
+            if (ce->removed) continue;
+            int i2 = omega_var_index(s, ce->v2->atom);
+            if (i2 < 0 || i2 == v) continue;
+            omega_add_bound(s, v, 1, i2, -1, ce->max_diff);
+        }
+    }
+}
 
-    /* Range bounds: var ∈ [lo, hi] → two ineqs */
-    for (RangeEntry *re = ctx->head; re; re = re->next) {
-        if (!re->range.known) continue;
-        int idx = omega_find_var(s, re->var->name, (int)re->var->length);
-        if (idx < 0) continue;
+/* ── normalization and pruning ───────────────────────────────────────────── */
 
-        int64_t c[OMEGA_MAX_VARS];
-        memset(c, 0, sizeof(c));
+static int64_t omega_gcd(int64_t a, int64_t b) {
+    if (a < 0) a = -a;
+    if (b < 0) b = -b;
+    while (b) { int64_t t = a % b; a = b; b = t; }
+    return a;
+}
 
-        if (re->range.max < INT64_MAX) {
-            c[idx] = 1;           /* var ≤ hi */
-            omega_add_ineq(s, c, re->range.max);
-            memset(c, 0, sizeof(c));
+static int64_t omega_floor_div(int64_t a, int64_t b) {
+    int64_t q = a / b;
+    return (a % b != 0 && (a < 0) != (b < 0)) ? q - 1 : q;
+}
+
+static int omega_row_width_for_cmp;   /* qsort has no context argument */
+
+static int omega_cmp_row(const void *a, const void *b) {
+    const int64_t *x = a, *y = b;
+    for (int k = 0; k < omega_row_width_for_cmp; k++)
+        if (x[k] != y[k]) return x[k] < y[k] ? -1 : 1;
+    return 0;
+}
+
+/*
+ * Put the rows in canonical form:
+ *   • divide each by the gcd of its coefficients, rounding the rhs down
+ *     (integer variables: 2x ≤ 5 is x ≤ 2);
+ *   • drop constant rows that hold (0 ≤ 3);
+ *   • sort, keeping only the tightest rhs for each left-hand side.
+ * Returns false if a constant row is violated (0 ≤ -1): the system is UNSAT.
+ */
+static bool omega_normalize(OmegaSystem *s) {
+    int w = omega_width(s), n = 0;
+    for (int r = 0; r < s->n_rows; r++) {
+        int64_t *row = omega_row(s, r);
+        int64_t g = 0;
+        for (int k = 0; k < s->n_vars; k++) g = omega_gcd(g, row[k]);
+        if (g == 0) {
+            if (row[s->n_vars] < 0) return false;
+            continue;
         }
-        if (re->range.min > INT64_MIN) {
-            c[idx] = -1;          /* -var ≤ -lo  ↔  var ≥ lo */
-            omega_add_ineq(s, c, -re->range.min);
-            memset(c, 0, sizeof(c));
+        if (g > 1) {
+            for (int k = 0; k < s->n_vars; k++) row[k] /= g;
+            row[s->n_vars] = omega_floor_div(row[s->n_vars], g);
         }
+        if (n != r) memmove(omega_row(s, n), row, (size_t)w * sizeof *row);
+        n++;
     }
-
-    /* Difference constraints: v1 - v2 ≤ max_diff */
-    for (ConstraintEntry *ce = ctx->constraints; ce; ce = ce->next) {
-        int i1 = omega_find_var(s, ce->v1->name, (int)ce->v1->length);
-        int i2 = omega_find_var(s, ce->v2->name, (int)ce->v2->length);
-        if (i1 < 0 || i2 < 0) continue;
-
-        int64_t c[OMEGA_MAX_VARS];
-        memset(c, 0, sizeof(c));
-        c[i1] =  1;
-        c[i2] = -1;
-        omega_add_ineq(s, c, ce->max_diff);
+    s->n_rows = n;
+    if (n < 2) return true;
+
+    omega_row_width_for_cmp = w;
+    qsort(s->rows, (size_t)n, (size_t)w * sizeof *s->rows, omega_cmp_row);
+    int kept = 1;
+    for (int r = 1; r < n; r++) {
+        int64_t *row = omega_row(s, r);
+        if (memcmp(omega_row(s, kept - 1), row, (size_t)s->n_vars * sizeof *row) == 0)
+            continue;   /* same left-hand side, looser (or equal) rhs */
+        if (kept != r) memcpy(omega_row(s, kept), row, (size_t)w * sizeof *row);
+        kept++;
     }
+    s->n_rows = kept;
+    return true;
 }
 
 /* ── Fourier-Motzkin elimination ─────────────────────────────────────────── */
@@ -221,78 +351,220 @@ static void omega_extract_vra(OmegaSystem *s, RangeTable *ctx) {
  * Returns false (UNSAT) if the system has no integer solution.
  * Returns true  (SAT or unknown) otherwise.
  *
- * Eliminates variables one by one.  For each variable v:
+ * Eliminates variables one by one, cheapest first (fewest generated rows).
+ * For each variable v:
  *   - Neutral ineqs (coeff[v]=0) pass through unchanged.
  *   - For each pair (upper U where coeff[v]>0, lower L where coeff[v]<0),
  *     generate:  b*(U without v) + a*(L without v)  ≤  b*rhs_U + a*rhs_L
  *     where a = coeff_U[v] > 0,  b = -coeff_L[v] > 0.
- * A zero-variable ineq  0 ≤ negative  → immediate UNSAT.
- * If the FM buffer overflows, we stop early and conservatively return true.
+ *     A combination that overflows int64 is dropped (a weaker system).
+ * A zero-variable ineq  0 ≤ negative  → UNSAT. If a step would exceed the
+ * budget we stop and conservatively return true.
  */
 static bool omega_fm_sat(OmegaSystem *s) {
-    int      ni  = s->n_ineqs;
-    OmegaIneq buf[OMEGA_FM_BUF];
-    memcpy(buf, s->ineqs, ni * sizeof(OmegaIneq));
+    int w = omega_width(s);
+    for (;;) {
+        if (!omega_normalize(s)) return false;
+
+        int best = -1;
+        isize best_cost = 0;
+        for (int v = 0; v < s->n_vars; v++) {
+            isize pos = 0, neg = 0;
+            for (int r = 0; r < s->n_rows; r++) {
+                int64_t c = omega_row(s, r)[v];
+                pos += c > 0;
+                neg += c < 0;
+            }
+            if (pos + neg == 0) continue;
+            isize cost = pos * neg - pos - neg;
+            if (best < 0 || cost < best_cost) { best = v; best_cost = cost; }
+        }
+        if (best < 0) return true;   /* only satisfied constant rows left */
+
+        int v = best;
+        isize neutral = 0, pos = 0, neg = 0;
+        for (int r = 0; r < s->n_rows; r++) {
+            int64_t c = omega_row(s, r)[v];
+            neutral += c == 0;
+            pos += c > 0;
+            neg += c < 0;
+        }
+        if (neutral + pos * neg > OMEGA_FM_BUDGET) return true;
 
-    for (int v = 0; v < s->n_vars; v++) {
-        int      new_ni = 0;
-        OmegaIneq newbuf[OMEGA_FM_BUF];
+        OmegaSystem next = *s;
+        next.n_rows = 0;
+        next.cap_rows = (int)(neutral + pos * neg);
+        next.rows = arena_push_many_aligned(s->arena, int64_t,
+                                            (isize)(next.cap_rows ? next.cap_rows : 1) * w);
 
         /* 1. Pass neutral ineqs (coeff[v] == 0) */
-        for (int i = 0; i < ni; i++) {
-            if (buf[i].coeff[v] != 0) continue;
-            if (new_ni >= OMEGA_FM_BUF) goto fm_overflow;
-            newbuf[new_ni++] = buf[i];
+        for (int r = 0; r < s->n_rows; r++) {
+            int64_t *row = omega_row(s, r);
+            if (row[v] == 0) memcpy(omega_row(&next, next.n_rows++), row, (size_t)w * sizeof *row);
         }
 
         /* 2. Cross upper × lower */
-        for (int i = 0; i < ni; i++) {
-            int64_t ci = buf[i].coeff[v];
-            if (ci <= 0) continue;               /* upper bound: coeff > 0 */
+        for (int i = 0; i < s->n_rows; i++) {
+            int64_t *up = omega_row(s, i);
+            if (up[v] <= 0) continue;                 /* upper bound: coeff > 0 */
+            for (int j = 0; j < s->n_rows; j++) {
+                int64_t *lo = omega_row(s, j);
+                if (lo[v] >= 0) continue;             /* lower bound: coeff < 0 */
+                int64_t a = up[v];        /* > 0 */
+                int64_t b = -lo[v];       /* > 0 */
+                int64_t *nq = omega_row(&next, next.n_rows);
+                bool overflow = false;
+                for (int k = 0; k < w && !overflow; k++) {
+                    if (k == v) { nq[k] = 0; continue; }
+                    int64_t x = sat_add_i64(sat_mul_i64(b, up[k]), sat_mul_i64(a, lo[k]));
+                    overflow = x == INT64_MAX || x == INT64_MIN;
+                    nq[k] = x;
+                }
+                if (!overflow) next.n_rows++;
+            }
+        }
+        *s = next;
+    }
+}
 
-            for (int j = 0; j < ni; j++) {
-                int64_t cj = buf[j].coeff[v];
-                if (cj >= 0) continue;           /* lower bound: coeff < 0 */
+/* ── query cache ─────────────────────────────────────────────────────────── */
 
-                int64_t a = ci;       /* > 0 */
-                int64_t b = -cj;      /* > 0 */
+/*
+ * Key: n_vars, the variable atoms, n_rows, then the rows, all as int64 words,
+ * of a normalized system. Value: whether it was UNSAT.
+ */
+typedef struct {
+    uint64_t hash;
+    int64_t *key;        /* NULL = empty slot; malloc'd */
+    isize    key_len;
+    bool     unsat;
+} OmegaCacheSlot;
+
+typedef struct OmegaCache {
+    OmegaCacheSlot *slots;
+    isize           capacity;   /* power of two */
+    isize           count;
+} OmegaCache;
+
+static void omega_cache_free(OmegaCache *c) {
+    if (!c) return;
+    for (isize i = 0; i < c->capacity; i++) free(c->slots[i].key);
+    free(c->slots);
+    free(c);
+}
 
-                if (new_ni >= OMEGA_FM_BUF) goto fm_overflow;
-                OmegaIneq *nq = &newbuf[new_ni++];
+static int64_t *omega_cache_key(const OmegaSystem *s, isize *len) {
+    isize n = 2 + s->n_vars + (isize)s->n_rows * omega_width(s);
+    int64_t *key = arena_push_many_aligned(s->arena, int64_t, n);
+    isize p = 0;
+    key[p++] = s->n_vars;
+    for (int v = 0; v < s->n_vars; v++) key[p++] = (int64_t)(uintptr_t)s->vars[v];
+    key[p++] = s->n_rows;
+    if (s->n_rows)
+        memcpy(key + p, s->rows, (size_t)s->n_rows * (size_t)omega_width(s) * sizeof *key);
+    *len = n;
+    return key;
+}
 
-                nq->rhs = sat_add_i64(sat_mul_i64(b, buf[i].rhs),
-                                      sat_mul_i64(a, buf[j].rhs));
+static uint64_t omega_cache_hash(const int64_t *key, isize len) {
+    uint64_t h = 14695981039346656037ull;
+    for (isize i = 0; i < len; i++) {
+        h ^= (uint64_t)key[i];
+        h *= 1099511628211ull;
+        h ^= h >> 32;
+    }
+    return h;
+}
 
-                bool all_zero = true;
-                for (int k = 0; k < OMEGA_MAX_VARS; k++) {
-                    if (k == v) { nq->coeff[k] = 0; continue; }
-                    nq->coeff[k] = sat_add_i64(sat_mul_i64(b, buf[i].coeff[k]),
-                                               sat_mul_i64(a, buf[j].coeff[k]));
-                    if (nq->coeff[k] != 0) all_zero = false;
-                }
+static OmegaCacheSlot *omega_cache_probe(OmegaCache *c, uint64_t hash, const int64_t *key, isize len) {
+    isize mask = c->capacity - 1;
+    for (isize i = (isize)(hash & (uint64_t)mask);; i = (i + 1) & mask) {
+        OmegaCacheSlot *slot = &c->slots[i];
+        if (!slot->key) return slot;
+        if (slot->hash == hash && slot->key_len == len &&
+            memcmp(slot->key, key, (size_t)len * sizeof *key) == 0) return slot;
+    }
+}
 
-                /* Early UNSAT: trivial  0 ≤ negative */
-                if (all_zero && nq->rhs < 0) return false;
-            }
-        }
+/* The cache of the current context, created (or emptied when full) on demand. */
+static OmegaCache *omega_cache_get(void) {
+    OmegaCache *c = sema_ctx->omega_cache;
+    if (c && c->count < OMEGA_CACHE_MAX_ITEMS) return c;
+    omega_cache_free(c);
+    c = calloc(1, sizeof *c);
+    if (c) {
+        c->capacity = 2 * OMEGA_CACHE_MAX_ITEMS;
+        c->slots = calloc((size_t)c->capacity, sizeof *c->slots);
+        if (!c->slots) { free(c); c = NULL; }
+    }
+    if (!c) {
+        sema_diag("Error: out of memory caching bounds proofs\n");
+        sema_fatal();
+    }
+    sema_ctx->omega_cache = c;
+    return c;
+}
 
-        memcpy(buf, newbuf, new_ni * sizeof(OmegaIneq));
-        ni = new_ni;
-        continue;
+/* ── driver ──────────────────────────────────────────────────────────────── */
 
-fm_overflow:
-        /* Buffer full: give up on this variable, leave remaining buf as-is */
-        break;
+/*
+ * Is  query ≤ rhs  unsatisfiable together with the VRA facts? `query` must
+ * be canonical and hold at least one term.
+ */
+static bool omega_refutes(RangeTable *ctx, Arena *arena, const OmegaLin *query, int64_t rhs) {
+    OmegaSystem sys;
+    memset(&sys, 0, sizeof sys);
+    sys.arena = arena;
+    omega_collect_vars(&sys, ctx, query);
+
+    int64_t *row = omega_push_row(&sys);
+    for (int i = 0; i < query->n_terms; i++)
+        row[omega_var_index(&sys, query->terms[i].var)] = query->terms[i].coeff;
+    row[sys.n_vars] = rhs;
+    omega_extract_vra(&sys, ctx);
+    if (!omega_normalize(&sys)) return true;
+
+    isize key_len;
+    int64_t *key = omega_cache_key(&sys, &key_len);
+    uint64_t hash = omega_cache_hash(key, key_len);
+    OmegaCache *cache = omega_cache_get();
+    OmegaCacheSlot *slot = omega_cache_probe(cache, hash, key, key_len);
+    if (slot->key) return slot->unsat;
+
+    bool unsat = !omega_fm_sat(&sys);
+    int64_t *stored = malloc((size_t)key_len * sizeof *stored);
+    if (stored) {
+        memcpy(stored, key, (size_t)key_len * sizeof *stored);
+        slot->hash = hash;
+        slot->key = stored;
+        slot->key_len = key_len;
+        slot->unsat = unsat;
+        cache->count++;
     }
+    return unsat;
+}
 
-    /* Final scan: any constant inequality violated? */
-    for (int i = 0; i < ni; i++) {
-        bool all_zero = true;
-        for (int k = 0; k < OMEGA_MAX_VARS; k++)
-            if (buf[i].coeff[k] != 0) { all_zero = false; break; }
-        if (all_zero && buf[i].rhs < 0) return false;
+/*
+ * Prove  lhs - rhs_expr ≤ offset  false, where the linear form lhs - rhs_expr
+ * is decomposed from the two expressions (rhs_expr may be NULL). Runs in the
+ * scratch arena and releases it.
+ */
+static bool omega_refute_diff(RangeTable *ctx, Expr *lhs, Expr *rhs_expr, int64_t offset) {
+    Arena *arena = sema_ctx->scratch ? sema_ctx->scratch : sema_ctx->arena;
+    char *mark = arena_mark(arena);
+    OmegaLin lin;
+    memset(&lin, 0, sizeof lin);
+    bool proved = false;
+    if (omega_decompose(arena, lhs, &lin, +1) &&
+        (!rhs_expr || omega_decompose(arena, rhs_expr, &lin, -1))) {
+        omega_lin_canonicalize(&lin);
+        int64_t rhs = sat_sub_i64(offset, lin.const_term);
+        /* Pure constant: no FM needed */
+        if (lin.n_terms == 0) proved = rhs < 0;
+        else proved = omega_refutes(ctx, arena, &lin, rhs);
     }
-    return true; /* sat or gave up — conservative */
+    arena_rewind(arena, mark);
+    return proved;
 }
 
 /* ── public entry points ─────────────────────────────────────────────────── */
@@ -306,22 +578,7 @@ fm_overflow:
  */
 static bool omega_prove_nonneg(RangeTable *ctx, Expr *index_expr) {
     if (!ctx || !index_expr) return false;
-
-    OmegaSystem sys;
-    memset(&sys, 0, sizeof(sys));
-
-    OmegaLin lin;
-    memset(&lin, 0, sizeof(lin));
-    if (!omega_decompose(&sys, index_expr, &lin, +1)) return false;
-
-    /* Pure constant */
-    if (sys.n_vars == 0) return lin.const_term >= 0;
-
-    /* Negated assumption: index_expr ≤ -1
-     * i.e. coeff*vars ≤ -1 - const_term  */
-    omega_add_ineq(&sys, lin.coeff, -1 - lin.const_term);
-    omega_extract_vra(&sys, ctx);
-    return !omega_fm_sat(&sys);
+    return omega_refute_diff(ctx, index_expr, NULL, -1);
 }
 
 /*
@@ -333,30 +590,7 @@ static bool omega_prove_nonneg(RangeTable *ctx, Expr *index_expr) {
 static bool omega_prove_le(RangeTable *ctx, Expr *index_expr,
                            Expr *bound_expr) {
     if (!ctx || !index_expr || !bound_expr) return false;
-
-    OmegaSystem sys;
-    memset(&sys, 0, sizeof(sys));
-
-    OmegaLin idx_lin, bnd_lin;
-    memset(&idx_lin, 0, sizeof(idx_lin));
-    memset(&bnd_lin, 0, sizeof(bnd_lin));
-
-    if (!omega_decompose(&sys, index_expr, &idx_lin, +1)) return false;
-    if (!omega_decompose(&sys, bound_expr, &bnd_lin, +1)) return false;
-
-    if (sys.n_vars == 0)
-        return idx_lin.const_term <= bnd_lin.const_term;
-
-    /* Negated query: index > bound  ↔  bound - index <= -1 */
-    {
-        int64_t qc[OMEGA_MAX_VARS];
-        for (int i = 0; i < OMEGA_MAX_VARS; i++)
-            qc[i] = bnd_lin.coeff[i] - idx_lin.coeff[i];
-        omega_add_ineq(&sys, qc, idx_lin.const_term - bnd_lin.const_term - 1);
-    }
-
-    omega_extract_vra(&sys, ctx);
-    return !omega_fm_sat(&sys);
+    return omega_refute_diff(ctx, bound_expr, index_expr, -1);
 }
 
 /*
@@ -368,47 +602,14 @@ static bool omega_prove_le(RangeTable *ctx, Expr *index_expr,
  *
  * Both `index_expr` and `bound_expr` may be type-annotation AST nodes
  * (unresolved decl/type pointers) — only raw identifier names are read.
+ *
+ * The negated query is  index ≥ bound  ↔  bound - index ≤ 0; if it is UNSAT
+ * together with the VRA facts, index < bound QED.
  */
 static bool omega_prove_lt(RangeTable *ctx, Expr *index_expr,
                            Expr *bound_expr) {
     if (!ctx || !index_expr || !bound_expr) return false;
-
-    OmegaSystem sys;
-    memset(&sys, 0, sizeof(sys));
-
-    /* Decompose both sides */
-    OmegaLin idx_lin, bnd_lin;
-    memset(&idx_lin, 0, sizeof(idx_lin));
-    memset(&bnd_lin, 0, sizeof(bnd_lin));
-
-    if (!omega_decompose(&sys, index_expr, &idx_lin, +1)) return false;
-    if (!omega_decompose(&sys, bound_expr, &bnd_lin, +1)) return false;
-
-    /* Pure-constant case: no FM needed */
-    if (sys.n_vars == 0)
-        return idx_lin.const_term < bnd_lin.const_term;
-
-    /*
-     * Add the negated query as an inequality:
-     *   index ≥ bound
-     *   ↔  bound - index ≤ 0
-     *   ↔  (bnd_coeff - idx_coeff)*vars  ≤  idx_const - bnd_const
-     */
-    {
-        int64_t qc[OMEGA_MAX_VARS];
-        for (int i = 0; i < OMEGA_MAX_VARS; i++)
-            qc[i] = bnd_lin.coeff[i] - idx_lin.coeff[i];
-        omega_add_ineq(&sys, qc, idx_lin.const_term - bnd_lin.const_term);
-    }
-
-    /* Pull in VRA constraints for the registered variables */
-    omega_extract_vra(&sys, ctx);
-
-    /*
-     * If the system (negated query + VRA) is UNSAT, the assumption
-     * "index ≥ bound" contradicts the known facts → index < bound QED.
-     */
-    return !omega_fm_sat(&sys);
+    return omega_refute_diff(ctx, bound_expr, index_expr, 0);
 }
 
 #endif /* SEMA_OMEGA_H */
@@ -128,6 +128,7 @@ typedef struct RangeEntry {
     Id *var;
     Range range;
     struct RangeEntry *next;
+    struct RangeEntry *shadowed;    // previous version of `var` (version stack)
 } RangeEntry;
 
 // Constraint: v1 - v2 <= max_diff
@@ -136,22 +137,155 @@ typedef struct ConstraintEntry {
     Id *v2;
     int64_t max_diff;
     struct ConstraintEntry *next;
+    struct ConstraintEntry *shadowed;   // previous constraint on the same (v1, v2)
+    struct ConstraintEntry *prev_from;  // previous constraint out of v1 (adjacency)
+    isize seq;                          // insertion order within the table
+    bool removed;                       // unlinked by constraint_unlink
 } ConstraintEntry;
 
-typedef struct {
+/*
+  The fact lists (`head`, `constraints`) are newest-first and shared: a scope
+  snapshots them by saving the two head pointers (range_snapshot) and drops
+  everything added since with range_restore. Readers that want every fact
+  still walk the lists.
+
+  Lookups go through an index instead: `vars` maps a variable to its newest
+  RangeEntry, whose `shadowed` link is the version it hides; `pairs` and
+  `from` do the same for constraints by (v1, v2) and by v1. Restoring pops
+  exactly the entries added since the snapshot, so it costs what they did to
+  add. Constraints unlinked from the middle of the list are flagged `removed`
+  and skipped when a version chain is walked. A restore cannot reach an
+  unlinked entry through the list, so when one newer than the snapshot was
+  unlinked the index is rebuilt instead: it must not keep pointing at entries
+  the restore released (a function's facts live in the scratch arena).
+*/
+typedef struct RangeTable {
     RangeEntry *head;
     ConstraintEntry *constraints; // New: List of relational constraints
     Arena *arena;
+    AtomMap vars;                 // var → newest RangeEntry
+    AtomMap pairs;                // (v1, v2) → newest ConstraintEntry
+    AtomMap from;                 // v1 → newest ConstraintEntry out of v1
+    isize next_seq;               // seq of the next constraint added
+    isize unlinked_seq;           // newest seq ever unlinked, -1 = none
 } RangeTable;
 
+typedef struct {
+    RangeEntry *head;
+    ConstraintEntry *constraints;
+    isize seq;
+} RangeSnapshot;
+
 static RangeTable *range_table_new(Arena *arena) {
     RangeTable *t = arena_push_aligned(arena, RangeTable);
-    t->head = NULL;
-    t->constraints = NULL;
+    memset(t, 0, sizeof *t);
     t->arena = arena;
+    t->unlinked_seq = -1;
     return t;
 }
 
+// Release the index (the entries themselves live in the arena).
+static void range_table_free(RangeTable *t) {
+    if (!t) return;
+    free(t->vars.slots);
+    free(t->pairs.slots);
+    free(t->from.slots);
+    memset(&t->vars, 0, sizeof t->vars);
+    memset(&t->pairs, 0, sizeof t->pairs);
+    memset(&t->from, 0, sizeof t->from);
+}
+
+static void _range_index_push(RangeTable *t, RangeEntry *e) {
+    e->shadowed = atom_map_get(&t->vars, e->var->atom, NULL);
+    atom_map_put(&t->vars, e->var->atom, NULL, e);
+}
+
+static void _constraint_index_push(RangeTable *t, ConstraintEntry *c) {
+    c->shadowed = atom_map_get(&t->pairs, c->v1->atom, c->v2->atom);
+    atom_map_put(&t->pairs, c->v1->atom, c->v2->atom, c);
+    c->prev_from = atom_map_get(&t->from, c->v1->atom, NULL);
+    atom_map_put(&t->from, c->v1->atom, NULL, c);
+}
+
+// Re-index from the lists (oldest first) when a restore target was not below
+// the current head. Never happens for properly nested snapshots.
+static void _range_index_rebuild(RangeTable *t) {
+    isize n = 0, m = 0;
+    for (RangeEntry *e = t->head; e; e = e->next) n++;
+    for (ConstraintEntry *c = t->constraints; c; c = c->next) m++;
+    void **stack = malloc((size_t)(n > m ? n : m) * sizeof *stack + 1);
+    if (!stack) {
+        sema_diag("Error: out of memory re-indexing range facts\n");
+        sema_fatal();
+    }
+    range_table_free(t);
+    isize i = 0;
+    for (RangeEntry *e = t->head; e; e = e->next) stack[i++] = e;
+    while (i > 0) _range_index_push(t, stack[--i]);
+    for (ConstraintEntry *c = t->constraints; c; c = c->next) stack[i++] = c;
+    while (i > 0) _constraint_index_push(t, stack[--i]);
+    free(stack);
+}
+
+static RangeSnapshot range_snapshot(RangeTable *t) {
+    RangeSnapshot snap = {0};
+    if (t) {
+        snap.head = t->head;
+        snap.constraints = t->constraints;
+        snap.seq = t->next_seq;
+    }
+    return snap;
+}
+
+// Drop the constraints added since `old` was the list head (`seq`: the
+// snapshot's next_seq).
+static void constraint_restore(RangeTable *t, ConstraintEntry *old, isize seq) {
+    if (!t) return;
+    ConstraintEntry *c = t->constraints;
+    for (; c && c != old; c = c->next) {
+        atom_map_put(&t->pairs, c->v1->atom, c->v2->atom, c->shadowed);
+        atom_map_put(&t->from, c->v1->atom, NULL, c->prev_from);
+    }
+    t->constraints = old;
+    // `old` was unlinked while it was the list head: it is live again
+    if (c != old || (old && old->removed) || t->unlinked_seq >= seq) {
+        if (old) old->removed = false;
+        _range_index_rebuild(t);
+    }
+}
+
+// Drop the ranges added since `old` was the list head.
+static void range_restore_head(RangeTable *t, RangeEntry *old) {
+    if (!t) return;
+    RangeEntry *e = t->head;
+    for (; e && e != old; e = e->next) {
+        atom_map_put(&t->vars, e->var->atom, NULL, e->shadowed);
+    }
+    t->head = old;
+    if (e != old) _range_index_rebuild(t);
+}
+
+static void range_restore(RangeTable *t, RangeSnapshot snap) {
+    range_restore_head(t, snap.head);
+    constraint_restore(t, snap.constraints, snap.seq);
+}
+
+// Unlink the constraint `*pp` points at (a stale fact). The entry may still be
+// reachable from an older snapshot head, so it is flagged rather than dropped
+// from the index.
+static void constraint_unlink(RangeTable *t, ConstraintEntry **pp) {
+    ConstraintEntry *c = *pp;
+    *pp = c->next;
+    c->removed = true;
+    if (c->seq > t->unlinked_seq) t->unlinked_seq = c->seq;
+}
+
+// Newest live constraint on (v1, v2) at or below `c`, following `shadowed`.
+static inline ConstraintEntry *_constraint_live(ConstraintEntry *c) {
+    while (c && c->removed) c = c->shadowed;
+    return c;
+}
+
 static void range_set(RangeTable *t, Id *var, Range r) {
     if (!t || !var) return;
     // Always push new entry to support shadowing/scoping
@@ -160,17 +294,18 @@ static void range_set(RangeTable *t, Id *var, Range r) {
     e->range = r;
     e->next = t->head;
     t->head = e;
+    _range_index_push(t, e);
+}
+
+// Newest range entry for the variable spelled `atom` (NULL: none).
+static inline RangeEntry *range_find_atom(RangeTable *t, const char *atom) {
+    return atom_map_get(&t->vars, atom, NULL);
 }
 
 static Range range_get(RangeTable *t, Id *var) {
     if (!t || !var) return range_unknown();
-    for (RangeEntry *e = t->head; e; e = e->next) {
-        if (e->var->length == var->length &&
-            strncmp(e->var->name, var->name, var->length) == 0) {
-            return e->range;
-        }
-    }
-    return range_unknown();
+    RangeEntry *e = range_find_atom(t, var->atom);
+    return e ? e->range : range_unknown();
 }
 
 // B.2 forward declare: derive a Range from a callee's return_constraints
@@ -372,12 +507,8 @@ static Range sema_eval_range(Expr *e, RangeTable *t) {
                 if (klen < (int)sizeof(key)) {
                     memcpy(key, "__len_", 6);
                     memcpy(key + 6, obj->name, obj->length);
-                    for (RangeEntry *re = t->head; re; re = re->next) {
-                        if (re->var->length == klen &&
-                            strncmp(re->var->name, key, klen) == 0) {
-                            return re->range;
-                        }
-                    }
+                    RangeEntry *re = range_find_atom(t, atom_find(key, klen));
+                    if (re) return re->range;
                 }
             }
             // Refined struct field read: `b.v` where field v has an invariant
@@ -454,7 +585,9 @@ static Range sema_range_infer_body(Decl *fn) {
         ret_in_progress_n >= RET_INFER_MAX)
         return range_unknown();
     extern int type_integer_range(Type *ty, long long *lo, long long *hi);
-    RangeTable *t = range_table_new(sema_arena);
+    prof_enter(PASS_VRA);
+    char *scratch_mark = arena_mark(sema_ctx->scratch);
+    RangeTable *t = range_table_new(sema_ctx->scratch);
     for (DeclList *p = fn->as.function_decl.params; p; p = p->next) {
         if (!p->decl || p->decl->kind != DECL_VARIABLE) continue;
         Type *pt = p->decl->as.variable_decl.type;
@@ -466,6 +599,9 @@ static Range sema_range_infer_body(Decl *fn) {
     Range acc = range_unknown(); bool any = false, bail = false;
     ret_collect(fn->as.function_decl.body, t, &acc, &any, &bail);
     ret_in_progress_n--;
+    range_table_free(t);
+    arena_rewind(sema_ctx->scratch, scratch_mark);
+    prof_leave();
     return (any && !bail) ? acc : range_unknown();
 }
 
@@ -519,28 +655,21 @@ static void constraint_add(RangeTable *t, Id *v1, Id *v2, int64_t max_diff) {
     // If we add a looser constraint, it will shadow the tighter one, which is bad.
     // But for IF conditions, we usually refine.
     
-    // Check if we already have a tighter constraint visible
-    for (ConstraintEntry *c = t->constraints; c; c = c->next) {
-        if (c->v1->length == v1->length && strncmp(c->v1->name, v1->name, v1->length) == 0 &&
-            c->v2->length == v2->length && strncmp(c->v2->name, v2->name, v2->length) == 0) {
-            if (c->max_diff <= max_diff) {
-                // Existing constraint is tighter or equal. Don't add looser one.
-                return;
-            }
-            // If existing is looser, we continue to add the new tighter one.
-            // We stop searching because we only care about the first match in `get`.
-            // Wait, `get` finds the first match. If we add a new one at head, `get` sees it.
-            // So we just need to make sure we don't add if the *first* match is already tighter.
-            break; 
-        }
-    }
+    // Check if we already have a tighter constraint visible. `get` uses the
+    // newest match, so only that one matters: if it is tighter or equal, don't
+    // add a looser one; if it is looser, the new tighter one shadows it.
+    ConstraintEntry *newest = _constraint_live(atom_map_get(&t->pairs, v1->atom, v2->atom));
+    if (newest && newest->max_diff <= max_diff) return;
 
     ConstraintEntry *c = arena_push_aligned(t->arena, ConstraintEntry);
     c->v1 = v1;
     c->v2 = v2;
     c->max_diff = max_diff;
+    c->seq = t->next_seq++;
+    c->removed = false;
     c->next = t->constraints;
     t->constraints = c;
+    _constraint_index_push(t, c);
 }
 
 // Get known max difference: v1 - v2 <= ?
@@ -551,24 +680,19 @@ static void constraint_add(RangeTable *t, Id *v1, Id *v2, int64_t max_diff) {
 static int64_t constraint_get_diff(RangeTable *t, Id *v1, Id *v2, bool *found) {
     if (!t || !v1 || !v2) { *found = false; return 0; }
     // Direct check
-    for (ConstraintEntry *c = t->constraints; c; c = c->next) {
-        if (c->v1->length == v1->length && strncmp(c->v1->name, v1->name, v1->length) == 0 &&
-            c->v2->length == v2->length && strncmp(c->v2->name, v2->name, v2->length) == 0) {
-            *found = true;
-            return c->max_diff;
-        }
+    ConstraintEntry *direct = _constraint_live(atom_map_get(&t->pairs, v1->atom, v2->atom));
+    if (direct) {
+        *found = true;
+        return direct->max_diff;
     }
-    // One-step bridge: v1 - MID <= d1, MID - v2 <= d2 → v1 - v2 <= d1+d2
+    // One-step bridge: v1 - MID <= d1, MID - v2 <= d2 → v1 - v2 <= d1+d2,
+    // over every live edge out of v1 and every live (MID, v2) version.
     int64_t best = INT64_MAX;
     bool bridge = false;
-    for (ConstraintEntry *c1 = t->constraints; c1; c1 = c1->next) {
-        if (c1->v1->length != v1->length ||
-            strncmp(c1->v1->name, v1->name, v1->length) != 0) continue;
-        for (ConstraintEntry *c2 = t->constraints; c2; c2 = c2->next) {
-            if (c2->v1->length != c1->v2->length ||
-                strncmp(c2->v1->name, c1->v2->name, c1->v2->length) != 0) continue;
-            if (c2->v2->length != v2->length ||
-                strncmp(c2->v2->name, v2->name, v2->length) != 0) continue;
+    for (ConstraintEntry *c1 = atom_map_get(&t->from, v1->atom, NULL); c1; c1 = c1->prev_from) {
+        if (c1->removed) continue;
+        for (ConstraintEntry *c2 = atom_map_get(&t->pairs, c1->v2->atom, v2->atom); c2; c2 = c2->shadowed) {
+            if (c2->removed) continue;
             int64_t total = sat_add_i64(c1->max_diff, c2->max_diff);
             if (!bridge || total < best) { best = total; bridge = true; }
         }
@@ -598,10 +722,8 @@ static Id *range_member_len_id(RangeTable *t, Expr *member) {
     if (klen >= (int)sizeof(key)) return NULL;
     memcpy(key, "__len_", 6);
     memcpy(key + 6, obj->name, obj->length);
-    for (RangeEntry *re = t->head; re; re = re->next)
-        if (re->var && re->var->length == klen && strncmp(re->var->name, key, klen) == 0)
-            return re->var;
-    return NULL;
+    RangeEntry *re = range_find_atom(t, atom_find(key, klen));
+    return re ? re->var : NULL;
 }
 
 // Canonicalize a pure identifier/member access path (`a`, `l.src`, `x.y.z`) to a
@@ -632,17 +754,16 @@ static int member_path_key(Expr *e, char *buf, int cap) {
 
 // Reuse or arena-create a synthetic Id with the given name, so the constraint
 // side and the bounds side name the same length key (the constraint table
-// compares Ids by name, not pointer).
+// compares Ids by interned name, not Id pointer).
 static Id *member_key_id(RangeTable *t, const char *key, int klen) {
-    for (ConstraintEntry *c = t->constraints; c; c = c->next) {
-        if (c->v1 && (int)c->v1->length == klen && strncmp(c->v1->name, key, (size_t)klen) == 0) return c->v1;
-        if (c->v2 && (int)c->v2->length == klen && strncmp(c->v2->name, key, (size_t)klen) == 0) return c->v2;
+    const char *atom = atom_find(key, klen);
+    for (ConstraintEntry *c = t->constraints; atom && c; c = c->next) {
+        if (c->v1 && c->v1->atom == atom) return c->v1;
+        if (c->v2 && c->v2->atom == atom) return c->v2;
     }
     char *stored = arena_push_many(t->arena, char, klen);
     memcpy(stored, key, (size_t)klen);
-    Id *id = arena_push_aligned(t->arena, Id);
-    id->length = klen; id->name = stored;
-    return id;
+    return id(t->arena, klen, stored);
 }
 
 // Member-path length constraints ("__mk_<path>") are only SOUND while the slice the
@@ -24,7 +24,7 @@
 #endif
 
 #if SEMA_REGION_DEBUG
-#define REGION_DBG(fmt, ...) fprintf(stderr, "[region] " fmt "\n", ##__VA_ARGS__)
+#define REGION_DBG(fmt, ...) sema_diag("[region] " fmt "\n", ##__VA_ARGS__)
 #else
 #define REGION_DBG(fmt, ...) do {} while(0)
 #endif
@@ -33,8 +33,6 @@
 │ Region: represents a lexical scope                                │
 ╚───────────────────────────────────────────────────────────────────*/
 
-static int next_region_id = 0;
-
 typedef struct Region {
     int id;                    // unique identifier
     int depth;                 // nesting depth (0 = function scope)
@@ -44,7 +42,7 @@ typedef struct Region {
 // Create a new region as child of parent
 static Region *region_new(Arena *arena, Region *parent) {
     Region *r = arena_push_aligned(arena, Region);
-    r->id = next_region_id++;
+    r->id = sema_ctx->next_region_id++;
     r->depth = parent ? parent->depth + 1 : 0;
     r->parent = parent;
     REGION_DBG("region_new: id=%d depth=%d parent=%d", 
@@ -108,8 +106,7 @@ static BorrowTable *borrow_table_new(Arena *arena) {
 static BorrowEntry *borrow_find(BorrowTable *t, Id *var) {
     if (!t) return NULL;
     for (BorrowEntry *e = t->head; e; e = e->next) {
-        if (e->var->length == var->length &&
-            strncmp(e->var->name, var->name, var->length) == 0) {
+        if (id_eq(e->var, var)) {
             return e;
         }
     }
@@ -121,7 +118,7 @@ static BorrowEntry *borrow_find(BorrowTable *t, Id *var) {
 // Two non-NULL fields overlap only if they name the same field.
 static bool fields_overlap(Id *f1, Id *f2) {
     if (!f1 || !f2) return true; // whole-var overlaps with any field
-    return f1->length == f2->length && strncmp(f1->name, f2->name, f1->length) == 0;
+    return id_eq(f1, f2);
 }
 
 static bool borrow_check_conflict_field(BorrowTable *t, Id *owner, OwnershipMode mode, Id *field);
@@ -133,9 +130,7 @@ static bool borrow_check_conflict(BorrowTable *t, Id *owner, OwnershipMode mode)
 static bool borrow_check_conflict_field(BorrowTable *t, Id *owner, OwnershipMode mode, Id *field) {
     if (!t) return false;
     for (BorrowEntry *e = t->head; e; e = e->next) {
-        if (e->owner_var && 
-            e->owner_var->length == owner->length &&
-            strncmp(e->owner_var->name, owner->name, owner->length) == 0) {
+        if (e->owner_var && id_eq(e->owner_var, owner)) {
             
             // Phase 7: check field overlap
             if (!fields_overlap(e->borrowed_field, field)) continue; // different fields → no conflict
@@ -146,22 +141,22 @@ static bool borrow_check_conflict_field(BorrowTable *t, Id *owner, OwnershipMode
                     continue; // allow shared read during reservation
                 }
                 if (field && e->borrowed_field) {
-                    fprintf(stderr, "[E004] borrow error: cannot borrow '%.*s.%.*s' because '%.*s.%.*s' is already mutably borrowed\n",
+                    sema_diag("[E004] borrow error: cannot borrow '%.*s.%.*s' because '%.*s.%.*s' is already mutably borrowed\n",
                             (int)owner->length, owner->name, (int)field->length, field->name,
                             (int)owner->length, owner->name, (int)e->borrowed_field->length, e->borrowed_field->name);
                 } else {
-                    fprintf(stderr, "[E004] borrow error: cannot borrow '%.*s' because it is already mutably borrowed\n",
+                    sema_diag("[E004] borrow error: cannot borrow '%.*s' because it is already mutably borrowed\n",
                             (int)owner->length, owner->name);
                 }
                 return true;
             }
             if (mode == MODE_MUTABLE) {
                 if (field && e->borrowed_field) {
-                    fprintf(stderr, "[E004] borrow error: cannot borrow '%.*s.%.*s' as mutable because '%.*s.%.*s' is already borrowed\n",
+                    sema_diag("[E004] borrow error: cannot borrow '%.*s.%.*s' as mutable because '%.*s.%.*s' is already borrowed\n",
                             (int)owner->length, owner->name, (int)field->length, field->name,
                             (int)owner->length, owner->name, (int)e->borrowed_field->length, e->borrowed_field->name);
                 } else {
-                    fprintf(stderr, "[E004] borrow error: cannot borrow '%.*s' as mutable because it is already borrowed\n",
+                    sema_diag("[E004] borrow error: cannot borrow '%.*s' as mutable because it is already borrowed\n",
                             (int)owner->length, owner->name);
                 }
                 return true;
@@ -206,14 +201,14 @@ static void borrow_register(Arena *arena, BorrowTable *t, Id *var, Id *owner,
                            OwnershipMode mode, Region *owner_region, bool is_temporary) {
     // Check for conflicts first
     if (borrow_check_conflict(t, owner, mode)) {
-        exit(1);  // Fatal error on conflict
+        sema_fatal();  // Fatal error on conflict
     }
     
     // Check that borrow doesn't outlive owner
     if (!region_contains(owner_region, t->current_region)) {
-        fprintf(stderr, "[E010] borrow error: reference '%.*s' would outlive its owner\n",
+        sema_diag("[E010] borrow error: reference '%.*s' would outlive its owner\n",
                 (int)var->length, var->name);
-        exit(1);
+        sema_fatal();
     }
     
     // Create entry
@@ -246,8 +241,7 @@ static BorrowEntry *borrow_find_by_binding(BorrowTable *t, Id *binding_id) {
     if (!t || !binding_id) return NULL;
     for (BorrowEntry *e = t->head; e; e = e->next) {
         if (!e->binding_id) continue;
-        if (e->binding_id->length == binding_id->length &&
-            strncmp(e->binding_id->name, binding_id->name, binding_id->length) == 0) {
+        if (id_eq(e->binding_id, binding_id)) {
             return e;
         }
     }
@@ -286,7 +280,7 @@ static void borrow_register_persistent(Arena *arena, BorrowTable *t, Id *binding
     // Skip conflict check for re-borrows: they extend an existing borrow chain
     // (e.g., ref2 = transform(var ref) where ref already borrows data).
     if (!is_reborrow && borrow_check_conflict(t, effective_root, mode)) {
-        exit(1);
+        sema_fatal();
     }
     
     // Create entry — NOT temporary
@@ -318,9 +312,7 @@ static void borrow_release_by_binding(BorrowTable *t, Id *binding_id) {
     if (!t || !binding_id) return;
     BorrowEntry **curr = &t->head;
     while (*curr) {
-        if ((*curr)->binding_id &&
-            (*curr)->binding_id->length == binding_id->length &&
-            strncmp((*curr)->binding_id->name, binding_id->name, binding_id->length) == 0) {
+        if ((*curr)->binding_id && id_eq((*curr)->binding_id, binding_id)) {
             REGION_DBG("borrow_release_by_binding: releasing borrow of '%.*s' held by '%.*s'",
                        (*curr)->owner_var ? (int)(*curr)->owner_var->length : 0,
                        (*curr)->owner_var ? (*curr)->owner_var->name : "<null>",
@@ -350,8 +342,7 @@ static bool borrow_check_owner_access_field(BorrowTable *t, Id *owner, Ownership
     for (BorrowEntry *e = t->head; e; e = e->next) {
         if (!e->owner_var) continue;  // invalidated borrow
         if (!e->binding_id) continue; // only check persistent borrows
-        if (e->owner_var->length != owner->length) continue;
-        if (strncmp(e->owner_var->name, owner->name, owner->length) != 0) continue;
+        if (!id_eq(e->owner_var, owner)) continue;
         
         // Phase 7: check field overlap
         if (!fields_overlap(e->borrowed_field, field)) continue;
@@ -364,7 +355,7 @@ static bool borrow_check_owner_access_field(BorrowTable *t, Id *owner, Ownership
             if (e->phase == BORROW_RESERVED && access_mode == MODE_SHARED) {
                 continue; // two-phase: allow shared reads during reservation
             }
-            fprintf(stderr, "[E004] Error Ln %li, Col %li: cannot access '%.*s' because it is mutably borrowed by '%.*s'.\n",
+            sema_diag("[E004] Error Ln %li, Col %li: cannot access '%.*s' because it is mutably borrowed by '%.*s'.\n",
                     (long)line, (long)col,
                     (int)owner->length, owner->name,
                     (int)e->binding_id->length, e->binding_id->name);
@@ -372,7 +363,7 @@ static bool borrow_check_owner_access_field(BorrowTable *t, Id *owner, Ownership
             return true;
         }
         if (access_mode == MODE_MUTABLE && e->mode == MODE_SHARED) {
-            fprintf(stderr, "[E004] Error Ln %li, Col %li: cannot mutate '%.*s' because it is borrowed by '%.*s'.\n",
+            sema_diag("[E004] Error Ln %li, Col %li: cannot mutate '%.*s' because it is borrowed by '%.*s'.\n",
                     (long)line, (long)col,
                     (int)owner->length, owner->name,
                     (int)e->binding_id->length, e->binding_id->name);
@@ -428,9 +419,7 @@ static void borrow_promote_to_active(BorrowTable *t) {
 // Invalidate all borrows of a specific owner (called when owner is moved)
 static void borrow_invalidate_owner(BorrowTable *t, Id *owner) {
     for (BorrowEntry *e = t->head; e; e = e->next) {
-        if (e->owner_var && 
-            e->owner_var->length == owner->length &&
-            strncmp(e->owner_var->name, owner->name, owner->length) == 0) {
+        if (e->owner_var && id_eq(e->owner_var, owner)) {
             REGION_DBG("borrow_invalidate: '%.*s' invalidated (owner moved)",
                        (int)e->var->length, e->var->name);
             e->owner_var = NULL;  // Mark as invalid
@@ -441,9 +430,7 @@ static void borrow_invalidate_owner(BorrowTable *t, Id *owner) {
 // Check if a variable has active borrows (prevents move while borrowed)
 static bool borrow_is_borrowed(BorrowTable *t, Id *owner) {
     for (BorrowEntry *e = t->head; e; e = e->next) {
-        if (e->owner_var && 
-            e->owner_var->length == owner->length &&
-            strncmp(e->owner_var->name, owner->name, owner->length) == 0) {
+        if (e->owner_var && id_eq(e->owner_var, owner)) {
             return true;
         }
     }
@@ -454,7 +441,7 @@ static bool borrow_is_borrowed(BorrowTable *t, Id *owner) {
 static bool __attribute__((unused)) borrow_check_use_after_move(BorrowTable *t, Id *var) {
     BorrowEntry *e = borrow_find(t, var);
     if (e && e->owner_var == NULL) {
-        fprintf(stderr, "[E001] borrow error: use of reference '%.*s' after owner was moved\n",
+        sema_diag("[E001] borrow error: use of reference '%.*s' after owner was moved\n",
                 (int)var->length, var->name);
         return true;
     }
@@ -480,8 +467,7 @@ static bool borrow_has_transitive_dependent(BorrowTable *t, BorrowEntry *candida
         if (!e->binding_id || e->is_temporary) continue;
         if (!e->root_owner) continue;
         // Same root owner?
-        if (e->root_owner->length == candidate->root_owner->length &&
-            strncmp(e->root_owner->name, candidate->root_owner->name, candidate->root_owner->length) == 0) {
+        if (id_eq(e->root_owner, candidate->root_owner)) {
             // This other borrow shares the same root — check if it's still alive
             bool other_expired = (e->last_use_stmt_idx < 0) ||
                                  (current_stmt_idx >= e->last_use_stmt_idx);
@@ -44,15 +44,8 @@
 #endif
 
 
-extern Type *current_return_type;
-extern Decl *current_function_decl; // New
-extern const char *current_module_path;
-
 // (Q-002 Phase 3 helper removed; int monomorphization rolled back.)
 extern DeclList *sema_decls;
-extern Arena *sema_arena;
-extern RangeTable *sema_ranges;
-extern bool sema_in_unsafe_block;
 
 Type *get_builtin_i32_type(void);
 Type *get_builtin_u8_type(void);
@@ -64,6 +57,8 @@ static bool sema_monomorphize_call(Expr *call);
 // Defined in monomorph.h; resolves generic type-applications `Vec(i32)` in a type.
 static Type *mono_resolve_type_apps(Type *t);
 static void  mono_resolve_signature(Decl *d);
+// Defined in typecheck.h; strips mut/mov/pointer wrappers off a value type.
+static Type *sema_unwrap_type(Type *t);
 void sema_resolve_expr(Expr *e); // forward
 
 /*
@@ -105,9 +100,9 @@ void sema_build_path(Expr *e, char *buf, size_t cap) {
     memcpy(buf + cur, field->name, to_copy);
     buf[cur + to_copy] = '\0';
   } else {
-    fprintf(stderr,
+    sema_diag(
             "sema error: `use` target must be identifier or member-path\n");
-    exit(1);
+    sema_fatal();
   }
 }
 
@@ -119,6 +114,7 @@ void sema_build_scope(DeclList *decls, const char *module_path) {
     sema_clear_globals();
   
     sema_decls = decls; // for struct lookups later
+    decl_index_build();
   
     // Sanitize module path for C names
     char *safe_module_path = strdup(module_path);
@@ -179,9 +175,9 @@ void sema_build_scope(DeclList *decls, const char *module_path) {
         // Phase 3: Purity & Test Refactoring
         // Reject `func main` and enforce `proc main`
         if (d->kind == DECL_FUNCTION && id->length == 4 && strncmp(id->name, "main", 4) == 0) {
-            fprintf(stderr, "[E013] Error Ln %li, Col %li: 'main' must be a procedure ('proc'), not a pure function ('func').\n", d->line, d->col);
+            sema_diag("[E013] Error Ln %li, Col %li: 'main' must be a procedure ('proc'), not a pure function ('func').\n", d->line, d->col);
             diagnostic_show_line(d->line, d->col);
-            exit(1);
+            sema_fatal();
         }
   
         char *rawf = malloc(id->length + 1);
@@ -220,7 +216,7 @@ void sema_build_scope(DeclList *decls, const char *module_path) {
         snprintf(cnames, sclen, "%s_%s", safe_module_path, raws);
         for (char *p = cnames; *p; p++) if (*p == '.') *p = '_';
   
-        Type *sty = type_simple(sema_arena, id);
+        Type *sty = type_simple(sema_ctx->arena, id);
         sema_insert_global(raws, cnames, sty, d, false);
   
         free(raws);
@@ -234,7 +230,7 @@ void sema_build_scope(DeclList *decls, const char *module_path) {
         memcpy(raw, id->name, id->length);
         raw[id->length] = '\0';
         char *cname = strdup(raw);
-        Type *t = type_simple(sema_arena, id);
+        Type *t = type_simple(sema_ctx->arena, id);
         sema_insert_global(raw, cname, t, d, false);
         free(raw);
         free(cname);
@@ -266,11 +262,11 @@ void sema_build_scope(DeclList *decls, const char *module_path) {
           cnamet[sizeof(cnamet) - 1] = '\0';
         }
   
-        Type *ety = type_simple(sema_arena, tid);
+        Type *ety = type_simple(sema_ctx->arena, tid);
         sema_insert_global(rawt, cnamet, ety, d, false);
   
         // 2) Do not register the variants here → they get resolved via
-        // current_return_type later.
+        // sema_ctx->return_type later.
         break;
       }
   
@@ -304,48 +300,38 @@ void sema_build_scope(DeclList *decls, const char *module_path) {
         // If it's a direct type, we get EXPR_TYPE. If it's a function call returning a type,
         // we execute the CTFE engine.
         // NOTE: we need to link in comptime.h, which we will do shortly.
-        const char *old_path = current_module_path;
-        current_module_path = safe_module_path;
+        const char *old_path = sema_ctx->module_path;
+        sema_ctx->module_path = safe_module_path;
         
         sema_resolve_expr(d->as.type_alias_decl.expr);
-        Expr* eval_rhs = comptime_evaluate_expr(sema_arena, d->as.type_alias_decl.expr, NULL);
+        Expr* eval_rhs = comptime_evaluate_expr(sema_ctx->arena, d->as.type_alias_decl.expr, NULL);
         
-        current_module_path = old_path;
+        sema_ctx->module_path = old_path;
         
         if (eval_rhs) {
              if (eval_rhs->kind == EXPR_ANON_STRUCT) {
                   // Register as a struct!
-                  Type *sty = type_simple(sema_arena, id);
+                  Type *sty = type_simple(sema_ctx->arena, id);
                   
-                  Decl* struct_d = arena_push_aligned(sema_arena, Decl);
+                  Decl* struct_d = arena_push_aligned(sema_ctx->arena, Decl);
                   struct_d->kind = DECL_STRUCT;
                   struct_d->as.struct_decl.name = id;
                   struct_d->as.struct_decl.fields = eval_rhs->as.anon_struct_expr.fields;
                   
                   sema_insert_global(raw, cname, sty, struct_d, false);
-                  
-                  DeclList *new_node = decl_list(sema_arena, struct_d);
-                  DeclList *tail = sema_decls;
-                  while (tail && tail->next) tail = tail->next;
-                  if (tail) tail->next = new_node;
-                  else sema_decls = new_node;
+                  sema_decls_append(struct_d);
                   
              } else if (eval_rhs->kind == EXPR_ANON_ENUM) {
                   // Register as an enum!
-                  Type *ety = type_simple(sema_arena, id);
+                  Type *ety = type_simple(sema_ctx->arena, id);
                   
-                  Decl* enum_d = arena_push_aligned(sema_arena, Decl);
+                  Decl* enum_d = arena_push_aligned(sema_ctx->arena, Decl);
                   enum_d->kind = DECL_ENUM;
                   enum_d->as.enum_decl.type_name = id;
                   enum_d->as.enum_decl.variants = eval_rhs->as.anon_enum_expr.variants;
                   
                   sema_insert_global(raw, cname, ety, enum_d, false);
-                  
-                  DeclList *new_node = decl_list(sema_arena, enum_d);
-                  DeclList *tail = sema_decls;
-                  while (tail && tail->next) tail = tail->next;
-                  if (tail) tail->next = new_node;
-                  else sema_decls = new_node;
+                  sema_decls_append(enum_d);
                   
              } else if (eval_rhs->kind == EXPR_TYPE) {
                   // It's just an alias to an existing type (e.g., type MyInt = int)
@@ -354,14 +340,14 @@ void sema_build_scope(DeclList *decls, const char *module_path) {
                   // passes (emit) can inspect the underlying type.
                   d->as.type_alias_decl.expr = eval_rhs;
              } else {
-                  fprintf(stderr, "[E012] Error Ln %li, Col %li: Type alias must evaluate to a type at compile-time (got kind=%d)\n", d->line, d->col, eval_rhs->kind);
+                  sema_diag("[E012] Error Ln %li, Col %li: Type alias must evaluate to a type at compile-time (got kind=%d)\n", d->line, d->col, eval_rhs->kind);
                   diagnostic_show_line(d->line, d->col);
-                  exit(1);
+                  sema_fatal();
              }
         } else {
-             fprintf(stderr, "[E012] Error Ln %li, Col %li: Type alias RHS could not be evaluated\n", d->line, d->col);
+             sema_diag("[E012] Error Ln %li, Col %li: Type alias RHS could not be evaluated\n", d->line, d->col);
              diagnostic_show_line(d->line, d->col);
-             exit(1);
+             sema_fatal();
         }
         break;
       }
@@ -375,6 +361,94 @@ void sema_build_scope(DeclList *decls, const char *module_path) {
     name-resolution logic
 */
 
+// Width and signedness of a `for` range bound, for picking the counter type.
+// `ty` is the bound's own type, NULL for a literal.
+typedef struct {
+    int   bits;
+    bool  sgn;
+    Type *ty;
+} ForBound;
+
+// Width and signedness of an integer type; usize and isize count as 64 bits.
+static void sema_int_width(Type *t, int *bits, bool *sgn) {
+    if (t->int_width_cache > 0) {
+        *bits = t->int_width_cache;
+        *sgn  = t->int_signed_cache;
+    } else {   // usize / isize, or `int` (i32)
+        *sgn  = t->base_type->name[0] != 'u';
+        *bits = t->base_type->length == 3 ? 32 : 64;
+    }
+}
+
+static Type *sema_usize_type(void) {
+    return type_simple(sema_ctx->arena, id(sema_ctx->arena, 5, "usize"));
+}
+
+// `x.len` of an array or slice counts in usize: that is its spec type and the
+// size_t the emitter passes, although expression inference still types `.len`
+// as i32. A literal needs just the bits of its value. `plus_one` asks for room
+// for the value after the bound too (the exclusive end of `a..=b`).
+static bool sema_for_bound(Expr *b, bool plus_one, ForBound *out) {
+    if (!b) return false;
+    if (b->kind == EXPR_LITERAL) {
+        int64_t v = b->as.literal_expr.value;
+        if (plus_one && v < INT64_MAX) v++;
+        out->ty = NULL;
+        out->sgn = v < 0;
+        uint64_t mag = v < 0 ? ~(uint64_t)v : (uint64_t)v;
+        out->bits = out->sgn ? 1 : 0;
+        while (mag) { out->bits++; mag >>= 1; }
+        return true;
+    }
+    Type *t = b->type;
+    if (b->kind == EXPR_MEMBER && b->as.member_expr.member->length == 3
+        && strncmp(b->as.member_expr.member->name, "len", 3) == 0) {
+        Type *target = sema_unwrap_type(b->as.member_expr.target->type);
+        if (target && (target->kind == TYPE_ARRAY || target->kind == TYPE_SLICE))
+            t = sema_usize_type();
+    }
+    if (!is_integer_type(t)) return false;
+    // (type_simple: the plain shared type, whatever the bound's mode.)
+    out->ty = type_simple(sema_ctx->arena, t->base_type);
+    sema_int_width(out->ty, &out->bits, &out->sgn);
+    if (plus_one) out->bits++;
+    return true;
+}
+
+// The counter type of `for v in start..end`: a type that holds every value the
+// counter takes, including the one that ends the loop. A bound of that exact
+// type (say `usize`) lends its name; a range of literals only stays i32.
+static Type *sema_for_counter_type(Expr *start, Expr *end, bool inclusive) {
+    ForBound bs, be;
+    bool has_s = sema_for_bound(start, false, &bs);
+    bool has_e = sema_for_bound(end, inclusive, &be);
+    if ((!has_s || !bs.ty) && (!has_e || !be.ty)) return get_builtin_i32_type();
+    if (!has_s) bs = be;
+    if (!has_e) be = bs;
+
+    int bits; bool sgn;
+    if (bs.sgn == be.sgn) {
+        sgn  = bs.sgn;
+        bits = bs.bits > be.bits ? bs.bits : be.bits;
+    } else {
+        ForBound u = bs.sgn ? be : bs, i = bs.sgn ? bs : be;
+        sgn  = true;
+        bits = i.bits > u.bits ? i.bits : u.bits + 1;
+    }
+    int width = bits <= 8 ? 8 : bits <= 16 ? 16 : bits <= 32 ? 32 : 64;
+
+    Type *named[2] = { be.ty, bs.ty };
+    for (int k = 0; k < 2; k++) {
+        int tw; bool ts;
+        if (!named[k]) continue;
+        sema_int_width(named[k], &tw, &ts);
+        if (tw == width && ts == sgn) return named[k];
+    }
+    char name[4];
+    int len = snprintf(name, sizeof name, "%c%d", sgn ? 'i' : 'u', width);
+    return type_simple(sema_ctx->arena, id(sema_ctx->arena, len, atom_intern(name, len)));
+}
+
 void sema_resolve_stmt(Stmt *s) {
   if (!s)
     return;
@@ -396,8 +470,8 @@ void sema_resolve_stmt(Stmt *s) {
     for (char *p = cname; *p; p++) if (*p == '.') *p = '_';
 
     if (!target->type) {
-      fprintf(stderr, "sema error: use-target `%s` has no type\n", cname);
-      exit(1);
+      sema_diag("sema error: use-target `%s` has no type\n", cname);
+      sema_fatal();
     }
 
     sema_insert_local(raw, cname, target->type, NULL, false);
@@ -429,7 +503,7 @@ void sema_resolve_stmt(Stmt *s) {
     if (rhs) {
       sema_resolve_expr(rhs);
       sema_infer_expr(rhs);
-      if (sema_ranges) {
+      if (sema_ctx->ranges) {
           // Range analysis moved to typecheck phase
       }
       if (!ty) {
@@ -438,7 +512,7 @@ void sema_resolve_stmt(Stmt *s) {
           // Exception: TYPE_POINTER with MODE_MUTABLE is a mutable thin pointer
           // (from `&arr[k]`) — preserve mutability so it emits without const.
           if (ty && ty->mode == MODE_MUTABLE && ty->kind != TYPE_POINTER) {
-              Type *stripped = arena_push_aligned(sema_arena, Type);
+              Type *stripped = arena_push_aligned(sema_ctx->arena, Type);
               *stripped = *ty;
               stripped->mode = MODE_SHARED;
               ty = stripped;
@@ -456,10 +530,10 @@ void sema_resolve_stmt(Stmt *s) {
               isize n = 0;
               for (ExprList *el = rhs->as.array_literal_expr.elements; el; el = el->next) n++;
               if (n != ty->array_len) {
-                  fprintf(stderr, "[E012] Error Ln %li, Col %li: Vec(%ld, ...) needs %ld "
+                  sema_diag("[E012] Error Ln %li, Col %li: Vec(%ld, ...) needs %ld "
                           "lane values, got %ld.\n", s->line, s->col,
                           (long)ty->array_len, (long)ty->array_len, (long)n);
-                  diagnostic_show_line(s->line, s->col); exit(1);
+                  diagnostic_show_line(s->line, s->col); sema_fatal();
               }
               rhs->type = ty;
           }
@@ -474,10 +548,10 @@ void sema_resolve_stmt(Stmt *s) {
     memcpy(raw, id->name, L);
     raw[L] = '\0';
 
-    if (sema_lookup(raw)) {
-        fprintf(stderr, "[E013] Error Ln %li, Col %li: Redeclaration or shadowing of variable '%s' is forbidden\n", s->line, s->col, raw);
+    if (sema_lookup_id(id)) {
+        sema_diag("[E013] Error Ln %li, Col %li: Redeclaration or shadowing of variable '%s' is forbidden\n", s->line, s->col, raw);
         diagnostic_show_line(s->line, s->col);
-        exit(1);
+        sema_fatal();
     }
 
     const char *cname = raw;
@@ -515,7 +589,11 @@ void sema_resolve_stmt(Stmt *s) {
     Type *val_ty = NULL;
 
     if (it->kind == EXPR_RANGE) {
-        val_ty = get_builtin_i32_type();
+        // The counter counts in a type that holds both bounds: `0..a.len`
+        // in usize, `0..n` in n's type, `lo..n` in their join, `0..=n` one
+        // step wider than n so the final increment cannot wrap.
+        val_ty = sema_for_counter_type(it->as.range_expr.start, it->as.range_expr.end,
+                                       it->as.range_expr.inclusive);
     } else {
         assert(iter_ty &&
                (iter_ty->kind == TYPE_ARRAY || iter_ty->kind == TYPE_SLICE));
@@ -533,7 +611,7 @@ void sema_resolve_stmt(Stmt *s) {
       raw_i[li] = '\0';
       sema_insert_local(raw_i, raw_i, idx_ty, NULL, false);
       // Range Analysis: Set range for loop index
-      if (sema_ranges && it->kind == EXPR_RANGE) {
+      if (sema_ctx->ranges && it->kind == EXPR_RANGE) {
           // Range analysis moved to typecheck phase
       }
     }
@@ -548,6 +626,7 @@ void sema_resolve_stmt(Stmt *s) {
       memcpy(raw_c, id_c->name, lc);
       raw_c[lc] = '\0';
       sema_insert_local(raw_c, raw_c, val_ty, NULL, false);
+      s->as.for_stmt.value_type = val_ty;
     }
 
     // recurse into the loop body (block-scoped)
@@ -574,7 +653,7 @@ void sema_resolve_stmt(Stmt *s) {
       memcpy(raw, lhs->as.identifier_expr.id->name, L);
       raw[L] = '\0';
 
-      Symbol *sym = sema_lookup(raw);
+      Symbol *sym = sema_lookup_id(lhs->as.identifier_expr.id);
       if (!sym) {
         // Convert STMT_ASSIGN → STMT_VAR (immutable, type inferred from RHS)
         Id *name = lhs->as.identifier_expr.id;
@@ -595,11 +674,11 @@ void sema_resolve_stmt(Stmt *s) {
                             sym->decl->as.variable_decl.type &&
                             sym->decl->as.variable_decl.type->mode == MODE_MUTABLE;
         if (!is_var_param) {
-          fprintf(stderr, "[E009] Error Ln %li, Col %li: Cannot assign to immutable variable '%s'. "
+          sema_diag("[E009] Error Ln %li, Col %li: Cannot assign to immutable variable '%s'. "
                   "Declare with 'var' for mutable variables.\n",
                   s->line, s->col, raw);
           diagnostic_show_line(s->line, s->col);
-          exit(1);
+          sema_fatal();
         }
       }
     }
@@ -611,19 +690,19 @@ void sema_resolve_stmt(Stmt *s) {
     sema_infer_expr(rhs);
 
     // Range Analysis: Update range
-    if (sema_ranges && lhs->kind == EXPR_IDENTIFIER) {
+    if (sema_ctx->ranges && lhs->kind == EXPR_IDENTIFIER) {
         // Range analysis moved to typecheck phase
     }
 
     // Purity Check: func cannot modify global variable
-    if (current_function_decl && current_function_decl->kind == DECL_FUNCTION) {
+    if (sema_ctx->function_decl && sema_ctx->function_decl->kind == DECL_FUNCTION) {
         if (lhs->is_global && lhs->decl && lhs->decl->kind == DECL_VARIABLE) {
-             fprintf(stderr, "[E011] Error Ln %li, Col %li: Pure function '%.*s' cannot modify global variable\n",
+             sema_diag("[E011] Error Ln %li, Col %li: Pure function '%.*s' cannot modify global variable\n",
                      s->line, s->col,
-                        (int)current_function_decl->as.function_decl.name->length,
-                        current_function_decl->as.function_decl.name->name);
+                        (int)sema_ctx->function_decl->as.function_decl.name->length,
+                        sema_ctx->function_decl->as.function_decl.name->name);
              diagnostic_show_line(s->line, s->col);
-             exit(1);
+             sema_fatal();
         }
     }
     break;
@@ -651,9 +730,9 @@ void sema_resolve_stmt(Stmt *s) {
                 is_param = root->decl->as.variable_decl.is_parameter;
             }
             if (!is_param) {
-                fprintf(stderr, "[E010] Error Ln %li, Col %li: Returning a mutable reference ('var') to a local variable is forbidden (dangling pointer)\n", s->line, s->col);
+                sema_diag("[E010] Error Ln %li, Col %li: Returning a mutable reference ('var') to a local variable is forbidden (dangling pointer)\n", s->line, s->col);
                 diagnostic_show_line(s->line, s->col);
-                exit(1);
+                sema_fatal();
             }
         }
     }
@@ -674,7 +753,7 @@ void sema_resolve_stmt(Stmt *s) {
     // Check exhaustiveness after resolving all cases
     if (!sema_check_match_exhaustive(s)) {
       sema_report_nonexhaustive_match(s);
-      exit(1);
+      sema_fatal();
     }
     break;
   
@@ -683,7 +762,7 @@ void sema_resolve_stmt(Stmt *s) {
     // UNLESS the condition consists entirely of pointer-in-arr guards (p in arr where
     // p has TYPE_POINTER): the walk phase will auto-synthesize the measure from the
     // monotone pointer decrement pattern.
-    if (current_function_decl && current_function_decl->kind == DECL_FUNCTION) {
+    if (sema_ctx->function_decl && sema_ctx->function_decl->kind == DECL_FUNCTION) {
         if (!s->as.while_stmt.measure) {
             // Structural scan: any `expr in expr` in condition → defer to walk phase
             bool has_in_cond = false;
@@ -700,14 +779,14 @@ void sema_resolve_stmt(Stmt *s) {
                 }
             }
             if (!has_in_cond) {
-                fprintf(stderr, "[E011] Error Ln %li, Col %li: 'while' loops without a termination measure "
+                sema_diag("[E011] Error Ln %li, Col %li: 'while' loops without a termination measure "
                         "are not allowed in pure function '%.*s'. "
                         "Add 'decreasing <measure>' or use 'proc'.\n",
                         s->line, s->col,
-                        (int)current_function_decl->as.function_decl.name->length,
-                        current_function_decl->as.function_decl.name->name);
+                        (int)sema_ctx->function_decl->as.function_decl.name->length,
+                        sema_ctx->function_decl->as.function_decl.name->name);
                 diagnostic_show_line(s->line, s->col);
-                exit(1);
+                sema_fatal();
             }
             // has_in_cond: defer — walk phase will auto-infer or emit E011
         }
@@ -726,14 +805,14 @@ void sema_resolve_stmt(Stmt *s) {
   }
 
  case STMT_UNSAFE: {
-    bool old = sema_in_unsafe_block;
-    sema_in_unsafe_block = true;
+    bool old = sema_ctx->in_unsafe_block;
+    sema_ctx->in_unsafe_block = true;
     sema_push_scope();
     for (StmtList *b = s->as.unsafe_stmt.body; b; b = b->next) {
         sema_resolve_stmt(b->stmt);
     }
     sema_pop_scope();
-    sema_in_unsafe_block = old;
+    sema_ctx->in_unsafe_block = old;
     break;
  }
 
@@ -747,15 +826,15 @@ void sema_resolve_stmt(Stmt *s) {
     sema_resolve_expr(cond);
 
     // 2) Evaluate the condition at compile time
-    Expr *eval = comptime_evaluate_expr(sema_arena, cond, NULL);
+    Expr *eval = comptime_evaluate_expr(sema_ctx->arena, cond, NULL);
     bool is_true = false;
     if (eval && eval->kind == EXPR_LITERAL) {
         is_true = eval->as.literal_expr.value != 0;
     } else {
-        fprintf(stderr, "[E014] Error Ln %li, Col %li: comptime if condition must evaluate to a compile-time constant\n",
+        sema_diag("[E014] Error Ln %li, Col %li: comptime if condition must evaluate to a compile-time constant\n",
                 s->line, s->col);
         diagnostic_show_line(s->line, s->col);
-        exit(1);
+        sema_fatal();
     }
 
     // 3) Mark which branch was taken
@@ -798,38 +877,38 @@ void sema_resolve_expr(Expr *e) {
     raw[L] = '\0';
 
     // 2) lookup in the two‐table (locals first, then globals)
-    Symbol *sym = sema_lookup(raw);
+    Symbol *sym = sema_lookup_id(e->as.identifier_expr.id);
     if (sym) {
       // Q-018: enforce [private] cross-module visibility using defining_module
       // tag set by load_module().
-      if (sym->is_global && sym->decl && sym->decl->is_private && current_module_path
+      if (sym->is_global && sym->decl && sym->decl->is_private && sema_ctx->module_path
           && sym->decl->defining_module) {
-        if (strcmp(sym->decl->defining_module, current_module_path) != 0) {
-          fprintf(stderr, "[E084] Error Ln %li, Col %li: cannot access private declaration '%.*s' from module '%s' (defined in '%s')\n",
+        if (strcmp(sym->decl->defining_module, sema_ctx->module_path) != 0) {
+          sema_diag("[E084] Error Ln %li, Col %li: cannot access private declaration '%.*s' from module '%s' (defined in '%s')\n",
                   e->line, e->col,
                   (int)e->as.identifier_expr.id->length, e->as.identifier_expr.id->name,
-                  current_module_path, sym->decl->defining_module);
-          exit(1);
+                  sema_ctx->module_path, sym->decl->defining_module);
+          sema_fatal();
         }
       }
 
       // Glob retirement: a bare name from ANOTHER module is visible only if it was
       // selectively imported (`import M.{name}`) or reached qualified (`M.name`).
       // The whole `import M` grants qualified access, not bare names.
-      if (sym->is_global && sym->decl && current_module_path && sym->decl->defining_module
+      if (sym->is_global && sym->decl && sema_ctx->module_path && sym->decl->defining_module
           && !e->as.identifier_expr.via_qualifier
-          && !module_paths_equal(sym->decl->defining_module, current_module_path)
-          && !sel_import_visible(current_module_path, raw, (size_t)L)) {
+          && !module_paths_equal(sym->decl->defining_module, sema_ctx->module_path)
+          && !sel_import_visible(sema_ctx->module_path, raw, (size_t)L)) {
         const char *seg = strrchr(sym->decl->defining_module, '.');
         seg = seg ? seg + 1 : sym->decl->defining_module;
-        fprintf(stderr, "[E105] Error Ln %li, Col %li: '%.*s' is defined in module '%s' — "
+        sema_diag("[E105] Error Ln %li, Col %li: '%.*s' is defined in module '%s' — "
                 "import it (`import %s.{%.*s}`) or qualify it (`%s.%.*s`).\n",
                 e->line, e->col,
                 (int)e->as.identifier_expr.id->length, e->as.identifier_expr.id->name,
                 sym->decl->defining_module,
                 sym->decl->defining_module, (int)e->as.identifier_expr.id->length, e->as.identifier_expr.id->name,
                 seg, (int)e->as.identifier_expr.id->length, e->as.identifier_expr.id->name);
-        exit(1);
+        sema_fatal();
       }
 
       if (sym->decl && (sym->decl->kind == DECL_STRUCT || sym->decl->kind == DECL_ENUM || sym->decl->kind == DECL_EXTERN_TYPE)) {
@@ -847,13 +926,12 @@ void sema_resolve_expr(Expr *e) {
       const char *mangled = sym->c_name;
       size_t mlen = strlen(mangled);
 
-      // Allocate (mlen+1) bytes in sema_arena and copy there
-      char *copy = arena_push_many_aligned(sema_arena, char, mlen + 1);
+      // Allocate (mlen+1) bytes in sema_ctx->arena and copy there
+      char *copy = arena_push_many_aligned(sema_ctx->arena, char, mlen + 1);
       memcpy(copy, mangled, mlen + 1); // include the '\0'
 
       // Now point the AST’s identifier at the arena‐allocated copy:
-      e->as.identifier_expr.id->name = copy;
-      e->as.identifier_expr.id->length = (isize)mlen;
+      id_set(e->as.identifier_expr.id, (isize)mlen, copy);
       e->type = sym->type;
       e->decl = sym->decl;       // Populate decl
       e->is_global = sym->is_global; // Populate is_global
@@ -881,13 +959,11 @@ void sema_resolve_expr(Expr *e) {
                 bits = bits * 10 + (raw[k] - '0');
             }
             if (all_digits && bits >= 1 && bits <= 64) {
-                Id *type_id = arena_push_aligned(sema_arena, Id);
-                char *nbuf = arena_push_many_aligned(sema_arena, char, rl + 1);
+                char *nbuf = arena_push_many_aligned(sema_ctx->arena, char, rl + 1);
                 memcpy(nbuf, raw, rl + 1);
-                type_id->name = nbuf;
-                type_id->length = (isize)rl;
+                Id *type_id = id(sema_ctx->arena, (isize)rl, nbuf);
                 e->kind = EXPR_TYPE;
-                e->as.type_expr.type_value = type_simple(sema_arena, type_id);
+                e->as.type_expr.type_value = type_simple(sema_ctx->arena, type_id);
                 e->type = NULL;
                 break;
             }
@@ -907,25 +983,24 @@ void sema_resolve_expr(Expr *e) {
         break;
     } else if (strcmp(raw, "f32") == 0 || strcmp(raw, "f64") == 0 || strcmp(raw, "float") == 0 || strcmp(raw, "bool") == 0 || strcmp(raw, "string") == 0) {
         e->kind = EXPR_TYPE;
-        Id *type_id = id(sema_arena, strlen(raw), arena_push_many_aligned(sema_arena, char, strlen(raw) + 1));
+        Id *type_id = id(sema_ctx->arena, strlen(raw), arena_push_many_aligned(sema_ctx->arena, char, strlen(raw) + 1));
         strcpy((char*)type_id->name, raw);
-        e->as.type_expr.type_value = type_simple(sema_arena, type_id);
+        e->as.type_expr.type_value = type_simple(sema_ctx->arena, type_id);
         e->type = NULL;
         break;
     }
 
     // 4) fallback: maybe it’s an enum‐variant …
-    for (DeclList *dl = sema_decls; dl; dl = dl->next) {
-      Decl *D = dl->decl;
-      if (D && D->kind == DECL_ENUM) {
+    {
+      Decl *D = decl_index_variant_enum(e->as.identifier_expr.id);
+      if (D) {
         Id *enum_id = D->as.enum_decl.type_name;
         for (Variant *vl = D->as.enum_decl.variants; vl; vl = vl->next) {
           Id *vid = vl->name;
-          if ((size_t)vid->length == strlen(raw) &&
-              strncmp(vid->name, raw, vid->length) == 0) {
+          if (id_eq(vid, e->as.identifier_expr.id)) {
             // build "<module>_<Enum>_<Variant>"
             static char buf[512];
-             snprintf(buf, sizeof(buf), "%s_%.*s_%.*s", current_module_path,
+             snprintf(buf, sizeof(buf), "%s_%.*s_%.*s", sema_ctx->module_path,
                       (int)enum_id->length, enum_id->name, (int)vid->length,
                       vid->name);
             // Sanitize dots in the generated name
@@ -934,11 +1009,10 @@ void sema_resolve_expr(Expr *e) {
             }
 
             size_t buflen = strlen(buf) + 1;
-            char *copy = arena_push_many_aligned(sema_arena, char, buflen);
+            char *copy = arena_push_many_aligned(sema_ctx->arena, char, buflen);
             memcpy(copy, buf, buflen);
 
-            e->as.identifier_expr.id->name = copy;
-            e->as.identifier_expr.id->length = (isize)strlen(copy);
+            id_set(e->as.identifier_expr.id, (isize)strlen(copy), copy);
             e->type = get_builtin_i32_type();
             e->decl = D; // Enum variant belongs to Enum Decl
             e->is_global = true;
@@ -989,16 +1063,16 @@ void sema_resolve_expr(Expr *e) {
     sema_monomorphize_call(e);   // no-op unless callee is a generic template
 
     // Purity Check: func cannot call proc (checked on the possibly-rewritten callee)
-    if (current_function_decl && current_function_decl->kind == DECL_FUNCTION) {
+    if (sema_ctx->function_decl && sema_ctx->function_decl->kind == DECL_FUNCTION) {
         Expr *callee = e->as.call_expr.callee;
         if (callee->decl) {
             if (callee->decl->kind == DECL_PROCEDURE || callee->decl->kind == DECL_EXTERN_PROCEDURE) {
-                fprintf(stderr, "[E011] Error Ln %li, Col %li: Pure function '%.*s' cannot call procedure\n",
+                sema_diag("[E011] Error Ln %li, Col %li: Pure function '%.*s' cannot call procedure\n",
                         e->line, e->col,
-                        (int)current_function_decl->as.function_decl.name->length,
-                        current_function_decl->as.function_decl.name->name);
+                        (int)sema_ctx->function_decl->as.function_decl.name->length,
+                        sema_ctx->function_decl->as.function_decl.name->name);
                 diagnostic_show_line(e->line, e->col);
-                exit(1);
+                sema_fatal();
             }
         }
     }
@@ -6,8 +6,8 @@
 #include <assert.h>
 
 #include "../ast.h"
-
-extern Arena *sema_arena;
+#include "context.h"
+#include "decl_index.h"
 
 // Helper: strdup using arena (no free needed)
 static char *arena_strdup(Arena *a, const char *s) {
@@ -21,17 +21,20 @@ static char *arena_strdup(Arena *a, const char *s) {
   A two‐table symbol‐scope implementation:
 
    • sema_globals[]: holds every top‐level symbol (enums, structs, functions, globals).
-   • sema_locals[]:  a fresh table for each function; holds that function’s params + var‐decls.
+   • sema_ctx->locals[]: a fresh table for each function; holds that function’s params + var‐decls.
 
-  Lookup always checks sema_locals first, then sema_globals.
+  Lookup always checks the locals first, then sema_globals.
   sema_clear_locals() is called at function‐entry and function‐exit.
   sema_clear_globals() is called once at program startup (or module‐reload).
-*/
 
-#define SEMA_BUCKET_COUNT 4096
+  Every local insert is recorded in an undo log (the symbol, in insertion
+  order), so block scopes and sema_clear_locals() unwind only the symbols that
+  were actually introduced instead of touching all SEMA_BUCKET_COUNT buckets.
+  The locals, the log and the scope marks live in the SemaContext (context.h).
+*/
 
 typedef struct Symbol {
-    char      *name;    // raw identifier, e.g. "lexeme"
+    const char *name;   // interned raw identifier (intern.h atom), e.g. "lexeme"
     char      *c_name;  // mangled C identifier, e.g. "main_match_keyword_lexeme"
     Type      *type;    // AST’s Type* for this symbol (NULL if not yet known)
     Decl      *decl;    // The declaration (NULL for locals defined via STMT_VAR)
@@ -40,65 +43,100 @@ typedef struct Symbol {
     struct Symbol *next;
 } Symbol;
 
-// ── the two tables ───────────────────────────────────────────────────────────
+// ── the global table (locals: sema_ctx->locals) ─────────────────────────────
 static Symbol *sema_globals[SEMA_BUCKET_COUNT];
-static Symbol *sema_locals [SEMA_BUCKET_COUNT];
 
-// ── hash function (unchanged) ───────────────────────────────────────────────
-static unsigned sema_hash(const char *s) {
-    unsigned long h = 5381;
-    while (*s) {
-        h = ((h << 5) + h) + (unsigned char)*s++;
+// ── bucket of an interned name (SEMA_BUCKET_COUNT is a power of two) ─────────
+static inline unsigned sema_bucket(const char *atom) {
+    return atom_hash(atom) & (SEMA_BUCKET_COUNT - 1);
+}
+
+// ── local undo log ──────────────────────────────────────────────────────────
+// Link an already-built local symbol into the current context's table.
+static void sema_push_local_symbol(Symbol *sym) {
+    SemaContext *ctx = sema_ctx;
+    if (ctx->local_log_len == ctx->local_log_cap) {
+        isize cap = ctx->local_log_cap ? ctx->local_log_cap * 2 : 256;
+        Symbol **log = realloc(ctx->local_log, (size_t)cap * sizeof *log);
+        if (!log) {
+            sema_diag("Error: out of memory growing the local symbol table\n");
+            sema_fatal();
+        }
+        ctx->local_log = log;
+        ctx->local_log_cap = cap;
+    }
+    unsigned idx = sema_bucket(sym->name);
+    sym->next = ctx->locals[idx];
+    ctx->locals[idx] = sym;
+    ctx->local_log[ctx->local_log_len++] = sym;
+}
+
+// Remove the most recent locals until only `mark` remain. Inserts push onto
+// the bucket head, so undoing them in reverse order restores every head.
+static void sema_local_log_unwind(isize mark) {
+    SemaContext *ctx = sema_ctx;
+    while (ctx->local_log_len > mark) {
+        Symbol *sym = ctx->local_log[--ctx->local_log_len];
+        ctx->locals[sema_bucket(sym->name)] = sym->next;
     }
-    return (unsigned)(h % SEMA_BUCKET_COUNT);
 }
 
 // ── insert into the global symbol‐table ──────────────────────────────────────
 static void sema_insert_global(const char *raw, const char *cname, Type *ty, Decl *decl, bool is_mutable) {
-    unsigned idx = sema_hash(raw);
-    Symbol *sym = arena_push_aligned(sema_arena, Symbol);
-    sym->name   = arena_strdup(sema_arena, raw);
-    sym->c_name = arena_strdup(sema_arena, cname);
+    Symbol *sym = arena_push_aligned(sema_ctx->arena, Symbol);
+    sym->name   = atom_intern(raw, strlen(raw));
+    sym->c_name = arena_strdup(sema_ctx->arena, cname);
     sym->type   = ty;
     sym->decl   = decl;
     sym->is_global = true;
     sym->is_mutable = is_mutable;
+    decl_index_add_c_name(sym->c_name, decl);
+    unsigned idx = sema_bucket(sym->name);
     sym->next   = sema_globals[idx];
     sema_globals[idx] = sym;
 }
 
 // ── insert into the local symbol‐table ───────────────────────────────────────
 static void sema_insert_local(const char *raw, const char *cname, Type *ty, Decl *decl, bool is_mutable) {
-    unsigned idx = sema_hash(raw);
-    Symbol *sym = arena_push_aligned(sema_arena, Symbol);
-    sym->name   = arena_strdup(sema_arena, raw);
-    sym->c_name = arena_strdup(sema_arena, cname);
+    Symbol *sym = arena_push_aligned(sema_ctx->arena, Symbol);
+    sym->name   = atom_intern(raw, strlen(raw));
+    sym->c_name = arena_strdup(sema_ctx->arena, cname);
     sym->type   = ty;
     sym->decl   = decl; 
     sym->is_global = false;
     sym->is_mutable = is_mutable;
-    sym->next   = sema_locals[idx];
-    sema_locals[idx] = sym;
+    sema_push_local_symbol(sym);
 }
 
-// ── lookup (locals first → globals) ─────────────────────────────────────────
-static Symbol *sema_lookup(const char *raw) {
-    unsigned idx = sema_hash(raw);
+// ── lookup by interned name (locals first → globals) ────────────────────────
+// Names are atoms, so a chain walk is a pointer compare per symbol.
+static Symbol *sema_lookup_atom(const char *atom) {
+    if (!atom) return NULL;
+    unsigned idx = sema_bucket(atom);
     // 1) check locals
-    for (Symbol *sym = sema_locals[idx]; sym; sym = sym->next) {
-        if (strcmp(sym->name, raw) == 0) {
+    for (Symbol *sym = sema_ctx->locals[idx]; sym; sym = sym->next) {
+        if (sym->name == atom) {
             return sym;
         }
     }
     // 2) fallback to globals
     for (Symbol *sym = sema_globals[idx]; sym; sym = sym->next) {
-        if (strcmp(sym->name, raw) == 0) {
+        if (sym->name == atom) {
             return sym;
         }
     }
     return NULL;
 }
 
+// A spelling that was never interned cannot name any symbol.
+static Symbol *sema_lookup(const char *raw) {
+    return sema_lookup_atom(atom_find(raw, strlen(raw)));
+}
+
+static inline Symbol *sema_lookup_id(Id *id) {
+    return sema_lookup_atom(id->atom);
+}
+
 // ── clear out only the global table (call this once at program start) ───────
 static void sema_clear_globals(void) {
     // Arena handles deallocation — just reset bucket pointers
@@ -109,38 +147,33 @@ static void sema_clear_globals(void) {
 
 // ── clear out only the local table (call this at function‐entry/function‐exit) ─
 static void sema_clear_locals(void) {
-    // Arena handles deallocation — just reset bucket pointers
-    for (int i = 0; i < SEMA_BUCKET_COUNT; i++) {
-        sema_locals[i] = NULL;
-    }
+    // Arena handles deallocation — just unwind what was inserted
+    sema_local_log_unwind(0);
 }
 
 // ── block scoping via push/pop ──────────────────────────────────────────────
-// ScopeFrame saves the head pointers of every bucket in sema_locals.
-// When popped, all symbols added since the push are effectively removed.
-
-typedef struct ScopeFrame {
-    Symbol *saved_locals[SEMA_BUCKET_COUNT];
-    struct ScopeFrame *parent;
-} ScopeFrame;
-
-static ScopeFrame *scope_stack = NULL;
+// A scope is a mark into the local undo log. When popped, every symbol added
+// since the push is unlinked again: O(symbols introduced), no per-block copy.
 
 static void sema_push_scope(void) {
-    // F-017: allocate on the sema arena (freed in bulk at end of compilation).
-    // The comment that used to say "allocate on the arena" now matches reality.
-    ScopeFrame *frame = arena_push_aligned(sema_arena, ScopeFrame);
-    memcpy(frame->saved_locals, sema_locals, sizeof(sema_locals));
-    frame->parent = scope_stack;
-    scope_stack = frame;
+    SemaContext *ctx = sema_ctx;
+    if (ctx->scope_depth == ctx->scope_capacity) {
+        isize cap = ctx->scope_capacity ? ctx->scope_capacity * 2 : 64;
+        isize *marks = realloc(ctx->scope_marks, (size_t)cap * sizeof *marks);
+        if (!marks) {
+            sema_diag("Error: out of memory growing the scope stack\n");
+            sema_fatal();
+        }
+        ctx->scope_marks = marks;
+        ctx->scope_capacity = cap;
+    }
+    ctx->scope_marks[ctx->scope_depth++] = ctx->local_log_len;
 }
 
 static void sema_pop_scope(void) {
-    if (!scope_stack) return;
-    ScopeFrame *frame = scope_stack;
-    memcpy(sema_locals, frame->saved_locals, sizeof(sema_locals));
-    scope_stack = frame->parent;
-    // No free: arena owns the memory.
+    SemaContext *ctx = sema_ctx;
+    if (!ctx->scope_depth) return;
+    sema_local_log_unwind(ctx->scope_marks[--ctx->scope_depth]);
 }
 
 #endif // SEMA_SCOPE_H
@@ -8,14 +8,7 @@
 #include "ranges.h" // Range analysis
 #include "bounds.h"  // Static bounds checking
 
-extern Arena *sema_arena;
 extern DeclList *sema_decls;
-extern Type *current_return_type;
-extern Decl *current_function_decl; // Defined in sema.h
-extern RangeTable *sema_ranges;     // Defined in sema.h
-extern bool sema_in_unsafe_block;   // Defined in sema.h
-extern bool sema_walk_phase;        // Defined in sema.h
-extern bool sema_addr_of_context;   // Defined in sema.h — set by EXPR_ADDR to relax &arr[len]
 
 // ...
 
@@ -35,10 +28,7 @@ Type *get_builtin_i32_type(void) {
   // returned Type is concretely i32.
   static Type *int_ty = NULL;
   if (!int_ty) {
-    Id *id = arena_push_aligned(sema_arena, Id);
-    id->name = "i32";
-    id->length = 3;
-    int_ty = type_simple(sema_arena, id);
+    int_ty = type_simple(sema_ctx->arena, id(sema_ctx->arena, 3, "i32"));
   }
   return int_ty;
 }
@@ -47,10 +37,7 @@ Type *get_builtin_u8_type(void) {
   static Type *u8_ty = NULL;
   if (!u8_ty) {
     // make a fake Id for “u8”
-    Id *id = arena_push_aligned(sema_arena, Id);
-    id->name = "u8";
-    id->length = 2;
-    u8_ty = type_simple(sema_arena, id);
+    u8_ty = type_simple(sema_ctx->arena, id(sema_ctx->arena, 2, "u8"));
   }
   return u8_ty;
 }
@@ -103,11 +90,11 @@ static void reject_float_int_mismatch(Type *from, Type *to, isize line, isize co
                                       const char *what, const char *label) {
     if ((is_float_type(from) && is_integer_type(to)) ||
         (is_integer_type(from) && is_float_type(to))) {
-        fprintf(stderr, "[E012] Error Ln %li, Col %li: implicit conversion between "
+        sema_diag("[E012] Error Ln %li, Col %li: implicit conversion between "
             "float and integer in %s '%s' — use an explicit 'as' cast.\n",
             (long)line, (long)col, what, label ? label : "");
         diagnostic_show_line(line, col);
-        exit(1);
+        sema_fatal();
     }
 }
 
@@ -164,7 +151,7 @@ bool check_value_fits_type(Range r, Type *target_type,
 bool check_value_fits_type(Range r, Type *target_type,
                            isize line, isize col,
                            const char *context, const char *target_label) {
-    if (sema_in_unsafe_block) return true;
+    if (sema_ctx->in_unsafe_block) return true;
     if (!r.known) return true;
     // Skip if range is effectively unbounded — VRA may have widened from
     // an unconstrained value, so a range whose extremum sits within a
@@ -183,7 +170,7 @@ bool check_value_fits_type(Range r, Type *target_type,
             type_name = target_type->base_type->name;
             type_len = (int)target_type->base_type->length;
         }
-        fprintf(stderr,
+        sema_diag(
             "[E086] Error Ln %li, Col %li: %s '%s' would overflow target type '%.*s'.\n"
             "       Value range [%lld, %lld] does not fit type range [%lld, %lld].\n"
             "       Options to resolve:\n"
@@ -196,7 +183,7 @@ bool check_value_fits_type(Range r, Type *target_type,
             type_len, type_name,
             (long long)r.min, (long long)r.max, tlo, thi);
         diagnostic_show_line(line, col);
-        exit(1);
+        sema_fatal();
     }
     return true;
 }
@@ -238,7 +225,7 @@ static bool range_proves_int_fit(Range r, Type *to) {
 static void reject_lossy_int_conversion(Type *from, Type *to, Range r,
                                         isize line, isize col,
                                         const char *ctx, const char *label) {
-    if (sema_in_unsafe_block) return;
+    if (sema_ctx->in_unsafe_block) return;
     if (from == to) return;                              // interned identity: same type
     if (!is_integer_type(from) || !is_integer_type(to)) return;
     long long flo, fhi, tlo, thi;
@@ -250,7 +237,7 @@ static void reject_lossy_int_conversion(Type *from, Type *to, Range r,
     int fl = (from->base_type) ? (int)from->base_type->length : 1;
     const char *tn = (to->base_type) ? to->base_type->name : "?";
     int tl = (to->base_type) ? (int)to->base_type->length : 1;
-    fprintf(stderr,
+    sema_diag(
         "[E086] Error Ln %li, Col %li: %s '%s' implicitly converts '%.*s' to '%.*s', "
         "which may lose information.\n"
         "       Source type range [%lld, %lld] does not fit target range [%lld, %lld].\n"
@@ -261,7 +248,7 @@ static void reject_lossy_int_conversion(Type *from, Type *to, Range r,
         (long)line, (long)col, ctx, label ? label : "",
         fl, fn, tl, tn, flo, fhi, tlo, thi, tl, tn);
     diagnostic_show_line(line, col);
-    exit(1);
+    sema_fatal();
 }
 
 // Rank in the implicit widening order (Q-002 extended).
@@ -612,7 +599,7 @@ static bool is_nominal_aggregate(Type *t) {
 static void reject_incompatible_conversion(Type *from, Type *to, Expr *src_expr,
                                            isize line, isize col,
                                            const char *ctx, const char *label) {
-    if (sema_in_unsafe_block) return;
+    if (sema_ctx->in_unsafe_block) return;
     if (!from || !to) return;
     Type *f = from, *t = to;
     while (f && f->kind == TYPE_COMPTIME) f = f->element_type;
@@ -645,12 +632,12 @@ static void reject_incompatible_conversion(Type *from, Type *to, Expr *src_expr,
     char fb[128], tb[128];
     type_describe(f, fb, sizeof fb);
     type_describe(t, tb, sizeof tb);
-    fprintf(stderr,
+    sema_diag(
         "[E012] Error Ln %li, Col %li: %s '%s' has incompatible type: cannot implicitly "
         "convert '%s' to '%s'.\n",
         (long)line, (long)col, ctx, label ? label : "", fb, tb);
     diagnostic_show_line(line, col);
-    exit(1);
+    sema_fatal();
 }
 
 // Return a refinement type alias's constraint list if `t` names one, else NULL.
@@ -678,7 +665,7 @@ static ExprList *alias_constraints_for(Type *t) {
 // var-decl) — previously only the initial var-decl was checked.
 static void check_type_alias_constraints(Type *to, Range r, isize line, isize col,
                                          const char *ctx, const char *label) {
-    if (sema_in_unsafe_block || !r.known) return;
+    if (sema_ctx->in_unsafe_block || !r.known) return;
     if (!to || to->kind != TYPE_SIMPLE || !to->base_type) return;
     if ((size_t)to->base_type->length >= 256) return;
     char tnam[256];
@@ -705,12 +692,12 @@ static void check_type_alias_constraints(Type *to, Range r, isize line, isize co
             default: fits = true; break;
         }
         if (!fits) {
-            fprintf(stderr, "[E086] Error Ln %li, Col %li: %s '%s' violates refinement "
+            sema_diag("[E086] Error Ln %li, Col %li: %s '%s' violates refinement "
                 "constraint of type alias '%s': value range [%lld, %lld] does not satisfy it.\n",
                 (long)line, (long)col, ctx, label ? label : "", tnam,
                 (long long)r.min, (long long)r.max);
             diagnostic_show_line(line, col);
-            exit(1);
+            sema_fatal();
         }
     }
 }
@@ -744,14 +731,13 @@ static Range eval_callsite_size_range(Expr *se, DeclList *params, ExprList *args
         if (!ref_arg) return range_unknown();
         if (ref_arg->type && ref_arg->type->kind == TYPE_ARRAY && ref_arg->type->array_len >= 0)
             return range_const(ref_arg->type->array_len);
-        if (ref_arg->kind == EXPR_IDENTIFIER && sema_ranges) {
+        if (ref_arg->kind == EXPR_IDENTIFIER && sema_ctx->ranges) {
             Id *aid = ref_arg->as.identifier_expr.id;
             char lk[272]; int lklen = 6 + (int)aid->length;
             if (lklen < (int)sizeof(lk)) {
                 memcpy(lk, "__len_", 6); memcpy(lk + 6, aid->name, aid->length);
-                for (RangeEntry *re = sema_ranges->head; re; re = re->next)
-                    if (re->var->length == lklen && strncmp(re->var->name, lk, lklen) == 0)
-                        return re->range;
+                RangeEntry *re = range_find_atom(sema_ctx->ranges, atom_find(lk, lklen));
+                if (re) return re->range;
             }
         }
         return range_unknown();
@@ -781,7 +767,7 @@ static Id *callsite_len_id(Expr *se, DeclList *params, ExprList *args) {
         se->as.member_expr.member->length != 3 ||
         strncmp(se->as.member_expr.member->name, "len", 3) != 0 ||
         !se->as.member_expr.target || se->as.member_expr.target->kind != EXPR_IDENTIFIER ||
-        !sema_ranges)
+        !sema_ctx->ranges)
         return NULL;
     Id *rid = se->as.member_expr.target->as.identifier_expr.id;
     int rpi = 0; Expr *ref_arg = NULL;
@@ -801,10 +787,8 @@ static Id *callsite_len_id(Expr *se, DeclList *params, ExprList *args) {
     char lk[272]; int lklen = 6 + (int)aid->length;
     if (lklen >= (int)sizeof(lk)) return NULL;
     memcpy(lk, "__len_", 6); memcpy(lk + 6, aid->name, aid->length);
-    for (RangeEntry *re = sema_ranges->head; re; re = re->next)
-        if (re->var && re->var->length == lklen && strncmp(re->var->name, lk, lklen) == 0)
-            return re->var;
-    return NULL;
+    RangeEntry *re = range_find_atom(sema_ctx->ranges, atom_find(lk, lklen));
+    return re ? re->var : NULL;
 }
 
 // Fail-CLOSED precondition proof for a relational parameter refinement
@@ -819,7 +803,7 @@ static Id *callsite_len_id(Expr *se, DeclList *params, ExprList *args) {
 //       guards, which all seed the difference constraint).
 static bool callsite_len_precond_proven(Expr *lhs_arg, Expr *rhs_len, TokenKind op,
                                         DeclList *params, ExprList *args) {
-    Range lr   = lhs_arg ? sema_eval_range(lhs_arg, sema_ranges) : range_unknown();
+    Range lr   = lhs_arg ? sema_eval_range(lhs_arg, sema_ctx->ranges) : range_unknown();
     Range lenr = eval_callsite_size_range(rhs_len, params, args);
     if (lr.known && lenr.known) {
         switch (op) {
@@ -830,23 +814,23 @@ static bool callsite_len_precond_proven(Expr *lhs_arg, Expr *rhs_len, TokenKind
             default: break;
         }
     }
-    if (lhs_arg && lhs_arg->kind == EXPR_IDENTIFIER && sema_ranges) {
+    if (lhs_arg && lhs_arg->kind == EXPR_IDENTIFIER && sema_ctx->ranges) {
         Id *argid = lhs_arg->as.identifier_expr.id;
         Id *lenid = callsite_len_id(rhs_len, params, args);
         if (argid && lenid) {
             bool found = false; int64_t diff = 0;
             switch (op) {
                 case TOKEN_ANGLE_BRACKET_LEFT:        // arg < len  ⇐  arg - len <= -1
-                    diff = constraint_get_diff(sema_ranges, argid, lenid, &found);
+                    diff = constraint_get_diff(sema_ctx->ranges, argid, lenid, &found);
                     if (found && diff <= -1) return true; break;
                 case TOKEN_ANGLE_BRACKET_LEFT_EQUAL:  // arg <= len ⇐  arg - len <= 0
-                    diff = constraint_get_diff(sema_ranges, argid, lenid, &found);
+                    diff = constraint_get_diff(sema_ctx->ranges, argid, lenid, &found);
                     if (found && diff <= 0) return true; break;
                 case TOKEN_ANGLE_BRACKET_RIGHT:       // arg > len  ⇐  len - arg <= -1
-                    diff = constraint_get_diff(sema_ranges, lenid, argid, &found);
+                    diff = constraint_get_diff(sema_ctx->ranges, lenid, argid, &found);
                     if (found && diff <= -1) return true; break;
                 case TOKEN_ANGLE_BRACKET_RIGHT_EQUAL: // arg >= len ⇐  len - arg <= 0
-                    diff = constraint_get_diff(sema_ranges, lenid, argid, &found);
+                    diff = constraint_get_diff(sema_ctx->ranges, lenid, argid, &found);
                     if (found && diff <= 0) return true; break;
                 default: break;
             }
@@ -906,15 +890,15 @@ static void check_conversion(Type *from, Type *to, Range r, Expr *src_expr,
         Type *fu = from; while (fu && fu->kind == TYPE_COMPTIME) fu = fu->element_type;
         Type *fpay = union_payload_type(fu);
         if (fpay && !union_payload_type(tu)) {
-            if (sema_in_unsafe_block || sema_is_narrowed(src_expr)) {
+            if (sema_ctx->in_unsafe_block || sema_is_narrowed(src_expr)) {
                 check_conversion(fpay, to, r, src_expr, line, col, ctx, label);
                 return;
             }
             char tb[128]; type_describe(to, tb, sizeof tb);
-            fprintf(stderr, "[E063] Error Ln %li, Col %li: %s value may be a marker; test it "
+            sema_diag("[E063] Error Ln %li, Col %li: %s value may be a marker; test it "
                     "(`if r { … }`) or match it (`case r { … }`) before using it as '%s'.\n",
                     (long)line, (long)col, ctx ? ctx : "this", tb);
-            diagnostic_show_line(line, col); exit(1);
+            diagnostic_show_line(line, col); sema_fatal();
         }
     }
     check_value_fits_type(r, to, line, col, ctx, label);
@@ -932,7 +916,7 @@ static void check_conversion(Type *from, Type *to, Range r, Expr *src_expr,
 // handled separately. `unsafe` bypasses the check.
 static void check_comparison_operands(Type *lt, Type *rt, Expr *le, Expr *re,
                                       const char *op, isize line, isize col) {
-    if (sema_in_unsafe_block) return;
+    if (sema_ctx->in_unsafe_block) return;
     if (!lt || !rt) return;
     Type *l = lt, *r = rt;
     while (l && l->kind == TYPE_COMPTIME) l = l->element_type;
@@ -957,11 +941,11 @@ static void check_comparison_operands(Type *lt, Type *rt, Expr *le, Expr *re,
     char lb[128], rb[128];
     type_describe(l, lb, sizeof lb);
     type_describe(r, rb, sizeof rb);
-    fprintf(stderr,
+    sema_diag(
         "[E012] Error Ln %li, Col %li: incompatible operand types for '%s': '%s' and '%s'.\n",
         (long)line, (long)col, op, lb, rb);
     diagnostic_show_line(line, col);
-    exit(1);
+    sema_fatal();
 }
 
 /*─────────────────────────────────────────────────────────────────╗
@@ -970,18 +954,8 @@ static void check_comparison_operands(Type *lt, Type *rt, Expr *le, Expr *re,
 
 /* lookup a struct Decl node by its name Id */
 static DeclStruct *find_struct_decl(Id *struct_name) {
-  if (!struct_name)
-    return NULL;
-  for (DeclList *dl = sema_decls; dl; dl = dl->next) {
-    Decl *d = dl->decl;
-    if (d && d->kind == DECL_STRUCT &&
-        d->as.struct_decl.name->length == struct_name->length &&
-        strncmp(d->as.struct_decl.name->name, struct_name->name,
-                struct_name->length) == 0) {
-      return &d->as.struct_decl;
-    }
-  }
-  return NULL;
+  Decl *d = decl_index_struct(struct_name);
+  return d ? &d->as.struct_decl : NULL;
 }
 
 // The refinement constraints of struct field `field` on a value of `struct_type`
@@ -1004,16 +978,16 @@ static ExprList *sema_member_field_constraints(Type *struct_type, Id *field) {
 /* lookup a field’s Type* given a struct and field Id */
 static Type *lookup_struct_field_type(Id *struct_name, Id *field) {
   if (!struct_name) {
-    fprintf(stderr, "sema error: internal: lookup_struct_field_type called "
+    sema_diag("sema error: internal: lookup_struct_field_type called "
                     "with NULL struct_name\n");
-    exit(1);
+    sema_fatal();
   }
 
   DeclStruct *sd = find_struct_decl(struct_name);
   if (!sd) {
-    fprintf(stderr, "sema error: unknown struct ‘%.*s’\n",
+    sema_diag("sema error: unknown struct ‘%.*s’\n",
             (int)struct_name->length, struct_name->name);
-    exit(1);
+    sema_fatal();
   }
   for (DeclList *fld = sd->fields; fld; fld = fld->next) {
     Decl *vd = fld->decl;
@@ -1048,18 +1022,8 @@ static Type *sema_unwrap_type(Type *t) {
 
 /* lookup an ADT Decl node by its name Id */
 static DeclEnum *find_adt_decl(Id *adt_name) {
-  if (!adt_name) return NULL;
-  for (DeclList *dl = sema_decls; dl; dl = dl->next) {
-    Decl *d = dl->decl;
-    if (d) {
-        if (d->kind == DECL_ENUM &&
-            d->as.enum_decl.type_name->length == adt_name->length &&
-            strncmp(d->as.enum_decl.type_name->name, adt_name->name, adt_name->length) == 0) {
-          return &d->as.enum_decl;
-        }
-    }
-  }
-  return NULL;
+  Decl *d = decl_index_enum(adt_name);
+  return d ? &d->as.enum_decl : NULL;
 }
 
 /* lookup a variant in an ADT */
@@ -1087,11 +1051,11 @@ static Type *fnptr_type_of_decl(Decl *d) {
     for (DeclList *p = d->as.function_decl.params; p; p = p->next) {
         Type *pt = (p->decl && p->decl->kind == DECL_VARIABLE)
                    ? p->decl->as.variable_decl.type : NULL;
-        TypeList *node = type_list(sema_arena, pt);
+        TypeList *node = type_list(sema_ctx->arena, pt);
         if (!pts) pts = node; else tail->next = node;
         tail = node;
     }
-    return type_func(sema_arena, pts, d->as.function_decl.return_type, is_func);
+    return type_func(sema_ctx->arena, pts, d->as.function_decl.return_type, is_func);
 }
 
 // Is a function-pointer value of type `from` assignable to target `to`?
@@ -1118,15 +1082,15 @@ static void fnptr_assign_check(Type *target, Expr *rhs, isize line, isize col) {
                  ? rhs->type                       // another fn-ptr value
                  : fnptr_type_of_decl(rhs->decl);  // a bare function name
     if (!from) {
-        fprintf(stderr, "[E122] Error Ln %li, Col %li: a function-pointer must be initialised with "
+        sema_diag("[E122] Error Ln %li, Col %li: a function-pointer must be initialised with "
                 "a matching function or function-pointer.\n", (long)line, (long)col);
-        diagnostic_show_line(line, col); exit(1);
+        diagnostic_show_line(line, col); sema_fatal();
     }
     if (!fnptr_types_assignable(target, from)) {
-        fprintf(stderr, "[E122] Error Ln %li, Col %li: function does not match the function-pointer "
+        sema_diag("[E122] Error Ln %li, Col %li: function does not match the function-pointer "
                 "type — arity, parameter/return types, or totality (`func` vs `proc`) differ.\n",
                 (long)line, (long)col);
-        diagnostic_show_line(line, col); exit(1);
+        diagnostic_show_line(line, col); sema_fatal();
     }
 }
 
@@ -1136,15 +1100,15 @@ void sema_infer_expr(Expr *e) {
   switch (e->kind) {
   case EXPR_IDENTIFIER:
     // already set in resolve
-    if (current_function_decl && current_function_decl->kind == DECL_FUNCTION) {
+    if (sema_ctx->function_decl && sema_ctx->function_decl->kind == DECL_FUNCTION) {
         if (e->is_global && e->decl && e->decl->kind == DECL_VARIABLE && e->decl->as.variable_decl.is_mutable) {
-            fprintf(stderr, "[E011] Error Ln %li, Col %li: pure function '%.*s' cannot read "
+            sema_diag("[E011] Error Ln %li, Col %li: pure function '%.*s' cannot read "
                     "mutable global variable '%.*s' (its result would depend on hidden state).\n",
                     (long)e->line, (long)e->col,
-                    (int)current_function_decl->as.function_decl.name->length, current_function_decl->as.function_decl.name->name,
+                    (int)sema_ctx->function_decl->as.function_decl.name->length, sema_ctx->function_decl->as.function_decl.name->name,
                     (int)e->as.identifier_expr.id->length, e->as.identifier_expr.id->name);
             diagnostic_show_line(e->line, e->col);
-            exit(1);
+            sema_fatal();
         }
     }
     break;
@@ -1162,11 +1126,11 @@ void sema_infer_expr(Expr *e) {
             DeclEnum *adt = &e->as.member_expr.target->decl->as.enum_decl;
             Variant *v = lookup_adt_variant(adt, e->as.member_expr.member);
             if (!v) {
-                fprintf(stderr, "sema error Ln %li, Col %li: ADT has no variant '%.*s'\n",
+                sema_diag("sema error Ln %li, Col %li: ADT has no variant '%.*s'\n",
                         e->line, e->col,
                         (int)e->as.member_expr.member->length, e->as.member_expr.member->name);
                 diagnostic_show_line(e->line, e->col);
-                exit(1);
+                sema_fatal();
             }
             // ADT variant evaluates to the ADT instance type
             e->type = e->as.member_expr.target->as.type_expr.type_value;
@@ -1187,12 +1151,12 @@ void sema_infer_expr(Expr *e) {
         const char *tn = tl ? tgt->as.identifier_expr.id->name : "";
         int ml = (int)e->as.member_expr.member->length;
         const char *mn = e->as.member_expr.member->name;
-        fprintf(stderr, "[E102] Error Ln %li, Col %li: cannot access member '%.*s' of "
+        sema_diag("[E102] Error Ln %li, Col %li: cannot access member '%.*s' of "
             "'%.*s' — '%.*s' is not a value. If it is an imported module, imports share "
             "a flat namespace: call '%.*s' directly (unqualified).\n",
             e->line, e->col, ml, mn, tl, tn, tl, tn, ml, mn);
         diagnostic_show_line(e->line, e->col);
-        exit(1);
+        sema_fatal();
     }
 
     // Unwrap wrappers (mut, mov, ptr)
@@ -1209,12 +1173,12 @@ void sema_infer_expr(Expr *e) {
                 return;
             }
         }
-        fprintf(stderr, "sema error Ln %li, Col %li: variant '%.*s' has no field '%.*s'\n",
+        sema_diag("sema error Ln %li, Col %li: variant '%.*s' has no field '%.*s'\n",
                 e->line, e->col,
                 (int)v->name->length, v->name->name,
                 (int)e->as.member_expr.member->length, e->as.member_expr.member->name);
         diagnostic_show_line(e->line, e->col);
-        exit(1);
+        sema_fatal();
     }
     
     // ADT Direct Unsafe Unpacking
@@ -1222,16 +1186,16 @@ void sema_infer_expr(Expr *e) {
     if (t->kind == TYPE_SIMPLE && (adt_decl = find_adt_decl(t->base_type)) != NULL) {
         Variant *v = lookup_adt_variant(adt_decl, e->as.member_expr.member);
         if (v) {
-            if (!sema_in_unsafe_block) {
-                fprintf(stderr, "[E125] Error Ln %li, Col %li: direct ADT field access ('%.*s.%.*s') is only allowed inside an 'unsafe' block — destructure with `case` instead.\n",
+            if (!sema_ctx->in_unsafe_block) {
+                sema_diag("[E125] Error Ln %li, Col %li: direct ADT field access ('%.*s.%.*s') is only allowed inside an 'unsafe' block — destructure with `case` instead.\n",
                         e->line, e->col,
                         (int)t->base_type->length, t->base_type->name,
                         (int)e->as.member_expr.member->length, e->as.member_expr.member->name);
                 diagnostic_show_line(e->line, e->col);
-                exit(1);
+                sema_fatal();
             }
             
-            Type *var_type = arena_push_aligned(sema_arena, Type);
+            Type *var_type = arena_push_aligned(sema_ctx->arena, Type);
             var_type->kind = TYPE_VARIANT;
             var_type->variant = v;
             e->type = var_type;
@@ -1249,7 +1213,7 @@ void sema_infer_expr(Expr *e) {
       }
       if (mem && mem->length == 4 && strncmp(mem->name, "data", 4) == 0) {
         // .data → pointer to element_type
-        e->type = type_pointer(sema_arena, t->element_type);
+        e->type = type_pointer(sema_ctx->arena, t->element_type);
         break;
       }
     }
@@ -1269,10 +1233,10 @@ void sema_infer_expr(Expr *e) {
             // We leave `e->type = NULL`. The parent `EXPR_CALL` will detect this
             // and rewrite the AST to `consume(l)`.
         } else {
-            fprintf(stderr, "sema error: struct '%.*s' has no field '%.*s'\n",
+            sema_diag("sema error: struct '%.*s' has no field '%.*s'\n",
                 (int)t->base_type->length, t->base_type->name, 
                 (int)e->as.member_expr.member->length, e->as.member_expr.member->name);
-            exit(1);
+            sema_fatal();
         }
     }
     break;
@@ -1301,15 +1265,15 @@ void sema_infer_expr(Expr *e) {
           sema_union_coerce(&arg->expr, pt->type);   // `T | markers` construction
           Range r = (arg->expr->kind == EXPR_LITERAL)
                     ? (Range){ arg->expr->as.literal_expr.value, arg->expr->as.literal_expr.value, true }
-                    : (sema_ranges ? sema_eval_range(arg->expr, sema_ranges) : range_unknown());
+                    : (sema_ctx->ranges ? sema_eval_range(arg->expr, sema_ctx->ranges) : range_unknown());
           check_conversion(arg->expr->type, pt->type, r, arg->expr, arg->expr->line, arg->expr->col,
                            "function-pointer argument", "");
           pt = pt->next; arg = arg->next;
         }
         if (pt || arg) {
-          fprintf(stderr, "[E123] Error Ln %li, Col %li: wrong number of arguments in call through "
+          sema_diag("[E123] Error Ln %li, Col %li: wrong number of arguments in call through "
                   "a function pointer.\n", (long)e->line, (long)e->col);
-          diagnostic_show_line(e->line, e->col); exit(1);
+          diagnostic_show_line(e->line, e->col); sema_fatal();
         }
         e->type = fnty->element_type;   // return type (NULL = void)
         break;
@@ -1353,8 +1317,8 @@ void sema_infer_expr(Expr *e) {
                          if (arg->expr->kind == EXPR_LITERAL)
                              r = (Range){ arg->expr->as.literal_expr.value,
                                           arg->expr->as.literal_expr.value, true };
-                         else if (sema_ranges)
-                             r = sema_eval_range(arg->expr, sema_ranges);
+                         else if (sema_ctx->ranges)
+                             r = sema_eval_range(arg->expr, sema_ctx->ranges);
                          else
                              r = range_unknown();
                          char vlbl[64];
@@ -1371,9 +1335,9 @@ void sema_infer_expr(Expr *e) {
                  }
                  
                  if (arg || field) {
-                     fprintf(stderr, "sema error: wrong number of arguments for variant constructor '%.*s'\n",
+                     sema_diag("sema error: wrong number of arguments for variant constructor '%.*s'\n",
                              (int)v->name->length, v->name->name);
-                     exit(1);
+                     sema_fatal();
                  }
                  
                  e->type = e->as.call_expr.callee->type; // The ADT type
@@ -1398,7 +1362,7 @@ void sema_infer_expr(Expr *e) {
         if (sym && sym->decl && (sym->decl->kind == DECL_FUNCTION || sym->decl->kind == DECL_PROCEDURE || sym->decl->kind == DECL_EXTERN_FUNCTION || sym->decl->kind == DECL_EXTERN_PROCEDURE)) {
             // It is a valid function! We convert the AST node to represent a UFCS call.
             // 1. Change the callee to simply be the function identifier
-            Expr *new_callee = arena_push(sema_arena, Expr);
+            Expr *new_callee = arena_push(sema_ctx->arena, Expr);
             new_callee->kind = EXPR_IDENTIFIER;
             new_callee->as.identifier_expr.id = method_name;
             new_callee->line = e->as.call_expr.callee->line;
@@ -1409,7 +1373,7 @@ void sema_infer_expr(Expr *e) {
             // ownership mode (var/mov). Auto-wrapping was previously only
             // applied for MUTABLE, leaving OWNED to fail silently. Now both
             // are handled symmetrically.
-            ExprList *new_arg = arena_push(sema_arena, ExprList);
+            ExprList *new_arg = arena_push(sema_ctx->arena, ExprList);
             DeclList *params = sym->decl->as.function_decl.params;
             OwnershipMode first_mode = MODE_SHARED;
             if (params && params->decl->kind == DECL_VARIABLE &&
@@ -1417,14 +1381,14 @@ void sema_infer_expr(Expr *e) {
                 first_mode = params->decl->as.variable_decl.type->mode;
             }
             if (first_mode == MODE_MUTABLE && target->kind != EXPR_MUT) {
-                Expr *mut_target = arena_push(sema_arena, Expr);
+                Expr *mut_target = arena_push(sema_ctx->arena, Expr);
                 mut_target->kind = EXPR_MUT;
                 mut_target->as.mut_expr.expr = target;
                 mut_target->line = target->line;
                 mut_target->col = target->col;
                 new_arg->expr = mut_target;
             } else if (first_mode == MODE_OWNED && target->kind != EXPR_MOVE) {
-                Expr *mov_target = arena_push(sema_arena, Expr);
+                Expr *mov_target = arena_push(sema_ctx->arena, Expr);
                 mov_target->kind = EXPR_MOVE;
                 mov_target->as.move_expr.expr = target;
                 mov_target->line = target->line;
@@ -1443,10 +1407,10 @@ void sema_infer_expr(Expr *e) {
             // Now proceed with normal call logic
             sema_infer_expr(e->as.call_expr.callee);
         } else {
-            fprintf(stderr, "sema error: struct field or UFCS method '%.*s' not found on type '%.*s'\n",
+            sema_diag("sema error: struct field or UFCS method '%.*s' not found on type '%.*s'\n",
                     (int)method_name->length, method_name->name,
                     (int)target->type->base_type->length, target->type->base_type->name);
-            exit(1);
+            sema_fatal();
         }
     }
     
@@ -1454,20 +1418,20 @@ void sema_infer_expr(Expr *e) {
     sema_resolve_expr(e->as.call_expr.callee);
     
     // Purity check: func cannot call proc
-    if (current_function_decl && current_function_decl->kind == DECL_FUNCTION) {
+    if (sema_ctx->function_decl && sema_ctx->function_decl->kind == DECL_FUNCTION) {
         Expr *callee = e->as.call_expr.callee;
         if (callee->decl) {
             if (callee->decl->kind == DECL_PROCEDURE || callee->decl->kind == DECL_EXTERN_PROCEDURE) {
-                fprintf(stderr, "sema error: pure function '%.*s' cannot call procedure\n",
-                        (int)current_function_decl->as.function_decl.name->length, current_function_decl->as.function_decl.name->name);
-                exit(1);
+                sema_diag("sema error: pure function '%.*s' cannot call procedure\n",
+                        (int)sema_ctx->function_decl->as.function_decl.name->length, sema_ctx->function_decl->as.function_decl.name->name);
+                sema_fatal();
             }
             
             // Termination Analysis: Ban recursion in func
-            if (callee->decl == current_function_decl) {
-                fprintf(stderr, "[E011] Error: recursion is not allowed in pure function '%.*s' (a `func` must be total; recursion cannot guarantee termination).\n",
-                        (int)current_function_decl->as.function_decl.name->length, current_function_decl->as.function_decl.name->name);
-                exit(1);
+            if (callee->decl == sema_ctx->function_decl) {
+                sema_diag("[E011] Error: recursion is not allowed in pure function '%.*s' (a `func` must be total; recursion cannot guarantee termination).\n",
+                        (int)sema_ctx->function_decl->as.function_decl.name->length, sema_ctx->function_decl->as.function_decl.name->name);
+                sema_fatal();
             }
         }
     }
@@ -1485,12 +1449,12 @@ void sema_infer_expr(Expr *e) {
             for (ExprList *a = e->as.call_expr.args; a; a = a->next) n_args++;
             if (n_args != n_params) {
                 Id *fn_name = cd->as.function_decl.name;
-                fprintf(stderr, "[E012] Error Ln %li, Col %li: function '%.*s' expects %d argument(s), got %d.\n",
+                sema_diag("[E012] Error Ln %li, Col %li: function '%.*s' expects %d argument(s), got %d.\n",
                         (long)e->line, (long)e->col,
                         (int)fn_name->length, fn_name->name,
                         n_params, n_args);
                 diagnostic_show_line(e->line, e->col);
-                exit(1);
+                sema_fatal();
             }
         }
     }
@@ -1542,7 +1506,7 @@ void sema_infer_expr(Expr *e) {
                 }
                 
                 (void)arr_type;
-                if (idx_arg && arr_arg && sema_walk_phase) {
+                if (idx_arg && arr_arg && sema_ctx->walk_phase) {
                     // P2/S3 (fail-CLOSED): the `in <arr>` invariant is 0 <= idx <
                     // arr.len. idx >= 0 holds for a usize; prove idx < arr.len at the
                     // CALL site — interval for a fixed array, or difference-constraint
@@ -1552,26 +1516,25 @@ void sema_infer_expr(Expr *e) {
                     // out-of-bounds read inside the callee (ASan-confirmed). Reuses the
                     // same prover as the `i < a.len` refinement. Walk-phase-gated so it
                     // cannot false-positive before VRA is populated.
-                    Range idx_range = sema_eval_range(idx_arg, sema_ranges);
+                    Range idx_range = sema_eval_range(idx_arg, sema_ctx->ranges);
                     if (idx_range.known && idx_range.min < 0) {
-                        fprintf(stderr, "[E085] Error Ln %li, Col %li: index may be negative: range [%ld, %ld].\n",
+                        sema_diag("[E085] Error Ln %li, Col %li: index may be negative: range [%ld, %ld].\n",
                                 (long)idx_arg->line, (long)idx_arg->col,
                                 (long)idx_range.min, (long)idx_range.max);
                         diagnostic_show_line(idx_arg->line, idx_arg->col);
-                        exit(1);
+                        sema_fatal();
                     }
                     // Synthetic `arr_name.len` member for the shared prover.
-                    Id *lm = arena_push_aligned(sema_arena, Id);
-                    lm->name = "len"; lm->length = 3;
-                    Expr *aid = arena_push_aligned(sema_arena, Expr);
+                    Id *lm = id(sema_ctx->arena, 3, "len");
+                    Expr *aid = arena_push_aligned(sema_ctx->arena, Expr);
                     aid->kind = EXPR_IDENTIFIER; aid->as.identifier_expr.id = arr_name;
-                    Expr *lenE = arena_push_aligned(sema_arena, Expr);
+                    Expr *lenE = arena_push_aligned(sema_ctx->arena, Expr);
                     lenE->kind = EXPR_MEMBER;
                     lenE->as.member_expr.target = aid;
                     lenE->as.member_expr.member = lm;
                     if (!callsite_len_precond_proven(idx_arg, lenE,
                                 TOKEN_ANGLE_BRACKET_LEFT, params, e->as.call_expr.args)) {
-                        fprintf(stderr, "[E085] Error Ln %li, Col %li: index argument cannot be proven "
+                        sema_diag("[E085] Error Ln %li, Col %li: index argument cannot be proven "
                             "within the bounds of '%.*s' (the `in %.*s` invariant). Constrain the index "
                             "(a literal, a bounded local, an `if`/loop guard, or a matching parameter "
                             "refinement) so VRA can discharge it.\n",
@@ -1579,7 +1542,7 @@ void sema_infer_expr(Expr *e) {
                             (int)arr_name->length, arr_name->name,
                             (int)arr_name->length, arr_name->name);
                         diagnostic_show_line(idx_arg->line, idx_arg->col);
-                        exit(1);
+                        sema_fatal();
                     }
                 }
             }
@@ -1631,13 +1594,13 @@ void sema_infer_expr(Expr *e) {
                                 // so a fail-closed check there would false-positive; the
                                 // walk phase is the final pass before emit, so an unproven
                                 // precondition there is genuinely unproven.
-                                if (sema_walk_phase &&
+                                if (sema_ctx->walk_phase &&
                                     !callsite_len_precond_proven(lhs_arg, rhs_expr,
                                             c->expr->as.binary_expr.op,
                                             params, e->as.call_expr.args)) {
                                     isize el = lhs_arg ? lhs_arg->line : e->line;
                                     isize ec = lhs_arg ? lhs_arg->col  : e->col;
-                                    fprintf(stderr, "[E012] Error Ln %li, Col %li: Constraint violation. "
+                                    sema_diag("[E012] Error Ln %li, Col %li: Constraint violation. "
                                         "Argument cannot be proven to satisfy the '%s' refinement "
                                         "'%.*s'. Constrain the argument (a literal, a bounded local, "
                                         "an `if`/loop guard, or a matching parameter refinement) so "
@@ -1647,7 +1610,7 @@ void sema_infer_expr(Expr *e) {
                                         (int)rhs_expr->as.member_expr.target->as.identifier_expr.id->length,
                                         rhs_expr->as.member_expr.target->as.identifier_expr.id->name);
                                     diagnostic_show_line(el, ec);
-                                    exit(1);
+                                    sema_fatal();
                                 }
                                 continue;  // handled directly; skip the sema_check_condition path
                             } else {
@@ -1665,14 +1628,14 @@ void sema_infer_expr(Expr *e) {
                             temp.line = lhs_arg ? lhs_arg->line : e->line;
                             temp.col  = lhs_arg ? lhs_arg->col  : e->col;
 
-                            int result = sema_check_condition(&temp, sema_ranges);
+                            int result = sema_check_condition(&temp, sema_ctx->ranges);
                             if (result == 0) {
-                                fprintf(stderr, "[E012] Error Ln %li, Col %li: Constraint violation. Argument does not satisfy '%s' constraint.\n",
+                                sema_diag("[E012] Error Ln %li, Col %li: Constraint violation. Argument does not satisfy '%s' constraint.\n",
                                         (long)temp.line, (long)temp.col,
                                         token_kind_to_str(c->expr->as.binary_expr.op));
                                 diagnostic_show_line(temp.line, temp.col);
-                                exit(1);
-                            } else if (result == -1 && sema_walk_phase &&
+                                sema_fatal();
+                            } else if (result == -1 && sema_ctx->walk_phase &&
                                        !arg_refinement_discharges(lhs_arg,
                                                c->expr->as.binary_expr.op, rhs_arg)) {
                                 // P2/S3 (fail-CLOSED): an UNPROVEN non-`.len` precondition
@@ -1685,7 +1648,7 @@ void sema_infer_expr(Expr *e) {
                                 // still discharge it (arg_refinement_discharges); range
                                 // and difference-constraint proofs are handled by
                                 // sema_check_condition above (result == 1).
-                                fprintf(stderr, "[E012] Error Ln %li, Col %li: Constraint violation. "
+                                sema_diag("[E012] Error Ln %li, Col %li: Constraint violation. "
                                         "Argument cannot be proven to satisfy the '%s' refinement. "
                                         "Constrain the argument (a literal, a bounded local, an "
                                         "`if`/loop guard, or a matching parameter refinement) so VRA "
@@ -1693,7 +1656,7 @@ void sema_infer_expr(Expr *e) {
                                         (long)temp.line, (long)temp.col,
                                         token_kind_to_str(c->expr->as.binary_expr.op));
                                 diagnostic_show_line(temp.line, temp.col);
-                                exit(1);
+                                sema_fatal();
                             }
                         }
                     }
@@ -1704,7 +1667,7 @@ void sema_infer_expr(Expr *e) {
             // Skip integer literals (polymorphic across iN/uN — trusted to fit).
             // Only fire during walk phase: during resolve, VRA hasn't yet
             // built up local variable ranges so we'd hit false positives.
-            if (sema_walk_phase && p->decl->kind == DECL_VARIABLE && sema_ranges) {
+            if (sema_ctx->walk_phase && p->decl->kind == DECL_VARIABLE && sema_ctx->ranges) {
                 Type *ptype = p->decl->as.variable_decl.type;
                 Expr *parg = NULL;
                 int a_idx = 0;
@@ -1727,7 +1690,7 @@ void sema_infer_expr(Expr *e) {
                                        parg->as.literal_expr.value, true }
                             : range_unknown();
                     } else {
-                        r = sema_eval_range(parg, sema_ranges);
+                        r = sema_eval_range(parg, sema_ctx->ranges);
                     }
                     Id *pname = p->decl->as.variable_decl.name;
                     char buf[160];
@@ -1741,7 +1704,7 @@ void sema_infer_expr(Expr *e) {
             }
             // E087: verify sized-slice length constraints at call site.
             // Conservative: only fires when a violation is statically provable.
-            if (sema_walk_phase && sema_ranges && p->decl->kind == DECL_VARIABLE) {
+            if (sema_ctx->walk_phase && sema_ctx->ranges && p->decl->kind == DECL_VARIABLE) {
                 Type *e87_ptype = p->decl->as.variable_decl.type;
                 if (e87_ptype && e87_ptype->kind == TYPE_ARRAY &&
                     e87_ptype->array_len == -1 && e87_ptype->size_expr) {
@@ -1765,11 +1728,8 @@ void sema_infer_expr(Expr *e) {
                             if (lklen < (int)sizeof(lk)) {
                                 memcpy(lk, "__len_", 6);
                                 memcpy(lk + 6, aid->name, aid->length);
-                                for (RangeEntry *re = sema_ranges->head; re; re = re->next) {
-                                    if (re->var->length == lklen &&
-                                        strncmp(re->var->name, lk, lklen) == 0)
-                                    { e87_alen = re->range; break; }
-                                }
+                                RangeEntry *re = range_find_atom(sema_ctx->ranges, atom_find(lk, lklen));
+                                if (re) e87_alen = re->range;
                             }
                         }
                         bool e87_fail = false;
@@ -1838,11 +1798,8 @@ void sema_infer_expr(Expr *e) {
                                         if (rklen < (int)sizeof(rk)) {
                                             memcpy(rk, "__len_", 6);
                                             memcpy(rk + 6, rid->name, rid->length);
-                                            for (RangeEntry *re = sema_ranges->head; re; re = re->next) {
-                                                if (re->var->length == rklen &&
-                                                    strncmp(re->var->name, rk, rklen) == 0)
-                                                { ref_len = re->range; break; }
-                                            }
+                                            RangeEntry *re = range_find_atom(sema_ctx->ranges, atom_find(rk, rklen));
+                                            if (re) ref_len = re->range;
                                         }
                                     }
                                     // Fire only when both sides are concrete point values that differ
@@ -1881,10 +1838,10 @@ void sema_infer_expr(Expr *e) {
                             }
                         }
                         if (e87_fail) {
-                            fprintf(stderr, "[E087] Error Ln %li, Col %li: %s.\n",
+                            sema_diag("[E087] Error Ln %li, Col %li: %s.\n",
                                     (long)e87_parg->line, (long)e87_parg->col, e87_msg);
                             diagnostic_show_line(e87_parg->line, e87_parg->col);
-                            exit(1);
+                            sema_fatal();
                         }
                     }
                 }
@@ -1929,7 +1886,7 @@ void sema_infer_expr(Expr *e) {
                 } else if (field_ty && arg_ty &&
                     !types_compatible(arg_ty, field_ty)) {
                     Id *fname = f->decl->as.variable_decl.name;
-                    fprintf(stderr,
+                    sema_diag(
                             "[E012] Error Ln %li, Col %li: struct '%.*s' field '%.*s' type mismatch at argument %d.\n",
                             (long)e->line, (long)e->col,
                             (int)callee_decl->as.struct_decl.name->length,
@@ -1937,12 +1894,12 @@ void sema_infer_expr(Expr *e) {
                             (int)fname->length, fname->name,
                             field_count + 1);
                     diagnostic_show_line(e->line, e->col);
-                    exit(1);
+                    sema_fatal();
                 }
                 // Q-002 Phase 5: overflow-at-boundary (struct field init).
-                if (sema_walk_phase && sema_ranges && field_ty
+                if (sema_ctx->walk_phase && sema_ctx->ranges && field_ty
                     && a->expr->kind != EXPR_LITERAL) {
-                    Range r = sema_eval_range(a->expr, sema_ranges);
+                    Range r = sema_eval_range(a->expr, sema_ctx->ranges);
                     Id *fname = f->decl->as.variable_decl.name;
                     char buf[160];
                     int n = fname ? (int)fname->length : 0;
@@ -1955,11 +1912,11 @@ void sema_infer_expr(Expr *e) {
                 // G5: enforce field refinement constraints at construction
                 // (`type Config { pct i32 >= 0 and <= 100 }`), so the invariant
                 // holds for every constructed value.
-                if (f->decl->as.variable_decl.constraints && sema_ranges &&
-                    !sema_in_unsafe_block) {
+                if (f->decl->as.variable_decl.constraints && sema_ctx->ranges &&
+                    !sema_ctx->in_unsafe_block) {
                     Range r = (a->expr->kind == EXPR_LITERAL)
                         ? (Range){ a->expr->as.literal_expr.value, a->expr->as.literal_expr.value, true }
-                        : sema_eval_range(a->expr, sema_ranges);
+                        : sema_eval_range(a->expr, sema_ctx->ranges);
                     if (r.known) {
                         for (ExprList *c = f->decl->as.variable_decl.constraints; c; c = c->next) {
                             if (!c->expr || c->expr->kind != EXPR_BINARY) continue;
@@ -1978,7 +1935,7 @@ void sema_infer_expr(Expr *e) {
                             }
                             if (!fits) {
                                 Id *fnm = f->decl->as.variable_decl.name;
-                                fprintf(stderr, "[E086] Error Ln %li, Col %li: struct '%.*s' field '%.*s' "
+                                sema_diag("[E086] Error Ln %li, Col %li: struct '%.*s' field '%.*s' "
                                     "value range [%lld, %lld] violates its refinement constraint.\n",
                                     (long)e->line, (long)e->col,
                                     (int)callee_decl->as.struct_decl.name->length,
@@ -1986,7 +1943,7 @@ void sema_infer_expr(Expr *e) {
                                     (int)(fnm ? fnm->length : 0), fnm ? fnm->name : "",
                                     (long long)r.min, (long long)r.max);
                                 diagnostic_show_line(e->line, e->col);
-                                exit(1);
+                                sema_fatal();
                             }
                         }
                     }
@@ -2002,19 +1959,19 @@ void sema_infer_expr(Expr *e) {
         while (a) { arg_count++; a = a->next; }
         
         if (arg_count < field_count) {
-            fprintf(stderr, "[E012] Error Ln %li, Col %li: Partial initialization of struct '%.*s'. Expected %d arguments, got %d.\n",
+            sema_diag("[E012] Error Ln %li, Col %li: Partial initialization of struct '%.*s'. Expected %d arguments, got %d.\n",
                     e->line, e->col,
                     (int)callee_decl->as.struct_decl.name->length, callee_decl->as.struct_decl.name->name,
                     field_count, arg_count);
             diagnostic_show_line(e->line, e->col);
-            exit(1);
+            sema_fatal();
         } else if (arg_count > field_count) {
-            fprintf(stderr, "[E012] Error Ln %li, Col %li: Too many arguments for struct '%.*s'. Expected %d, got %d.\n",
+            sema_diag("[E012] Error Ln %li, Col %li: Too many arguments for struct '%.*s'. Expected %d, got %d.\n",
                     e->line, e->col,
                     (int)callee_decl->as.struct_decl.name->length, callee_decl->as.struct_decl.name->name,
                     field_count, arg_count);
             diagnostic_show_line(e->line, e->col);
-            exit(1);
+            sema_fatal();
         }
     }
     // function-call expression type is the callee's type (return type)
@@ -2038,7 +1995,7 @@ void sema_infer_expr(Expr *e) {
     // For 'and' chains: if LHS is/contains 'in', push in-guard before evaluating RHS
     // This allows: while l.pos in l.src and l.src[l.pos] != '"'
     if (e->as.binary_expr.op == TOKEN_KEYWORD_AND) {
-        InGuardEntry *old_guards = sema_in_guards;
+        InGuardEntry *old_guards = sema_ctx->in_guards;
         sema_push_in_guards(e->as.binary_expr.left);
         // Within-`&&` flow: also apply the LHS's relational constraints (e.g. the
         // `j < n` in `j < n and src[j]`) before proving the RHS. Short-circuit &&
@@ -2047,21 +2004,17 @@ void sema_infer_expr(Expr *e) {
         // needed. SCOPED: the constraints/ranges the LHS adds are restored right
         // after, so they never leak past this condition (soundness — a stale
         // `j < n` outside the `&&` must not keep proving anything).
-        ConstraintEntry *old_cons = sema_ranges ? sema_ranges->constraints : NULL;
-        RangeEntry      *old_head = sema_ranges ? sema_ranges->head        : NULL;
+        RangeSnapshot old_facts = range_snapshot(sema_ctx->ranges);
         // Enable member-path length keys ONLY here: they're created for the LHS
         // (`i < l.src.len`), used to prove the RHS read (`l.src[i]`), then dropped
         // with the constraint-list restore below — so a struct-field slice length
         // can never persist past this read and go stale (sound by construction).
         bool old_mk = sema_mk_scoped; sema_mk_scoped = true;
-        if (sema_ranges) sema_apply_constraint(e->as.binary_expr.left, sema_ranges);
+        if (sema_ctx->ranges) sema_apply_constraint(e->as.binary_expr.left, sema_ctx->ranges);
         sema_infer_expr(e->as.binary_expr.right);
         sema_mk_scoped = old_mk;
-        if (sema_ranges) {
-            sema_ranges->constraints = old_cons;
-            sema_ranges->head        = old_head;
-        }
-        sema_in_guards = old_guards;
+        range_restore(sema_ctx->ranges, old_facts);
+        sema_ctx->in_guards = old_guards;
     } else {
         sema_infer_expr(e->as.binary_expr.right);
     }
@@ -2089,8 +2042,8 @@ void sema_infer_expr(Expr *e) {
             rt && rt->kind == TYPE_POINTER &&
             op == TOKEN_MINUS) {
             // Build usize type
-            Id *usize_id = id(sema_arena, 5, "usize");
-            e->type = type_simple(sema_arena, usize_id);
+            Id *usize_id = id(sema_ctx->arena, 5, "usize");
+            e->type = type_simple(sema_ctx->arena, usize_id);
             break;
         }
         // SIMD: an elementwise op on vectors yields a vector of the same shape (a
@@ -2115,15 +2068,15 @@ void sema_infer_expr(Expr *e) {
         if (dop == TOKEN_SLASH || dop == TOKEN_PERCENT) {
             Expr *rhs = e->as.binary_expr.right;
             bool is_zero = rhs && rhs->kind == EXPR_LITERAL && rhs->as.literal_expr.value == 0;
-            if (!is_zero && sema_ranges && rhs) {
-                Range dr = sema_eval_range(rhs, sema_ranges);
+            if (!is_zero && sema_ctx->ranges && rhs) {
+                Range dr = sema_eval_range(rhs, sema_ctx->ranges);
                 if (dr.known && dr.min == 0 && dr.max == 0) is_zero = true;
             }
             if (is_zero) {
-                fprintf(stderr, "[E015] Error Ln %li, Col %li: division or modulo by zero.\n",
+                sema_diag("[E015] Error Ln %li, Col %li: division or modulo by zero.\n",
                         (long)e->line, (long)e->col);
                 diagnostic_show_line(e->line, e->col);
-                exit(1);
+                sema_fatal();
             }
         }
     }
@@ -2140,11 +2093,11 @@ void sema_infer_expr(Expr *e) {
                 parse_iN_uN(lhs->type, &bits, &sgn)) {
                 long long n = rhs->as.literal_expr.value;
                 if (n < 0 || n >= bits) {
-                    fprintf(stderr, "[E086] Error Ln %li, Col %li: shift amount %lld is out of "
+                    sema_diag("[E086] Error Ln %li, Col %li: shift amount %lld is out of "
                         "range for a %d-bit operand (valid range 0..%d).\n",
                         (long)e->line, (long)e->col, n, bits, bits - 1);
                     diagnostic_show_line(e->line, e->col);
-                    exit(1);
+                    sema_fatal();
                 }
             }
         }
@@ -2152,10 +2105,10 @@ void sema_infer_expr(Expr *e) {
 
     // Division/modulo by zero check in pure func (must be total).
     // Parameter constraints (e.g., `b int != 0`) guarantee safety.
-    if (current_function_decl && current_function_decl->kind == DECL_FUNCTION) {
+    if (sema_ctx->function_decl && sema_ctx->function_decl->kind == DECL_FUNCTION) {
         TokenKind op = e->as.binary_expr.op;
         if (op == TOKEN_SLASH || op == TOKEN_PERCENT) {
-            Range rhs_range = sema_eval_range(e->as.binary_expr.right, sema_ranges);
+            Range rhs_range = sema_eval_range(e->as.binary_expr.right, sema_ctx->ranges);
             
             // Check if divisor is provably non-zero
             bool proven_nonzero = false;
@@ -2183,21 +2136,21 @@ void sema_infer_expr(Expr *e) {
             
             if (!proven_nonzero) {
                 if (!rhs_range.known) {
-                    fprintf(stderr, "[E015] Error Ln %li, Col %li: potential division by zero in pure function '%.*s'. "
+                    sema_diag("[E015] Error Ln %li, Col %li: potential division by zero in pure function '%.*s'. "
                             "The divisor's range is unknown. Use a constraint (e.g., `b int != 0`) to prove safety.\n",
                             (long)e->line, (long)e->col,
-                            (int)current_function_decl->as.function_decl.name->length,
-                            current_function_decl->as.function_decl.name->name);
+                            (int)sema_ctx->function_decl->as.function_decl.name->length,
+                            sema_ctx->function_decl->as.function_decl.name->name);
                 } else {
-                    fprintf(stderr, "[E015] Error Ln %li, Col %li: potential division by zero in pure function '%.*s'. "
+                    sema_diag("[E015] Error Ln %li, Col %li: potential division by zero in pure function '%.*s'. "
                             "Divisor range [%ld, %ld] includes zero. Use a constraint (e.g., `b int != 0`) to prove safety.\n",
                             (long)e->line, (long)e->col,
-                            (int)current_function_decl->as.function_decl.name->length,
-                            current_function_decl->as.function_decl.name->name,
+                            (int)sema_ctx->function_decl->as.function_decl.name->length,
+                            sema_ctx->function_decl->as.function_decl.name->name,
                             (long)rhs_range.min, (long)rhs_range.max);
                 }
                 diagnostic_show_line(e->line, e->col);
-                exit(1);
+                sema_fatal();
             }
         }
     }
@@ -2215,12 +2168,12 @@ void sema_infer_expr(Expr *e) {
                 lbuf[ll] = '\0';
                 Symbol *lsym = sema_lookup(lbuf);
                 if (lsym && lsym->decl && (lsym->decl->kind == DECL_STRUCT || lsym->decl->kind == DECL_ENUM)) {
-                    fprintf(stderr, "[E012] Error Ln %li, Col %li: cannot use '%s' on struct/enum type '%s'. "
+                    sema_diag("[E012] Error Ln %li, Col %li: cannot use '%s' on struct/enum type '%s'. "
                             "Implement an 'equals' method and use it instead.\n",
                             (long)e->line, (long)e->col,
                             op == TOKEN_EQUAL_EQUAL ? "==" : "!=", lbuf);
                     diagnostic_show_line(e->line, e->col);
-                    exit(1);
+                    sema_fatal();
                 }
             }
         }
@@ -2250,12 +2203,12 @@ void sema_infer_expr(Expr *e) {
                 if (!str_lit_cmp) {
                     const char *what = (is_nominal_aggregate(alt) || is_nominal_aggregate(art))
                                        ? "struct/enum" : "array/slice";
-                    fprintf(stderr, "[E012] Error Ln %li, Col %li: operator '%s' is not "
+                    sema_diag("[E012] Error Ln %li, Col %li: operator '%s' is not "
                         "defined on %s types%s. Implement a method instead.\n",
                         (long)e->line, (long)e->col, token_kind_to_str(bop), what,
                         eqop ? " (compare a slice against a string literal, or write a helper)" : "");
                     diagnostic_show_line(e->line, e->col);
-                    exit(1);
+                    sema_fatal();
                 }
             }
         }
@@ -2298,11 +2251,11 @@ void sema_infer_expr(Expr *e) {
                     if (int_side && int_side->kind == EXPR_LITERAL) {
                         e->type = l_flt ? lt : rt;
                     } else {
-                        fprintf(stderr, "[E012] Error Ln %li, Col %li: mixed float/integer "
+                        sema_diag("[E012] Error Ln %li, Col %li: mixed float/integer "
                             "arithmetic requires an explicit 'as' cast.\n",
                             (long)e->line, (long)e->col);
                         diagnostic_show_line(e->line, e->col);
-                        exit(1);
+                        sema_fatal();
                     }
                 } else if (l_flt || r_flt) {
                     e->type = l_flt ? lt : rt;
@@ -2321,7 +2274,7 @@ void sema_infer_expr(Expr *e) {
     {
         TokenKind aop2 = e->as.binary_expr.op;
         if ((aop2 == TOKEN_PLUS || aop2 == TOKEN_MINUS || aop2 == TOKEN_ASTERISK) &&
-            sema_walk_phase && sema_ranges && !sema_in_unsafe_block &&
+            sema_ctx->walk_phase && sema_ctx->ranges && !sema_ctx->in_unsafe_block &&
             e->type && is_integer_type(e->type)) {
             // C integer promotion: operands narrower than int (i8/i16/u8/u16) are
             // promoted to int for the operation. So the op is computed in `int`,
@@ -2334,7 +2287,7 @@ void sema_infer_expr(Expr *e) {
             int abits; bool asgn;
             bool narrow = parse_iN_uN(e->type, &abits, &asgn) && abits < 32;
             Type *check_ty = narrow ? get_builtin_i32_type() : e->type;
-            Range rr = sema_eval_range(e, sema_ranges);
+            Range rr = sema_eval_range(e, sema_ctx->ranges);
             // Some parsed sub-expressions (notably arithmetic inside if/while
             // conditions) carry no line info; borrow the left operand's so the
             // diagnostic points somewhere useful instead of "Ln 0".
@@ -2349,8 +2302,8 @@ void sema_infer_expr(Expr *e) {
             // 128-bit and check it directly. (i32*i32 is already caught by the
             // i64 range, so this only adds the wide/unsigned cases.)
             if (aop2 == TOKEN_ASTERISK) {
-                Range lrg = sema_eval_range(e->as.binary_expr.left, sema_ranges);
-                Range rrg = sema_eval_range(e->as.binary_expr.right, sema_ranges);
+                Range lrg = sema_eval_range(e->as.binary_expr.left, sema_ctx->ranges);
+                Range rrg = sema_eval_range(e->as.binary_expr.right, sema_ctx->ranges);
                 long long tlo, thi;
                 if (lrg.known && rrg.known && type_integer_range(check_ty, &tlo, &thi)) {
                     __int128 c1 = (__int128)lrg.min * (__int128)rrg.min;
@@ -2365,12 +2318,12 @@ void sema_infer_expr(Expr *e) {
                     if (c4 < pmin) pmin = c4;
                     if (c4 > pmax) pmax = c4;
                     if (pmin < (__int128)tlo || pmax > (__int128)thi) {
-                        fprintf(stderr, "[E086] Error Ln %li, Col %li: multiplication would "
+                        sema_diag("[E086] Error Ln %li, Col %li: multiplication would "
                             "overflow target type — the product range exceeds the type's range. "
                             "Use a wrapping (*%%) or saturating (*|) operator, widen the type, or "
                             "constrain the operands.\n", dl, dc);
                         diagnostic_show_line(dl, dc);
-                        exit(1);
+                        sema_fatal();
                     }
                 }
             }
@@ -2389,8 +2342,8 @@ void sema_infer_expr(Expr *e) {
              // e->type = get_builtin_i32_type(); // fallback
              // return;
              // Actually let's exit to be consistent with previous panic
-             fprintf(stderr, "sema error: internal: deref operand untyped\n");
-             exit(1);
+             sema_diag("sema error: internal: deref operand untyped\n");
+             sema_fatal();
         }
         
         Type *t = e->as.unary_expr.right->type;
@@ -2400,9 +2353,9 @@ void sema_infer_expr(Expr *e) {
         
         if (t->kind == TYPE_POINTER) {
             e->type = t->element_type;
-            if (!sema_in_unsafe_block) {
-                fprintf(stderr, "sema error: Dereference of raw pointer outside 'unsafe' block.\n");
-                exit(1);
+            if (!sema_ctx->in_unsafe_block) {
+                sema_diag("sema error: Dereference of raw pointer outside 'unsafe' block.\n");
+                sema_fatal();
             }
         } else {
              // Non-pointer deref??
@@ -2418,12 +2371,12 @@ void sema_infer_expr(Expr *e) {
         // integer type. (The common abs idiom uses the binary form `0 - x`,
         // which the EXPR_BINARY check above already covers.)
         if (e->as.unary_expr.op == TOKEN_MINUS &&
-            sema_walk_phase && sema_ranges && !sema_in_unsafe_block) {
+            sema_ctx->walk_phase && sema_ctx->ranges && !sema_ctx->in_unsafe_block) {
             Type *ot = e->as.unary_expr.right ? e->as.unary_expr.right->type : NULL;
             int nbits; bool nsgn;
             bool narrow = ot && parse_iN_uN(ot, &nbits, &nsgn) && nbits < 32;
             if (ot && is_integer_type(ot) && !narrow) {
-                Range rr = sema_eval_range(e, sema_ranges);
+                Range rr = sema_eval_range(e, sema_ctx->ranges);
                 long dl = e->line > 0 ? e->line
                           : (e->as.unary_expr.right ? (long)e->as.unary_expr.right->line : e->line);
                 long dc = e->line > 0 ? e->col
@@ -2442,7 +2395,7 @@ void sema_infer_expr(Expr *e) {
     Type *elem = get_builtin_u8_type();
 
     // carve out the slice-type in the arena
-    Type *slice_ty = arena_push_aligned(sema_arena, Type);
+    Type *slice_ty = arena_push_aligned(sema_ctx->arena, Type);
     slice_ty->kind = TYPE_SLICE;
     slice_ty->mode = MODE_SHARED;  // string literals are shared by default
     slice_ty->element_type = elem;
@@ -2459,9 +2412,9 @@ void sema_infer_expr(Expr *e) {
   case EXPR_ARRAY_LITERAL: {
     ExprList *elems = e->as.array_literal_expr.elements;
     if (!elems) {
-        fprintf(stderr, "sema error Ln %li, Col %li: empty array literal\n", e->line, e->col);
+        sema_diag("sema error Ln %li, Col %li: empty array literal\n", e->line, e->col);
         diagnostic_show_line(e->line, e->col);
-        exit(1);
+        sema_fatal();
     }
     Type *elem_type = NULL;
     isize count = 0;
@@ -2472,7 +2425,7 @@ void sema_infer_expr(Expr *e) {
         }
         count++;
     }
-    e->type = type_array(sema_arena, elem_type, count);
+    e->type = type_array(sema_ctx->arena, elem_type, count);
     break;
   }
 
@@ -2483,21 +2436,21 @@ void sema_infer_expr(Expr *e) {
     sema_infer_expr(body);
     sema_infer_expr(range);
     if (!range || range->kind != EXPR_RANGE) {
-        fprintf(stderr, "sema error Ln %li, Col %li: array comprehension requires a range `start..end`\n", e->line, e->col);
-        diagnostic_show_line(e->line, e->col); exit(1);
+        sema_diag("sema error Ln %li, Col %li: array comprehension requires a range `start..end`\n", e->line, e->col);
+        diagnostic_show_line(e->line, e->col); sema_fatal();
     }
     Expr *lo = range->as.range_expr.start, *hi = range->as.range_expr.end;
     if (!lo || lo->kind != EXPR_LITERAL || !hi || hi->kind != EXPR_LITERAL) {
-        fprintf(stderr, "sema error Ln %li, Col %li: array comprehension range bounds must be integer literals\n", e->line, e->col);
-        diagnostic_show_line(e->line, e->col); exit(1);
+        sema_diag("sema error Ln %li, Col %li: array comprehension range bounds must be integer literals\n", e->line, e->col);
+        diagnostic_show_line(e->line, e->col); sema_fatal();
     }
     isize n = (isize)hi->as.literal_expr.value - (isize)lo->as.literal_expr.value;
     if (range->as.range_expr.inclusive) n += 1;
     if (n <= 0) {
-        fprintf(stderr, "sema error Ln %li, Col %li: array comprehension length must be positive\n", e->line, e->col);
-        diagnostic_show_line(e->line, e->col); exit(1);
+        sema_diag("sema error Ln %li, Col %li: array comprehension length must be positive\n", e->line, e->col);
+        diagnostic_show_line(e->line, e->col); sema_fatal();
     }
-    e->type = type_array(sema_arena, body->type, n);
+    e->type = type_array(sema_ctx->arena, body->type, n);
     break;
   }
 
@@ -2513,10 +2466,7 @@ void sema_infer_expr(Expr *e) {
     // Float literals infer to f64
     static Type *f64_ty = NULL;
     if (!f64_ty) {
-      Id *id = arena_push_aligned(sema_arena, Id);
-      id->name = "f64";
-      id->length = 3;
-      f64_ty = type_simple(sema_arena, id);
+      f64_ty = type_simple(sema_ctx->arena, id(sema_ctx->arena, 3, "f64"));
     }
     e->type = f64_ty;
     break;
@@ -2532,8 +2482,8 @@ void sema_infer_expr(Expr *e) {
     sema_infer_expr(e->as.index_expr.target);
     // Capture and clear the addr-of flag before inferring the index sub-expression
     // so that nested array accesses within the index are NOT treated as addr-of.
-    bool _is_addr_of = sema_addr_of_context;
-    sema_addr_of_context = false;
+    bool _is_addr_of = sema_ctx->addr_of_context;
+    sema_ctx->addr_of_context = false;
     sema_infer_expr(e->as.index_expr.index);
 
     Type *t = sema_unwrap_type(e->as.index_expr.target->type);
@@ -2548,32 +2498,34 @@ void sema_infer_expr(Expr *e) {
             // subsequent accesses can be VRA-proven without unsafe.
             Expr *rs = e->as.index_expr.index->as.range_expr.start;
             Expr *re = e->as.index_expr.index->as.range_expr.end;
-            Expr *len_expr = expr_binary(sema_arena, TOKEN_MINUS, re, rs);
-            e->type = type_sized_array(sema_arena, t->element_type, len_expr, TOKEN_EQUAL_EQUAL);
-            if (!sema_in_unsafe_block &&
+            Expr *len_expr = expr_binary(sema_ctx->arena, TOKEN_MINUS, re, rs);
+            e->type = type_sized_array(sema_ctx->arena, t->element_type, len_expr, TOKEN_EQUAL_EQUAL);
+            if (!sema_ctx->in_unsafe_block &&
                 rs && re &&
                 rs->kind == EXPR_LITERAL && re->kind == EXPR_LITERAL) {
                 long long sv = (long long)rs->as.literal_expr.value;
                 long long ev = (long long)re->as.literal_expr.value;
                 if (sv > ev) {
-                    fprintf(stderr,
+                    sema_diag(
                         "[E087] Error Ln %li, Col %li: sub-slice start (%lld) is "
                         "greater than end (%lld). Range must satisfy start <= end.\n",
                         (long)e->line, (long)e->col, sv, ev);
                     diagnostic_show_line(e->line, e->col);
-                    exit(1);
+                    sema_fatal();
                 }
             }
         } else {
             e->type = t->element_type;
         }
         // STATIC BOUNDS CHECK (only during walk phase, skipped in unsafe/in-guarded)
-        if (sema_ranges && sema_walk_phase && !sema_in_unsafe_block) {
+        if (sema_ctx->ranges && sema_ctx->walk_phase && !sema_ctx->in_unsafe_block) {
             bool guarded = sema_is_in_guarded(e->as.index_expr.index, e->as.index_expr.target);
             if (guarded) {
                 /* bounds proven by 'in' guard — skip check */
             } else {
-                sema_check_bounds(sema_ranges, e->as.index_expr.index, t, e->as.index_expr.target, _is_addr_of);
+                prof_enter(PASS_VRA);
+                sema_check_bounds(sema_ctx->ranges, e->as.index_expr.index, t, e->as.index_expr.target, _is_addr_of);
+                prof_leave();
             }
         }
     } else if (t->kind == TYPE_VECTOR) {
@@ -2582,14 +2534,14 @@ void sema_infer_expr(Expr *e) {
         // C, so reject it at compile time.
         e->type = t->element_type;
         Expr *ix = e->as.index_expr.index;
-        if (!sema_in_unsafe_block && ix && ix->kind == EXPR_LITERAL) {
+        if (!sema_ctx->in_unsafe_block && ix && ix->kind == EXPR_LITERAL) {
             long long li = (long long)ix->as.literal_expr.value;
             if (li < 0 || li >= t->array_len) {
-                fprintf(stderr, "[E085] bounds error Ln %li, Col %li: vector lane %lld is out of "
+                sema_diag("[E085] bounds error Ln %li, Col %li: vector lane %lld is out of "
                         "range for Vec(%ld, ...).\n",
                         (long)e->line, (long)e->col, li, (long)t->array_len);
                 diagnostic_show_line(e->line, e->col);
-                exit(1);
+                sema_fatal();
             }
         }
     } else if (t->kind == TYPE_POINTER) {
@@ -2598,8 +2550,8 @@ void sema_infer_expr(Expr *e) {
         // But we have no bounds info.
         e->type = t->element_type;
     } else {
-        fprintf(stderr, "sema error: indexing non-array/slice type\n");
-        // exit(1); // Optional: be strict
+        sema_diag("sema error: indexing non-array/slice type\n");
+        // sema_fatal(); // Optional: be strict
     }
     break;
   }
@@ -2622,9 +2574,9 @@ void sema_infer_expr(Expr *e) {
     }
     
     if (!sema_check_expr_match_exhaustive(e)) {
-        fprintf(stderr, "[E014] Error Ln %li, Col %li: non-exhaustive match expression\n", e->line, e->col);
+        sema_diag("[E014] Error Ln %li, Col %li: non-exhaustive match expression\n", e->line, e->col);
         diagnostic_show_line(e->line, e->col);
-        exit(1);
+        sema_fatal();
     }
     
     // If inferred type is a fixed-length string literal type (TYPE_SLICE with
@@ -2634,7 +2586,7 @@ void sema_infer_expr(Expr *e) {
         !inferred_type->sentinel_is_string &&
         inferred_type->sentinel_str == NULL &&
         inferred_type->sentinel_len > 0) {
-        Type *slice_ty = arena_push_aligned(sema_arena, Type);
+        Type *slice_ty = arena_push_aligned(sema_ctx->arena, Type);
         slice_ty->kind       = TYPE_SLICE;
         slice_ty->mode       = MODE_SHARED;
         slice_ty->element_type = inferred_type->element_type;
@@ -2651,16 +2603,16 @@ void sema_infer_expr(Expr *e) {
   case EXPR_MOVE:
     sema_infer_expr(e->as.move_expr.expr);
     if (!e->as.move_expr.expr->type) {
-        fprintf(stderr, "[E012] Error Ln %li, Col %li: `mov` expects an owned value, but its operand "
+        sema_diag("[E012] Error Ln %li, Col %li: `mov` expects an owned value, but its operand "
                 "has no value type.\n", (long)e->line, (long)e->col);
-        diagnostic_show_line(e->line, e->col); exit(1);
+        diagnostic_show_line(e->line, e->col); sema_fatal();
     }
-    e->type = type_move(sema_arena, e->as.move_expr.expr->type);
+    e->type = type_move(sema_ctx->arena, e->as.move_expr.expr->type);
     break;
 
   case EXPR_MUT:
     sema_infer_expr(e->as.mut_expr.expr);
-    e->type = type_mut(sema_arena, e->as.mut_expr.expr->type);
+    e->type = type_mut(sema_ctx->arena, e->as.mut_expr.expr->type);
     break;
 
   case EXPR_CAST: {
@@ -2673,11 +2625,11 @@ void sema_infer_expr(Expr *e) {
     while (tgt_u && tgt_u->kind == TYPE_COMPTIME) tgt_u = tgt_u->element_type;
     bool src_is_ptr = src_u && src_u->kind == TYPE_POINTER;
     bool tgt_is_ptr = tgt_u && tgt_u->kind == TYPE_POINTER;
-    if ((src_is_ptr || tgt_is_ptr) && !sema_in_unsafe_block) {
-        fprintf(stderr, "[E012] Error Ln %li, Col %li: cast involving a raw pointer requires an 'unsafe' block.\n",
+    if ((src_is_ptr || tgt_is_ptr) && !sema_ctx->in_unsafe_block) {
+        sema_diag("[E012] Error Ln %li, Col %li: cast involving a raw pointer requires an 'unsafe' block.\n",
                 (long)e->line, (long)e->col);
         diagnostic_show_line(e->line, e->col);
-        exit(1);
+        sema_fatal();
     }
     // Reject incompatible `as` casts between an aggregate (struct/enum/array/
     // slice) and a scalar, or between distinct aggregates — they emit broken C
@@ -2692,11 +2644,11 @@ void sema_infer_expr(Expr *e) {
             char sb[128], tb[128];
             type_describe(src_r, sb, sizeof sb);
             type_describe(tgt_r, tb, sizeof tb);
-            fprintf(stderr, "[E012] Error Ln %li, Col %li: cannot cast '%s' to '%s' with 'as' — "
+            sema_diag("[E012] Error Ln %li, Col %li: cannot cast '%s' to '%s' with 'as' — "
                 "'as' converts between numeric types only.\n",
                 (long)e->line, (long)e->col, sb, tb);
             diagnostic_show_line(e->line, e->col);
-            exit(1);
+            sema_fatal();
         }
     }
     // type already set at parse time (target_type)
@@ -2707,13 +2659,13 @@ void sema_infer_expr(Expr *e) {
     // &arr[k] — address of an element.
     // Type: TYPE_POINTER(elem_type).
     // Mutability: if arr is mutable (var), the pointer is writable (no const).
-    bool _prev_addr_of = sema_addr_of_context;
-    sema_addr_of_context = true;
+    bool _prev_addr_of = sema_ctx->addr_of_context;
+    sema_ctx->addr_of_context = true;
     sema_infer_expr(e->as.addr_expr.expr);
-    sema_addr_of_context = _prev_addr_of;
+    sema_ctx->addr_of_context = _prev_addr_of;
     Type *inner = e->as.addr_expr.expr ? e->as.addr_expr.expr->type : NULL;
     if (inner) {
-        e->type = type_pointer(sema_arena, inner);
+        e->type = type_pointer(sema_ctx->arena, inner);
         // Propagate mutability from the indexed array.
         Expr *addr_inner = e->as.addr_expr.expr;
         if (addr_inner->kind == EXPR_INDEX && addr_inner->as.index_expr.target) {
@@ -2738,11 +2690,11 @@ void sema_infer_expr(Expr *e) {
     }
     // Safety check only during walk phase (when in-guards are active).
     // During resolve phase, in-guards aren't pushed yet — skip the check.
-    if (sema_walk_phase && !sema_in_unsafe_block) {
+    if (sema_ctx->walk_phase && !sema_ctx->in_unsafe_block) {
         bool guarded = false;
         Expr *deref_ptr = e->as.deref_expr.expr;
         // Forward in-guard: `p in arr` or `p in arr` pointer guard
-        for (InGuardEntry *ig = sema_in_guards; ig && !guarded; ig = ig->next) {
+        for (InGuardEntry *ig = sema_ctx->in_guards; ig && !guarded; ig = ig->next) {
             if (ig->is_ptr_guard && !ig->is_backward_guard &&
                 expr_struct_equal(ig->index, deref_ptr))
                 guarded = true;
@@ -2756,19 +2708,19 @@ void sema_infer_expr(Expr *e) {
             bool offset_pos = (offset && offset->kind == EXPR_LITERAL &&
                                offset->as.literal_expr.value >= 1);
             if (offset_pos) {
-                for (InGuardEntry *ig = sema_in_guards; ig && !guarded; ig = ig->next) {
+                for (InGuardEntry *ig = sema_ctx->in_guards; ig && !guarded; ig = ig->next) {
                     if (ig->is_backward_guard && expr_struct_equal(ig->index, base))
                         guarded = true;
                 }
             }
         }
         if (!guarded) {
-            fprintf(stderr,
+            sema_diag(
                 "[E060] Error Ln %li, Col %li: pointer dereference outside 'unsafe' block. "
                 "Use 'unsafe { }' or declare the pointer with 'var p *T in arr' and guard with 'p in arr'.\n",
                 e->line, e->col);
             diagnostic_show_line(e->line, e->col);
-            exit(1);
+            sema_fatal();
         }
     }
     break;
@@ -2791,9 +2743,7 @@ void sema_infer_expr(Expr *e) {
         // yield a u32 (a bit count, or a lane bitmask).
         static Type *u32_ty = NULL;
         if (!u32_ty) {
-            Id *uid = arena_push_aligned(sema_arena, Id);
-            uid->name = "u32"; uid->length = 3;
-            u32_ty = type_simple(sema_arena, uid);
+            u32_ty = type_simple(sema_ctx->arena, id(sema_ctx->arena, 3, "u32"));
         }
         e->type = u32_ty;
     } else if (bk == BUILTIN_LOAD || bk == BUILTIN_SPLAT || bk == BUILTIN_STORE ||
@@ -2814,7 +2764,7 @@ void sema_infer_expr(Expr *e) {
         // byte offset IS the element index, so the existing bounds machinery
         // proves it directly (never invent a proof): off ∈ [0,len) and
         // off+L-1 ∈ [0,len)  ⟹  [off, off+L) ⊆ [0,len). Unproven ⟹ hard [VRA].
-        if (bk == BUILTIN_LOAD && sema_ranges && sema_walk_phase && !sema_in_unsafe_block) {
+        if (bk == BUILTIN_LOAD && sema_ctx->ranges && sema_ctx->walk_phase && !sema_ctx->in_unsafe_block) {
             Type *bt = e->as.builtin_expr.arg ? sema_unwrap_type(e->as.builtin_expr.arg->type) : NULL;
             Type *vt = e->as.builtin_expr.vec_type;
             bool u8_buf = bt && bt->kind == TYPE_ARRAY &&
@@ -2824,8 +2774,8 @@ void sema_infer_expr(Expr *e) {
             if (u8_buf && vt && vt->kind == TYPE_VECTOR && e->as.builtin_expr.arg2) {
                 long L = (long)vt->array_len;
                 Expr *off  = e->as.builtin_expr.arg2;
-                Expr *last = expr_binary(sema_arena, TOKEN_PLUS, off,
-                                         expr_literal(sema_arena, L - 1));
+                Expr *last = expr_binary(sema_ctx->arena, TOKEN_PLUS, off,
+                                         expr_literal(sema_ctx->arena, L - 1));
                 // P2b: a wide load is ALSO proven if its LAST byte is in-guarded —
                 // `(off + L-1) in buf`. For an UNSIGNED offset (off >= 0 by type),
                 // the last-byte guard plus contiguity proves the whole [off, off+L)
@@ -2839,8 +2789,10 @@ void sema_infer_expr(Expr *e) {
                 if (off_unsigned && sema_is_in_guarded(last, e->as.builtin_expr.arg)) {
                     /* proven via the last-byte in-guard — no check, no error */
                 } else {
-                    sema_check_bounds(sema_ranges, off,  bt, e->as.builtin_expr.arg, false);
-                    sema_check_bounds(sema_ranges, last, bt, e->as.builtin_expr.arg, false);
+                    prof_enter(PASS_VRA);
+                    sema_check_bounds(sema_ctx->ranges, off,  bt, e->as.builtin_expr.arg, false);
+                    sema_check_bounds(sema_ctx->ranges, last, bt, e->as.builtin_expr.arg, false);
+                    prof_leave();
                 }
             }
         }
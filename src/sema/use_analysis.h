@@ -24,7 +24,7 @@
 #endif
 
 #if SEMA_USE_ANALYSIS_DEBUG
-#define USE_DBG(fmt, ...) fprintf(stderr, "[use_analysis] " fmt "\n", ##__VA_ARGS__)
+#define USE_DBG(fmt, ...) sema_diag("[use_analysis] " fmt "\n", ##__VA_ARGS__)
 #else
 #define USE_DBG(fmt, ...) do {} while(0)
 #endif
@@ -54,8 +54,7 @@ static UseTable *use_table_new(Arena *arena) {
 static UseInfo *use_table_find(UseTable *t, Id *id) {
     if (!t || !id) return NULL;
     for (UseInfo *u = t->head; u; u = u->next) {
-        if (u->id->length == id->length &&
-            strncmp(u->id->name, id->name, id->length) == 0) {
+        if (id_eq(u->id, id)) {
             return u;
         }
     }
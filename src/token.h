@@ -101,56 +101,82 @@ typedef struct {
     isize       length;
 } Token;
 
-TokenKind token_match_keyword(const char* lexeme, isize len) {
-    switch (len) {
-        case 2:
-            if (strncmp(lexeme, "if", 2) == 0)          return TOKEN_KEYWORD_IF;
-            if (strncmp(lexeme, "in", 2) == 0)          return TOKEN_KEYWORD_IN;
-            if (strncmp(lexeme, "as", 2) == 0)          return TOKEN_KEYWORD_AS;
-            if (strncmp(lexeme, "or", 2) == 0)          return TOKEN_KEYWORD_OR;
-            break;
-        case 3:
-            if (strncmp(lexeme, "for", 3) == 0)         return TOKEN_KEYWORD_FOR;
-            if (strncmp(lexeme, "var", 3) == 0)         return TOKEN_KEYWORD_VAR;
-            if (strncmp(lexeme, "mov", 3) == 0)         return TOKEN_KEYWORD_MOV;
+/*──────────────────────────────────────────────────────────────────╗
+│ KEYWORDS                                                          │
+╚──────────────────────────────────────────────────────────────────*/
 
-            if (strncmp(lexeme, "use", 3) == 0)         return TOKEN_KEYWORD_USE;
-            if (strncmp(lexeme, "and", 3) == 0)         return TOKEN_KEYWORD_AND;
-            if (strncmp(lexeme, "nil", 3) == 0)         return TOKEN_KEYWORD_NIL;
-            break;
-        case 4:
-            if (strncmp(lexeme, "type", 4) == 0)        return TOKEN_KEYWORD_TYPE;
-            if (strncmp(lexeme, "func", 4) == 0)        return TOKEN_KEYWORD_FUNC;
-            if (strncmp(lexeme, "proc", 4) == 0)        return TOKEN_KEYWORD_PROC;
-            if (strncmp(lexeme, "else", 4) == 0)        return TOKEN_KEYWORD_ELSE;
-            if (strncmp(lexeme, "case", 4) == 0)        return TOKEN_KEYWORD_CASE;
-            if (strncmp(lexeme, "true", 4) == 0)        return TOKEN_KEYWORD_TRUE;
-            break;
-        case 5:
-            if (strncmp(lexeme, "break", 5) == 0)       return TOKEN_KEYWORD_BREAK;
-            if (strncmp(lexeme, "false", 5) == 0)       return TOKEN_KEYWORD_FALSE;
-            if (strncmp(lexeme, "while", 5) == 0)       return TOKEN_KEYWORD_WHILE;
-            if (strncmp(lexeme, "defer", 5) == 0)       return TOKEN_KEYWORD_DEFER;
-            break;
-        case 6:
-            if (strncmp(lexeme, "import", 6) == 0)      return TOKEN_KEYWORD_IMPORT;
-            if (strncmp(lexeme, "extern", 6) == 0)      return TOKEN_KEYWORD_EXTERN;
-            if (strncmp(lexeme, "return", 6) == 0)      return TOKEN_KEYWORD_RETURN;
-            if (strncmp(lexeme, "unsafe", 6) == 0)      return TOKEN_KEYWORD_UNSAFE;
-            break;
-        case 8:
-            if (strncmp(lexeme, "continue", 8) == 0)    return TOKEN_KEYWORD_CONTINUE;
-            if (strncmp(lexeme, "comptime", 8) == 0)    return TOKEN_KEYWORD_COMPTIME;
-            break;
-        case 9:
-            if (strncmp(lexeme, "c_include", 9) == 0)   return TOKEN_KEYWORD_C_INCLUDE;
-            break;
-        case 10:
-            if (strncmp(lexeme, "decreasing", 10) == 0) return TOKEN_KEYWORD_DECREASING;
-            break;
-    }
+// The single source of truth for reserved words. To add one: add its
+// TOKEN_KEYWORD_* kind above, list it here, then regenerate the hash table:
+//
+//   gcc -std=c99 -D_DEFAULT_SOURCE -I src -o /tmp/kwgen src/token_keywords_gen.c
+//   /tmp/kwgen > src/token_keywords.h
+#define TOKEN_KEYWORDS(X)                       \
+    X("if",         TOKEN_KEYWORD_IF)           \
+    X("in",         TOKEN_KEYWORD_IN)           \
+    X("as",         TOKEN_KEYWORD_AS)           \
+    X("or",         TOKEN_KEYWORD_OR)           \
+    X("for",        TOKEN_KEYWORD_FOR)          \
+    X("var",        TOKEN_KEYWORD_VAR)          \
+    X("mov",        TOKEN_KEYWORD_MOV)          \
+    X("use",        TOKEN_KEYWORD_USE)          \
+    X("and",        TOKEN_KEYWORD_AND)          \
+    X("nil",        TOKEN_KEYWORD_NIL)          \
+    X("type",       TOKEN_KEYWORD_TYPE)         \
+    X("func",       TOKEN_KEYWORD_FUNC)         \
+    X("proc",       TOKEN_KEYWORD_PROC)         \
+    X("else",       TOKEN_KEYWORD_ELSE)         \
+    X("case",       TOKEN_KEYWORD_CASE)         \
+    X("true",       TOKEN_KEYWORD_TRUE)         \
+    X("break",      TOKEN_KEYWORD_BREAK)        \
+    X("false",      TOKEN_KEYWORD_FALSE)        \
+    X("while",      TOKEN_KEYWORD_WHILE)        \
+    X("defer",      TOKEN_KEYWORD_DEFER)        \
+    X("import",     TOKEN_KEYWORD_IMPORT)       \
+    X("extern",     TOKEN_KEYWORD_EXTERN)       \
+    X("return",     TOKEN_KEYWORD_RETURN)       \
+    X("unsafe",     TOKEN_KEYWORD_UNSAFE)       \
+    X("continue",   TOKEN_KEYWORD_CONTINUE)     \
+    X("comptime",   TOKEN_KEYWORD_COMPTIME)     \
+    X("c_include",  TOKEN_KEYWORD_C_INCLUDE)    \
+    X("decreasing", TOKEN_KEYWORD_DECREASING)
+
+// Perfect-hash key of a keyword candidate (len >= 2): the length plus the
+// first, second-to-last and last bytes. Length + first + last alone is not
+// enough — it collides on type/true and continue/comptime.
+static inline uint32 token_keyword_key(const char *lexeme, isize len) {
+    return (uint32)len
+         | (uint32)(uint8)lexeme[0]       << 8
+         | (uint32)(uint8)lexeme[len - 2] << 16
+         | (uint32)(uint8)lexeme[len - 1] << 24;
+}
+
+// Multiplicative hash of the key onto a 2^bits-slot table; the generator
+// searches for a `magic` that makes it collision-free over TOKEN_KEYWORDS.
+#define TOKEN_KEYWORD_SLOT(key, magic, bits) \
+    ((uint32)((uint32)(key) * (uint32)(magic)) >> (32 - (bits)))
+
+typedef struct {
+    char  text[14];   // NUL-padded spelling
+    uint8 length;     // 0 = empty slot (never matches)
+    uint8 kind;       // TokenKind
+} TokenKeywordSlot;
+
+#ifndef TOKEN_KEYWORDS_GEN
+#include "token_keywords.h"
+
+// Called on every identifier the lexer produces: one hash, one table probe and
+// a single compare against the only keyword that can live in that slot.
+TokenKind token_match_keyword(const char* lexeme, isize len) {
+    if (len < TOKEN_KEYWORD_MIN_LENGTH || len > TOKEN_KEYWORD_MAX_LENGTH)
+        return TOKEN_IDENTIFIER;
+    const TokenKeywordSlot *slot = &token_keyword_table[
+        TOKEN_KEYWORD_SLOT(token_keyword_key(lexeme, len),
+                           TOKEN_KEYWORD_HASH_MAGIC, TOKEN_KEYWORD_HASH_BITS)];
+    if (slot->length == len && memcmp(slot->text, lexeme, (size_t)len) == 0)
+        return (TokenKind)slot->kind;
     return TOKEN_IDENTIFIER;
 }
+#endif
 
 const char* token_kind_name(TokenKind kind) {
     switch (kind) {
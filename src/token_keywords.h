@@ -0,0 +1,42 @@
+#ifndef TOKEN_KEYWORDS_H
+#define TOKEN_KEYWORDS_H
+
+/* Generated by src/token_keywords_gen.c from TOKEN_KEYWORDS in token.h — do not edit. */
+
+#define TOKEN_KEYWORD_MIN_LENGTH  2
+#define TOKEN_KEYWORD_MAX_LENGTH  10
+#define TOKEN_KEYWORD_HASH_BITS   6
+#define TOKEN_KEYWORD_HASH_MAGIC  0xAD2E6455u
+
+static const TokenKeywordSlot token_keyword_table[1 << TOKEN_KEYWORD_HASH_BITS] = {
+    [  3] = { "in",            2, TOKEN_KEYWORD_IN },
+    [  7] = { "true",          4, TOKEN_KEYWORD_TRUE },
+    [  8] = { "as",            2, TOKEN_KEYWORD_AS },
+    [ 10] = { "type",          4, TOKEN_KEYWORD_TYPE },
+    [ 11] = { "func",          4, TOKEN_KEYWORD_FUNC },
+    [ 12] = { "decreasing",   10, TOKEN_KEYWORD_DECREASING },
+    [ 16] = { "case",          4, TOKEN_KEYWORD_CASE },
+    [ 17] = { "var",           3, TOKEN_KEYWORD_VAR },
+    [ 18] = { "import",        6, TOKEN_KEYWORD_IMPORT },
+    [ 24] = { "proc",          4, TOKEN_KEYWORD_PROC },
+    [ 25] = { "if",            2, TOKEN_KEYWORD_IF },
+    [ 29] = { "mov",           3, TOKEN_KEYWORD_MOV },
+    [ 30] = { "false",         5, TOKEN_KEYWORD_FALSE },
+    [ 36] = { "extern",        6, TOKEN_KEYWORD_EXTERN },
+    [ 38] = { "comptime",      8, TOKEN_KEYWORD_COMPTIME },
+    [ 39] = { "else",          4, TOKEN_KEYWORD_ELSE },
+    [ 43] = { "break",         5, TOKEN_KEYWORD_BREAK },
+    [ 47] = { "continue",      8, TOKEN_KEYWORD_CONTINUE },
+    [ 48] = { "c_include",     9, TOKEN_KEYWORD_C_INCLUDE },
+    [ 49] = { "unsafe",        6, TOKEN_KEYWORD_UNSAFE },
+    [ 51] = { "while",         5, TOKEN_KEYWORD_WHILE },
+    [ 52] = { "or",            2, TOKEN_KEYWORD_OR },
+    [ 53] = { "use",           3, TOKEN_KEYWORD_USE },
+    [ 55] = { "for",           3, TOKEN_KEYWORD_FOR },
+    [ 58] = { "return",        6, TOKEN_KEYWORD_RETURN },
+    [ 59] = { "and",           3, TOKEN_KEYWORD_AND },
+    [ 60] = { "defer",         5, TOKEN_KEYWORD_DEFER },
+    [ 62] = { "nil",           3, TOKEN_KEYWORD_NIL },
+};
+
+#endif /* TOKEN_KEYWORDS_H */
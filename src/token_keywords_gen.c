@@ -0,0 +1,114 @@
+/*
+    Generator for src/token_keywords.h — the perfect-hash keyword table used by
+    token_match_keyword (src/token.h).
+
+    Reads the TOKEN_KEYWORDS list, checks that the keys (token_keyword_key) are
+    distinct, then searches for the smallest table and a multiplier for which
+    TOKEN_KEYWORD_SLOT puts every keyword in its own slot.
+
+        gcc -std=c99 -D_DEFAULT_SOURCE -I src -o /tmp/kwgen src/token_keywords_gen.c
+        /tmp/kwgen > src/token_keywords.h
+*/
+
+#define TOKEN_KEYWORDS_GEN
+#include "token.h"
+
+typedef struct {
+    const char *text;
+    const char *kind;
+} KeywordSpec;
+
+#define KEYWORD_SPEC(text, kind) { text, #kind },
+static const KeywordSpec keywords[] = { TOKEN_KEYWORDS(KEYWORD_SPEC) };
+#undef KEYWORD_SPEC
+
+#define KEYWORD_COUNT ((int)countof(keywords))
+#define MAX_BITS      10
+#define MAX_TRIES     (1u << 24)
+
+// xorshift32: deterministic, so regenerating an unchanged list is a no-op diff
+static uint32 rng_state = 0x9E3779B9u;
+static uint32 rng_next(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+static bool try_magic(const uint32 *keys, uint32 magic, int bits, int *slots) {
+    static uint8 used[1 << MAX_BITS];
+    memset(used, 0, sizeof(used));
+    for (int i = 0; i < KEYWORD_COUNT; i++) {
+        uint32 slot = TOKEN_KEYWORD_SLOT(keys[i], magic, bits);
+        if (used[slot]) return false;
+        used[slot] = 1;
+        slots[i] = (int)slot;
+    }
+    return true;
+}
+
+int main(void) {
+    uint32 keys[KEYWORD_COUNT];
+    int    slots[KEYWORD_COUNT];
+    isize  min_len = 1 << 30, max_len = 0;
+
+    for (int i = 0; i < KEYWORD_COUNT; i++) {
+        isize len = (isize)strlen(keywords[i].text);
+        if (len < 2 || len >= (isize)sizeof(((TokenKeywordSlot *)0)->text)) {
+            fprintf(stderr, "keyword '%s': length must be in [2, %ld]\n", keywords[i].text,
+                    (long)sizeof(((TokenKeywordSlot *)0)->text) - 1);
+            return 1;
+        }
+        if (len < min_len) min_len = len;
+        if (len > max_len) max_len = len;
+        keys[i] = token_keyword_key(keywords[i].text, len);
+        for (int j = 0; j < i; j++) {
+            if (keys[j] == keys[i]) {
+                fprintf(stderr, "keywords '%s' and '%s' share a hash key; "
+                        "extend token_keyword_key with another byte\n",
+                        keywords[j].text, keywords[i].text);
+                return 1;
+            }
+        }
+    }
+
+    int bits = 1;
+    while ((1 << bits) < KEYWORD_COUNT) bits++;
+    uint32 magic = 0;
+    for (; bits <= MAX_BITS; bits++) {
+        for (uint32 t = 0; t < MAX_TRIES; t++) {
+            uint32 m = rng_next() | 1u;
+            if (try_magic(keys, m, bits, slots)) { magic = m; break; }
+        }
+        if (magic) break;
+    }
+    if (!magic) {
+        fprintf(stderr, "no perfect hash found up to 2^%d slots\n", MAX_BITS);
+        return 1;
+    }
+
+    const char *by_slot[1 << MAX_BITS] = {0};
+    int         idx_by_slot[1 << MAX_BITS];
+    for (int i = 0; i < KEYWORD_COUNT; i++) {
+        by_slot[slots[i]] = keywords[i].text;
+        idx_by_slot[slots[i]] = i;
+    }
+
+    printf("#ifndef TOKEN_KEYWORDS_H\n");
+    printf("#define TOKEN_KEYWORDS_H\n\n");
+    printf("/* Generated by src/token_keywords_gen.c from TOKEN_KEYWORDS in token.h — do not edit. */\n\n");
+    printf("#define TOKEN_KEYWORD_MIN_LENGTH  %ld\n", (long)min_len);
+    printf("#define TOKEN_KEYWORD_MAX_LENGTH  %ld\n", (long)max_len);
+    printf("#define TOKEN_KEYWORD_HASH_BITS   %d\n", bits);
+    printf("#define TOKEN_KEYWORD_HASH_MAGIC  0x%08Xu\n\n", magic);
+    printf("static const TokenKeywordSlot token_keyword_table[1 << TOKEN_KEYWORD_HASH_BITS] = {\n");
+    for (int s = 0; s < (1 << bits); s++) {
+        if (!by_slot[s]) continue;
+        const KeywordSpec *k = &keywords[idx_by_slot[s]];
+        printf("    [%3d] = { \"%s\",%*s %2ld, %s },\n", s, k->text,
+               (int)(12 - strlen(k->text)), "", (long)strlen(k->text), k->kind);
+    }
+    printf("};\n\n");
+    printf("#endif /* TOKEN_KEYWORDS_H */\n");
+    return 0;
+}
@@ -3,9 +3,27 @@
 
 /*
     from: https://nullprogram.com/blog/2023/09/27/
+
+    Two kinds of arena share one struct:
+
+      • arena_new(allocator, size): a fixed block; running out panics.
+      • arena_reserve(size): reserves `size` bytes of address space and
+        commits pages on demand, so a small program touches only what it
+        uses. A reservation the OS refuses (say under `ulimit -v`) is retried
+        at half the size. When it runs out the arena chains a new block, so
+        pointers into it stay valid; a single push never spans two blocks.
+
+    `beg`..`limit` is the current block: `end` is the end of its usable
+    (committed) memory, `limit` the end of its reservation; a fixed arena has
+    end == limit. A chained block starts with a copy of the arena as it was
+    before the block, `prev`, which arena_rewind() restores when it rewinds
+    past the block. `used` counts the bytes in the earlier blocks and `peak`
+    is the high-water mark in bytes: arena_rewind()/arena_clear() record it
+    before moving back, and arena_high_water() folds in the current position.
 */
 
 #include "common/def.h"     /* usize, isize, uptr */
+#include "common/system/memory.h"  /* memory_reserve, memory_commit */
 #include "common/predef.h"  /* nodiscard, inline, alignof */
 #include "panic.h"          /* panic_if_msg */
 
@@ -20,11 +38,34 @@
 #define arena_pop(arena, type)                      (type *)_arena_pop(arena, sizeof(type), 1)
 #define arena_pop_many(arena, type, count)          (type *)_arena_pop(arena, sizeof(type), count)
 
-typedef struct {
+/* Address space reserved by arena_reserve() callers that have no better bound. */
+#if WORDSIZE_BITS == 64
+#   define ARENA_RESERVE_DEFAULT   ((usize)256 << 20)  /* 256 MiB */
+#else
+#   define ARENA_RESERVE_DEFAULT   ((usize)64 << 20)   /* 64 MiB */
+#endif
+
+/* arena_reserve() halves a refused reservation down to this size. */
+#define ARENA_RESERVE_MIN           ((usize)4 << 20)    /* 4 MiB */
+
+/* Pages are committed at least this many bytes at a time. */
+#define ARENA_COMMIT_GRANULE        ((isize)1 << 20)    /* 1 MiB */
+
+/* Room for the saved arena at the start of a chained block; keeps `beg` aligned. */
+#define ARENA_BLOCK_HEADER          ((sizeof(Arena) + 63) & ~(isize)63)
+
+typedef struct Arena Arena;
+struct Arena {
     char    *beg;
     char    *cur;
-    char    *end;
-} Arena;
+    char    *end;       /* end of committed memory */
+    char    *limit;     /* end of the reservation */
+    Arena   *prev;      /* the arena before this block, or NULL */
+    isize    used;      /* bytes used in earlier blocks */
+    isize    committed; /* bytes committed in earlier blocks */
+    isize    peak;      /* high-water mark as of the last rewind */
+    bool     grows;     /* made by arena_reserve(): can chain blocks */
+};
 
 static inline Arena arena_new(void* (*allocator)(usize), usize size) {
     Arena arena = {};
@@ -39,21 +80,133 @@ static inline Arena arena_new(void* (*allocator)(usize), usize size) {
     arena.beg = ptr;
     arena.cur = ptr;
     arena.end = ptr + size;
+    arena.limit = arena.end;
+
+    return arena;
+}
+
+static inline Arena arena_reserve(usize size) {
+    Arena arena = {0};
+
+    char *ptr = memory_reserve(size);
+    while (ptr == MEMORY_PAGE_RESERVE_FAILED && size / 2 >= ARENA_RESERVE_MIN) {
+        size /= 2;
+        ptr = memory_reserve(size);
+    }
+    panic_if_msg(ptr == MEMORY_PAGE_RESERVE_FAILED,
+                 "Arena creation failed: cannot reserve %zu bytes of address space.", size);
+
+    arena.beg = ptr;
+    arena.cur = ptr;
+    arena.end = ptr;
+    arena.limit = ptr + size;
+    arena.grows = true;
 
     return arena;
 }
 
+/* Start of the current block's reservation (before its header, if chained). */
+static inline char *_arena_block(const Arena *arena) {
+    return arena->prev ? (char *)arena->prev : arena->beg;
+}
+
+/*
+    Start a new block with room for `need` bytes. It reserves as much as the
+    current block, halving while the OS refuses, but never less than `need`.
+*/
+static void _arena_chain(Arena *arena, isize need) {
+    isize min  = (ARENA_BLOCK_HEADER + need + ARENA_COMMIT_GRANULE - 1) & ~(ARENA_COMMIT_GRANULE - 1);
+    isize size = arena->limit - _arena_block(arena);
+    if (size < min) size = min;
+
+    char *block = memory_reserve((usize)size);
+    while (block == MEMORY_PAGE_RESERVE_FAILED && size / 2 >= min) {
+        size /= 2;
+        block = memory_reserve((usize)size);
+    }
+    panic_if_msg(block == MEMORY_PAGE_RESERVE_FAILED,
+                 "Arena push failed: cannot reserve another %ld bytes of address space.", min);
+    panic_if_msg(memory_commit(block, (usize)ARENA_COMMIT_GRANULE) == MEMORY_PAGE_COMMIT_FAILED,
+                 "Arena push failed: cannot commit %ld more bytes.", ARENA_COMMIT_GRANULE);
+
+    Arena *saved = (Arena *)block;
+    *saved = *arena;
+    arena->used      += arena->cur - arena->beg;
+    arena->committed += arena->end - _arena_block(arena);
+    arena->prev  = saved;
+    arena->beg   = block + ARENA_BLOCK_HEADER;
+    arena->cur   = arena->beg;
+    arena->end   = block + ARENA_COMMIT_GRANULE;
+    arena->limit = block + size;
+}
+
+/* Drop the current block and go back to the one before it. */
+static void _arena_unchain(Arena *arena) {
+    char *block = _arena_block(arena);
+    isize size  = arena->limit - block;
+    isize peak  = arena->peak;
+
+    *arena = *arena->prev;
+    arena->peak = peak;
+    (void)memory_free(block, (usize)size);
+}
+
+/*
+    Commit enough pages for `need` more bytes past `cur`. Commits at least
+    ARENA_COMMIT_GRANULE and at least as much as is already committed, so a
+    growing arena makes O(log n) commit calls. Chains a new block when the
+    reservation is exhausted; panics only when the OS refuses to reserve or
+    commit.
+*/
+static void _arena_grow(Arena *arena, isize need) {
+    if (arena->cur - _arena_block(arena) + need > arena->limit - _arena_block(arena)) {
+        _arena_chain(arena, need);
+        if (arena->end - arena->cur >= need) return;
+    }
+
+    char *block     = _arena_block(arena);
+    isize committed = arena->end - block;
+    isize reserved  = arena->limit - block;
+    isize wanted    = arena->cur - block + need;
+
+    isize target = committed + (committed > ARENA_COMMIT_GRANULE ? committed : ARENA_COMMIT_GRANULE);
+    if (target < wanted) target = wanted;
+    target = (target + ARENA_COMMIT_GRANULE - 1) & ~(ARENA_COMMIT_GRANULE - 1);
+    if (target > reserved) target = reserved;
+
+    panic_if_msg(memory_commit(arena->end, (usize)(target - committed)) == MEMORY_PAGE_COMMIT_FAILED,
+                 "Arena push failed: cannot commit %ld more bytes.", target - committed);
+    arena->end = block + target;
+}
+
+/*
+    Make room for `size * count` bytes after `padding`, growing if possible.
+    Growing may chain a new block, so callers recompute their padding.
+*/
+static inline void _arena_ensure(Arena *arena, isize size, isize count, isize padding) {
+    isize available = arena->end - arena->cur - padding;
+    if (available >= 0 && count <= available / size) return;
+    panic_if_msg(!arena->grows,
+                 "Arena push failed: insufficient space for requested items (count: %ld, available: %ld).",
+                 count, available > 0 ? available / size : 0);
+    panic_if_msg(count > (PTRDIFF_MAX / 2 - padding) / size,
+                 "Arena push failed: request too large (size: %ld, count: %ld).", size, count);
+    _arena_grow(arena, padding + size * count);
+}
+
 static inline void arena_align(Arena *arena, isize alignment) {
     isize padding = -(uptr)arena->cur & (alignment - 1);
 
 #if ARENA_DEBUG
-    isize available = arena->end - arena->cur - padding;
     panic_if_msg(alignment <= 0, 
                  "Arena alignment failed: alignment must be greater than 0 (alignment: %ld).", alignment);
-    panic_if_msg(available <= 0, 
-                 "Arena alignment failed: insufficient space after padding (available: %ld, required: %ld).", available, padding);
 #endif
 
+    if (arena->end - arena->cur <= padding) {
+        _arena_ensure(arena, 1, 1, padding);
+        padding = -(uptr)arena->cur & (alignment - 1);
+    }
+
     arena->cur += padding;
 }
 
@@ -65,14 +218,10 @@ static inline void *_arena_push(Arena *arena, isize size, isize count) {
                  "Arena push failed: size must be greater than 0 (got: %ld).", size);
     panic_if_msg(count <= 0, 
                  "Arena push failed: count must be greater than 0 (got: %ld).", count);
-
-    isize available = arena->end - arena->cur;
-    panic_if_msg(available <= 0, 
-                 "Arena push failed: no space available in the arena (available: %ld bytes).", available);
-    panic_if_msg(count > available / size, 
-                 "Arena push failed: insufficient space for requested items (count: %ld, available: %ld).", count, available / size);
 #endif
 
+    _arena_ensure(arena, size, count, 0);
+
     void *ptr = arena->cur;
     arena->cur += size * count;
     return ptr;
@@ -90,14 +239,11 @@ static inline void *_arena_push_aligned(Arena *arena, isize size, isize count, i
                  "Arena push aligned failed: count must be greater than 0 (got: %ld).", count);
     panic_if_msg(alignment <= 0, 
                  "Arena push aligned failed: alignment must be greater than 0 (alignment: %ld).", alignment);
-
-    isize available = arena->end - arena->cur - padding;
-    panic_if_msg(available <= 0, 
-                 "Arena push aligned failed: no space available after alignment (available: %ld bytes).", available);
-    panic_if_msg(count > available / size, 
-                 "Arena push aligned failed: insufficient space for requested items (count: %ld, available: %ld).", count, available / size);
 #endif
 
+    _arena_ensure(arena, size, count, padding);
+    padding = -(uptr)arena->cur & (alignment - 1);
+
     void *ptr = arena->cur + padding;
     arena->cur += padding + size * count;
     return ptr;
@@ -115,10 +261,50 @@ static inline void *_arena_pop(Arena *arena, isize size, isize count) {
                  "Arena pop failed: overflow detected (size: %ld, count: %ld).", size, count);
 #endif
 
+    isize used = arena->used + (arena->cur - arena->beg);
+    if (used > arena->peak) arena->peak = used;
     return arena->cur -= size * count;
 }
 
+/* Current position, to hand back to arena_rewind() later. */
+static inline char *arena_mark(const Arena *arena) {
+    return arena->cur;
+}
+
+/* Bytes in use, across all blocks. */
+static inline isize arena_used(const Arena *arena) {
+    return arena->used + (arena->cur - arena->beg);
+}
+
+/* Bytes committed, across all blocks. */
+static inline isize arena_committed(const Arena *arena) {
+    return arena->committed + (arena->end - _arena_block(arena));
+}
+
+/* Bytes in use at the high-water mark. */
+static inline isize arena_high_water(const Arena *arena) {
+    isize used = arena_used(arena);
+    return used > arena->peak ? used : arena->peak;
+}
+
+/*
+    Release everything pushed after `mark` (a previous value of `cur`),
+    dropping the blocks chained since.
+*/
+static inline void arena_rewind(Arena *arena, char *mark) {
+    arena->peak = arena_high_water(arena);
+    while (arena->prev && (mark < arena->beg || mark > arena->cur))
+        _arena_unchain(arena);
+#if ARENA_DEBUG
+    panic_if_msg(mark < arena->beg || mark > arena->cur,
+                 "Arena rewind failed: mark is outside the used part of the arena.");
+#endif
+    arena->cur = mark;
+}
+
 static inline void arena_clear(Arena *arena) {
+    arena->peak = arena_high_water(arena);
+    while (arena->prev) _arena_unchain(arena);
     arena->cur = arena->beg;
 }
 
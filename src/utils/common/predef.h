@@ -118,12 +118,16 @@
 
 #include "predef/specifier/constexpr.h"
 #include "predef/specifier/restrict.h"
+#include "predef/specifier/thread_local.h"
 
 #define constexpr                      ATTRIBUTE_CONSTEXPR
 
 /* The pointer is not aliased. */
 #define restrict                       ATTRIBUTE_RESTRICT
 
+/* Every thread has its own instance of the variable. */
+#define _thread_local                  SPECIFIER_THREAD_LOCAL
+
 
 #include "predef/translation/current_function.h"
 
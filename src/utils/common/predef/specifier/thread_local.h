@@ -0,0 +1,33 @@
+#ifndef SPECIFIER_THREAD_LOCAL_H
+#define SPECIFIER_THREAD_LOCAL_H
+
+/*
+                   Copyright Marco De Groskovskaja 2023 - 2024
+            Distributed under the Boost Software License Version 1.0
+                      https://www.boost.org/LICENSE_1_0.txt
+*/
+
+#include "../language/c.h"
+#include "../language/cpp.h"
+#include "../compiler/clang.h"
+#include "../compiler/gcc.h"
+#include "../compiler/msvc.h"
+
+#if LANGUAGE_CPP11 || LANGUAGE_C23
+#   define SPECIFIER_THREAD_LOCAL thread_local
+
+#elif LANGUAGE_C11
+#   define SPECIFIER_THREAD_LOCAL _Thread_local
+
+#elif COMPILER_GCC || COMPILER_CLANG
+#   define SPECIFIER_THREAD_LOCAL __thread
+
+#elif COMPILER_MSVC
+#   define SPECIFIER_THREAD_LOCAL __declspec(thread)
+
+#else
+#   define SPECIFIER_THREAD_LOCAL
+
+#endif
+
+#endif /* SPECIFIER_THREAD_LOCAL_H */
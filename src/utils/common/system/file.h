@@ -320,4 +320,43 @@ static void* file_map_rw(file handle, int64 length) /* lenght should be = file s
     return p;
 }
 
+/*
+    Maps `length` bytes of the file read-only, followed by at least `tail`
+    zero bytes: the kernel zero-fills the rest of the file's last page, and
+    whole anonymous zero pages are reserved after it. The mapping outlives
+    `handle`, so the caller may close it right away.
+
+    Return FILE_MAP_FAILED on failure. Not implemented on Windows (always
+    fails), callers fall back to reading the file.
+*/
+static void* file_map_r_zero_tail(file handle, int64 length, int64 tail)
+{
+#if FILE_DEBUG
+    assert(length > 0);
+
+#endif
+
+#if OS_WINDOWS
+    (void)handle; (void)length; (void)tail;
+    return FILE_MAP_FAILED;
+
+#elif OS_LINUX
+    int64 page  = sysconf(_SC_PAGE_SIZE);
+    int64 span  = (length + page - 1) & ~(page - 1);
+    int64 total = span + ((tail + page - 1) & ~(page - 1));
+
+    /* reserve the whole range as zero pages, then map the file over its head */
+    void *base = mmap(NULL, total, PROT_READ, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (base == MAP_FAILED) return MAP_FAILED;
+
+    void *p = mmap(base, length, PROT_READ, MAP_PRIVATE | MAP_FIXED, handle, 0);
+    if (p == MAP_FAILED) {
+        munmap(base, total);
+        return MAP_FAILED;
+    }
+    return p;
+
+#endif
+}
+
 #endif /* SYSTEM_FILE_H */
\ No newline at end of file
@@ -32,13 +32,13 @@
     @brief
         Value returned by `memory_reserve` on failure.
 */
-//#undef MEMORY_RESERVE_FAILED
+#undef MEMORY_PAGE_RESERVE_FAILED
 
 /**
     @brief
         Value returned by `memory_commit` on failure.
 */
-//#undef MEMORY_COMMIT_FAILED
+#undef MEMORY_PAGE_COMMIT_FAILED
 
 /**
     @brief
@@ -64,23 +64,23 @@
 
     @return
         A pointer to the reserved memory on success.
-        `MEMORY_RESERVE_FAILED` on failure.
+        `MEMORY_PAGE_RESERVE_FAILED` on failure.
 */
-//static void *memory_reserve(isize size);
+nodiscard static inline noalias void *memory_reserve(usize size);
 
 /**
     @brief
         Commits previously reserved memory.
 
     @param addr
-        Non-null pointer to the reserved memory block to commit.
+        Non-null, page-aligned pointer into a reserved block.
     @param size
         Size of memory to commit, in bytes.
 
     @return
-        `MEMORY_COMMIT_FAILED` on failure.
+        `MEMORY_PAGE_COMMIT_FAILED` on failure.
 */
-//static int memory_commit(void* addr, isize size);
+static inline nonnull(1) int memory_commit(void *addr, usize size);
 
 /**
     @brief
@@ -135,61 +135,62 @@ nodiscard static inline int64 memory_page_size(void);
 #endif
 
 #if OS_WINDOWS
-//#   define MEMORY_PAGE_RESERVE_FAILED   NULL
-//#   define MEMORY_PAGE_COMMIT_FAILED    NULL
+#   define MEMORY_PAGE_RESERVE_FAILED   NULL
+#   define MEMORY_PAGE_COMMIT_FAILED    -1
 #   define MEMORY_PAGE_ALLOC_FAILED     NULL
 #   define MEMORY_PAGE_FREE_FAILED      0
 
 #elif OS_LINUX
-//#   define MEMORY_PAGE_RESERVE_FAILED   MAP_FAILED
-//#   define MEMORY_PAGE_COMMIT_FAILED    -1
+#   define MEMORY_PAGE_RESERVE_FAILED   MAP_FAILED
+#   define MEMORY_PAGE_COMMIT_FAILED    -1
 #   define MEMORY_PAGE_ALLOC_FAILED     MAP_FAILED
 #   define MEMORY_PAGE_FREE_FAILED      -1
 
 #endif
 
-//static inline noalias void *memory_reserve(isize size)
-//{
-//    void *p;
-//
-//#if OS_WINDOWS
-//    p = VirtualAlloc(NULL, size, MEM_RESERVE, PAGE_NOACCESS);
-//
-//#elif OS_LINUX
-//    p = mmap(NULL, size, PROT_NONE, MAP_PRIVATE|MAP_ANONYMOUS, -1, 0);
-//
-//#endif
-//
-//#if MEMORY_PAGE_DEBUG
-//    assert(p != MEMORY_PAGE_RESERVE_FAILED);
-//
-//#endif
-//
-//    return p;
-//}
-//
-///*
-//    issue: this function doesn't validate whether the addr is indeed part of a previously reserved region. Accessing invalid memory regions may lead to undefined behavior.
-//*/
-//static inline nonnull(1) int memory_commit(void* addr, isize size)
-//{
-//    int i;
-//
-//#if OS_WINDOWS
-//    i = VirtualAlloc(addr, size, MEM_COMMIT, PAGE_READWRITE);
-//
-//#elif OS_LINUX
-//    i = mprotect(addr, size, PROT_READ|PROT_WRITE);
-//
-//#endif
-//
-//#if MEMORY_PAGE_DEBUG
-//    assert(i != MEMORY_PAGE_COMMIT_FAILED);
-//
-//#endif
-//
-//    return i;
-//}
+nodiscard static inline noalias void *memory_reserve(usize size)
+{
+    void *p;
+
+#if OS_WINDOWS
+    p = VirtualAlloc(NULL, size, MEM_RESERVE, PAGE_NOACCESS);
+
+#elif OS_LINUX
+    /* PROT_NONE + MAP_NORESERVE: address space only, no swap accounting */
+    p = mmap(NULL, size, PROT_NONE, MAP_PRIVATE|MAP_ANONYMOUS|MAP_NORESERVE, -1, 0);
+
+#endif
+
+#if MEMORY_PAGE_DEBUG
+    assert(p != MEMORY_PAGE_RESERVE_FAILED);
+
+#endif
+
+    return p;
+}
+
+/*
+    issue: this function doesn't validate whether the addr is indeed part of a previously reserved region. Accessing invalid memory regions may lead to undefined behavior.
+*/
+static inline nonnull(1) int memory_commit(void *addr, usize size)
+{
+    int i;
+
+#if OS_WINDOWS
+    i = VirtualAlloc(addr, size, MEM_COMMIT, PAGE_READWRITE) ? 0 : -1;
+
+#elif OS_LINUX
+    i = mprotect(addr, size, PROT_READ|PROT_WRITE);
+
+#endif
+
+#if MEMORY_PAGE_DEBUG
+    assert(i != MEMORY_PAGE_COMMIT_FAILED);
+
+#endif
+
+    return i;
+}
 
 nodiscard static inline noalias void *memory_alloc(usize size)
 {
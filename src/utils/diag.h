@@ -0,0 +1,51 @@
+/* Copyright © 2024 Marco De Groskovskaja, licensed under the MIT License, see https://mit-license.org for details. */
+
+#ifndef UTILS_DIAG_H
+#define UTILS_DIAG_H
+
+/*
+    Growable diagnostics buffer.
+
+    The module parser's -j worker threads format their diagnostics into a
+    DiagBuffer instead of printing them, so the main thread can print them
+    later in the order the serial build would. The parser keeps a
+    `_thread_local` pointer to the buffer its current thread reports into.
+    Sema records into one too, for --cache-dir (cache.h).
+*/
+
+#include "common/def.h"     /* isize */
+#include "common/libc.h"    /* va_list, vsnprintf, realloc */
+
+typedef struct DiagBuffer {
+    char    *text;      // NUL-terminated, NULL until something is appended
+    isize    len;
+    isize    cap;
+} DiagBuffer;
+
+static void _diag_buffer_reserve(DiagBuffer *b, isize n) {
+    if (b->len + n + 1 <= b->cap) return;
+    isize c = b->cap ? b->cap : 256;
+    while (c < b->len + n + 1) c *= 2;
+    char *grown = realloc(b->text, (size_t)c);
+    if (!grown) {
+        fprintf(stderr, "Error: out of memory buffering diagnostics\n");
+        exit(1);
+    }
+    b->text = grown;
+    b->cap  = c;
+}
+
+// Append printf-formatted text.
+static void diag_buffer_vprintf(DiagBuffer *b, const char *fmt, va_list ap) {
+    va_list ap2;
+    va_copy(ap2, ap);
+    int n = vsnprintf(NULL, 0, fmt, ap);
+    if (n > 0) {
+        _diag_buffer_reserve(b, n);
+        vsnprintf(b->text + b->len, (size_t)n + 1, fmt, ap2);
+        b->len += n;
+    }
+    va_end(ap2);
+}
+
+#endif /* UTILS_DIAG_H */
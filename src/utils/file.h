@@ -18,14 +18,25 @@ typedef struct
     char* contents;
 } File;
 
-static File file_read_into_arena(Arena* arena, char* filename)
+/*
+    Zero bytes guaranteed to follow the contents returned by file_load_source
+    (the first is the NUL terminator), so NUL-terminated scans and wide SIMD
+    loads near the end of a source never need a bounds check.
+*/
+#define FILE_SOURCE_PADDING 64
+
+/*
+    Load a source file for lexing without copying it: map it read-only with a
+    zero-filled tail (see file_map_r_zero_tail). Falls back to reading into
+    `arena` — with the same FILE_SOURCE_PADDING zero tail — for empty files or
+    when mapping is unavailable. `contents` is NULL if the file cannot be opened.
+*/
+static File file_load_source(Arena* arena, char* filename)
 {
     File f = {0};
 
     f.handle = file_open_r(filename);
     if (f.handle == FILE_OPEN_FAILED) {
-        // Leave f.contents = NULL so the caller reports a useful diagnostic.
-        // (Fixed C.1: previously abort() here hid the actual path failure.)
         return f;
     }
     f.size = file_size(f.handle);
@@ -34,15 +45,21 @@ static File file_read_into_arena(Arena* arena, char* filename)
         exit(1);
     }
 
-    // allocate f.size + 1 bytes so we can NUL‑terminate
-    char* buf = arena_push_many(arena, char, f.size + 1);
-    f.contents = buf;
-
-    // read exactly f.size bytes
-    file_read(f.handle, f.contents, f.size);
+    if (f.size > 0) {
+        void *p = file_map_r_zero_tail(f.handle, f.size, FILE_SOURCE_PADDING);
+        if (p != FILE_MAP_FAILED) {
+            f.contents = p;
+            file_close(f.handle);
+            return f;
+        }
+    }
 
-    // NUL‑terminate
-    buf[f.size] = '\0';
+    char* buf = arena_push_many(arena, char, f.size + FILE_SOURCE_PADDING);
+    f.contents = buf;
+    isize got = f.size > 0 ? file_read(f.handle, f.contents, f.size) : 0;
+    if (got < 0) got = 0;
+    memset(buf + got, 0, (size_t)(f.size + FILE_SOURCE_PADDING - got));
+    file_close(f.handle);
 
     arena_align(arena, 8);
 
@@ -0,0 +1,25 @@
+#!/usr/bin/env bash
+# --whole-program gives every function internal linkage except main and the
+# ones marked [export]; without the flag only [private] functions are static.
+set -u
+ROOT="$(cd "$(dirname "$0")/../.." && pwd)"
+LAIN="$ROOT/lain"
+D="$(mktemp -d)"
+trap 'rm -rf "$D"' EXIT
+cat > "$D/wp.ln" <<'LN'
+func helper(x i32) i32 { return x +% 1 }
+
+[export]
+func api_entry(x i32) i32 { return helper(x) *% 2 }
+
+proc main() i32 { return api_entry(1) -% 4 }
+LN
+( cd "$D" && "$LAIN" wp.ln --whole-program -o wp.c >/dev/null 2>&1 ) || { echo "compile failed"; exit 1; }
+grep -q '^static __attribute__((unused)) .*wp_helper(int32_t);' "$D/wp.c" || { echo "helper not static"; exit 1; }
+grep -q '^static .*wp_api_entry' "$D/wp.c" && { echo "[export] function made static"; exit 1; }
+grep -q '^static .*main(' "$D/wp.c" && { echo "main made static"; exit 1; }
+gcc -std=gnu11 -w -o "$D/wp" "$D/wp.c" && "$D/wp" || { echo "emitted C failed"; exit 1; }
+
+( cd "$D" && "$LAIN" wp.ln -o plain.c >/dev/null 2>&1 ) || { echo "compile failed"; exit 1; }
+grep -q '^static .*wp_helper' "$D/plain.c" && { echo "helper static without --whole-program"; exit 1; }
+exit 0
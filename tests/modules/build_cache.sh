@@ -0,0 +1,43 @@
+#!/usr/bin/env bash
+# --cache-dir: an unchanged build is reused, an edit is a miss, and reverting
+# the edit finds the earlier build again. --units output is cached too, and a
+# hit leaves unit files whose C did not change untouched. A different
+# compiler binary never reuses another one's builds.
+set -u
+ROOT="$(cd "$(dirname "$0")/../.." && pwd)"
+LAIN="${LAIN:-$ROOT/lain}"
+D="$(mktemp -d)"
+trap 'rm -rf "$D"' EXIT
+
+printf 'func base(x i32) i32 { return x +%% 1 }\n' > "$D/shared.ln"
+printf 'import shared\nproc main() i32 { return shared.base(1) -%% 2 }\n' > "$D/app.ln"
+cp "$D/shared.ln" "$D/shared.orig"
+lain() { ( cd "$D" && "$LAIN" app.ln --cache-dir=cache "$@" >/dev/null 2>&1 ); }
+entries() { cat "$D"/cache/*.manifest | grep -c '^build '; }
+
+lain -o a.c || { echo "first compile failed"; exit 1; }
+[ "$(entries)" -eq 1 ] || { echo "first build not stored"; exit 1; }
+lain -o b.c && cmp -s "$D/a.c" "$D/b.c" || { echo "hit emitted different C"; exit 1; }
+[ "$(entries)" -eq 1 ] || { echo "a hit stored a new build"; exit 1; }
+
+printf 'func base(x i32) i32 { return x +%% 2 }\n' > "$D/shared.ln"
+lain -o c.c || { echo "compile after edit failed"; exit 1; }
+grep -q '+ 2\|+2' "$D/c.c" && ! cmp -s "$D/a.c" "$D/c.c" || { echo "edit reused the old build"; exit 1; }
+[ "$(entries)" -eq 2 ] || { echo "edited build not stored"; exit 1; }
+
+cp "$D/shared.orig" "$D/shared.ln"
+lain -o d.c && cmp -s "$D/a.c" "$D/d.c" || { echo "revert emitted different C"; exit 1; }
+[ "$(entries)" -eq 2 ] || { echo "revert was not a hit"; exit 1; }
+
+( cd "$D" && "$LAIN" app.ln --units=ref >/dev/null 2>&1 ) || { echo "--units compile failed"; exit 1; }
+lain --units=u1 && lain --units=u2 || { echo "--units with cache failed"; exit 1; }
+diff -r "$D/ref" "$D/u2" >/dev/null || { echo "--units hit wrote different files"; exit 1; }
+[ "$(entries)" -eq 3 ] || { echo "--units hit stored a new build"; exit 1; }
+touch -d '2000-01-01' "$D"/u2/*
+lain --units=u2 || { echo "--units hit failed"; exit 1; }
+[ -z "$(find "$D/u2" -type f -newer "$D/app.ln")" ] || { echo "--units hit rewrote unchanged files"; exit 1; }
+
+cp "$LAIN" "$D/lain2" && printf 'x' >> "$D/lain2"
+( cd "$D" && ./lain2 app.ln --cache-dir=cache -o e.c >/dev/null 2>&1 ) || { echo "other compiler failed"; exit 1; }
+[ "$(ls "$D"/cache/*.manifest | wc -l)" -eq 3 ] || { echo "other compiler shared a manifest"; exit 1; }
+exit 0
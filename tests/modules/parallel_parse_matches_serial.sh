@@ -0,0 +1,37 @@
+#!/usr/bin/env bash
+# -j N parses modules on worker threads but must behave exactly like the
+# serial build: the same C for a good program, and for a program with several
+# bad modules the same diagnostic (the first bad module in import order),
+# however the threads happen to finish.
+set -u
+ROOT="$(cd "$(dirname "$0")/../.." && pwd)"
+LAIN="${LAIN:-$ROOT/lain}"
+D="$(mktemp -d)"
+trap 'rm -rf "$D"' EXIT
+
+printf 'func base(x i32) i32 { return x +%% 1 }\n' > "$D/shared.ln"
+imports=""; calls="0"
+for i in 1 2 3 4 5 6 7 8; do
+    printf 'import shared\nfunc f%d(x i32) i32 { return shared.base(x) +%% %d }\n' "$i" "$i" > "$D/m$i.ln"
+    imports="${imports}import m$i\n"; calls="m$i.f$i($calls)"
+done
+printf "${imports}proc main() i32 { return $calls -%% 44 }\n" > "$D/good.ln"
+( cd "$D" && "$LAIN" good.ln -o serial.c >/dev/null 2>&1 ) || { echo "serial compile failed"; exit 1; }
+( cd "$D" && "$LAIN" good.ln -j 4 -o par.c >/dev/null 2>&1 ) || { echo "-j 4 compile failed"; exit 1; }
+cmp -s "$D/serial.c" "$D/par.c" || { echo "-j 4 emitted different C"; exit 1; }
+
+# b2 is large, so its error is found after the small b5's has been.
+{ for k in $(seq 1 3000); do printf 'func g%d(x i32) i32 { return x }\n' "$k"; done
+  printf 'func bad2() i32 { return ) }\n'; } > "$D/b2.ln"
+printf 'func ok1() i32 { return 1 }\n' > "$D/b1.ln"
+printf 'func ok3() i32 { return 3 }\n' > "$D/b3.ln"
+printf 'func bad5() i32 {\n    var x = [1, 2\n}\n' > "$D/b5.ln"
+printf 'import b1\nimport b2\nimport b3\nimport b5\nproc main() i32 { return 0 }\n' > "$D/bad.ln"
+( cd "$D" && "$LAIN" bad.ln -o bad.c > serial.out 2>&1 ); src=$?
+[ "$src" -ne 0 ] || { echo "bad program compiled"; exit 1; }
+for run in 1 2 3 4 5; do
+    ( cd "$D" && "$LAIN" bad.ln -j 4 -o bad.c > par.out 2>&1 ); prc=$?
+    [ "$prc" -eq "$src" ] || { echo "-j 4 exit $prc, serial $src"; exit 1; }
+    cmp -s "$D/serial.out" "$D/par.out" || { echo "-j 4 reported a different error:"; cat "$D/par.out"; exit 1; }
+done
+exit 0
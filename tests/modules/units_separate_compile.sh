@@ -0,0 +1,62 @@
+#!/usr/bin/env bash
+# --units: every unit compiles on its own as C99 and the objects link into a
+# working program. Re-emitting leaves the units whose C did not change
+# untouched (mtime included), so a C build only redoes the edited module, even
+# when the edit adds loops (their temporaries are numbered per function), and
+# the unit of a module the program stopped importing is removed.
+set -u
+ROOT="$(cd "$(dirname "$0")/../.." && pwd)"
+LAIN="${LAIN:-$ROOT/lain}"
+CC="${CC:-gcc}"
+D="$(mktemp -d)"
+trap 'rm -rf "$D"' EXIT
+
+printf 'func base(x i32) i32 {\n    var c i32 = x\n    for i in 0..1 { c = c +%% 1 }\n    return c\n}\n' > "$D/shared.ln"
+printf 'func twice(x i32) i32 {\n    var c i32 = 0\n    for i in 0..2 { c = c +%% x }\n    return c\n}\n' > "$D/other.ln"
+printf 'import shared\nimport other\nproc main() i32 { return other.twice(shared.base(20)) }\n' > "$D/app.ln"
+units() { ( cd "$D" && "$LAIN" app.ln --units=u >/dev/null 2>&1 ); }
+build() {
+    rm -f "$D"/u/*.o
+    for c in "$D"/u/*.c; do
+        "$CC" -std=c99 -c "$c" -o "${c%.c}.o" 2>/dev/null || { echo "$(basename "$c") does not compile"; return 1; }
+    done
+    "$CC" "$D"/u/*.o -o "$D/prog" || { echo "units do not link"; return 1; }
+}
+run() { "$D/prog"; echo $?; }
+
+units || { echo "--units compile failed"; exit 1; }
+for f in lain.h app.c shared.c other.c; do
+    [ -f "$D/u/$f" ] || { echo "missing unit $f"; exit 1; }
+done
+build || exit 1
+[ "$(run)" -eq 42 ] || { echo "linked program returned $(run), not 42"; exit 1; }
+
+touch -d '2000-01-01' "$D"/u/*
+units || { echo "re-emit failed"; exit 1; }
+[ -z "$(find "$D/u" -type f -newer "$D/app.ln")" ] || { echo "re-emit rewrote unchanged units"; exit 1; }
+
+# Edit one module, then the other: each time only the edited unit changes.
+printf 'func twice(x i32) i32 {\n    var c i32 = 0\n    for i in 0..3 { c = c +%% x }\n    return c\n}\n' > "$D/other.ln"
+units || { echo "re-emit after edit failed"; exit 1; }
+[ -n "$(find "$D/u/other.c" -newer "$D/app.ln")" ] || { echo "edited unit was not rewritten"; exit 1; }
+[ -z "$(find "$D/u" -type f -name '*.[ch]' ! -name other.c -newer "$D/app.ln")" ] \
+    || { echo "edit to other.ln rewrote other units"; exit 1; }
+build || exit 1
+[ "$(run)" -eq 63 ] || { echo "rebuilt program returned $(run), not 63"; exit 1; }
+
+touch -d '2000-01-01' "$D"/u/*
+printf 'func base(x i32) i32 {\n    var c i32 = x\n    for i in 0..1 { c = c +%% 1 }\n    for i in 0..0 { c = c +%% 1 }\n    return c\n}\n' > "$D/shared.ln"
+units || { echo "re-emit after second edit failed"; exit 1; }
+[ -n "$(find "$D/u/shared.c" -newer "$D/app.ln")" ] || { echo "edited unit was not rewritten"; exit 1; }
+[ -z "$(find "$D/u" -type f -name '*.[ch]' ! -name shared.c -newer "$D/app.ln")" ] \
+    || { echo "edit to shared.ln rewrote other units"; exit 1; }
+
+printf 'int helper(void) { return 0; }\n' > "$D/u/helper.c"
+printf 'import shared\nproc main() i32 { return shared.base(6) }\n' > "$D/app.ln"
+units || { echo "re-emit without other failed"; exit 1; }
+[ ! -e "$D/u/other.c" ] || { echo "stale unit other.c was kept"; exit 1; }
+[ -f "$D/u/helper.c" ] || { echo "a C file that is not a unit was removed"; exit 1; }
+rm "$D/u/helper.c"
+build || exit 1
+[ "$(run)" -eq 7 ] || { echo "program without other returned $(run), not 7"; exit 1; }
+exit 0